@@ -128,24 +128,18 @@ bool renderMenu(GLFWwindow* win, Camera& cam, RenderEngine* eng, const float cpu
     cam.setFarPlane(farPlane);
 
     RenderDevice* dev = eng->getDevice();
-    const RenderGraph& graph = eng->getRenderGraph();
-    const std::vector<uint64_t> timeStamps = dev->getAvailableTimestamps();
-    // There is a 3 frame delay on timestamps so graph could have been rebuilt by now.
-    if(timeStamps.size() == graph.taskCount())
+    const std::vector<TaskTimestamp>& timeStamps = dev->getAvailableTimestamps();
+    float totalGPUTime = 0.0f;
+    for(const TaskTimestamp& timeStamp : timeStamps)
     {
-        float totalGPUTime = 0.0f;
-        for(uint32_t i = 0; i < timeStamps.size(); ++i)
-        {
-            const RenderTask& task = graph.getTask(i);
-            const float taskTime = dev->getTimeStampPeriod() * (float(timeStamps[i]) / 1000000.0f);
-            ImGui::Text("%s : %f ms", task.getName().c_str(), taskTime);
-            totalGPUTime += taskTime;
-        }
-
-        ImGui::Text("Total GPU time %f ms", totalGPUTime);
-        ImGui::Text("Total CPU time %f ms", cpuTime);
+        const float taskTime = dev->getTimeStampPeriod() * (float(timeStamp.mDuration) / 1000000.0f);
+        ImGui::Text("%s : %f ms", timeStamp.mTaskName.c_str(), taskTime);
+        totalGPUTime += taskTime;
     }
 
+    ImGui::Text("Total GPU time %f ms", totalGPUTime);
+    ImGui::Text("Total CPU time %f ms", cpuTime);
+
 	ImGui::End();
 
 	ImGui::Render();
@@ -1,7 +1,7 @@
 #ifndef BELL_LOGGING_HPP
 #define BELL_LOGGING_HPP
 
-#include <stdio.h>
+#include "Core/Log.hpp"
 
 #ifndef NDEBUG
 #define ENABLE_LOGGING 1
@@ -9,22 +9,19 @@
 #define ENABLE_LOGGING 0
 #endif
 
-// This file contains logging/assert macros that will print out in debug builds.
+// This file contains logging/assert macros. Logging is in all builds and filtered at runtime (see Log.hpp),
+// traps and asserts are only enabled in debug builds.
 #define BELL_ENABLE_LOGGING ENABLE_LOGGING
 
 // BELL_LOG
-#if BELL_ENABLE_LOGGING
-
-#define BELL_LOG_ARGS(msg_format, ...) printf(msg_format "\n", __VA_ARGS__); \
-                                        fflush(stdout);
-#define BELL_LOG(msg)		  printf(msg "\n");
+#define BELL_LOG_SEVERITY(severity, category, ...) { if(Log::isEnabled(severity, category)) Log::write(severity, category, __FILE__, __LINE__, __VA_ARGS__); }
 
-#else
+#define BELL_LOG_ARGS(msg_format, ...) BELL_LOG_SEVERITY(Log::Severity::Info, Log::Category::General, msg_format, __VA_ARGS__)
+#define BELL_LOG(msg)		  BELL_LOG_SEVERITY(Log::Severity::Info, Log::Category::General, msg)
 
-#define BELL_LOG_ARGS(msg_format, ...)
-#define BELL_LOG(msg)
-
-#endif
+#define BELL_LOG_TRACE(category, ...) BELL_LOG_SEVERITY(Log::Severity::Trace, Log::Category::category, __VA_ARGS__)
+#define BELL_LOG_WARNING(category, ...) BELL_LOG_SEVERITY(Log::Severity::Warning, Log::Category::category, __VA_ARGS__)
+#define BELL_LOG_ERROR(category, ...) BELL_LOG_SEVERITY(Log::Severity::Error, Log::Category::category, __VA_ARGS__)
 
 // BELL_TRAP
 #if BELL_ENABLE_LOGGING
@@ -48,7 +45,7 @@
 // BELL_ASSRT
 #if BELL_ENABLE_LOGGING
 
-#define BELL_ASSERT(condition, msg) if(!(condition)) { printf(msg #condition "\n"); BELL_TRAP; }
+#define BELL_ASSERT(condition, msg) if(!(condition)) { Log::write(Log::Severity::Fatal, Log::Category::General, __FILE__, __LINE__, "%s", msg #condition); BELL_TRAP; }
 
 #else
 
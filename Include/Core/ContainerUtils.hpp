@@ -2,7 +2,9 @@
 #define CONTAINER_UTILS_HPP
 
 #include <cstdint>
+#include <cstring>
 #include <new>
+#include <vector>
 
 #include "BellLogging.hpp"
 #include "Engine/Allocators.hpp"
@@ -71,26 +73,6 @@ class Array
 {
 public:
 
-    Array(const uint64_t count, RAIISlabAllocator& alloc)
-    {
-        mBacking = static_cast<T*>(alloc.allocate(count * sizeof(T), alignof(T)));
-        mSize = count;
-        mNext = 0;
-        mAllocator = nullptr;
-
-        BELL_ASSERT(mBacking, "Allocator is exhausted")
-    }
-
-    Array(const uint64_t count, SlabAllocator& alloc)
-    {
-        mBacking = static_cast<T*>(alloc.allocate(count * sizeof(T), alignof(T)));
-        mSize = count;
-        mNext = 0;
-        mAllocator = nullptr;
-
-        BELL_ASSERT(mBacking, "Allocator is exhausted")
-    }
-
     Array(const uint64_t count, std::pmr::memory_resource* alloc)
     {
         mBacking = static_cast<T*>(alloc->allocate(count * sizeof(T), alignof(T)));
@@ -103,11 +85,10 @@ public:
 
     ~Array()
     {
-        // not using a frame/slab allocator so need to manually free memory.
-        if(mAllocator)
-        {
-            mAllocator->deallocate(mBacking, mSize * sizeof(T), alignof(T));
-        }
+        for(uint64_t i = 0; i < mNext; ++i)
+            mBacking[i].~T();
+
+        mAllocator->deallocate(mBacking, mSize * sizeof(T), alignof(T));
     }
 
     T* data()
@@ -199,4 +180,57 @@ private:
 };
 
 
+// LSD radix sort on a 64 bit key, a byte per pass. Stable, so equal keys keep their order.
+// Passes over a byte that is the same for every key are skipped, so small keys only pay for the bytes they use.
+// T must be trivially copyable, scratch is only used as working memory.
+template<typename T, typename KeyFunc>
+void radixSort(std::vector<T>& items, std::vector<T>& scratch, KeyFunc key)
+{
+    const size_t count = items.size();
+    if(count <= 1)
+        return;
+
+    uint32_t histograms[8][256];
+    memset(histograms, 0, sizeof(histograms));
+
+    for(const T& item : items)
+    {
+        const uint64_t k = key(item);
+        for(uint32_t byte = 0; byte < 8; ++byte)
+            ++histograms[byte][(k >> (byte * 8)) & 0xFF];
+    }
+
+    scratch.resize(count);
+    T* src = items.data();
+    T* dst = scratch.data();
+
+    for(uint32_t byte = 0; byte < 8; ++byte)
+    {
+        uint32_t* histogram = histograms[byte];
+        const uint64_t firstDigit = (key(src[0]) >> (byte * 8)) & 0xFF;
+        if(histogram[firstDigit] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for(uint32_t digit = 0; digit < 256; ++digit)
+        {
+            const uint32_t digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        for(size_t i = 0; i < count; ++i)
+        {
+            const uint64_t digit = (key(src[i]) >> (byte * 8)) & 0xFF;
+            dst[histogram[digit]++] = src[i];
+        }
+
+        std::swap(src, dst);
+    }
+
+    if(src != items.data())
+        items.swap(scratch);
+}
+
+
 #endif
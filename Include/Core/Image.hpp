@@ -17,6 +17,7 @@ class RenderDevice;
 class Executor;
 class ImageViewBase;
 class VulkanBarrierRecorder;
+class NullBarrierRecorder;
 
 struct ImageExtent
 {
@@ -35,6 +36,7 @@ struct SubResourceInfo
 class ImageBase : public GPUResource, public DeviceChild 
 {
 	friend VulkanBarrierRecorder;
+	friend NullBarrierRecorder;
 	friend ImageViewBase;
 public:
 
@@ -11,6 +11,7 @@
 
 struct SubResourceInfo;
 class VulkanBarrierRecorder;
+class NullBarrierRecorder;
 
 
 enum class ImageViewType
@@ -24,6 +25,7 @@ enum class ImageViewType
 class ImageViewBase : public GPUResource, public DeviceChild
 {
     friend VulkanBarrierRecorder;
+    friend NullBarrierRecorder;
 public:
 
 	ImageViewBase(Image&,
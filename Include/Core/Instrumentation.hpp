@@ -0,0 +1,104 @@
+#ifndef BELL_INSTRUMENTATION_HPP
+#define BELL_INSTRUMENTATION_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+// Built in CPU and GPU instrumentation, cheap enough to leave compiled in to release builds.
+// Recording is off until enabled at runtime, whilst off a scoped event costs a single relaxed load. Whilst on each
+// thread writes it's events in to it's own ring buffer, so recording never takes a lock. The engine feeds in GPU
+// task timings as they resolve and brackets each frame, which builds rolling frame statistics.
+namespace Instrumentation
+{
+    // Events kept per thread, older ones are overwritten.
+    constexpr uint32_t kEventsPerThread = 16384;
+    // Frames the statistics are calculated over.
+    constexpr uint32_t kStatisticsWindow = 256;
+
+    extern std::atomic<bool> gEnabled;
+
+    inline bool isEnabled()
+    {
+        return gEnabled.load(std::memory_order_relaxed);
+    }
+
+    // Clears anything recorded when enabling, so a capture only contains what happened whilst it was on.
+    void setEnabled(const bool);
+
+    void setThreadName(const char* name);
+
+    uint64_t getTimeNs();
+
+    // Names must outlive the capture, string literals or __func__.
+    void recordCPUEvent(const char* name, const uint64_t startNs, const uint64_t endNs);
+
+    class ScopedEvent
+    {
+    public:
+
+        ScopedEvent(const char* function, const char* name = nullptr) :
+            mName{name ? name : function},
+            mStartNs{isEnabled() ? getTimeNs() : 0} {}
+
+        ~ScopedEvent()
+        {
+            if(mStartNs != 0)
+                recordCPUEvent(mName, mStartNs, getTimeNs());
+        }
+
+        ScopedEvent& operator=(const ScopedEvent&) = delete;
+        ScopedEvent(const ScopedEvent&) = delete;
+
+    private:
+
+        const char* mName;
+        uint64_t mStartNs;
+    };
+
+    struct GPUTaskTime
+    {
+        std::string mTaskName;
+        double mMilliseconds;
+    };
+
+    struct FrameMetrics
+    {
+        uint64_t mFrame;
+        double mCPUMilliseconds;
+        double mGPUMilliseconds; // Sum of the task times.
+        const std::vector<GPUTaskTime>& mGPUTasks; // Resolved this frame, so are from a frame or more ago.
+    };
+
+    // Called at the end of every frame whilst enabled.
+    using MetricsCallback = std::function<void(const FrameMetrics&)>;
+    void setMetricsCallback(MetricsCallback);
+
+    void beginFrame();
+    void recordGPUTasks(const std::vector<GPUTaskTime>&);
+    void endFrame();
+
+    struct Statistic
+    {
+        double mMean;
+        double mP50;
+        double mP99;
+        double mMax;
+        uint32_t mSamples;
+    };
+
+    // In milliseconds over the last kStatisticsWindow frames, "cpu/frame", "gpu/frame" and "gpu/<task name>".
+    std::vector<std::pair<std::string, Statistic>> getStatistics();
+
+    // Writes everything currently recorded in the Chrome trace event format, viewable in chrome://tracing or Perfetto.
+    // GPU task durations are exact, but as only durations are resolved they're laid out back to back from the start
+    // of the frame they were resolved in on their own track.
+    bool writeChromeTrace(const char* path);
+}
+
+#endif
@@ -0,0 +1,198 @@
+#ifndef BELL_LOG_HPP
+#define BELL_LOG_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+
+// Asynchronous logging backend behind the BELL_LOG macros, compiled in to all builds.
+// Logging a message only copies the format string pointer and the binary arguments in to a buffer owned by the
+// calling thread. A background writer drains every threads buffer, does the printf style formatting and passes
+// the messages on to the registered sinks in timestamp order. Messages are dropped rather than blocking when a
+// threads buffer is full, the writer reports how many were lost.
+namespace Log
+{
+    enum class Severity : uint8_t
+    {
+        Trace,
+        Info,
+        Warning,
+        Error,
+        Fatal, // Flushed before returning.
+        Count
+    };
+
+    enum class Category : uint8_t
+    {
+        General,
+        Device,
+        RenderGraph,
+        Engine,
+        Assets,
+        Shaders,
+        Count
+    };
+
+    const char* getSeverityName(const Severity);
+    const char* getCategoryName(const Category);
+
+    // Bytes of buffered messages per thread.
+    constexpr uint32_t kBufferSize = 256 * 1024;
+    // Largest size of a single messages packed arguments, longer strings are truncated.
+    constexpr uint32_t kMaxArgumentSize = 4096;
+
+    extern std::atomic<uint8_t> gMinimumSeverity[static_cast<uint32_t>(Category::Count)];
+
+    inline bool isEnabled(const Severity severity, const Category category)
+    {
+        return static_cast<uint8_t>(severity) >= gMinimumSeverity[static_cast<uint32_t>(category)].load(std::memory_order_relaxed);
+    }
+
+    // Messages below severity are discarded before anything is copied. Defaults to Info.
+    void setMinimumSeverity(const Severity);
+    void setMinimumSeverity(const Category, const Severity);
+
+    struct Record
+    {
+        uint64_t mTimeNs;
+        uint32_t mThreadID;
+        Severity mSeverity;
+        Category mCategory;
+        const char* mFile;
+        uint32_t mLine;
+        std::string_view mMessage;
+    };
+
+    // Sinks are only ever called from one thread at a time.
+    class Sink
+    {
+    public:
+        virtual ~Sink() = default;
+
+        virtual void write(const Record&) = 0;
+        virtual void flush() {}
+    };
+
+    // Errors and above go to stderr, the rest to stdout. Registered by default.
+    class ConsoleSink : public Sink
+    {
+    public:
+        void write(const Record&) override;
+        void flush() override;
+    };
+
+    class FileSink : public Sink
+    {
+    public:
+        FileSink(const char* path);
+        ~FileSink() override;
+
+        bool isOpen() const
+        {
+            return mFile != nullptr;
+        }
+
+        void write(const Record&) override;
+        void flush() override;
+
+    private:
+
+        FILE* mFile;
+    };
+
+    // Takes ownership, returns the sink for removing it later.
+    Sink* addSink(std::unique_ptr<Sink>);
+    void removeSink(const Sink*);
+    void clearSinks();
+
+    // Blocks until every message logged before the call has been written.
+    void flush();
+
+    // Arguments are packed as a tag followed by their value, strings are copied.
+    class ArgumentPacker
+    {
+    public:
+
+        enum class Tag : uint8_t
+        {
+            Signed,
+            Unsigned,
+            Float,
+            String,
+            Pointer
+        };
+
+        ArgumentPacker() :
+            mSize{0} {}
+
+        template<typename T>
+        void add(const T& value)
+        {
+            if constexpr(std::is_same_v<T, bool>)
+                addValue(Tag::Unsigned, static_cast<uint64_t>(value));
+            else if constexpr(std::is_enum_v<T>)
+                addValue(Tag::Unsigned, static_cast<uint64_t>(value));
+            else if constexpr(std::is_integral_v<T> && std::is_signed_v<T>)
+                addValue(Tag::Signed, static_cast<int64_t>(value));
+            else if constexpr(std::is_integral_v<T>)
+                addValue(Tag::Unsigned, static_cast<uint64_t>(value));
+            else if constexpr(std::is_floating_point_v<T>)
+                addValue(Tag::Float, static_cast<double>(value));
+            else if constexpr(std::is_convertible_v<const T&, const char*>)
+                addString(static_cast<const char*>(value));
+            else if constexpr(std::is_convertible_v<const T&, const wchar_t*>)
+                addWideString(static_cast<const wchar_t*>(value));
+            else if constexpr(std::is_pointer_v<T>)
+                addValue(Tag::Pointer, reinterpret_cast<uint64_t>(value));
+            else
+                static_assert(std::is_pointer_v<T>, "Unsupported log argument, strings need passing with c_str()");
+        }
+
+        const unsigned char* getData() const
+        {
+            return mData;
+        }
+
+        uint32_t getSize() const
+        {
+            return mSize;
+        }
+
+    private:
+
+        template<typename T>
+        void addValue(const Tag tag, const T value)
+        {
+            if(mSize + 1 + sizeof(T) > kMaxArgumentSize)
+                return;
+
+            mData[mSize++] = static_cast<unsigned char>(tag);
+            std::memcpy(mData + mSize, &value, sizeof(T));
+            mSize += sizeof(T);
+        }
+
+        void addString(const char*);
+        void addWideString(const wchar_t*);
+
+        unsigned char mData[kMaxArgumentSize];
+        uint32_t mSize;
+    };
+
+    // Format must be a string literal, as it's only formatted later on the writer thread.
+    void submit(const Severity, const Category, const char* file, const uint32_t line, const char* format, const ArgumentPacker&);
+
+    template<typename... Args>
+    void write(const Severity severity, const Category category, const char* file, const uint32_t line, const char* format, const Args&... args)
+    {
+        ArgumentPacker packer{};
+        (packer.add(args), ...);
+        submit(severity, category, file, line, format, packer);
+    }
+}
+
+#endif
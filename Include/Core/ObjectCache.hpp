@@ -0,0 +1,111 @@
+#ifndef OBJECT_CACHE_HPP
+#define OBJECT_CACHE_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+
+
+// Thread safe cache for backend objects created on demand whilst recording (framebuffers, samplers...).
+// Keys are spread over StripeCount independently locked maps, so threads only contend when their keys hash to the
+// same stripe. Every entry tracks the last submission it was returned for, so callers can evict objects that
+// haven't been used recently and defer their destruction until that submission has finished.
+template<typename K, typename V, typename Hasher = std::hash<K>, uint32_t StripeCount = 16>
+class ObjectCache
+{
+public:
+
+    ObjectCache() = default;
+
+    ObjectCache(const ObjectCache&) = delete;
+    ObjectCache& operator=(const ObjectCache&) = delete;
+
+    // create is called with the stripe locked, so is only called once per key.
+    template<typename Create>
+    V get(const K& key, const uint64_t submission, Create&& create)
+    {
+        const size_t hash = mHasher(key);
+        Stripe& stripe = mStripes[hash % StripeCount];
+
+        std::lock_guard<std::mutex> lock{stripe.mLock};
+
+        auto it = stripe.mEntries.find(key);
+        if(it != stripe.mEntries.end())
+        {
+            it->second.mLastUsed = std::max(it->second.mLastUsed, submission);
+            return it->second.mValue;
+        }
+
+        const V value = create();
+        stripe.mEntries.insert({key, Entry{value, submission}});
+
+        return value;
+    }
+
+    // Removes every entry evict returns true for, destroy is called with the value and the submission it was last used in.
+    template<typename Evict, typename Destroy>
+    void evictIf(Evict&& evict, Destroy&& destroy)
+    {
+        for(Stripe& stripe : mStripes)
+        {
+            std::lock_guard<std::mutex> lock{stripe.mLock};
+
+            for(auto it = stripe.mEntries.begin(); it != stripe.mEntries.end();)
+            {
+                if(evict(it->first, it->second.mLastUsed))
+                {
+                    destroy(it->second.mValue, it->second.mLastUsed);
+                    it = stripe.mEntries.erase(it);
+                }
+                else
+                    ++it;
+            }
+        }
+    }
+
+    template<typename Destroy>
+    void evictUnused(const uint64_t oldestSubmission, Destroy&& destroy)
+    {
+        evictIf([oldestSubmission](const K&, const uint64_t lastUsed) { return lastUsed < oldestSubmission; }, destroy);
+    }
+
+    template<typename Destroy>
+    void clear(Destroy&& destroy)
+    {
+        evictIf([](const K&, const uint64_t) { return true; }, destroy);
+    }
+
+    size_t size() const
+    {
+        size_t count = 0;
+        for(const Stripe& stripe : mStripes)
+        {
+            std::lock_guard<std::mutex> lock{stripe.mLock};
+            count += stripe.mEntries.size();
+        }
+
+        return count;
+    }
+
+private:
+
+    struct Entry
+    {
+        V mValue;
+        uint64_t mLastUsed;
+    };
+
+    // Padded to avoid false sharing between the stripe locks.
+    struct alignas(64) Stripe
+    {
+        mutable std::mutex mLock;
+        std::unordered_map<K, Entry, Hasher> mEntries;
+    };
+
+    Hasher mHasher;
+    Stripe mStripes[StripeCount];
+};
+
+#endif
@@ -5,10 +5,18 @@
 
 #define USE_OPTIK PROFILE
 
+// The built in instrumentation is used when Optick isn't, it does nothing until enabled at runtime.
+#ifndef BELL_INSTRUMENTATION
+#define BELL_INSTRUMENTATION 1
+#endif
+
 #include "optick.h"
+#include "Core/Instrumentation.hpp"
 
 #ifdef VULKAN
 #include "Core/Vulkan/VulkanExecutor.hpp"
+#elif defined(NULL_DEVICE)
+#include "Core/Null/NullExecutor.hpp"
 #else
 #include "Core/DX_12/DX_12Executor.hpp"
 #endif
@@ -33,6 +41,11 @@
 
 #define PROFILER_GPU_TASK(exec) OPTICK_GPU_CONTEXT(static_cast<VulkanExecutor*>(exec)->getCommandBuffer())
 
+#elif defined(NULL_DEVICE)
+
+// Nothing runs on a GPU to be profiled.
+#define PROFILER_GPU_TASK(exec)
+
 #else
 
 #define PROFILER_GPU_TASK(exec) OPTICK_GPU_CONTEXT(static_cast<DX12_Executor*>(exec)->getCommandList())
@@ -41,6 +54,28 @@
 
 #define PROFILER_GPU_EVENT(n) OPTICK_GPU_EVENT(n)
 
+#elif BELL_INSTRUMENTATION
+
+#define PROFILER_CONCAT_IMPL(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_IMPL(a, b)
+
+#define PROFILER_START_FRAME(n)
+
+// Named after the enclosing function unless given a name.
+#define PROFILER_EVENT(...) Instrumentation::ScopedEvent PROFILER_CONCAT(profilerEvent, __LINE__){__func__, ##__VA_ARGS__};
+
+#define PROFILER_THREAD(n) Instrumentation::setThreadName(n);
+
+#define PROFILER_TAG(e, n)
+
+#define PROFILER_INIT_VULKAN(dev, physDev, queues, queueFamilies, queueCount, functions)
+
+#define PROFILER_GPU_FLIP(swapChain)
+
+#define PROFILER_GPU_TASK(exec)
+
+#define PROFILER_GPU_EVENT(n)
+
 #else
 
 #define PROFILER_START_FRAME(n)
@@ -8,6 +8,7 @@
 #include "Engine/PassTypes.hpp"
 
 #include <memory>
+#include <utility>
 #include <vector>
 
 class ImageView;
@@ -29,9 +30,16 @@ public:
     void addDataBufferWO(const BufferView&);
     void addDataBufferROArray(const BufferViewArray&);
 
+    // Bindless arrays can have individual elements changed after the set has been finalised, and whilst
+    // it's in use by frames in flight as long as the element being changed isn't accessed by them.
+    void addBindlessSampledImageArray(const ImageViewArray&);
+    void setSampledImageArrayElement(const uint32_t binding, const uint32_t element, const ImageView&);
+
     void updateLastAccessed();
 
 	virtual void finalise() = 0;
+    // Writes any array elements that have changed since finalise or the last update.
+    virtual void updateArrayElements() = 0;
 
 	struct ResourceInfo
 	{
@@ -50,6 +58,9 @@ protected:
     std::vector<BufferViewArray> mBufferArrays;
 
 	std::vector<ResourceInfo> mResources;
+
+    bool mUpdateAfterBind;
+    std::vector<std::pair<uint32_t, uint32_t>> mPendingElementUpdates; // binding, element.
 };
 
 
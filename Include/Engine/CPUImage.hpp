@@ -7,45 +7,76 @@
 #include "Core/Image.hpp"
 #include "Core/ConversionUtils.hpp"
 
+#include <vector>
 
+
+// Filtered images for the CPU ray tracer.
+// A full mip chain is built on construction and every level is stored in 4x4 texel tiles, so the texels of a
+// bilinear footprint are nearly always in the same cache line. Lookups are bilinear within a level and linear
+// between levels, the format specific texel fetch is picked once up front rather than on each lookup.
 class CPUImage
 {
 public:
-    CPUImage(std::vector<unsigned char>&& data, const ImageExtent& extent, const Format format) :
-    mData(data),
-    mExtent(extent),
-    mFormat(format),
-    mPixelSize(getPixelSize(mFormat))
-    {}
+    CPUImage(std::vector<unsigned char>&& data, const ImageExtent& extent, const Format format);
 
-    ~CPUImage();
+    float sample(const float2& uv, const float lod = 0.0f) const;
+    float2 sample2(const float2& uv, const float lod = 0.0f) const;
+    float3 sample3(const float2& uv, const float lod = 0.0f) const;
+    float4 sample4(const float2& uv, const float lod = 0.0f) const;
 
-    float sample(const float2& uv) const;
-    float2 sample2(const float2& uv) const;
-    float3 sample3(const float2& uv) const;
-    float4 sample4(const float2& uv) const;
+    float sampleCube(const float3& uv, const float lod = 0.0f) const;
+    float2 sampleCube2(const float3& uv, const float lod = 0.0f) const;
+    float3 sampleCube3(const float3& uv, const float lod = 0.0f) const;
+    float4 sampleCube4(const float3& uv, const float lod = 0.0f) const;
 
-    float sampleCube(const float3& uv) const;
-    float2 sampleCube2(const float3& uv) const;
-    float3 sampleCube3(const float3& uv) const;
-    float4 sampleCube4(const float3& uv) const;
+    // Level of detail for a ray cone hitting a surface. triangleLOD is 0.5 * log2(uv area / world area) of the
+    // hit triangle, coneWidth the width of the cone at the hit and cosTheta the cosine between the ray and the normal.
+    float calculateLOD(const float triangleLOD, const float coneWidth, const float cosTheta) const;
+    // Level of detail for a cube map lookup by a cone with the given spread angle in radians.
+    float calculateCubeLOD(const float spreadAngle) const;
 
     const ImageExtent& getExtent() const
     {
         return mExtent;
     }
 
+    uint32_t getMipCount() const
+    {
+        return static_cast<uint32_t>(mMips.size());
+    }
+
+    static constexpr uint32_t kTileSize = 4;
+
+    struct MipLevel
+    {
+        uint32_t mWidth;
+        uint32_t mHeight;
+        uint32_t mTilesX;
+        uint64_t mOffset;
+        uint64_t mFaceSize; // Faces of a cube map are stored consecutively within each level.
+    };
+
+    // Bilinear lookup in a single face of a single level.
+    using BilinearFunction = float4(*)(const unsigned char* data, const MipLevel& level, const float2& uv, const bool wrap);
+    using StoreFunction = void(*)(const float4& texel, unsigned char* data);
+
 private:
 
-    const unsigned char* getDataPtr(const float2& uv) const;
-    const unsigned char* getDataPtr(const float2& uv, const uint32_t face) const;
+    void buildMipChain(const std::vector<unsigned char>& linearData);
+
+    float4 sampleLevels(const float2& uv, const uint32_t face, const float lod, const bool wrap) const;
+    float4 sampleCubeLevels(const float3& d, const float lod) const;
 
     void resolveCubemapUV(const float3& v, uint32_t& faceIndex, float2& uvOut) const;
 
     std::vector<unsigned char> mData;
+    std::vector<MipLevel> mMips;
     ImageExtent mExtent;
     Format mFormat;
     uint32_t mPixelSize;
+
+    BilinearFunction mSampleBilinear;
+    StoreFunction mStore;
 };
 
 #endif
@@ -0,0 +1,234 @@
+#ifndef COOKED_MESH_HPP
+#define COOKED_MESH_HPP
+
+#include "Core/BellLogging.hpp"
+#include "Engine/GeomUtils.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Bell native mesh format (.bmesh).
+// Produced offline by the mesh cooker so that all the assimp post processing and per attribute
+// repacking only happens once. Vertex, index, submesh, meshlet and LOD data are stored in their final GPU layout
+// at 16 byte alligned offsets, so they can be copied/uploaded straight out of the mapped file.
+// The skeleton and animations are variable sized so are serialised after them with Writer/Reader.
+namespace CookedMesh
+{
+    constexpr uint32_t kMagic = 0x48534D42; // "BMSH"
+    constexpr uint32_t kVersion = 3;
+    constexpr const char* kFileExtension = ".bmesh";
+    constexpr uint64_t kSectionAllignment = 16;
+
+    struct Header
+    {
+        uint32_t mMagic;
+        uint32_t mVersion;
+        uint32_t mVertexAttributes;
+        uint32_t mVertexStride;
+        uint64_t mVertexCount;
+        uint64_t mIndexCount;
+        uint32_t mSubMeshCount;
+        uint32_t mBoneCount;
+        uint32_t mMeshletCount;
+        uint32_t mLODCount;
+        float4   mAABBMin;
+        float4   mAABBMax;
+
+        // Byte offsets from the start of the file.
+        uint64_t mVertexDataOffset;
+        uint64_t mIndexDataOffset;
+        uint64_t mSubMeshOffset;
+        uint64_t mMeshletOffset;
+        uint64_t mLODOffset; // LOD errors followed by the submesh LODs.
+        uint64_t mAnimationDataOffset;
+        uint64_t mAnimationDataSize;
+    };
+    static_assert(std::is_trivially_copyable_v<Header>, "Cooked mesh header must be trivially copyable");
+
+    bool isCookedMesh(const std::string& path);
+
+
+    class Writer
+    {
+    public:
+
+        Writer() :
+            mData{} {}
+
+        template<typename T>
+        void write(const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only POD types can be written directly");
+            writeBytes(&value, sizeof(T));
+        }
+
+        template<typename T>
+        void writeVector(const std::vector<T>& values)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only POD types can be written directly");
+            write<uint64_t>(values.size());
+            writeBytes(values.data(), values.size() * sizeof(T));
+        }
+
+        void writeString(const std::string& str)
+        {
+            write<uint64_t>(str.size());
+            writeBytes(str.data(), str.size());
+        }
+
+        void writeBytes(const void* data, const size_t size)
+        {
+            const size_t offset = mData.size();
+            mData.resize(offset + size);
+            if(size > 0)
+                std::memcpy(mData.data() + offset, data, size);
+        }
+
+        void allignTo(const uint64_t allignment)
+        {
+            mData.resize(((mData.size() + allignment - 1) / allignment) * allignment, 0);
+        }
+
+        // Overwrite previously written data, used for patching up the header.
+        template<typename T>
+        void writeAt(const uint64_t offset, const T& value)
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only POD types can be written directly");
+            BELL_ASSERT(offset + sizeof(T) <= mData.size(), "Writing past end of cooked data")
+            std::memcpy(mData.data() + offset, &value, sizeof(T));
+        }
+
+        uint64_t getOffset() const
+        {
+            return mData.size();
+        }
+
+        bool writeToFile(const std::string& path) const;
+
+    private:
+
+        std::vector<unsigned char> mData;
+    };
+
+
+    class Reader
+    {
+    public:
+
+        Reader(const unsigned char* data, const size_t size) :
+            mData{data},
+            mSize{size},
+            mOffset{0},
+            mValid{true} {}
+
+        template<typename T>
+        T read()
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only POD types can be read directly");
+            T value{};
+            readBytes(&value, sizeof(T));
+            return value;
+        }
+
+        template<typename T>
+        std::vector<T> readVector()
+        {
+            static_assert(std::is_trivially_copyable_v<T>, "Only POD types can be read directly");
+            const uint64_t count = read<uint64_t>();
+            if(!mValid || count > ((mSize - mOffset) / sizeof(T)))
+            {
+                mValid = false;
+                return {};
+            }
+
+            std::vector<T> values(count);
+            readBytes(values.data(), count * sizeof(T));
+            return values;
+        }
+
+        std::string readString()
+        {
+            const uint64_t size = read<uint64_t>();
+            if(!mValid || size > (mSize - mOffset))
+            {
+                mValid = false;
+                return {};
+            }
+
+            std::string str(reinterpret_cast<const char*>(mData + mOffset), size);
+            mOffset += size;
+            return str;
+        }
+
+        void readBytes(void* dst, const size_t size)
+        {
+            if(!mValid || size > (mSize - mOffset))
+            {
+                BELL_LOG_ERROR(Assets, "Read past end of cooked data")
+                mValid = false;
+                return;
+            }
+
+            if(size > 0)
+                std::memcpy(dst, mData + mOffset, size);
+            mOffset += size;
+        }
+
+        bool isValid() const
+        {
+            return mValid;
+        }
+
+    private:
+
+        const unsigned char* mData;
+        size_t mSize;
+        size_t mOffset;
+        bool mValid;
+    };
+
+
+    // Read only memory mapping of a whole file.
+    class MappedFile
+    {
+    public:
+
+        MappedFile(const std::string& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool isValid() const
+        {
+            return mData != nullptr;
+        }
+
+        const unsigned char* getData() const
+        {
+            return mData;
+        }
+
+        size_t getSize() const
+        {
+            return mSize;
+        }
+
+    private:
+
+        const unsigned char* mData;
+        size_t mSize;
+
+#ifdef _WIN32
+        void* mFileHandle;
+        void* mMappingHandle;
+#else
+        int mFileDescriptor;
+#endif
+    };
+}
+
+#endif
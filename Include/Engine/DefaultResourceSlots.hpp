@@ -54,6 +54,18 @@ extern const char kSkinningBuffers[];
 extern const char kMainCameraBVH[];
 extern const char kInstanceTransformsBuffer[];
 extern const char kPreviousInstanceTransformsBuffer[];
+extern const char kIndirectDrawCandidates[];
+extern const char kIndirectDrawCommands[];
+extern const char kIndirectDrawCounts[];
+extern const char kIndirectDrawEntries[];
+extern const char kIndirectDrawWork[];
+extern const char kIndirectDrawOcclusionRetest[];
+// The same buffers as the commands, counts and entries above, under their own names so that the second culling
+// phase can be ordered after the first phases draws.
+extern const char kIndirectDrawLateCommands[];
+extern const char kIndirectDrawLateCounts[];
+extern const char kIndirectDrawLateEntries[];
+extern const char kMeshlets[];
 
 extern const char kFrameBufer[];
 extern const char kGlobalLighting[];
@@ -15,6 +15,11 @@
 #include "Engine/UniformBuffers.h"
 #include "Engine/Technique.hpp"
 #include "Engine/ThreadPool.hpp"
+#include "Engine/TextureStreamer.hpp"
+#include "Engine/MaterialTable.hpp"
+#include "Engine/InstanceTable.hpp"
+#include "Engine/GeometryPool.hpp"
+#include "Engine/IndirectDrawList.hpp"
 #include "Core/Profiling.hpp"
 #include "Engine/Allocators.hpp"
 #include "Engine/RenderQueue.hpp"
@@ -30,6 +35,11 @@
 #include <string>
 #include <variant>
 
+namespace FrameCapture
+{
+    struct Frame;
+}
+
 struct GraphicsOptions
 {
     int deviceFeatures;
@@ -41,6 +51,8 @@ class RenderEngine
 public:
 
     RenderEngine(GLFWwindow*, const GraphicsOptions&);
+    // Renders without a window, only supported by the null device.
+    RenderEngine(const uint32_t width, const uint32_t height, const GraphicsOptions&);
 
     void setScene(const std::string& path);
 
@@ -67,6 +79,11 @@ public:
     }
 
     RenderView& getRenderView(const uint32_t index)
+    {
+        return mRenderViews[index];
+    }
+
+    const RenderView& getRenderView(const uint32_t index) const
     {
         return mRenderViews[index];
     }
@@ -115,13 +132,48 @@ public:
         return mDefaultMemoryResource;
     }
 
-    SlabAllocator& getFrameAllocator()
+    FrameAllocator& getFrameAllocator()
     {
         return mFrameAllocator;
     }
 
+    ThreadPool& getThreadPool()
+    {
+        return mThreadPool;
+    }
+
+    TextureStreamer& getTextureStreamer()
+    {
+        return mTextureStreamer;
+    }
+
+    MaterialTable& getMaterialTable()
+    {
+        return mMaterialTable;
+    }
+
+    InstanceTable& getInstanceTable()
+    {
+        return mInstanceTable;
+    }
+
+    GeometryPool& getGeometryPool()
+    {
+        return mGeometryPool;
+    }
+
+    const IndirectDrawList& getIndirectDrawList() const
+    {
+        return mIndirectDrawList;
+    }
+
 	void registerPass(const PassType);
 	bool isPassRegistered(const PassType) const;
+
+    uint64_t getRegisteredPasses() const
+    {
+        return mCurrentRegisteredPasses;
+    }
 	void clearRegisteredPasses()
 	{
 		mTechniques.clear();
@@ -170,6 +222,10 @@ public:
     {
         mRenderDevice->startFrame();
 
+        Instrumentation::beginFrame();
+        if(Instrumentation::isEnabled())
+            recordGPUTimings();
+
         mFrameUpdateDelta = frameDelta;
         // Start timestamp after swapchain wait ie don't count waiting for vsync in frametime.
         mFrameStartTime = std::chrono::system_clock::now();
@@ -180,11 +236,13 @@ public:
         mRenderDevice->endFrame();
         mDebugAABBs.clear();
         mDebugLines.clear();
-        mFrameAllocator.reset();
+        mFrameAllocator.nextFrame();
         // Set the frame time.
         mAccumilatedFrameUpdates += mFrameUpdateDelta;
         std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
         mLastFrameTime = std::chrono::duration_cast<std::chrono::microseconds>(now - mFrameStartTime);
+
+        Instrumentation::endFrame();
     }
 
     void render();
@@ -225,6 +283,21 @@ public:
         return mLastFrameTime;
     }
 
+    std::chrono::microseconds getFrameUpdateDelta() const
+    {
+        return mFrameUpdateDelta;
+    }
+
+    // Writes the inputs of the next rendered frame to path, see FrameCapture.hpp.
+    void captureNextFrame(const std::string& path)
+    {
+        mFrameCapturePath = path;
+    }
+
+    // Renders from the captured frame instead of the live scene until called with nullptr, the captured scene
+    // must already be set. The frame must outlive the replay, returns false if the scene doesn't match it.
+    bool setReplayFrame(const FrameCapture::Frame*);
+
     Technique* getRegisteredTechnique(const PassType);
 
     void rayTraceScene();
@@ -347,19 +420,26 @@ public:
 
 private:
 
+    RenderEngine(GLFWwindow*, const uint2 size, const GraphicsOptions&);
+
+    // Passes the task timings the device resolved this frame on to the instrumentation.
+    void recordGPUTimings();
+
     CPUImage renderDiffuseCubeMap(const CPURayTracingScene &scene, const float3 &position, const uint32_t x, const uint32_t y);
     SphericalHarmonic generateSphericalHarmonic(const float3 &position, const CPUImage& cubemap);
 
-    void updateInstanceTransformBuffers(const std::vector<MeshInstance*>&);
+    // Must be at least the number of frames in flight.
+    static constexpr uint32_t kFrameAllocatorFrameCount = 3;
 
     Allocator mDefaultMemoryResource;
-    SlabAllocator mFrameAllocator;
+    FrameAllocator mFrameAllocator;
 
     std::unique_ptr<Technique>                   getSingleTechnique(const PassType);
 
     GraphicsOptions mOptions;
 
     ThreadPool mThreadPool;
+    TextureStreamer mTextureStreamer;
 
     RenderInstance* mRenderInstance;
     RenderDevice* mRenderDevice;
@@ -375,8 +455,6 @@ private:
     uint32_t mAnimationVertexSize;
     BufferBuilder mAnimationVertexBuilder;
 
-    ShaderResourceSet mMaterials;
-
     Image mLTCMat;
     ImageView mLTCMatView;
     Image mLTCAmp;
@@ -387,6 +465,8 @@ private:
     Image mDefaultDiffuseTexture;
     ImageView mDefaultDiffuseView;
 
+    MaterialTable mMaterialTable;
+
     std::unordered_map < const MeshInstance*, uint64_t>                    mMeshBoundsCache;
 
     RenderGraph mCurrentRenderGraph;
@@ -399,11 +479,11 @@ private:
     std::shared_mutex mShaderCacheMutex;
     std::unordered_map<uint64_t, Shader> mShaderCache;
 
-    // Instance transforms buffers.
-    PerFrameResource<Buffer> mInstanceTransformsBuffer;
-    PerFrameResource<BufferView> mInstanceTransformsBufferView;
-    PerFrameResource<Buffer> mPrevInstanceTransformsBuffer;
-    PerFrameResource<BufferView> mPrevInstanceTransformsBufferView;
+    InstanceTable mInstanceTable;
+
+    // GPU driven rendering, only used when the indirect draw culling pass is registered.
+    GeometryPool mGeometryPool;
+    IndirectDrawList mIndirectDrawList;
 
     // Animation data.
     PerFrameResource<Buffer> mBoneBuffer;
@@ -432,7 +512,11 @@ private:
 
     float2 mTAAJitter[16];
 
-    void tickAnimations(const std::vector<MeshInstance*>&);
+    void tickAnimations(const std::pmr::vector<MeshInstance*>&);
+
+    std::string mFrameCapturePath;
+    std::vector<float4x4> mCapturedBoneMatrices;
+    const FrameCapture::Frame* mReplayFrame;
 
     std::chrono::system_clock::time_point mFrameStartTime;
     std::chrono::microseconds mLastFrameTime;
@@ -0,0 +1,131 @@
+#ifndef FRAME_CAPTURE_HPP
+#define FRAME_CAPTURE_HPP
+
+#include "Engine/GeomUtils.h"
+#include "Engine/Camera.hpp"
+#include "Engine/RenderQueue.hpp"
+#include "RenderGraph/RenderGraph.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class RenderEngine;
+
+// Bell frame capture format (.bframe).
+// Serialises the inputs to a single frame, the compiled render graph, what each render view drew, instance transforms
+// and bone matrices, so the frame can be re-recorded in isolation for profiling and A/B testing.
+// Meshes, materials and textures aren't captured, a replay loads them from the captured scene path and the captured
+// instances are matched up with the loaded ones by InstanceID.
+namespace FrameCapture
+{
+    constexpr uint32_t kMagic = 0x52464C42; // "BLFR"
+    constexpr uint32_t kVersion = 1;
+    constexpr const char* kFileExtension = ".bframe";
+
+    struct TaskInput
+    {
+        std::string mSlot;
+        AttachmentType mType;
+        uint64_t mArraySize;
+    };
+
+    struct TaskOutput
+    {
+        std::string mSlot;
+        AttachmentType mType;
+        Format mFormat;
+        SizeClass mSize;
+        LoadOp mLoadOp;
+        StoreOp mStoreOp;
+        ImageUsage mUsage;
+    };
+
+    struct Task
+    {
+        std::string mName;
+        TaskType mType;
+        uint8_t mRenderView;
+        std::vector<TaskInput> mInputs;
+        std::vector<TaskOutput> mOutputs;
+    };
+
+    // Only the description of bound resources is captured, not their contents.
+    struct BoundResource
+    {
+        std::string mSlot;
+        RenderGraph::ResourceType mType;
+        Format mFormat;
+        ImageExtent mExtent;
+        uint64_t mSize; // Of buffers, in bytes.
+        uint32_t mArraySize;
+    };
+
+    struct Instance
+    {
+        InstanceID mID;
+        float3 mPosition;
+        quat mRotation;
+        float3 mScale;
+        float4x4 mTransform; // World space, only for inspecting captures.
+        uint32_t mInstanceFlags;
+        uint32_t mBoneOffset;
+    };
+    static_assert(std::is_trivially_copyable_v<Instance>, "Captured instances are written directly");
+
+    struct CameraState
+    {
+        float3 mPosition;
+        float3 mDirection;
+        float3 mUp;
+        float2 mOrthographicSize;
+        float mNearPlane;
+        float mFarPlane;
+        float mFOV;
+        float mAspect;
+        CameraMode mMode;
+    };
+    static_assert(std::is_trivially_copyable_v<CameraState>, "Captured camera is written directly");
+
+    struct View
+    {
+        std::vector<InstanceID> mInstances;
+        std::vector<uint32_t> mLODs;
+        std::vector<ViewDraw> mDraws;
+    };
+
+    struct Frame
+    {
+        std::string mScenePath;
+        uint64_t mRegisteredPasses;
+        uint32_t mWidth;
+        uint32_t mHeight;
+        std::chrono::microseconds mFrameDelta;
+        CameraState mCamera;
+
+        // In the compiled order.
+        std::vector<Task> mTasks;
+        std::vector<std::pair<uint32_t, uint32_t>> mDependancies;
+        std::vector<BoundResource> mResources;
+
+        std::vector<Instance> mInstances; // Every instance drawn by any view.
+        View mViews[kRenderView_Count];
+        std::vector<float4x4> mBoneMatrices;
+    };
+
+    // Call once the frame has been recorded, boneMatrices are the ones uploaded this frame.
+    Frame captureFrame(RenderEngine&, const std::vector<float4x4>& boneMatrices);
+
+    bool writeToFile(const std::string& path, const Frame&);
+    bool readFromFile(const std::string& path, Frame&);
+
+    void applyCamera(const CameraState&, Camera&);
+
+    // Describes each difference in task order, slots and dependancies between two captured graphs.
+    std::vector<std::string> compareGraphs(const Frame& expected, const Frame& actual);
+}
+
+#endif
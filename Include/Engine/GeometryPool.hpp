@@ -0,0 +1,98 @@
+#ifndef GEOMETRY_POOL_HPP
+#define GEOMETRY_POOL_HPP
+
+#include "Core/Buffer.hpp"
+#include "Core/BufferView.hpp"
+#include "Engine/Meshlet.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class RenderDevice;
+class StaticMesh;
+
+// Shared vertex and index megabuffers for GPU driven rendering.
+// Meshes are packed in to blocks by vertex stride, so every draw from a block can share one vertex and index
+// buffer binding. Blocks are never resized, a new one is started once the current one is full.
+class GeometryPool
+{
+public:
+
+    GeometryPool(RenderDevice* dev);
+
+    struct Allocation
+    {
+        uint32_t mBlock;
+        uint32_t mVertexOffset; // In vertices.
+        uint32_t mIndexOffset;  // In indices.
+        uint32_t mMeshletOffset;
+    };
+
+    // Packs the mesh in to the pool the first time it's requested.
+    const Allocation& getAllocation(const StaticMesh* mesh);
+
+    const BufferView& getVertexBufferView(const uint32_t block) const
+    {
+        return mBlocks[block]->mVertexBufferView;
+    }
+
+    const BufferView& getIndexBufferView(const uint32_t block) const
+    {
+        return mBlocks[block]->mIndexBufferView;
+    }
+
+    // Every packed meshes meshlets, with index offsets relative to the start of their block.
+    const BufferView& getMeshletBufferView() const
+    {
+        return mMeshletBufferView;
+    }
+
+    uint32_t getBlockCount() const
+    {
+        return static_cast<uint32_t>(mBlocks.size());
+    }
+
+    // Keeps every block alive until the current frame has finished with it.
+    void updateLastAccessed();
+
+    // Forgets all meshes, blocks are released once the frames in flight have finished with them.
+    void clear();
+
+    static constexpr uint32_t kBlockVertexBytes = 32 * 1024 * 1024;
+    static constexpr uint32_t kBlockIndexCount = 8 * 1024 * 1024;
+
+private:
+
+    struct Block
+    {
+        Block(RenderDevice* dev, const uint32_t vertexStride, const uint32_t vertexCapacity, const uint32_t indexCapacity);
+
+        uint32_t mVertexStride;
+        uint32_t mVertexCapacity;
+        uint32_t mVertexCount;
+        uint32_t mIndexCapacity;
+        uint32_t mIndexCount;
+
+        Buffer mVertexBuffer;
+        BufferView mVertexBufferView;
+        Buffer mIndexBuffer;
+        BufferView mIndexBufferView;
+    };
+
+    void addMeshlets(const std::vector<Meshlet>& meshlets, const uint32_t indexOffset);
+
+    uint32_t findBlock(const uint32_t vertexStride, const uint32_t vertexCount, const uint32_t indexCount);
+
+    RenderDevice* mDevice;
+
+    std::vector<std::unique_ptr<Block>> mBlocks;
+    std::unordered_map<const StaticMesh*, Allocation> mAllocations;
+
+    std::vector<Meshlet> mMeshlets;
+    Buffer mMeshletBuffer;
+    BufferView mMeshletBufferView;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef INDIRECT_DRAW_CULLING_TECHNIQUE_HPP
+#define INDIRECT_DRAW_CULLING_TECHNIQUE_HPP
+
+#include "Technique.hpp"
+#include "Core/Image.hpp"
+#include "Core/ImageView.hpp"
+#include "Core/RenderDevice.hpp"
+#include "Core/Sampler.hpp"
+#include "RenderGraph/GraphicsTask.hpp"
+
+#include <vector>
+
+
+// Frustum, normal cone and Hi-Z culls the engines indirect draw list a meshlet at a time, compacting the visible
+// draws in to per bucket indirect draw commands for the GPU driven geometry passes.
+// Occlusion culling is two phase. The first phase tests against last frames depth and the draws it keeps are
+// rendered to an occlusion depth buffer. The second phase retests what the first occluded against that, so
+// anything revealed this frame is still drawn this frame.
+class IndirectDrawCullingTechnique : public Technique
+{
+public:
+    IndirectDrawCullingTechnique(RenderEngine*, RenderGraph&);
+    ~IndirectDrawCullingTechnique() = default;
+
+    virtual PassType getPassType() const
+    {
+        return PassType::IndirectDrawCulling;
+    }
+
+    virtual void render(RenderGraph&, RenderEngine*) override;
+
+    virtual void bindResources(RenderGraph&);
+
+    virtual void postGraphCompilation(RenderGraph&, RenderEngine*) override;
+
+private:
+
+    uint32_t mMipLevels;
+
+    Shader mIndirectDrawCullingShader;
+    Shader mHierarchicalDepthShader;
+
+    Sampler mOcclusionSampler;
+
+    GraphicsPipelineDescription mOcclusionDepthDescription;
+    PipelineHandle mOcclusionDepthPipelines[2]; // For skinned and non-skinned.
+    TaskID mOcclusionDepthTask;
+
+    Image mHierarchicalDepth;
+    ImageView mHierarchicalDepthView;
+    std::vector<ImageView> mHierarchicalDepthMips;
+};
+
+#endif
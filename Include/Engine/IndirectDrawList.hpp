@@ -0,0 +1,125 @@
+#ifndef INDIRECT_DRAW_LIST_HPP
+#define INDIRECT_DRAW_LIST_HPP
+
+#include "Core/Buffer.hpp"
+#include "Core/BufferView.hpp"
+#include "Core/PerFrameResource.hpp"
+#include "Engine/GeomUtils.h"
+#include "Engine/StaticMesh.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class RenderDevice;
+class MeshInstance;
+class GeometryPool;
+
+// Matches the IndirectDrawCandidate struct in IndirectDrawCulling.comp.
+struct IndirectDrawCandidate
+{
+    float4 mBoundsMin;
+    float4 mBoundsMax;
+    MeshEntry mEntry;
+    uint32_t mIndexCount;
+    uint32_t mFirstIndex;
+    uint32_t mVertexOffset;
+    uint32_t mBucket;
+    uint32_t mFirstDraw; // First draw of the bucket.
+    uint32_t mPadding[3];
+};
+static_assert(sizeof(IndirectDrawCandidate) == 80, "Needs to match the shader struct layout");
+
+// Every submesh draw in a view, for the indirect draw culling pass to cull and compact in to indirect draws.
+// Submeshes with meshlets are culled and drawn a meshlet at a time, each one is a work item for the culling pass.
+// Draws are bucketed by pipeline and geometry pool block, each bucket gets a range of draw commands big enough
+// for all of its draws and is rendered with a single indirect draw count.
+class IndirectDrawList
+{
+public:
+
+    IndirectDrawList(RenderDevice* dev);
+
+    struct Bucket
+    {
+        uint64_t mShadeFlags;
+        uint32_t mBlock;
+        uint32_t mFirstDraw;
+        uint32_t mMaxDraws;
+    };
+
+    // Needs calling once a frame after the instance table has been updated, draws index its transform slots.
+    void build(const std::vector<const MeshInstance*>& instances, GeometryPool& pool);
+
+    const std::vector<Bucket>& getBuckets() const
+    {
+        return mBuckets;
+    }
+
+    // Upper bound on the number of draws, one per work item.
+    uint32_t getDrawCount() const
+    {
+        return static_cast<uint32_t>(mWork.size());
+    }
+
+    // Work items index a candidate and a meshlet in the geometry pool, or kNoMeshlet to draw the whole submesh.
+    static constexpr uint32_t kNoMeshlet = ~0u;
+
+    BufferView& getCandidatesView()
+    {
+        return *mCandidatesView;
+    }
+
+    BufferView& getCommandsView()
+    {
+        return *mCommandsView;
+    }
+
+    BufferView& getWorkView()
+    {
+        return *mWorkView;
+    }
+
+    BufferView& getCountsView()
+    {
+        return *mCountsView;
+    }
+
+    BufferView& getEntriesView()
+    {
+        return *mEntriesView;
+    }
+
+    // One flag per work item, set by the first culling phase for the work it occlusion culled.
+    BufferView& getOcclusionRetestView()
+    {
+        return *mOcclusionRetestView;
+    }
+
+private:
+
+    void upload();
+
+    RenderDevice* mDevice;
+
+    std::vector<Bucket> mBuckets;
+    std::unordered_map<uint64_t, uint32_t> mBucketLookup;
+    std::vector<IndirectDrawCandidate> mCandidates;
+    std::vector<uint2> mWork;
+    std::vector<uint32_t> mZeroCounts;
+
+    PerFrameResource<Buffer> mCandidatesBuffer;
+    PerFrameResource<BufferView> mCandidatesView;
+    PerFrameResource<Buffer> mWorkBuffer;
+    PerFrameResource<BufferView> mWorkView;
+    PerFrameResource<Buffer> mCommandsBuffer;
+    PerFrameResource<BufferView> mCommandsView;
+    PerFrameResource<Buffer> mCountsBuffer;
+    PerFrameResource<BufferView> mCountsView;
+    PerFrameResource<Buffer> mEntriesBuffer;
+    PerFrameResource<BufferView> mEntriesView;
+    PerFrameResource<Buffer> mOcclusionRetestBuffer;
+    PerFrameResource<BufferView> mOcclusionRetestView;
+};
+
+#endif
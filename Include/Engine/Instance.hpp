@@ -5,6 +5,9 @@
 #include <glm/gtx/transform.hpp>
 #include <glm/gtx/matrix_decompose.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <string>
 
 
@@ -17,7 +20,8 @@ public:
         mRotation(1.0f, 0.0f, 0.0f, 0.0f),
         mScale(10.f, 1.0f ,1.0f),
         mPreviousTransformation(trans),
-        mName{name}
+        mName{name},
+        mTransformVersion(nextTransformVersion())
         {
             float3 skew;
             float4 persp;
@@ -30,7 +34,8 @@ public:
             mRotation(rotation),
             mScale(scale),
             mPreviousTransformation(createTransMatrix()),
-            mName{name}
+            mName{name},
+            mTransformVersion(nextTransformVersion())
     {
     }
 
@@ -39,6 +44,7 @@ public:
     void setParentInstance(const Instance* parent)
     {
         mParent = parent;
+        mTransformVersion = nextTransformVersion();
     }
 
     const Instance* getParent() const
@@ -69,6 +75,7 @@ public:
     void setPosition(const float3& pos)
     {
         mPosition = pos;
+        mTransformVersion = nextTransformVersion();
     }
 
     const float3& getPosition() const
@@ -79,6 +86,7 @@ public:
     void setRotation(const quat& rot)
     {
         mRotation = rot;
+        mTransformVersion = nextTransformVersion();
     }
 
     const quat& getRotation() const
@@ -89,6 +97,7 @@ public:
     void setScale(const float3& scale)
     {
         mScale = scale;
+        mTransformVersion = nextTransformVersion();
     }
 
     const float3& getScale() const
@@ -106,6 +115,16 @@ public:
         mPreviousTransformation = createTransMatrix();
     }
 
+    // Changes whenever the transform of this instance or any of its parents does, versions are never reused
+    // so comparing against a stored version is enough to tell if the world transform needs recalculating.
+    uint64_t getTransformVersion() const
+    {
+        if(mParent)
+            return std::max(mTransformVersion, mParent->getTransformVersion());
+        else
+            return mTransformVersion;
+    }
+
 protected:
 
     float4x4 createTransMatrix() const
@@ -120,6 +139,15 @@ protected:
     float3 mScale;
     float4x4 mPreviousTransformation;
     std::string mName;
+    uint64_t mTransformVersion;
+
+private:
+
+    static uint64_t nextTransformVersion()
+    {
+        static std::atomic<uint64_t> version{0};
+        return ++version;
+    }
 };
 
 #endif
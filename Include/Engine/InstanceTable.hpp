@@ -0,0 +1,108 @@
+#ifndef INSTANCE_TABLE_HPP
+#define INSTANCE_TABLE_HPP
+
+#include "Core/Buffer.hpp"
+#include "Core/BufferView.hpp"
+#include "Core/PerFrameResource.hpp"
+#include "Engine/GeomUtils.h"
+
+#include <cstdint>
+#include <deque>
+#include <memory_resource>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class RenderDevice;
+class MeshInstance;
+
+// Persistent GPU table of instance transforms.
+// Each mesh instance owns a stable slot per submesh for as long as it's in the scene, draws index the table
+// with the slot. Only the transforms of instances that have moved are uploaded, each frames copy of the
+// table is caught up with the changes made since it was last used.
+class InstanceTable
+{
+public:
+
+    InstanceTable(RenderDevice* dev);
+
+    // Gives new instances their slots and uploads the transforms of any that have moved.
+    // Needs calling once a frame with every instance that will be drawn, before any recording.
+    void updateInstances(const std::pmr::vector<MeshInstance*>& instances);
+
+    // Slots are only reused once the frames in flight have finished with them.
+    void releaseSlots(const uint32_t baseSlot);
+
+    // Forgets all instances, the instances themselves need their slots resetting.
+    void clear();
+
+    BufferView& getTransformsView()
+    {
+        return *mTransformsView;
+    }
+
+    BufferView& getPreviousTransformsView()
+    {
+        return *mPrevTransformsView;
+    }
+
+    uint32_t getSlotCount() const
+    {
+        return mSlotCount;
+    }
+
+    // Bytes uploaded to each of the transform buffers last frame.
+    uint64_t getUploadedBytes() const
+    {
+        return mUploadedBytes;
+    }
+
+private:
+
+    struct SlotEntry
+    {
+        uint64_t mVersion;
+        uint64_t mLastSeen;
+        uint64_t mLastMoved;
+        uint32_t mCount;
+        bool mSettling; // Moved recently so the previous transforms still need to catch up.
+    };
+
+    struct DirtyRange
+    {
+        uint64_t mFrame;
+        uint32_t mBegin;
+        uint32_t mEnd;
+    };
+
+    uint32_t allocateSlots(const uint32_t count);
+    void     recycleRetired();
+    void     markDirty(const uint32_t begin, const uint32_t end);
+    void     upload();
+
+    RenderDevice* mDevice;
+
+    // Indexed by the base slot of each instance.
+    std::vector<SlotEntry> mEntries;
+    std::vector<float3x4> mTransforms;
+    std::vector<float3x4> mPrevTransforms;
+    uint32_t mSlotCount;
+
+    std::unordered_map<uint32_t, std::vector<uint32_t>> mFreeSlots; // Keyed by slot count.
+    std::deque<std::pair<uint64_t, uint32_t>> mRetiredSlots;
+
+    std::vector<uint32_t> mSettlingSlots;
+
+    // Changes not yet in every frames copy of the table.
+    std::deque<DirtyRange> mDirtyRanges;
+    std::vector<uint64_t> mSyncedFrame;
+    std::vector<bool> mNeedsFullUpload;
+    uint64_t mUploadedBytes;
+
+    PerFrameResource<Buffer> mTransformsBuffer;
+    PerFrameResource<BufferView> mTransformsView;
+    PerFrameResource<Buffer> mPrevTransformsBuffer;
+    PerFrameResource<BufferView> mPrevTransformsView;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef MATERIAL_TABLE_HPP
+#define MATERIAL_TABLE_HPP
+
+#include "Core/Buffer.hpp"
+#include "Core/BufferView.hpp"
+#include "Core/ImageView.hpp"
+#include "Core/ShaderResourceSet.hpp"
+
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+class RenderDevice;
+
+// Bindless material storage. All material textures live in one fixed size descriptor array and each material
+// has an entry in a GPU table holding the array slot of each of its textures, shaders index the table by material ID.
+// The set layout never changes, so adding materials or streaming textures in only writes the descriptors that changed.
+class MaterialTable
+{
+public:
+
+    static constexpr uint32_t kMaxTextures = 4096;
+    static constexpr uint32_t kMaxMaterials = 1024;
+    static constexpr uint32_t kMaxTexturesPerMaterial = 8;
+
+    MaterialTable(RenderDevice* dev, const ImageView& defaultView);
+
+    // Returns the material ID, textures need to be in the order the material shaders sample them in.
+    uint32_t addMaterial(const uint32_t materialTypes, const std::vector<ImageView>& textures);
+    void     removeMaterial(const uint32_t materialID);
+
+    // Swap one of a materials textures, the new view gets a new slot so frames in flight are unaffected.
+    void setTexture(const uint32_t materialID, const uint32_t textureIndex, const ImageView& view);
+
+    // Writes changed descriptors and table entries, needs calling once a frame before any recording.
+    void update();
+
+    // Removes all materials.
+    void clear();
+
+    ShaderResourceSet& getResourceSet()
+    {
+        return mResourceSet;
+    }
+
+    uint32_t getUsedTextureSlots() const
+    {
+        return mNextTextureSlot - static_cast<uint32_t>(mFreeTextureSlots.size() + mRetiredTextureSlots.size());
+    }
+
+private:
+
+    // Must match MaterialTableEntry in UniformBuffers.hlsl.
+    struct MaterialEntry
+    {
+        uint32_t mTextureSlots[kMaxTexturesPerMaterial];
+        uint32_t mMaterialTypes;
+        uint32_t mPadding[3];
+    };
+    static_assert(sizeof(MaterialEntry) == 48, "Material entry doesn't match the shader layout");
+
+    uint32_t allocateTextureSlot();
+    // Slots and IDs can still be accessed by frames in flight, so they're only reused once those have finished.
+    void     retireTextureSlot(const uint32_t slot);
+    void     recycleRetired();
+
+    void     markDirty(const uint32_t materialID);
+
+    RenderDevice* mDevice;
+    ImageView mDefaultView;
+
+    std::vector<MaterialEntry> mEntries;
+    std::vector<uint32_t> mFreeMaterialIDs;
+    std::deque<std::pair<uint64_t, uint32_t>> mRetiredMaterialIDs;
+
+    uint32_t mNextTextureSlot;
+    std::vector<uint32_t> mFreeTextureSlots;
+    std::deque<std::pair<uint64_t, uint32_t>> mRetiredTextureSlots;
+
+    // Range of entries that need uploading.
+    uint32_t mDirtyBegin;
+    uint32_t mDirtyEnd;
+
+    Buffer mTableBuffer;
+    BufferView mTableBufferView;
+    ShaderResourceSet mResourceSet;
+};
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef MESH_SIMPLIFICATION_HPP
+#define MESH_SIMPLIFICATION_HPP
+
+#include <cstdint>
+#include <vector>
+
+// Quadric error metric simplification of an indexed triangle list.
+// Edges are collapsed on to one of their existing vertices, so the result indexes the original vertex data and a
+// LOD only needs new indices. Vertices on attribute seams are never moved and open borders only collapse along
+// themselves, so simplified meshes don't crack or smear their UVs.
+// resultError is the largest error introduced, as a distance in the space of the vertex positions.
+std::vector<uint32_t> simplifyMesh(const uint32_t* indices,
+                                   const uint32_t indexCount,
+                                   const unsigned char* vertexData,
+                                   const uint32_t vertexStride,
+                                   const uint32_t vertexCount,
+                                   const uint32_t targetIndexCount,
+                                   float& resultError);
+
+#endif
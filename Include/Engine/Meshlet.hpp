@@ -0,0 +1,63 @@
+#ifndef MESHLET_HPP
+#define MESHLET_HPP
+
+#include "Engine/GeomUtils.h"
+
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+// A small cluster of a submeshes triangles, the unit of culling for the GPU driven passes.
+// Triangles are reordered so that every meshlet is a contiguous range of the index buffer, so they can be
+// drawn with a regular indexed draw. Bounds are in the same space as the vertex data.
+struct Meshlet
+{
+    float4 mBoundingSphere; // xyz centre, w radius.
+    float4 mConeApex;
+    float4 mConeAxisCutoff; // xyz axis, w cutoff. A cutoff of 1 means the cone can't be used to cull.
+    uint32_t mIndexOffset;
+    uint32_t mIndexCount;
+    uint32_t mVertexCount;
+    uint32_t mPadding;
+};
+static_assert(sizeof(Meshlet) == 64, "Needs to match the shader struct layout");
+static_assert(std::is_trivially_copyable_v<Meshlet>, "Meshlet must be trivially copyable to be cooked");
+
+constexpr uint32_t kMeshletMaxVertices = 64;
+constexpr uint32_t kMeshletMaxTriangles = 124;
+
+// Splits the triangles in [indexOffset, indexOffset + indexCount) in to meshlets, reordering the indices in place.
+// Indices are relative to vertexData, which must start with a float3 position.
+void buildMeshlets(std::vector<uint32_t>& indices,
+                   const uint32_t indexOffset,
+                   const uint32_t indexCount,
+                   const unsigned char* vertexData,
+                   const uint32_t vertexStride,
+                   std::vector<Meshlet>& meshlets);
+
+
+enum class MeshletCullResult
+{
+    Visible,
+    Frustum,
+    Backface,
+    Occluded
+};
+
+struct MeshletCullingView
+{
+    float4x4 mViewProj;
+    float3 mCameraPosition;
+    float mNearPlane;
+    float mFarPlane;
+    float2 mFrameBufferSize;
+
+    // Max linear depth of the occluders at a uv and mip level, occlusion culling is skipped if not set.
+    std::function<float(const float2& uv, const float lod)> mHierarchicalDepth;
+};
+
+// CPU reference of the cluster culling in IndirectDrawCulling.comp, transform is the meshlets object to world matrix.
+MeshletCullResult cullMeshlet(const Meshlet& meshlet, const float4x4& transform, const MeshletCullingView& view);
+
+#endif
@@ -18,7 +18,7 @@ public:
         return PassType::OcclusionCulling;
     }
 
-    virtual void render(RenderGraph&, RenderEngine*) {};
+    virtual void render(RenderGraph&, RenderEngine*) override;
 
     virtual void bindResources(RenderGraph&);
 
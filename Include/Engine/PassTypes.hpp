@@ -41,7 +41,8 @@
                     DownSampleColour = 1ULL << 35, \
                     VoxelTerrain = 1ULL << 36,   \
                     InstanceID = 1ULL << 37,     \
-                    BuildAccelerationStructures = 1ULL << 38
+                    BuildAccelerationStructures = 1ULL << 38, \
+                    IndirectDrawCulling = 1ULL << 39
 
 // An enum to keep track of which 
 enum class PassType : uint64_t
@@ -139,6 +140,9 @@ inline const char* passToString(const PassType passType)
         case PassType::OcclusionCulling:
             return "OcclusionCulling";
 
+        case PassType::IndirectDrawCulling:
+            return "IndirectDrawCulling";
+
         case PassType::PathTracing:
             return "PathTracing";
 
@@ -247,6 +251,9 @@ inline const wchar_t* passToWString(const PassType passType)
         case PassType::OcclusionCulling:
             return L"OcclusionCulling";
 
+        case PassType::IndirectDrawCulling:
+            return L"IndirectDrawCulling";
+
         case PassType::PathTracing:
             return L"PathTracing";
 
@@ -326,7 +333,14 @@ enum class Format
 	R16UInt,
     RGBA16UInt,
     RGBA16Int,
-    RGBA8Uint
+    RGBA8Uint,
+
+    // Block compressed, 4x4 texel blocks.
+    BC1UNorm,
+    BC3UNorm,
+    BC4UNorm,
+    BC5UNorm,
+    BC7UNorm
 };
 
 
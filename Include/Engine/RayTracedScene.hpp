@@ -7,6 +7,7 @@
 #include "GeomUtils.h"
 #include "CPUImage.hpp"
 #include "Engine/RayTracingSamplers.hpp"
+#include "Engine/TerrainMesher.hpp"
 #include "Core/AccelerationStructures.hpp"
 #include "Engine/ThreadPool.hpp"
 
@@ -37,7 +38,19 @@ public:
         float3 mNormal;
         float4 mVertexColour;
         uint32_t mPrimID;
+        float mTriangleLOD; // 0.5 * log2(uv area / world area) of the triangle.
+        // Ray cone at the hit, used to pick texture mips.
+        float mConeWidth;
+        float mConeSpread;
+        float mConeCosine;
     };
+    // Cone traced along with a ray, width grows by the spread angle (in radians) per unit travelled.
+    struct RayCone
+    {
+        float mWidth;
+        float mSpreadAngle;
+    };
+
     InterpolatedVertex interpolateFragment(const uint32_t primID, const float u, const float v) const;
 
     struct MaterialInfo
@@ -60,13 +73,15 @@ public:
 
     bool traceRayNonAlphaTested(const nanort::Ray<float>& ray, InterpolatedVertex* result) const;
 
+    // The terrain blocks selection, but hits on it return kInvalidInstanceID.
     bool intersectsMesh(const nanort::Ray<float>& ray, uint64_t* instanceID);
 
+    // Rebuilds the BVH from every instance and the terrain, only the terrain chunks that have changed are remeshed.
     void updateCPUAccelerationStructure(const Scene* scene);
 
 private:
 
-    bool traceRay(const nanort::Ray<float>& ray, InterpolatedVertex* result) const;
+    bool traceRay(const nanort::Ray<float>& ray, InterpolatedVertex* result, const RayCone& cone = RayCone{0.0f, 0.0f}) const;
 
     bool traceShadowRay(const InterpolatedVertex& position) const;
 
@@ -89,6 +104,9 @@ private:
 
     std::vector<MaterialInfo> mPrimitiveMaterialID; // maps prim ID to material ID.
     const Scene* mScene;
+
+    RenderEngine* mEngine;
+    TerrainMesher mTerrainMesher;
 };
 
 
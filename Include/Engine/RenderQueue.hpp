@@ -6,7 +6,9 @@
 #include <vector>
 
 class Camera;
+class Executor;
 class RenderEngine;
+class UberShaderStateCache;
 
 enum RenderViewIndex : uint8_t
 {
@@ -19,16 +21,61 @@ enum RenderViewIndex : uint8_t
     kRenderView_Count
 };
 
+// A single submesh draw, sorted by a key packing (from most to least significant) the draw layer, shade flags,
+// material and quantized view depth. Opaque draws are front to back, transparent ones back to front.
+struct ViewDraw
+{
+    uint64_t mKey;
+    uint32_t mInstance; // Index in to the view instances.
+    uint32_t mSubMesh;
+};
+
+enum class DrawLayer : uint8_t
+{
+    Opaque = 0,
+    AlphaTested,
+    Transparent
+};
+
+uint64_t makeDrawKey(const DrawLayer layer, const uint64_t shadeFlags, const uint32_t materialIndex, const float normalisedDepth);
+
 class RenderView
 {
 public:
 
     RenderView(const RenderEngine* eng) :
         mEng{eng},
-        mInstances() {}
+        mInstances(),
+        mLODBias{1.0f},
+        mFrozen{false} {}
     ~RenderView() = default;
 
-    void updateView(const Camera&);
+    // viewportHeight is in pixels and is used to pick a LOD for each instance.
+    void updateView(const Camera&, const float viewportHeight);
+
+    // Replaces the contents of the view, which updateView then leaves alone until unfrozen. Used to replay captured frames.
+    void freeze(const std::vector<MeshInstance*>& instances, const std::vector<uint32_t>& lods, const std::vector<ViewDraw>& draws);
+
+    void unfreeze()
+    {
+        mFrozen = false;
+    }
+
+    bool isFrozen() const
+    {
+        return mFrozen;
+    }
+
+    // Screen space error in pixels each instances LOD is allowed to introduce.
+    void setLODBias(const float bias)
+    {
+        mLODBias = bias;
+    }
+
+    float getLODBias() const
+    {
+        return mLODBias;
+    }
 
     const std::vector<MeshInstance*>& getViewInstances() const
     {
@@ -40,12 +87,50 @@ public:
         return mConstInstances;
     }
 
+    // LOD to draw each of the view instances with, in the same order.
+    const std::vector<uint32_t>& getInstanceLODs() const
+    {
+        return mInstanceLODs;
+    }
+
+    // Every submesh of the drawable view instances, sorted so draws sharing a pipeline are adjacent.
+    const std::vector<ViewDraw>& getSortedDraws() const
+    {
+        return mDraws;
+    }
+
+    // Records the sorted draws, only rebinding geometry when the mesh changes and updating the
+    // state cache when the shade flags do.
+    void recordSortedDraws(Executor*, UberShaderStateCache*) const;
+
 private:
 
     const RenderEngine* mEng;
 
     std::vector<MeshInstance*> mInstances;
     std::vector<const MeshInstance*> mConstInstances;
+    std::vector<uint32_t> mInstanceLODs;
+
+    struct SortEntry
+    {
+        uint64_t mKey;
+        MeshInstance* mInstance;
+    };
+    std::vector<SortEntry> mSortEntries;
+    std::vector<SortEntry> mSortScratch;
+    std::vector<float> mInstanceDepths;
+
+    std::vector<ViewDraw> mDraws;
+    std::vector<ViewDraw> mDrawScratch;
+
+    float mLODBias;
+    bool mFrozen;
 };
 
+// Shadows are filtered and rarely seen up close, so can use coarser LODs than the main view.
+constexpr float kShadowLODBias = 4.0f;
+
+// Coarsest LOD of the instance whose error covers no more than lodBias pixels when seen from camera.
+uint32_t selectInstanceLOD(const MeshInstance& instance, const Camera& camera, const float viewportHeight, const float lodBias);
+
 #endif
\ No newline at end of file
@@ -19,6 +19,7 @@
 #include <atomic>
 #include <cstdint>
 #include <filesystem>
+#include <future>
 #include <limits>
 #include <memory>
 #include <string>
@@ -106,7 +107,8 @@ enum ShadeFlags
     kMaterial_AlphaTested = static_cast<uint32_t>(MaterialType::AlphaTested),
     kMaterial_Transparent = static_cast<uint32_t>(MaterialType::Transparent),
 
-    kShade_Skinning = 1 << 22
+    kShade_Skinning = 1 << 22,
+    kShade_IndirectDraw = 1 << 23 // Vertex shader reads its MeshEntry from the indirect draw entries.
 };
 
 enum class PBRType
@@ -201,11 +203,24 @@ public:
         mGlobalBoneBufferOffset = offset;
     }
 
+    uint32_t getGlobalBoneBufferOffset() const
+    {
+        return mGlobalBoneBufferOffset;
+    }
+
+    // Slot of the first submesh in the engines instance table, each submesh has a consecutive slot.
+    static constexpr uint32_t kInvalidTransformsIndex = ~0u;
+
     void setBaseTransformsIndex(const uint32_t index)
     {
         mBaseTransformsIndex = index;
     }
 
+    uint32_t getBaseTransformsIndex() const
+    {
+        return mBaseTransformsIndex;
+    }
+
     bool isSkinned() const
     {
         return mIsSkinned;
@@ -224,15 +239,15 @@ public:
         mAnimationActive = false;
     }
 
-    std::vector<float4x4> tickAnimation(const double);
+    // Writes a matrix for every bone in the skeleton.
+    void tickAnimation(const double, float4x4* boneMatracies);
 
-    void draw(Executor*, UberShaderStateCache*) const;
+    void draw(Executor*, UberShaderStateCache*, const uint32_t lod = 0) const;
 
-    uint64_t getShadeFlags(const uint32_t subMesh_i) const;
+    // Draws a single submesh, the meshes vertex and index buffers must already be bound.
+    void drawSubMesh(Executor*, const uint32_t subMesh_i, const uint32_t lod = 0) const;
 
-    const SkeletalAnimation* getActiveAnimation() const;
-
-private:
+    uint64_t getShadeFlags(const uint32_t subMesh_i) const;
 
     MeshEntry getMeshShaderEntry(const uint32_t submesh_i) const
     {
@@ -245,6 +260,10 @@ private:
         return entry;
     }
 
+    const SkeletalAnimation* getActiveAnimation() const;
+
+private:
+
     Scene* mScene;
     SceneID mMesh;
     InstanceID mID;
@@ -307,6 +326,17 @@ public:
                                   const std::string& name = "");
     void          removeInstance(const InstanceID);
 
+    // Forget all instance table slots, for when the scene is moved to a new table.
+    void          resetTransformSlots();
+
+    // Instance table slots of removed instances, these need handing back to the engine.
+    std::vector<uint32_t> takeReleasedTransformSlots()
+    {
+        std::vector<uint32_t> slots{};
+        slots.swap(mReleasedTransformSlots);
+        return slots;
+    }
+
     void          computeBounds(const AccelerationStructure);
 
     struct Light
@@ -398,16 +428,6 @@ public:
         return mShadowingLight;
     }
 
-    const std::vector<ImageView>& getMaterials() const
-    {
-	return mMaterialImageViews;
-    }
-
-    std::vector<ImageView>& getMaterials()
-    {
-        return mMaterialImageViews;
-    }
-
 	struct Material
 	{
         std::string mName;
@@ -419,7 +439,7 @@ public:
         Image* mAmbientOcclusion;
         Image* mHeightMap;
         uint32_t mMaterialTypes;
-        uint32_t mMaterialOffset;
+        uint32_t mMaterialOffset; // ID in the engines material table.
 
         void updateLastAccessed()
         {
@@ -467,8 +487,17 @@ public:
         return mCPUMaterials;
     }
 
-    void addMaterial(const Material& mat);
+    // Index of a materials first texture in getCPUImageMaterials.
+    uint32_t getCPUImageOffset(const uint32_t materialID) const
+    {
+        return materialID < mCPUMaterialOffsets.size() ? mCPUMaterialOffsets[materialID] : 0;
+    }
+
+    // Registers the material with the engines material table, which assigns it's ID.
+    void addMaterial(const Material& mat, RenderEngine* eng);
     void addMaterial(const MaterialPaths& mat, RenderEngine *eng);
+    // Decodes all the textures in parallel on the engines thread pool, materials are added in order.
+    void addMaterials(const std::vector<MaterialPaths>& materials, RenderEngine* eng);
 
     InstanceID addLight(const Light& light);
 
@@ -588,6 +617,8 @@ private:
 
     void generateSceneAABB(const bool includeStatic);
 
+    void releaseTransformSlots(MeshInstance&);
+
 	struct AiStringComparitor
 	{
 		bool operator()(const aiString& l, const aiString& r) const noexcept
@@ -603,6 +634,13 @@ private:
     // Loads materials at the index specified by the external scene file.
     void loadMaterialsExternal(RenderEngine*, const aiScene *scene);
 
+    // Images in the order their views are added to the material image views.
+    static std::vector<Image*> getMaterialViewImages(const Material&);
+
+    struct DecodedMaterial;
+    static DecodedMaterial decodeMaterial(const MaterialPaths&);
+    void addMaterial(DecodedMaterial&&, RenderEngine*);
+
     void parseNode(RenderEngine* eng,
                    const aiScene* scene,
                    const aiNode* node,
@@ -610,6 +648,7 @@ private:
                    const InstanceID parentID,
                    const int vertAttributes,
                    const MaterialMappings& materialIndexMappings,
+                   std::vector<std::future<StaticMesh>>& meshFutures,
                    std::unordered_map<const aiMesh *, SceneID> &meshMappings,
                    std::vector<InstanceID>& instanceIds);
 
@@ -624,6 +663,7 @@ private:
     std::vector<uint32_t>     mFreeStaticMeshIndicies;
     std::vector<MeshInstance> mDynamicMeshInstances;
     std::vector<uint32_t>     mFreeDynamicMeshIndicies;
+    std::vector<uint32_t>     mReleasedTransformSlots;
 
     OctTree<MeshInstance*> mStaticMeshBoundingVolume;
     OctTree<MeshInstance*> mDynamicMeshBoundingVolume;
@@ -635,9 +675,9 @@ private:
 	Camera* mSceneCamera;
 
 	std::vector<Material> mMaterials;
-	std::vector<ImageView> mMaterialImageViews;
 
     std::vector<CPUImage> mCPUMaterials;
+    std::vector<uint32_t> mCPUMaterialOffsets; // Indexed by material ID.
 
     std::vector<Light>        mLights;
     std::vector<uint32_t>     mFreeLightIndicies;
@@ -5,6 +5,7 @@
 #include "Engine/AABB.hpp"
 #include "Engine/PassTypes.hpp"
 #include "Engine/Animation.hpp"
+#include "Engine/Meshlet.hpp"
 #include "RenderGraph/GraphicsTask.hpp"
 
 #include "assimp/vector2.h"
@@ -40,6 +41,13 @@ public:
         mBuffer.resize(size);
     }
 
+    // Copy in already interleaved vertex data.
+    void setData(const unsigned char* data, const size_t size)
+    {
+        mBuffer.assign(data, data + size);
+        mCurrentOffset = size;
+    }
+
     void writeVertexVector4(const aiVector3D&);
     void writeVertexVector4(const float4&);
     void writeVertexVector2(const aiVector2D&);
@@ -93,10 +101,21 @@ struct SubMesh
     uint32_t mVertexCount;
     uint32_t mIndexOffset;
     uint32_t mIndexCount;
+    uint32_t mMeshletOffset;
+    uint32_t mMeshletCount;
 
     float4x4 mTransform;
 };
 
+// Index range of a submesh in one LOD, every LOD shares the meshes vertex data.
+struct SubMeshLOD
+{
+    uint32_t mIndexOffset;
+    uint32_t mIndexCount;
+};
+
+constexpr uint32_t kMaxMeshLODs = 6;
+
 class StaticMesh
 {
 public:
@@ -127,6 +146,9 @@ public:
         return mIndexData;
     }
 
+    // Number of indices in LOD 0, the indices of coarser LODs are stored after them.
+    uint32_t getBaseIndexCount() const;
+
     Buffer* getVertexBuffer()
     {
         return mVertexBuffer;
@@ -228,6 +250,32 @@ public:
         return mSubMeshes;
     }
 
+    // Meshlet index offsets are relative to the start of the index data, like the submeshes.
+    const std::vector<Meshlet>& getMeshlets() const
+    {
+        return mMeshlets;
+    }
+
+    uint32_t getLODCount() const
+    {
+        return static_cast<uint32_t>(mLODErrors.size());
+    }
+
+    // Largest distance the LOD moves the surface from the full detail mesh, in object space.
+    float getLODError(const uint32_t lod) const
+    {
+        return mLODErrors[lod];
+    }
+
+    const SubMeshLOD& getSubMeshLOD(const uint32_t lod, const uint32_t subMesh_i) const
+    {
+        BELL_ASSERT(lod < getLODCount() && subMesh_i < mSubMeshes.size(), "LOD out of range")
+        return mLODSubMeshes[(lod * mSubMeshes.size()) + subMesh_i];
+    }
+
+    // Coarsest LOD with an error no bigger than maxError.
+    uint32_t getLODForError(const float maxError) const;
+
     uint32_t getBoneCount() const
     {
         return mSkeleton.size();
@@ -245,8 +293,15 @@ public:
 
     void initializeDeviceBuffers(RenderEngine*);
 
+    // Write out the mesh in the cooked format, see CookedMesh.hpp.
+    bool writeCookedMesh(const std::string& filePath) const;
+
 private:
 
+    void loadCookedMesh(const std::string& filePath);
+
+    void generateLODs();
+
     void configure(const aiScene *scene, const aiMesh* mesh, const float4x4 transform, const int vertexAttributes);
 
     uint16_t findBoneParent(const aiNode*, float4x4&);
@@ -263,6 +318,11 @@ private:
                    const int vertAttributes);
 
     std::vector<SubMesh> mSubMeshes;
+    std::vector<Meshlet> mMeshlets;
+
+    // LOD major, LOD 0 matches the submeshes.
+    std::vector<SubMeshLOD> mLODSubMeshes;
+    std::vector<float> mLODErrors;
 
     std::unordered_map<std::string, uint32_t> mBoneIndexMap;
     std::vector<Bone> mSkeleton;
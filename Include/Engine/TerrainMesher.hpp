@@ -0,0 +1,50 @@
+#ifndef TERRAIN_MESHER_HPP
+#define TERRAIN_MESHER_HPP
+
+#include "Engine/GeomUtils.h"
+
+#include <vector>
+
+class ThreadPool;
+class VoxelTerrain;
+
+
+// Builds the same marching cubes surface as MarchingCubes.comp on the CPU, at full detail, so the terrain can be
+// ray traced and navigated. Each chunk keeps its own triangles, and is only remeshed once its voxels have changed.
+class TerrainMesher
+{
+public:
+    TerrainMesher();
+    ~TerrainMesher() = default;
+
+    // Remeshes the chunks that have changed since the last update across the thread pool.
+    // Returns the number of chunks that were remeshed.
+    uint32_t update(const VoxelTerrain&, ThreadPool&);
+
+    // Unindexed, every three vertices form a triangle.
+    struct ChunkMesh
+    {
+        std::vector<float3> mPositions;
+        std::vector<float3> mNormals;
+        uint32_t mRevision; // VoxelTerrain chunk revision the mesh was built from.
+    };
+
+    const std::vector<ChunkMesh>& getChunkMeshes() const
+    {
+        return mChunkMeshes;
+    }
+
+    uint32_t getVertexCount() const;
+
+    // Appends every chunks triangles.
+    void getTriangles(std::vector<float3>& positions, std::vector<float3>& normals) const;
+
+private:
+
+    void meshChunk(const VoxelTerrain&, const uint32_t chunk, int8_t* brick, ChunkMesh&) const;
+
+    const VoxelTerrain* mTerrain;
+    std::vector<ChunkMesh> mChunkMeshes;
+};
+
+#endif
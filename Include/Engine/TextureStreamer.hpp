@@ -0,0 +1,149 @@
+#ifndef TEXTURE_STREAMER_HPP
+#define TEXTURE_STREAMER_HPP
+
+#include "Core/Image.hpp"
+#include "Engine/PassTypes.hpp"
+#include "Engine/ThreadPool.hpp"
+
+#include <cstdint>
+#include <future>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class RenderEngine;
+class MeshInstance;
+class Camera;
+
+namespace TextureUtil
+{
+    struct TextureInfo;
+}
+
+namespace TextureCompression
+{
+    struct CompressedTexture;
+}
+
+// Streams material texture mips in and out of video memory.
+// Only the low mips are uploaded when a material is added, each frame the visible instances request
+// a mip based on their projected size and the higher mips are loaded from disk on background threads.
+// When the resident size goes over the memory budget the least recently requested textures are dropped
+// back to their base mips.
+class TextureStreamer
+{
+public:
+
+    // Textures are always resident down to this size.
+    static constexpr uint32_t kBaseMipSize = 64;
+
+    struct TextureDesc
+    {
+        std::string mName;
+        std::string mPath; // Cooked .dds when mCompressed is set.
+        bool mCompressed;
+        Format mFormat;
+        int mChannels;
+        uint32_t mWidth;
+        uint32_t mHeight;
+        uint32_t mMipCount;
+    };
+
+    // mMips[0] is mip level mFirstMip. Uncompressed textures only store the first level, the rest are generated on the GPU.
+    struct StreamedMips
+    {
+        uint32_t mFirstMip;
+        std::vector<std::vector<unsigned char>> mMips;
+    };
+
+    TextureStreamer(RenderEngine* eng);
+    ~TextureStreamer();
+
+    static uint32_t getBaseMip(const uint32_t width, const uint32_t height, const uint32_t mipCount);
+    static StreamedMips extractMips(const TextureUtil::TextureInfo& info, const uint32_t channels, const uint32_t firstMip);
+    static StreamedMips extractMips(const TextureCompression::CompressedTexture& texture, const uint32_t firstMip);
+
+    // Creates the image with only the base mips resident, the image is owned by the caller.
+    Image* addTexture(const TextureDesc& desc, StreamedMips&& baseMips);
+    // Tell the streamer which material and which of it's textures an image is, so the material table can be updated.
+    void setMaterialSlot(const Image* image, const uint32_t materialID, const uint32_t textureIndex);
+
+    // Request mips for all materials used by the instances, based on their projected size in pixels.
+    void requestMips(const std::vector<MeshInstance*>& instances, const Camera& camera, const uint32_t viewportHeight);
+    void requestMaterial(const uint32_t materialID, const float projectedSize);
+
+    // Uploads finished loads, evicts and kicks off new loads.
+    // Residency changes are written to the engines material table.
+    void update();
+
+    // Waits for any in flight loads and forgets all textures.
+    void clear();
+
+    void setMemoryBudget(const uint64_t bytes)
+    {
+        mMemoryBudget = bytes;
+    }
+
+    uint64_t getMemoryBudget() const
+    {
+        return mMemoryBudget;
+    }
+
+    uint64_t getResidentMemory() const
+    {
+        return mResidentMemory;
+    }
+
+    // Positive values bias requests towards lower resolution mips.
+    void setMipBias(const float bias)
+    {
+        mMipBias = bias;
+    }
+
+private:
+
+    struct StreamedTexture
+    {
+        TextureDesc mDesc;
+        Image* mImage;
+        uint32_t mMaterialID;
+        uint32_t mMaterialTextureIndex;
+        uint32_t mBaseMip;
+        uint32_t mResidentMip;
+        uint32_t mRequestedMip;
+        uint64_t mLastRequested;
+        bool mLoading;
+        bool mFailed;
+    };
+
+    struct LoadResult
+    {
+        uint32_t mTextureIndex;
+        StreamedMips mMips;
+    };
+
+    static StreamedMips loadMips(const TextureDesc& desc, const uint32_t firstMip);
+    static uint64_t calculateSize(const TextureDesc& desc, const uint32_t firstMip);
+
+    void upload(StreamedTexture& texture, const StreamedMips& mips);
+    bool evict(const uint64_t requiredBytes);
+
+    RenderEngine* mEngine;
+
+    // Loads get their own threads so they never hold up command recording on the engine thread pool.
+    ThreadPool mLoadThreads;
+
+    std::vector<StreamedTexture> mTextures;
+    std::unordered_map<const Image*, uint32_t> mImageLookup;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> mMaterialTextures;
+    // Base mips are kept on the CPU so eviction doesn't have to wait on the disk.
+    std::vector<StreamedMips> mBaseMips;
+    std::vector<std::future<LoadResult>> mPendingLoads;
+
+    uint64_t mMemoryBudget;
+    uint64_t mResidentMemory;
+    uint64_t mPendingMemory;
+    float mMipBias;
+};
+
+#endif
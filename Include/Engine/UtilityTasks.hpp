@@ -14,18 +14,21 @@ TaskID addBlurXTaskR8(const char* name, const char* input, const char* output, c
 
 TaskID addBlurYTaskR8(const char* name, const char* input, const char* output, const uint2 outputSize, RenderEngine*, RenderGraph&);
 
+// vertexShadeFlags are added to every vertex shader variant, but aren't part of the pipeline key.
 void compileShadeFlagsPipelines(std::unordered_map<uint64_t, uint64_t>& pipelineMap,
                                 const std::string& vertexPath,
                                 const std::string& fragmentPath,
                                 RenderEngine*,
                                 const RenderGraph&,
-                                const TaskID id);
+                                const TaskID id,
+                                const uint64_t vertexShadeFlags = 0);
 
 void compileSkinnedPipelineVariants(uint64_t*,
                                     const std::string& vertexPath,
                                     const std::string& fragmentPath,
                                     RenderEngine*,
                                     const RenderGraph&,
-                                    const TaskID id);
+                                    const TaskID id,
+                                    const uint64_t vertexShadeFlags = 0);
 
 #endif
@@ -2,47 +2,157 @@
 #define VOXEL_TERRAIN_HPP
 
 #include "GeomUtils.h"
+#include "AABB.hpp"
+
 #include <string>
 #include <vector>
 
 
+// Voxels are stored in kChunkSize^3 chunks, indexed x + z * kChunkSize + y * kChunkSize * kChunkSize, negative
+// values are inside the terrain. A chunk that is entirely inside or outside along with all of its neighbours can't
+// contribute to the surface, so only stores a single value. Every other chunk keeps kLODCount - 1 downsampled
+// copies of its voxels for meshing distant chunks.
 class VoxelTerrain
 {
 public:
     VoxelTerrain(const uint3& size, const float voxelSize);
     ~VoxelTerrain() = default;
 
+    static constexpr uint32_t kChunkSize = 16;
+    static constexpr uint32_t kLODCount = 3;
+
     void initialiseFromHeightMap(const std::string& path);
+    // Data is a dense grid indexed x + z * size.x + y * size.x * size.z.
     void initialiseFromData(const std::vector<int8_t>& data);
 
-    const std::vector<int8_t>& getVoxelData() const
+    // Position is in voxels at lod, and is clamped to the grid.
+    int8_t getVoxel(const int3& position, const uint32_t lod = 0) const;
+    void setVoxel(const uint3& position, const int8_t value);
+
+    // Adds value to every voxel within radius of a world space position.
+    void modify(const float3& position, const float radius, const int32_t value);
+
+    uint3 getSize() const
     {
-        return mVoxelData;
+        return mSize;
     }
 
-    std::vector<int8_t>& getVoxelData()
+    float getVoxelSize() const
     {
-        return mVoxelData;
+        return mVoxelSize;
     }
 
-    uint3 getSize() const
+    // The grid is centred on the origin.
+    float3 getMinimum() const
     {
-        return mSize;    void initialiseFromData(const std::vector<int8_t>&);
+        return -(float3(mSize) * mVoxelSize) / 2.0f;
+    }
 
+    uint3 getChunkCount() const
+    {
+        return mChunkCount;
     }
 
-    float getVoxelSize() const
+    uint32_t getChunkIndex(const uint3& chunk) const
     {
-        return mVoxelSize;
+        return chunk.x + (chunk.z * mChunkCount.x) + (chunk.y * mChunkCount.x * mChunkCount.z);
     }
 
+    uint3 getChunkPosition(const uint32_t index) const
+    {
+        return uint3{index % mChunkCount.x, index / (mChunkCount.x * mChunkCount.z), (index / mChunkCount.x) % mChunkCount.z};
+    }
+
+    AABB getChunkBounds(const uint32_t chunk) const;
+
+    static uint32_t getChunkCellCount(const uint32_t lod)
+    {
+        return kChunkSize >> lod;
+    }
+
+    // A brick holds the voxels needed to mesh a chunk, including a one voxel border either side for normals.
+    static uint32_t getBrickSize(const uint32_t lod)
+    {
+        return getChunkCellCount(lod) + 3;
+    }
+
+    // Returns false when the chunk and all of its neighbours are on the same side of the surface.
+    bool mayContainSurface(const uint32_t chunk) const;
+
+    // Fills brick (getBrickSize(lod)^3 voxels) starting one voxel before the chunk, using the chunks LOD voxels.
+    // Returns false if the surface doesn't pass through the chunk at that LOD.
+    bool getChunkBrick(const uint32_t chunk, const uint32_t lod, int8_t* brick) const;
+
+    // Incremented whenever the chunks mesh may have changed, for consumers that don't use the dirty list.
+    uint32_t getChunkRevision(const uint32_t chunk) const
+    {
+        return mChunks[chunk].mRevision;
+    }
+
+    // Chunks whose mesh may have changed since the last call to clearDirtyChunks.
+    const std::vector<uint32_t>& getDirtyChunks() const
+    {
+        return mDirtyChunks;
+    }
+
+    void clearDirtyChunks();
+
+    // Bytes of voxel data stored across every chunk.
+    size_t getMemoryUsage() const;
+
+    // Trilinearly filtered voxels at a world space position, in [-1, 1] and negative inside.
+    float sampleDensity(const float3& position) const;
+
+    // Density gradient, pointing out of the terrain.
+    float3 sampleNormal(const float3& position) const;
+
+    // Distance along the ray to where it enters the terrain, std::limits<float>::max() to indicate no intersection.
+    // Chunks that can't contain the surface are skipped, and only cells with corners either side of it are sampled.
+    float intersectionDistance(const Ray&, const float maxDistance) const;
+
+    // Conservative, true if any of the voxels at the corners of the cells the box overlaps are inside.
+    bool intersects(const AABB&) const;
+
 private:
 
+    enum Signs : uint8_t
+    {
+        kInside = 1,
+        kOutside = 1 << 1
+    };
+
+    struct Chunk
+    {
+        std::vector<int8_t> mVoxels; // Empty when every voxel is mUniformValue.
+        std::vector<int8_t> mLODs[kLODCount - 1];
+        int8_t mUniformValue;
+        uint8_t mSigns;
+        bool mDirty;
+        uint32_t mRevision;
+    };
+
+    // Fills every chunk with voxelValue(position), then compacts them.
+    template<typename F>
+    void initialiseChunks(F&& voxelValue);
+
+    // Recalculates the chunks signs and LODs after its voxels have changed, collapsing it if they're all the same.
+    void updateChunk(Chunk&);
+
+    // Collapses the chunks in the range that can't contribute to the surface.
+    void compactChunks(const uint3& minChunk, const uint3& maxChunk);
+
+    // Marks every chunk that meshes a voxel in the range at any LOD.
+    void markDirty(const int3& minVoxel, const int3& maxVoxel);
+
+    // Trilinearly filtered voxels at a position in voxels.
+    float sampleGrid(const float3& position) const;
+
     uint3 mSize;
     float mVoxelSize;
 
-    // for 3 LODS.
-    std::vector<int8_t> mVoxelData;
+    uint3 mChunkCount;
+    std::vector<Chunk> mChunks;
+    std::vector<uint32_t> mDirtyChunks;
 };
 
 #endif
@@ -4,6 +4,14 @@
 #include "Technique.hpp"
 #include "Core/PerFrameResource.hpp"
 
+#include <deque>
+#include <map>
+
+class VoxelTerrain;
+
+// Meshes the terrain a chunk at a time in to persistent ranges of one vertex buffer. Only chunks that have been
+// edited, or need a different LOD, are remeshed, and at most kMaxChunkUpdatesPerFrame of them each frame.
+// Chunks that can't contain the surface are never uploaded or meshed.
 class VoxelTerrainTechnique : public Technique
 {
 public:
@@ -14,13 +22,7 @@ public:
     { return PassType::VoxelTerrain; }
 
     virtual void bindResources(RenderGraph&) override final;
-    virtual void render(RenderGraph&, RenderEngine*) override final
-    {
-        mVoxelGrid->updateLastAccessed();
-        mVoxelGridView->updateLastAccessed();
-        mVertexBuffer->updateLastAccessed();
-        mIndirectArgsBuffer->updateLastAccessed();
-    }
+    virtual void render(RenderGraph&, RenderEngine*) override final;
 
     void setTextureScale(const float2& scale)
     {
@@ -37,15 +39,25 @@ public:
         mMaterialIndexY = index;
     }
 
+    // Chunks further away than this use LOD 1, and LOD 2 past twice this.
+    void setLODDistance(const float distance)
+    {
+        mLODDistance = distance;
+    }
+
+    static constexpr uint32_t kMaxChunkUpdatesPerFrame = 64;
+
 private:
 
-    struct TerrainVolume
+    struct TerrainChunk
     {
         float3 minimum;
         float  voxelSize;
-        uint3  offset;
-        uint32_t   lod;
-        float4 frustumPlanes[6];
+        uint32_t brickOffset;
+        uint32_t cellCount;
+        uint32_t vertexOffset;
+        uint32_t vertexCapacity;
+        uint32_t counterIndex;
     };
 
     struct TerrainTexturing
@@ -58,32 +70,87 @@ private:
     struct TerrainModifying
     {
         uint2 mMousePos;
-        float mValue;
-        float mSize;
-        float3 mTerrainSize;
     };
 
+    struct ChunkMesh
+    {
+        uint32_t mVertexOffset;
+        uint32_t mVertexCount; // Zero if the chunk hasn't got a mesh.
+        uint8_t mLOD;
+        bool mQueued;
+    };
+
+    struct ChunkUpdate
+    {
+        uint32_t mChunk;
+        uint32_t mLOD;
+        uint32_t mVertexOffset;
+        uint32_t mVertexCount;
+    };
+
+    struct VertexRange
+    {
+        uint32_t mOffset;
+        uint32_t mCount;
+    };
+
+    uint32_t selectLOD(const VoxelTerrain&, const uint32_t chunk, const float3& cameraPosition) const;
+
+    // Builds the chunks brick and records its update, returns false once the vertex buffer has been reset.
+    bool updateChunk(const VoxelTerrain&, const uint32_t chunk, const uint32_t lod);
+
+    // Releases the chunks mesh once the frames in flight have finished drawing it.
+    void retireMesh(ChunkMesh&);
+
+    bool allocateVertices(const uint32_t count, uint32_t& offset);
+    void freeVertices(const VertexRange&);
+
+    // Doubles the vertex buffer, discarding every mesh so they're all rebuilt.
+    void growVertexBuffer(const uint32_t requiredCount);
+
+    void applyEdit(RenderEngine*, VoxelTerrain&);
+
     Shader mGenerateTerrainMeshShader;
-    Shader mInitialiseIndirectDrawShader;
 
     Shader mTerrainVertexShader;
     Shader mTerrainFragmentShaderDeferred;
 
     Shader mModifyTerrainShader;
 
-    Image mVoxelGrid;
-    ImageView mVoxelGridView;
+    // Bricks of the chunks being meshed this frame, stacked along z.
+    PerFrameResource<Image> mBricks;
+    PerFrameResource<ImageView> mBricksView;
 
     Buffer mVertexBuffer;
     BufferView mVertexBufferView;
 
-    Buffer mIndirectArgsBuffer;
-    BufferView mIndirectArgView;
+    // One vertex counter per chunk update.
+    PerFrameResource<Buffer> mVertexCounters;
+    PerFrameResource<BufferView> mVertexCountersView;
+
+    PerFrameResource<Buffer> mDrawCommands;
+    PerFrameResource<BufferView> mDrawCommandsView;
+
+    // World space position under the mouse, w is zero if nothing was picked.
+    PerFrameResource<Buffer> mEditPosition;
+    PerFrameResource<BufferView> mEditPositionView;
+
+    std::vector<ChunkMesh> mChunkMeshes;
+    std::deque<uint32_t> mRemeshQueue;
+    std::vector<ChunkUpdate> mChunkUpdates;
+    std::vector<int8_t> mBrickData;
+    std::vector<uint4> mDrawCommandData;
+
+    // Free vertex ranges keyed by offset, and the ranges freed by each frame index that may still be drawn.
+    std::map<uint32_t, uint32_t> mFreeVertexRanges;
+    std::vector<std::vector<VertexRange>> mRetiredVertexRanges;
+    uint32_t mVertexCapacity;
 
     TaskID mSurfaceGenerationTask;
     TaskID mRenderTaskID;
 
     float mModifySize;
+    float mLODDistance;
     float2 mTextureScale;
     uint32_t mMaterialIndexXZ;
     uint32_t mMaterialIndexY;
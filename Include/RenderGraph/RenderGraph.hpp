@@ -82,6 +82,12 @@ public:
     TaskIterator taskBegin() const;
     TaskIterator taskEnd() const;
 
+    // Dependancy, Dependant pairs of task indicies in the compiled order.
+    const std::vector<std::pair<uint32_t, uint32_t>>& getCompiledDependancies() const
+    {
+        return mCompiledDependancies;
+    }
+
 	const std::vector<bool>& getDescriptorsNeedUpdating() const
 	{
 		return mDescriptorsNeedUpdating; 
@@ -100,6 +106,7 @@ public:
 		ImageArray,
         Sampler,
         Buffer,
+        BufferArray,
         VertexBuffer,
         IndexBuffer,
 		SRS,
@@ -119,6 +126,9 @@ public:
     const Sampler&		getSampler(const char* name) const;
     const TopLevelAccelerationStructure& getAccelerationStructure(const char*) const;
 
+    // Every slot with a resource bound to it, internal resources included.
+    std::vector<std::pair<const char*, ResourceType>> getBoundResources() const;
+
     struct ResourceInfo
     {
         AttachmentType mType;
@@ -157,6 +167,8 @@ private:
 
     // Dependancy, Dependant
     std::vector<std::pair<uint32_t, uint32_t>> mTaskDependancies;
+    // Consumed by reordering, so kept remapped to the final order.
+    std::vector<std::pair<uint32_t, uint32_t>> mCompiledDependancies;
 
     struct ResourceUsageEntries
     {
@@ -0,0 +1,221 @@
+#include "Benchmark.hpp"
+
+#include "Core/BellLogging.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <thread>
+
+
+void BenchmarkState::measure(const std::function<void()>& body)
+{
+    BELL_ASSERT(mSamples.empty(), "Benchmarks can only measure once")
+
+    // Warm up caches and let anything lazily created get created.
+    body();
+
+    std::chrono::nanoseconds totalTime{0};
+    while(mSamples.size() < mSettings.mMaxSamples &&
+          (mSamples.size() < mSettings.mMinSamples || totalTime < mSettings.mMinTime))
+    {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const auto end = std::chrono::steady_clock::now();
+
+        const std::chrono::nanoseconds sample = end - start;
+        totalTime += sample;
+        mSamples.push_back(static_cast<double>(sample.count()));
+    }
+}
+
+
+void BenchmarkState::setCounter(const std::string& name, const double value)
+{
+    auto counter = std::find_if(mCounters.begin(), mCounters.end(), [&name](const auto& c) { return c.first == name; });
+    if(counter != mCounters.end())
+        counter->second = value;
+    else
+        mCounters.push_back({name, value});
+}
+
+
+BenchmarkResult BenchmarkState::getResult(const std::string& name) const
+{
+    BenchmarkResult result{};
+    result.mName = name;
+    result.mSamples = static_cast<uint32_t>(mSamples.size());
+    result.mCounters = mCounters;
+
+    if(mSamples.empty())
+        return result;
+
+    std::vector<double> sorted = mSamples;
+    std::sort(sorted.begin(), sorted.end());
+
+    const size_t middle = sorted.size() / 2;
+    result.mMedianNs = (sorted.size() % 2) == 0 ? (sorted[middle - 1] + sorted[middle]) * 0.5 : sorted[middle];
+    result.mMinNs = sorted.front();
+    result.mMeanNs = std::accumulate(sorted.begin(), sorted.end(), 0.0) / double(sorted.size());
+
+    double variance = 0.0;
+    for(const double sample : sorted)
+        variance += (sample - result.mMeanNs) * (sample - result.mMeanNs);
+    result.mStdDevNs = std::sqrt(variance / double(sorted.size()));
+
+    // Use the median so a few preempted samples don't skew the throughput.
+    if(mItemsPerSample > 0 && result.mMedianNs > 0.0)
+        result.mItemsPerSecond = double(mItemsPerSample) * 1e9 / result.mMedianNs;
+
+    return result;
+}
+
+
+std::vector<BenchmarkResult> BenchmarkRegistry::run(const BenchmarkSettings& settings, const std::string& filter) const
+{
+    std::vector<BenchmarkResult> results{};
+
+    for(const auto& [name, function] : mBenchmarks)
+    {
+        if(!filter.empty() && name.find(filter) == std::string::npos)
+            continue;
+
+        BenchmarkState state{settings};
+        function(state);
+
+        // Benchmarks can skip themselves, e.g. scenes larger than mMaxInstances.
+        BenchmarkResult result = state.getResult(name);
+        if(result.mSamples == 0)
+            continue;
+
+        fprintf(stderr, "%-48s %12.0f ns (median) %8u samples\n", name.c_str(), result.mMedianNs, result.mSamples);
+        results.push_back(std::move(result));
+    }
+
+    return results;
+}
+
+
+namespace
+{
+    // Benchmark and counter names are plain identifiers, but escape anyway so the output is always valid.
+    void writeJSONString(FILE* file, const std::string& str)
+    {
+        fputc('"', file);
+        for(const char c : str)
+        {
+            if(c == '"' || c == '\\')
+                fprintf(file, "\\%c", c);
+            else if(static_cast<unsigned char>(c) < 0x20)
+                fprintf(file, "\\u%04x", c);
+            else
+                fputc(c, file);
+        }
+        fputc('"', file);
+    }
+
+    const char* getBackendName()
+    {
+#if defined(VULKAN)
+        return "vulkan";
+#elif defined(DX_12)
+        return "dx12";
+#elif defined(NULL_DEVICE)
+        return "null";
+#else
+        return "none";
+#endif
+    }
+
+    const char* getCompilerName()
+    {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        return "msvc";
+#else
+        return "unknown";
+#endif
+    }
+}
+
+
+void writeBenchmarkResults(FILE* file, const BenchmarkSettings& settings, const std::vector<BenchmarkResult>& results)
+{
+    fprintf(file, "{\n");
+    fprintf(file, "\"context\": {\"backend\": \"%s\", ", getBackendName());
+#ifdef NDEBUG
+    fprintf(file, "\"build\": \"release\", ");
+#else
+    fprintf(file, "\"build\": \"debug\", ");
+#endif
+    fprintf(file, "\"compiler\": ");
+    writeJSONString(file, getCompilerName());
+    fprintf(file, ", \"hardware_threads\": %u, \"min_time_ms\": %lld, \"max_instances\": %llu},\n",
+            std::thread::hardware_concurrency(), static_cast<long long>(settings.mMinTime.count()),
+            static_cast<unsigned long long>(settings.mMaxInstances));
+
+    fprintf(file, "\"benchmarks\": [\n");
+    for(size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult& result = results[i];
+
+        fprintf(file, "{\"name\": ");
+        writeJSONString(file, result.mName);
+        fprintf(file, ", \"median_ns\": %.1f, \"mean_ns\": %.1f, \"min_ns\": %.1f, \"stddev_ns\": %.1f, \"samples\": %u",
+                result.mMedianNs, result.mMeanNs, result.mMinNs, result.mStdDevNs, result.mSamples);
+
+        if(result.mItemsPerSecond > 0.0)
+            fprintf(file, ", \"items_per_second\": %.1f", result.mItemsPerSecond);
+
+        if(!result.mCounters.empty())
+        {
+            fprintf(file, ", \"counters\": {");
+            for(size_t c = 0; c < result.mCounters.size(); ++c)
+            {
+                writeJSONString(file, result.mCounters[c].first);
+                fprintf(file, ": %.3f%s", result.mCounters[c].second, (c + 1) < result.mCounters.size() ? ", " : "");
+            }
+            fprintf(file, "}");
+        }
+
+        fprintf(file, "}%s\n", (i + 1) < results.size() ? "," : "");
+    }
+    fprintf(file, "]\n}\n");
+}
+
+
+std::vector<std::pair<std::string, double>> readBenchmarkBaseline(const char* path)
+{
+    std::vector<std::pair<std::string, double>> baseline{};
+
+    FILE* file = fopen(path, "r");
+    if(!file)
+    {
+        BELL_LOG_ARGS("Unable to open baseline %s", path)
+        return baseline;
+    }
+
+    char line[4096];
+    while(fgets(line, sizeof(line), file))
+    {
+        const char* name = strstr(line, "{\"name\": \"");
+        const char* median = strstr(line, "\"median_ns\": ");
+        if(!name || !median)
+            continue;
+
+        name += strlen("{\"name\": \"");
+        const char* nameEnd = strchr(name, '"');
+        if(!nameEnd)
+            continue;
+
+        baseline.push_back({std::string(name, nameEnd), strtod(median + strlen("\"median_ns\": "), nullptr)});
+    }
+
+    fclose(file);
+
+    return baseline;
+}
@@ -0,0 +1,116 @@
+#ifndef BELL_BENCHMARK_HPP
+#define BELL_BENCHMARK_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+struct BenchmarkSettings
+{
+    std::chrono::milliseconds mMinTime{500}; // Keep sampling until at least this much time has been measured.
+    uint32_t mMinSamples = 5;
+    uint32_t mMaxSamples = 10000;
+    uint64_t mMaxInstances = 1000000; // Largest procedural scene the scaling benchmarks generate.
+};
+
+
+struct BenchmarkResult
+{
+    std::string mName;
+    uint32_t mSamples;
+    double mMeanNs;
+    double mMedianNs;
+    double mMinNs;
+    double mStdDevNs;
+    double mItemsPerSecond; // Zero if the benchmark doesn't process items.
+    std::vector<std::pair<std::string, double>> mCounters;
+};
+
+
+// Handed to each benchmark, which does its setup then passes the code to be timed to measure.
+class BenchmarkState
+{
+public:
+
+    BenchmarkState(const BenchmarkSettings& settings) : mSettings{settings}, mSamples{}, mItemsPerSample{0}, mCounters{} {}
+
+    // Calls body once to warm up, then times one call per sample.
+    void measure(const std::function<void()>& body);
+
+    // Items processed by each call of the body, reported as items per second.
+    void setItemsPerSample(const uint64_t items)
+    {
+        mItemsPerSample = items;
+    }
+
+    // Anything else worth tracking alongside the timings, e.g. the number of draws a frame recorded.
+    void setCounter(const std::string& name, const double value);
+
+    const BenchmarkSettings& getSettings() const
+    {
+        return mSettings;
+    }
+
+    BenchmarkResult getResult(const std::string& name) const;
+
+private:
+
+    const BenchmarkSettings& mSettings;
+    std::vector<double> mSamples;
+    uint64_t mItemsPerSample;
+    std::vector<std::pair<std::string, double>> mCounters;
+};
+
+
+// Names should stay stable between runs as results are compared against baselines by name.
+// They take the form group/benchmark/parameter:value, e.g. octtree/build/lights:10000.
+class BenchmarkRegistry
+{
+public:
+
+    using BenchmarkFunction = std::function<void(BenchmarkState&)>;
+
+    void add(const std::string& name, BenchmarkFunction function)
+    {
+        mBenchmarks.push_back({name, std::move(function)});
+    }
+
+    // Runs the benchmarks containing filter in their name, in the order they were added.
+    std::vector<BenchmarkResult> run(const BenchmarkSettings&, const std::string& filter) const;
+
+private:
+
+    std::vector<std::pair<std::string, BenchmarkFunction>> mBenchmarks;
+};
+
+
+// Stops the compiler throwing away results that are never used.
+template<typename T>
+inline void doNotOptimise(const T& value)
+{
+#ifdef _MSC_VER
+    const volatile void* sink = &value;
+    (void)sink;
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+
+// One benchmark per line, so baselines can be read back without a full JSON parser.
+void writeBenchmarkResults(FILE* file, const BenchmarkSettings&, const std::vector<BenchmarkResult>&);
+
+// Reads the name and median of each benchmark from a file written by writeBenchmarkResults.
+std::vector<std::pair<std::string, double>> readBenchmarkBaseline(const char* path);
+
+#endif
@@ -0,0 +1,351 @@
+#include "Benchmark.hpp"
+#include "ProceduralScene.hpp"
+
+#include "Engine/Allocators.hpp"
+#include "Engine/Camera.hpp"
+#include "Engine/OctTree.hpp"
+#include "Engine/StaticMesh.h"
+#include "Engine/TextureUtil.hpp"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Benchmarks that only need the CPU side of the engine, so run with any backend.
+
+namespace
+{
+    constexpr uint64_t kSeed = 0xBE11;
+
+    const uint64_t kLightCounts[] = {1000, 10000, 100000};
+    const uint64_t kAABBCounts[] = {1000, 100000, 1000000};
+    const uint32_t kBoneCounts[] = {16, 64};
+    const uint32_t kTextureSizes[] = {256, 1024, 2048};
+
+    constexpr uint32_t kAABBQueries = 256;
+    constexpr uint32_t kAllocations = 10000;
+
+    std::vector<OctTree<Scene::Light*>::BoundedValue> getLightBounds(std::vector<Scene::Light>& lights)
+    {
+        std::vector<OctTree<Scene::Light*>::BoundedValue> bounds{};
+        bounds.reserve(lights.size());
+        for(Scene::Light& light : lights)
+            bounds.push_back({light.getAABB(), &light});
+
+        return bounds;
+    }
+
+    // Looks across the scene from one corner, so roughly half of it is in view.
+    Camera getOverviewCamera(const AABB& bounds)
+    {
+        const float3 min = float3(bounds.getMin());
+        const float3 max = float3(bounds.getMax());
+
+        return Camera(min, glm::normalize(max - min), 16.0f / 9.0f, 0.1f, glm::length(max - min));
+    }
+
+    std::vector<unsigned char> generateTexture(const uint32_t size, const uint32_t channels)
+    {
+        BenchmarkRandom random{kSeed};
+
+        std::vector<unsigned char> texture(size_t(size) * size * channels);
+        for(unsigned char& texel : texture)
+            texel = static_cast<unsigned char>(random.next() & 0xFF);
+
+        return texture;
+    }
+
+    std::vector<float> generateFloatTexture(const uint32_t size, const uint32_t channels)
+    {
+        BenchmarkRandom random{kSeed};
+
+        std::vector<float> texture(size_t(size) * size * channels);
+        for(float& texel : texture)
+            texel = random.nextFloat();
+
+        return texture;
+    }
+
+
+    void registerOctTreeBenchmarks(BenchmarkRegistry& registry)
+    {
+        for(const uint64_t count : kLightCounts)
+        {
+            const std::string suffix = "/lights:" + std::to_string(count);
+
+            registry.add("octtree/build" + suffix, [count](BenchmarkState& state)
+            {
+                if(count > state.getSettings().mMaxInstances)
+                    return;
+
+                std::vector<Scene::Light> lights = ProceduralScene::generatePointLights(static_cast<uint32_t>(count), ProceduralScene::getInstanceBounds(count), kSeed);
+                std::vector<OctTree<Scene::Light*>::BoundedValue> bounds = getLightBounds(lights);
+                const AABB rootBounds = ProceduralScene::getInstanceBounds(count);
+
+                state.setItemsPerSample(count);
+                state.measure([&]()
+                {
+                    OctTreeFactory<Scene::Light*> factory(rootBounds, bounds);
+                    OctTree<Scene::Light*> tree = factory.generateOctTree();
+                    doNotOptimise(tree);
+                });
+            });
+
+            registry.add("octtree/frustum" + suffix, [count](BenchmarkState& state)
+            {
+                if(count > state.getSettings().mMaxInstances)
+                    return;
+
+                std::vector<Scene::Light> lights = ProceduralScene::generatePointLights(static_cast<uint32_t>(count), ProceduralScene::getInstanceBounds(count), kSeed);
+                std::vector<OctTree<Scene::Light*>::BoundedValue> bounds = getLightBounds(lights);
+                const AABB rootBounds = ProceduralScene::getInstanceBounds(count);
+                OctTreeFactory<Scene::Light*> factory(rootBounds, bounds);
+                const OctTree<Scene::Light*> tree = factory.generateOctTree();
+
+                const Frustum frustum = getOverviewCamera(rootBounds).getFrustum();
+
+                size_t visible = 0;
+                state.measure([&]()
+                {
+                    const std::vector<Scene::Light*> result = tree.containedWithin(frustum);
+                    visible = result.size();
+                    doNotOptimise(result.data());
+                });
+                state.setCounter("visible", double(visible));
+            });
+
+            registry.add("octtree/intersect" + suffix, [count](BenchmarkState& state)
+            {
+                if(count > state.getSettings().mMaxInstances)
+                    return;
+
+                std::vector<Scene::Light> lights = ProceduralScene::generatePointLights(static_cast<uint32_t>(count), ProceduralScene::getInstanceBounds(count), kSeed);
+                std::vector<OctTree<Scene::Light*>::BoundedValue> bounds = getLightBounds(lights);
+                const AABB rootBounds = ProceduralScene::getInstanceBounds(count);
+                OctTreeFactory<Scene::Light*> factory(rootBounds, bounds);
+                const OctTree<Scene::Light*> tree = factory.generateOctTree();
+
+                // Instance sized queries, like the ones used for finding the lights affecting a mesh.
+                BenchmarkRandom random{kSeed + 1};
+                const float4 min = rootBounds.getMin();
+                const float4 max = rootBounds.getMax();
+                std::vector<AABB> queries{};
+                for(uint32_t i = 0; i < kAABBQueries; ++i)
+                {
+                    const float4 centre{random.nextFloat(min.x, max.x), random.nextFloat(min.y, max.y), random.nextFloat(min.z, max.z), 1.0f};
+                    queries.push_back(AABB(centre - float4(1.0f, 1.0f, 1.0f, 0.0f), centre + float4(1.0f, 1.0f, 1.0f, 0.0f)));
+                }
+
+                state.setItemsPerSample(kAABBQueries);
+                state.measure([&]()
+                {
+                    for(const AABB& query : queries)
+                    {
+                        const std::vector<Scene::Light*> result = tree.getIntersections(query);
+                        doNotOptimise(result.data());
+                    }
+                });
+            });
+        }
+    }
+
+
+    void registerFrustumBenchmarks(BenchmarkRegistry& registry)
+    {
+        for(const uint64_t count : kAABBCounts)
+        {
+            registry.add("frustum/aabbs:" + std::to_string(count), [count](BenchmarkState& state)
+            {
+                if(count > state.getSettings().mMaxInstances)
+                    return;
+
+                const AABB sceneBounds = ProceduralScene::getInstanceBounds(count);
+                const std::vector<float4x4> transforms = ProceduralScene::generateInstanceTransforms(count, kSeed);
+                const AABB unitBounds(float4(-1.0f, -1.0f, -1.0f, 1.0f), float4(1.0f, 1.0f, 1.0f, 1.0f));
+
+                std::vector<AABB> bounds{};
+                bounds.reserve(count);
+                for(const float4x4& transform : transforms)
+                    bounds.push_back(unitBounds * transform);
+
+                const Frustum frustum = getOverviewCamera(sceneBounds).getFrustum();
+
+                uint64_t visible = 0;
+                state.setItemsPerSample(count);
+                state.measure([&]()
+                {
+                    visible = 0;
+                    for(const AABB& aabb : bounds)
+                        visible += frustum.isContainedWithin(aabb) != Intersection::None ? 1 : 0;
+                    doNotOptimise(visible);
+                });
+                state.setCounter("visible", double(visible));
+            });
+        }
+    }
+
+
+    void registerAnimationBenchmarks(BenchmarkRegistry& registry)
+    {
+        for(const uint32_t boneCount : kBoneCounts)
+        {
+            registry.add("animation/bone_matrices/bones:" + std::to_string(boneCount), [boneCount](BenchmarkState& state)
+            {
+                const std::unique_ptr<aiScene> scene = ProceduralScene::createSkinnedTube(boneCount, 4, 16, 64);
+                const StaticMesh mesh(scene.get(), scene->mMeshes[0], VertexAttributes::Position4 | VertexAttributes::TextureCoordinates |
+                                                                      VertexAttributes::Normals | VertexAttributes::Albedo);
+                const SkeletalAnimation& animation = mesh.getSkeletalAnimation("Bend");
+
+                std::vector<float4x4> boneMatrices(mesh.getSkeleton().size());
+                double tick = 0.0;
+
+                state.setItemsPerSample(boneCount);
+                state.measure([&]()
+                {
+                    animation.calculateBoneMatracies(mesh, tick, boneMatrices.data());
+                    doNotOptimise(boneMatrices.data());
+
+                    // Step through the animation a frame at a time so the key lookups aren't always the same.
+                    tick = std::fmod(tick + 0.4, animation.getTotalTicks());
+                });
+            });
+        }
+    }
+
+
+    void registerTextureBenchmarks(BenchmarkRegistry& registry)
+    {
+        for(const uint32_t size : kTextureSizes)
+        {
+            const std::string suffix = ":" + std::to_string(size);
+            const uint64_t texels = uint64_t(size) * size;
+
+            registry.add("texture/mip/rgba8" + suffix, [size, texels](BenchmarkState& state)
+            {
+                const std::vector<unsigned char> texture = generateTexture(size, 4);
+
+                state.setItemsPerSample(texels);
+                state.measure([&]()
+                {
+                    const std::vector<unsigned char> mip = TextureUtil::generateMip2D(texture, size, size, 4);
+                    doNotOptimise(mip.data());
+                });
+            });
+
+            registry.add("texture/mip/rgba32f" + suffix, [size, texels](BenchmarkState& state)
+            {
+                const std::vector<float> texture = generateFloatTexture(size, 4);
+
+                state.setItemsPerSample(texels);
+                state.measure([&]()
+                {
+                    const std::vector<float> mip = TextureUtil::generateMip(texture, size, size, 1, 4);
+                    doNotOptimise(mip.data());
+                });
+            });
+
+            registry.add("texture/mip_max/r32f" + suffix, [size, texels](BenchmarkState& state)
+            {
+                const std::vector<float> texture = generateFloatTexture(size, 1);
+
+                state.setItemsPerSample(texels);
+                state.measure([&]()
+                {
+                    const std::vector<float> mip = TextureUtil::generateMipMax(texture, size, size, 1, 1);
+                    doNotOptimise(mip.data());
+                });
+            });
+        }
+
+        registry.add("texture/voxel_mip/rgba8:64", [](BenchmarkState& state)
+        {
+            constexpr uint32_t size = 64;
+            BenchmarkRandom random{kSeed};
+            std::vector<unsigned char> texture(size * size * size * 4);
+            for(unsigned char& texel : texture)
+                texel = static_cast<unsigned char>(random.next() & 0xFF);
+
+            state.setItemsPerSample(size * size * size);
+            state.measure([&]()
+            {
+                const std::vector<unsigned char> mip = TextureUtil::generateVoxelMip(texture, size, size, size, 4);
+                doNotOptimise(mip.data());
+            });
+        });
+    }
+
+
+    // Mixed sizes, weighted towards the small allocations the engine makes most of.
+    std::vector<size_t> generateAllocationSizes()
+    {
+        BenchmarkRandom random{kSeed};
+
+        std::vector<size_t> sizes(kAllocations);
+        for(size_t& size : sizes)
+            size = size_t(16) << (random.next() % 6);
+
+        return sizes;
+    }
+
+    void registerAllocatorBenchmarks(BenchmarkRegistry& registry)
+    {
+        registry.add("allocator/frame/allocate", [](BenchmarkState& state)
+        {
+            const std::vector<size_t> sizes = generateAllocationSizes();
+            FrameAllocator allocator{2, 1024 * 1024};
+
+            state.setItemsPerSample(kAllocations);
+            state.measure([&]()
+            {
+                for(const size_t size : sizes)
+                    doNotOptimise(allocator.allocate(size, 16));
+
+                allocator.nextFrame();
+            });
+        });
+
+        registry.add("allocator/slab/allocate_free", [](BenchmarkState& state)
+        {
+            const std::vector<size_t> sizes = generateAllocationSizes();
+            std::vector<void*> allocations(kAllocations);
+            Allocator allocator{};
+
+            state.setItemsPerSample(kAllocations);
+            state.measure([&]()
+            {
+                for(size_t i = 0; i < sizes.size(); ++i)
+                    allocations[i] = allocator.allocate(sizes[i], 16);
+                for(size_t i = 0; i < sizes.size(); ++i)
+                    allocator.deallocate(allocations[i], sizes[i], 16);
+            });
+        });
+
+        // What the allocators are replacing, for comparison.
+        registry.add("allocator/new_delete/allocate_free", [](BenchmarkState& state)
+        {
+            const std::vector<size_t> sizes = generateAllocationSizes();
+            std::vector<void*> allocations(kAllocations);
+            std::pmr::memory_resource* resource = std::pmr::new_delete_resource();
+
+            state.setItemsPerSample(kAllocations);
+            state.measure([&]()
+            {
+                for(size_t i = 0; i < sizes.size(); ++i)
+                    allocations[i] = resource->allocate(sizes[i], 16);
+                for(size_t i = 0; i < sizes.size(); ++i)
+                    resource->deallocate(allocations[i], sizes[i], 16);
+            });
+        });
+    }
+}
+
+
+void registerCoreBenchmarks(BenchmarkRegistry& registry)
+{
+    registerOctTreeBenchmarks(registry);
+    registerFrustumBenchmarks(registry);
+    registerAnimationBenchmarks(registry);
+    registerTextureBenchmarks(registry);
+    registerAllocatorBenchmarks(registry);
+}
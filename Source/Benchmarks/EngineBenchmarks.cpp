@@ -0,0 +1,354 @@
+#include "Benchmark.hpp"
+
+#ifdef NULL_DEVICE
+
+#include "ProceduralScene.hpp"
+
+#include "Core/Null/NullRenderDevice.hpp"
+#include "Engine/Engine.hpp"
+#include "Engine/RayTracedScene.hpp"
+#include "Engine/StaticMesh.h"
+#include "RenderGraph/RenderGraph.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Benchmarks that drive the engine itself. They run against the null device, so measure only the CPU cost of a
+// frame without any driver overhead or waiting on a GPU.
+
+namespace
+{
+    constexpr uint64_t kSeed = 0xBE11;
+
+    constexpr uint32_t kWidth = 1920;
+    constexpr uint32_t kHeight = 1080;
+
+    // A fixed delta so animation and TAA jitter are the same every run.
+    constexpr std::chrono::microseconds kFrameDelta{16666};
+
+    constexpr uint32_t kLightCount = 256;
+
+    const uint64_t kFrameInstanceCounts[] = {1000, 10000, 100000, 1000000};
+    const uint64_t kRayTracingInstanceCounts[] = {100, 1000};
+
+    constexpr uint32_t kRayGridWidth = 256;
+    constexpr uint32_t kRayGridHeight = 144;
+
+    constexpr int kVertexAttributes = VertexAttributes::Position4 | VertexAttributes::TextureCoordinates |
+                                      VertexAttributes::Normals | VertexAttributes::Albedo;
+
+    // Like the editor the engine lives until exit. Creating it loads all it's assets, so it's shared by every benchmark.
+    RenderEngine* getEngine()
+    {
+        static RenderEngine* engine = new RenderEngine{kWidth, kHeight, GraphicsOptions{DeviceFeaturesFlags::Compute | DeviceFeaturesFlags::Subgroup, false}};
+        return engine;
+    }
+
+    // Instanced spheres lit by point lights, viewed from one corner so roughly half of them are on screen.
+    class ProceduralFrameScene
+    {
+    public:
+
+        ProceduralFrameScene(RenderEngine* eng, const uint64_t instanceCount, const uint32_t lightCount, const bool setAsCurrent) :
+            mEngine{eng},
+            mScene{"Procedural scene"},
+            mCamera{float3(0.0f), float3(0.0f, 0.0f, 1.0f), float(kWidth) / float(kHeight)},
+            mShadowCamera{float3(0.0f), float3(0.0f, -1.0f, 0.0f), float(kWidth) / float(kHeight)},
+            mIsCurrent{setAsCurrent}
+        {
+            const std::unique_ptr<aiScene> sphere = ProceduralScene::createSphere(16, 32);
+            const StaticMesh mesh(sphere.get(), kVertexAttributes);
+            ProceduralScene::populateScene(mScene, eng, mesh, instanceCount, lightCount, kSeed);
+
+            const AABB bounds = ProceduralScene::getInstanceBounds(instanceCount);
+            const float3 min = float3(bounds.getMin());
+            const float3 max = float3(bounds.getMax());
+            const float3 centre = (min + max) * 0.5f;
+            const float extent = max.x - min.x;
+
+            mCamera = Camera(min, glm::normalize(max - min), float(kWidth) / float(kHeight), 0.1f, glm::length(max - min));
+            mScene.setCamera(&mCamera);
+
+            mShadowCamera = Camera(float3(centre.x, max.y + 1.0f, centre.z), float3(0.0f, -1.0f, 0.0f), float(kWidth) / float(kHeight), 1.0f, extent + 2.0f);
+            mShadowCamera.setUp(float3(0.0f, 0.0f, 1.0f));
+            mShadowCamera.setMode(CameraMode::Orthographic);
+            mShadowCamera.setOrthographicSize(float2(extent, extent));
+            mScene.setShadowingLight(&mShadowCamera);
+
+            if(mIsCurrent)
+                mEngine->setScene(&mScene);
+        }
+
+        ~ProceduralFrameScene()
+        {
+            if(mIsCurrent)
+                mEngine->setScene(nullptr);
+        }
+
+        const Scene& getScene() const
+        {
+            return mScene;
+        }
+
+        const Camera& getCamera() const
+        {
+            return mCamera;
+        }
+
+    private:
+
+        RenderEngine* mEngine;
+        Scene mScene;
+        Camera mCamera;
+        Camera mShadowCamera;
+        bool mIsCurrent;
+    };
+
+    // A deferred frame without any image based lighting, so there's no skybox to load.
+    void registerDeferredPasses(RenderEngine* eng)
+    {
+        eng->registerPass(PassType::DepthPre);
+        eng->registerPass(PassType::GBufferPreDepth);
+        eng->registerPass(PassType::Shadow);
+        eng->registerPass(PassType::LightFroxelation);
+        eng->registerPass(PassType::DeferredAnalyticalLighting);
+        eng->registerPass(PassType::SSAO);
+        eng->registerPass(PassType::LineariseDepth);
+        eng->registerPass(PassType::Composite);
+    }
+
+    void renderFrame(RenderEngine* eng)
+    {
+        eng->startFrame(kFrameDelta);
+        registerDeferredPasses(eng);
+        eng->recordScene();
+        eng->render();
+        eng->swap();
+        eng->endFrame();
+    }
+
+    // What the last frame recorded, so changes in the amount of work are visible alongside the timings.
+    void setFrameCounters(BenchmarkState& state, RenderEngine* eng)
+    {
+        const NullRenderDevice* device = static_cast<const NullRenderDevice*>(eng->getDevice());
+
+        uint64_t commands = 0;
+        uint64_t draws = 0;
+        uint64_t barriers = 0;
+        for(const NullSubmission& submission : device->getSubmissions())
+        {
+            commands += submission.mStream.mCommands.size();
+            barriers += submission.mStream.mBarriers.size();
+            for(const NullCommand& command : submission.mStream.mCommands)
+            {
+                switch(command.mType)
+                {
+                    case NullCommandType::Draw:
+                    case NullCommandType::InstancedDraw:
+                    case NullCommandType::IndexedDraw:
+                    case NullCommandType::IndexedInstancedDraw:
+                    case NullCommandType::IndirectDraw:
+                    case NullCommandType::IndexedIndirectDraw:
+                    case NullCommandType::IndexedIndirectDrawCount:
+                        ++draws;
+                        break;
+
+                    default:
+                        break;
+                }
+            }
+        }
+
+        state.setCounter("tasks", double(eng->getRenderGraph().taskCount()));
+        state.setCounter("commands", double(commands));
+        state.setCounter("draws", double(draws));
+        state.setCounter("barriers", double(barriers));
+    }
+
+
+    void registerFrameBenchmarks(BenchmarkRegistry& registry)
+    {
+        for(const uint64_t count : kFrameInstanceCounts)
+        {
+            registry.add("frame/deferred/instances:" + std::to_string(count), [count](BenchmarkState& state)
+            {
+                if(count > state.getSettings().mMaxInstances)
+                    return;
+
+                RenderEngine* eng = getEngine();
+                const ProceduralFrameScene scene{eng, count, kLightCount, true};
+
+                // Start from scratch so the graph compilation happens in the warm up frame.
+                eng->clearRegisteredPasses();
+
+                state.setItemsPerSample(count);
+                state.measure([eng]()
+                {
+                    renderFrame(eng);
+                });
+                setFrameCounters(state, eng);
+            });
+        }
+    }
+
+
+    void registerRenderGraphBenchmarks(BenchmarkRegistry& registry)
+    {
+        // Includes copying the uncompiled graph, as compiling can only be done once.
+        registry.add("rendergraph/compile/deferred", [](BenchmarkState& state)
+        {
+            RenderEngine* eng = getEngine();
+            const ProceduralFrameScene scene{eng, 1000, kLightCount, true};
+
+            eng->clearRegisteredPasses();
+            eng->startFrame(kFrameDelta);
+            registerDeferredPasses(eng);
+            eng->recordScene();
+            const RenderGraph uncompiledGraph = eng->getRenderGraph();
+            eng->render();
+            eng->swap();
+            eng->endFrame();
+
+            RenderDevice* device = eng->getDevice();
+            state.setCounter("tasks", double(eng->getRenderGraph().taskCount()));
+            state.measure([&]()
+            {
+                RenderGraph graph = uncompiledGraph;
+                graph.compile(device);
+                doNotOptimise(graph);
+            });
+        });
+
+        registry.add("rendergraph/barriers/deferred", [](BenchmarkState& state)
+        {
+            RenderEngine* eng = getEngine();
+            const ProceduralFrameScene scene{eng, 1000, kLightCount, true};
+
+            eng->clearRegisteredPasses();
+            renderFrame(eng);
+
+            RenderDevice* device = eng->getDevice();
+            RenderGraph& graph = eng->getRenderGraph();
+            state.setCounter("tasks", double(graph.taskCount()));
+            state.measure([&]()
+            {
+                const std::vector<BarrierRecorder> barriers = graph.generateBarriers(device);
+                doNotOptimise(barriers.data());
+            });
+        });
+    }
+
+
+    void registerRayTracingBenchmarks(BenchmarkRegistry& registry)
+    {
+        for(const uint64_t count : kRayTracingInstanceCounts)
+        {
+            const std::string suffix = "/instances:" + std::to_string(count);
+
+            // Camera rays through a fixed grid, reported as rays per second.
+            registry.add("raytracing/cpu/primary" + suffix, [count](BenchmarkState& state)
+            {
+                if(count > state.getSettings().mMaxInstances)
+                    return;
+
+                RenderEngine* eng = getEngine();
+                // Lights have instance IDs too, which the CPU scene would treat as meshes.
+                const ProceduralFrameScene scene{eng, count, 0, false};
+                const CPURayTracingScene rayTracingScene{eng, &scene.getScene()};
+
+                const Camera& camera = scene.getCamera();
+                const float3 origin = camera.getPosition();
+                const float3 forward = camera.getDirection();
+                const float3 up = camera.getUp();
+                const float3 right = camera.getRight();
+                const float aspect = float(kRayGridWidth) / float(kRayGridHeight);
+
+                std::vector<nanort::Ray<float>> rays{};
+                rays.reserve(kRayGridWidth * kRayGridHeight);
+                for(uint32_t y = 0; y < kRayGridHeight; ++y)
+                {
+                    for(uint32_t x = 0; x < kRayGridWidth; ++x)
+                    {
+                        const float2 offset{((float(x) + 0.5f) / float(kRayGridWidth) - 0.5f) * aspect, (float(y) + 0.5f) / float(kRayGridHeight) - 0.5f};
+                        const float3 dir = glm::normalize(forward + (offset.y * up) + (offset.x * right));
+
+                        nanort::Ray<float> ray;
+                        ray.org[0] = origin.x;
+                        ray.org[1] = origin.y;
+                        ray.org[2] = origin.z;
+                        ray.dir[0] = dir.x;
+                        ray.dir[1] = dir.y;
+                        ray.dir[2] = dir.z;
+                        ray.min_t = 0.0f;
+                        ray.max_t = camera.getFarPlane();
+                        rays.push_back(ray);
+                    }
+                }
+
+                uint64_t hits = 0;
+                state.setItemsPerSample(rays.size());
+                state.measure([&]()
+                {
+                    hits = 0;
+                    CPURayTracingScene::InterpolatedVertex vertex;
+                    for(const nanort::Ray<float>& ray : rays)
+                        hits += rayTracingScene.traceRayNonAlphaTested(ray, &vertex) ? 1 : 0;
+                    doNotOptimise(hits);
+                });
+                state.setCounter("hit_ratio", double(hits) / double(rays.size()));
+            });
+
+            // Occlusion tests between random points in the scene, like the ones used for shadows.
+            registry.add("raytracing/cpu/visibility" + suffix, [count](BenchmarkState& state)
+            {
+                if(count > state.getSettings().mMaxInstances)
+                    return;
+
+                RenderEngine* eng = getEngine();
+                const ProceduralFrameScene scene{eng, count, 0, false};
+                const CPURayTracingScene rayTracingScene{eng, &scene.getScene()};
+
+                const AABB bounds = ProceduralScene::getInstanceBounds(count);
+                const float4 min = bounds.getMin();
+                const float4 max = bounds.getMax();
+
+                BenchmarkRandom random{kSeed};
+                std::vector<std::pair<float3, float3>> queries(kRayGridWidth * kRayGridHeight);
+                for(auto& [dst, src] : queries)
+                {
+                    dst = float3(random.nextFloat(min.x, max.x), random.nextFloat(min.y, max.y), random.nextFloat(min.z, max.z));
+                    src = float3(random.nextFloat(min.x, max.x), random.nextFloat(min.y, max.y), random.nextFloat(min.z, max.z));
+                }
+
+                uint64_t visible = 0;
+                state.setItemsPerSample(queries.size());
+                state.measure([&]()
+                {
+                    visible = 0;
+                    for(const auto& [dst, src] : queries)
+                        visible += rayTracingScene.isVisibleFrom(dst, src) ? 1 : 0;
+                    doNotOptimise(visible);
+                });
+                state.setCounter("visible_ratio", double(visible) / double(queries.size()));
+            });
+        }
+    }
+}
+
+
+void registerEngineBenchmarks(BenchmarkRegistry& registry)
+{
+    registerRenderGraphBenchmarks(registry);
+    registerRayTracingBenchmarks(registry);
+    registerFrameBenchmarks(registry);
+}
+
+#else
+
+// The engine benchmarks need a device that can run without a window or GPU, so are only built with the null device.
+void registerEngineBenchmarks(BenchmarkRegistry&)
+{
+}
+
+#endif
@@ -0,0 +1,354 @@
+#include "ProceduralScene.hpp"
+
+#include "Engine/Engine.hpp"
+#include "Engine/StaticMesh.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <cmath>
+#include <string>
+
+
+namespace
+{
+    constexpr float kPi = 3.14159265358979f;
+
+    // Distance between grid cells, instances are jittered by up to a quarter of this.
+    constexpr float kInstanceSpacing = 4.0f;
+
+    constexpr float kTubeRadius = 0.25f;
+
+    aiMesh* createMesh(const char* name, const uint32_t vertexCount, const uint32_t faceCount)
+    {
+        aiMesh* mesh = new aiMesh();
+        mesh->mName = aiString(name);
+        mesh->mPrimitiveTypes = aiPrimitiveType_TRIANGLE;
+        mesh->mMaterialIndex = 0;
+
+        mesh->mNumVertices = vertexCount;
+        mesh->mVertices = new aiVector3D[vertexCount];
+        mesh->mNormals = new aiVector3D[vertexCount];
+        mesh->mTextureCoords[0] = new aiVector3D[vertexCount];
+        mesh->mNumUVComponents[0] = 2;
+        mesh->mColors[0] = new aiColor4D[vertexCount];
+
+        mesh->mNumFaces = 0;
+        mesh->mFaces = new aiFace[faceCount];
+
+        return mesh;
+    }
+
+    void addTriangle(aiMesh* mesh, const uint32_t a, const uint32_t b, const uint32_t c)
+    {
+        aiFace& face = mesh->mFaces[mesh->mNumFaces++];
+        face.mNumIndices = 3;
+        face.mIndices = new unsigned int[3]{a, b, c};
+    }
+
+    // Rings of segments + 1 verticies, the seam is duplicated so the uvs wrap.
+    void addRingFaces(aiMesh* mesh, const uint32_t rings, const uint32_t segments, const bool skipPoles)
+    {
+        for(uint32_t r = 0; r < rings; ++r)
+        {
+            for(uint32_t s = 0; s < segments; ++s)
+            {
+                const uint32_t a = r * (segments + 1) + s;
+                const uint32_t b = a + segments + 1;
+
+                if(!skipPoles || r != 0)
+                    addTriangle(mesh, a, b, a + 1);
+                if(!skipPoles || r != (rings - 1))
+                    addTriangle(mesh, a + 1, b, b + 1);
+            }
+        }
+    }
+
+    void setVertex(aiMesh* mesh, const uint32_t index, const float3& position, const float3& normal, const float2& uv)
+    {
+        mesh->mVertices[index] = aiVector3D(position.x, position.y, position.z);
+        mesh->mNormals[index] = aiVector3D(normal.x, normal.y, normal.z);
+        mesh->mTextureCoords[0][index] = aiVector3D(uv.x, uv.y, 0.0f);
+        mesh->mColors[0][index] = aiColor4D(0.5f + normal.x * 0.5f, 0.5f + normal.y * 0.5f, 0.5f + normal.z * 0.5f, 1.0f);
+    }
+
+    aiMaterial* createDefaultMaterial()
+    {
+        aiMaterial* material = new aiMaterial();
+
+        const aiString name("Procedural material");
+        material->AddProperty(&name, AI_MATKEY_NAME);
+        const aiColor4D diffuse(0.8f, 0.8f, 0.8f, 1.0f);
+        material->AddProperty(&diffuse, 1, AI_MATKEY_COLOR_DIFFUSE);
+
+        return material;
+    }
+
+    aiNode* createMeshNode(const char* name)
+    {
+        aiNode* node = new aiNode(name);
+        node->mNumMeshes = 1;
+        node->mMeshes = new unsigned int[1]{0};
+
+        return node;
+    }
+
+    void initialiseScene(aiScene* scene, aiMesh* mesh)
+    {
+        scene->mNumMeshes = 1;
+        scene->mMeshes = new aiMesh*[1]{mesh};
+        scene->mNumMaterials = 1;
+        scene->mMaterials = new aiMaterial*[1]{createDefaultMaterial()};
+        scene->mRootNode = new aiNode("Root");
+    }
+}
+
+
+BenchmarkRandom::BenchmarkRandom(const uint64_t seed) :
+    mState{0}
+{
+    next();
+    mState += seed;
+    next();
+}
+
+
+uint32_t BenchmarkRandom::next()
+{
+    const uint64_t oldState = mState;
+    mState = oldState * 6364136223846793005ull + 1442695040888963407ull;
+
+    const uint32_t xorShifted = static_cast<uint32_t>(((oldState >> 18u) ^ oldState) >> 27u);
+    const uint32_t rotation = static_cast<uint32_t>(oldState >> 59u);
+
+    return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+}
+
+
+float BenchmarkRandom::nextFloat(const float min, const float max)
+{
+    // Top 24 bits so every value is exactly representable.
+    const float unit = float(next() >> 8) * (1.0f / 16777216.0f);
+
+    return min + unit * (max - min);
+}
+
+
+namespace ProceduralScene
+{
+
+std::unique_ptr<aiScene> createSphere(const uint32_t rings, const uint32_t segments)
+{
+    BELL_ASSERT(rings >= 2 && segments >= 3, "Sphere too coarse")
+
+    std::unique_ptr<aiScene> scene = std::make_unique<aiScene>();
+
+    const uint32_t vertexCount = (rings + 1) * (segments + 1);
+    aiMesh* mesh = createMesh("Sphere", vertexCount, (rings - 1) * segments * 2);
+
+    for(uint32_t r = 0; r <= rings; ++r)
+    {
+        const float theta = kPi * float(r) / float(rings);
+        for(uint32_t s = 0; s <= segments; ++s)
+        {
+            const float phi = 2.0f * kPi * float(s) / float(segments);
+            const float3 normal{std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)};
+
+            setVertex(mesh, r * (segments + 1) + s, normal, normal, float2(float(s) / float(segments), float(r) / float(rings)));
+        }
+    }
+
+    addRingFaces(mesh, rings, segments, true);
+
+    initialiseScene(scene.get(), mesh);
+    aiNode* meshNode = createMeshNode("Sphere");
+    scene->mRootNode->addChildren(1, &meshNode);
+
+    return scene;
+}
+
+
+std::unique_ptr<aiScene> createSkinnedTube(const uint32_t boneCount, const uint32_t ringsPerBone, const uint32_t segments, const uint32_t keyCount)
+{
+    BELL_ASSERT(boneCount > 0 && ringsPerBone > 0 && segments >= 3 && keyCount >= 2, "Invalid tube")
+
+    std::unique_ptr<aiScene> scene = std::make_unique<aiScene>();
+
+    const uint32_t rings = boneCount * ringsPerBone;
+    const uint32_t vertexCount = (rings + 1) * (segments + 1);
+    aiMesh* mesh = createMesh("Tube", vertexCount, rings * segments * 2);
+
+    // Each vertex is mostly weighted to the bone it's beside, blending in to the neighbouring bone near the joints.
+    std::vector<std::vector<aiVertexWeight>> boneWeights(boneCount);
+    for(uint32_t r = 0; r <= rings; ++r)
+    {
+        const float height = float(r) / float(ringsPerBone);
+        const uint32_t bone = std::min(static_cast<uint32_t>(height), boneCount - 1);
+        const float fraction = height - float(bone);
+
+        for(uint32_t s = 0; s <= segments; ++s)
+        {
+            const float phi = 2.0f * kPi * float(s) / float(segments);
+            const float3 normal{std::cos(phi), 0.0f, std::sin(phi)};
+            const uint32_t vertex = r * (segments + 1) + s;
+
+            setVertex(mesh, vertex, float3(normal.x * kTubeRadius, height, normal.z * kTubeRadius), normal,
+                      float2(float(s) / float(segments), height / float(boneCount)));
+
+            if(fraction > 0.5f && (bone + 1) < boneCount)
+            {
+                boneWeights[bone].push_back(aiVertexWeight(vertex, 1.5f - fraction));
+                boneWeights[bone + 1].push_back(aiVertexWeight(vertex, fraction - 0.5f));
+            }
+            else if(fraction < 0.5f && bone > 0)
+            {
+                boneWeights[bone].push_back(aiVertexWeight(vertex, 0.5f + fraction));
+                boneWeights[bone - 1].push_back(aiVertexWeight(vertex, 0.5f - fraction));
+            }
+            else
+                boneWeights[bone].push_back(aiVertexWeight(vertex, 1.0f));
+        }
+    }
+
+    addRingFaces(mesh, rings, segments, false);
+
+    // Bones must be ordered parents first, the first being the root.
+    mesh->mNumBones = boneCount;
+    mesh->mBones = new aiBone*[boneCount];
+    for(uint32_t i = 0; i < boneCount; ++i)
+    {
+        aiBone* bone = new aiBone();
+        bone->mName = aiString("Bone" + std::to_string(i));
+        aiMatrix4x4::Translation(aiVector3D(0.0f, -float(i), 0.0f), bone->mOffsetMatrix);
+
+        bone->mNumWeights = static_cast<unsigned int>(boneWeights[i].size());
+        bone->mWeights = new aiVertexWeight[bone->mNumWeights];
+        std::copy(boneWeights[i].begin(), boneWeights[i].end(), bone->mWeights);
+
+        mesh->mBones[i] = bone;
+    }
+
+    initialiseScene(scene.get(), mesh);
+    aiNode* meshNode = createMeshNode("Tube");
+    scene->mRootNode->addChildren(1, &meshNode);
+
+    aiNode* parent = scene->mRootNode;
+    for(uint32_t i = 0; i < boneCount; ++i)
+    {
+        aiNode* boneNode = new aiNode("Bone" + std::to_string(i));
+        aiMatrix4x4::Translation(aiVector3D(0.0f, i == 0 ? 0.0f : 1.0f, 0.0f), boneNode->mTransformation);
+        parent->addChildren(1, &boneNode);
+        parent = boneNode;
+    }
+
+    aiAnimation* animation = new aiAnimation();
+    animation->mName = aiString("Bend");
+    animation->mDuration = double(keyCount - 1);
+    animation->mTicksPerSecond = 24.0;
+    animation->mNumChannels = boneCount;
+    animation->mChannels = new aiNodeAnim*[boneCount];
+    for(uint32_t i = 0; i < boneCount; ++i)
+    {
+        aiNodeAnim* channel = new aiNodeAnim();
+        channel->mNodeName = aiString("Bone" + std::to_string(i));
+
+        channel->mNumPositionKeys = keyCount;
+        channel->mPositionKeys = new aiVectorKey[keyCount];
+        channel->mNumRotationKeys = keyCount;
+        channel->mRotationKeys = new aiQuatKey[keyCount];
+        channel->mNumScalingKeys = keyCount;
+        channel->mScalingKeys = new aiVectorKey[keyCount];
+
+        for(uint32_t k = 0; k < keyCount; ++k)
+        {
+            const double time = double(k);
+            const float angle = 0.4f * std::sin((2.0f * kPi * float(k) / float(keyCount - 1)) + float(i) * 0.5f);
+
+            channel->mPositionKeys[k] = aiVectorKey(time, aiVector3D(0.0f, i == 0 ? 0.0f : 1.0f, 0.0f));
+            channel->mRotationKeys[k] = aiQuatKey(time, aiQuaternion(aiVector3D(0.0f, 0.0f, 1.0f), angle));
+            channel->mScalingKeys[k] = aiVectorKey(time, aiVector3D(1.0f, 1.0f, 1.0f));
+        }
+
+        animation->mChannels[i] = channel;
+    }
+
+    scene->mNumAnimations = 1;
+    scene->mAnimations = new aiAnimation*[1]{animation};
+
+    return scene;
+}
+
+
+AABB getInstanceBounds(const uint64_t instanceCount)
+{
+    const uint64_t side = static_cast<uint64_t>(std::ceil(std::cbrt(double(std::max<uint64_t>(instanceCount, 1)))));
+    const float extent = float(side) * kInstanceSpacing;
+
+    return AABB(float4(0.0f, 0.0f, 0.0f, 1.0f), float4(extent, extent, extent, 1.0f));
+}
+
+
+std::vector<float4x4> generateInstanceTransforms(const uint64_t instanceCount, const uint64_t seed)
+{
+    BenchmarkRandom random{seed};
+
+    const uint64_t side = static_cast<uint64_t>(std::ceil(std::cbrt(double(std::max<uint64_t>(instanceCount, 1)))));
+    const float jitter = kInstanceSpacing * 0.25f;
+
+    std::vector<float4x4> transforms{};
+    transforms.reserve(instanceCount);
+    for(uint64_t i = 0; i < instanceCount; ++i)
+    {
+        const float3 cell{float(i % side), float((i / side) % side), float(i / (side * side))};
+        const float3 position = (cell + 0.5f) * kInstanceSpacing +
+                                float3(random.nextFloat(-jitter, jitter), random.nextFloat(-jitter, jitter), random.nextFloat(-jitter, jitter));
+        const float rotation = random.nextFloat(0.0f, 2.0f * kPi);
+        const float scale = random.nextFloat(0.5f, 1.0f);
+
+        transforms.push_back(glm::translate(position) * glm::rotate(rotation, float3(0.0f, 1.0f, 0.0f)) * glm::scale(float3(scale)));
+    }
+
+    return transforms;
+}
+
+
+std::vector<Scene::Light> generatePointLights(const uint32_t lightCount, const AABB& bounds, const uint64_t seed)
+{
+    BenchmarkRandom random{seed};
+
+    const float4 min = bounds.getMin();
+    const float4 max = bounds.getMax();
+
+    std::vector<Scene::Light> lights{};
+    lights.reserve(lightCount);
+    for(uint32_t i = 0; i < lightCount; ++i)
+    {
+        const float4 position{random.nextFloat(min.x, max.x), random.nextFloat(min.y, max.y), random.nextFloat(min.z, max.z), 1.0f};
+        const float4 albedo{random.nextFloat(), random.nextFloat(), random.nextFloat(), 1.0f};
+        const float intensity = random.nextFloat(10.0f, 50.0f);
+        const float radius = random.nextFloat(2.0f, 6.0f);
+
+        lights.push_back(Scene::Light::pointLight(position, albedo, intensity, radius));
+    }
+
+    return lights;
+}
+
+
+void populateScene(Scene& scene, RenderEngine* eng, const StaticMesh& mesh, const uint64_t instanceCount, const uint32_t lightCount, const uint64_t seed)
+{
+    const SceneID meshID = scene.addMesh(eng, mesh, MeshType::Static);
+
+    const std::vector<float4x4> transforms = generateInstanceTransforms(instanceCount, seed);
+    for(const float4x4& transform : transforms)
+        scene.addMeshInstance(meshID, kInvalidInstanceID, transform, 0, static_cast<uint32_t>(MaterialType::Diffuse), "Instance");
+
+    const std::vector<Scene::Light> lights = generatePointLights(lightCount, getInstanceBounds(instanceCount), seed + 1);
+    for(const Scene::Light& light : lights)
+        scene.addLight(light);
+
+    scene.computeBounds(AccelerationStructure::StaticMesh);
+    scene.computeBounds(AccelerationStructure::DynamicMesh);
+    scene.computeBounds(AccelerationStructure::Lights);
+}
+
+}
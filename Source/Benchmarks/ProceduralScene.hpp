@@ -0,0 +1,56 @@
+#ifndef BELL_PROCEDURAL_SCENE_HPP
+#define BELL_PROCEDURAL_SCENE_HPP
+
+#include "Engine/AABB.hpp"
+#include "Engine/GeomUtils.h"
+#include "Engine/Scene.h"
+
+#include "assimp/scene.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class RenderEngine;
+class StaticMesh;
+
+
+// PCG32, the standard distributions aren't specified so would generate different scenes on different platforms.
+class BenchmarkRandom
+{
+public:
+
+    explicit BenchmarkRandom(const uint64_t seed);
+
+    uint32_t next();
+
+    // In [min, max).
+    float nextFloat(const float min = 0.0f, const float max = 1.0f);
+
+private:
+
+    uint64_t mState;
+};
+
+
+// Everything below only depends on it's arguments, so the same arguments always produce the same scene.
+namespace ProceduralScene
+{
+    // UV sphere of radius 1 with positions, normals, uvs and vertex colours.
+    std::unique_ptr<aiScene> createSphere(const uint32_t rings, const uint32_t segments);
+
+    // Tube along +y skinned to a chain of boneCount bones, one unit apart, with a looping "Bend" animation of keyCount keys.
+    std::unique_ptr<aiScene> createSkinnedTube(const uint32_t boneCount, const uint32_t ringsPerBone, const uint32_t segments, const uint32_t keyCount);
+
+    // Instances are placed on a jittered grid that grows with the count, so density stays the same at every scale.
+    AABB getInstanceBounds(const uint64_t instanceCount);
+    std::vector<float4x4> generateInstanceTransforms(const uint64_t instanceCount, const uint64_t seed);
+
+    std::vector<Scene::Light> generatePointLights(const uint32_t lightCount, const AABB& bounds, const uint64_t seed);
+
+    // Adds mesh to scene, instances it instanceCount times and adds lightCount point lights, then computes the scenes bounds.
+    // Instances use material 0, which is the engines default material if the scene has none of it's own.
+    void populateScene(Scene& scene, RenderEngine* eng, const StaticMesh& mesh, const uint64_t instanceCount, const uint32_t lightCount, const uint64_t seed);
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+void registerCoreBenchmarks(BenchmarkRegistry&);
+void registerEngineBenchmarks(BenchmarkRegistry&);
+
+
+// CPU benchmarks for the engine, results are written as JSON.
+// usage: BELL_BENCH [--filter <substring>] [--out <file>] [--min-time <ms>] [--max-instances <count>]
+//                   [--baseline <file> [--threshold <percent>]]
+// With a baseline any benchmark whose median is more than threshold percent slower than the baselines fails the run.
+// Needs to be run from the build directory, as the engine benchmarks load the engines assets.
+int main(int argc, char** argv)
+{
+    BenchmarkSettings settings{};
+    std::string filter{};
+    const char* outputPath = nullptr;
+    const char* baselinePath = nullptr;
+    double threshold = 5.0;
+
+    for(int i = 1; i < argc; ++i)
+    {
+        const bool hasValue = (i + 1) < argc;
+
+        if(strcmp(argv[i], "--filter") == 0 && hasValue)
+            filter = argv[++i];
+        else if(strcmp(argv[i], "--out") == 0 && hasValue)
+            outputPath = argv[++i];
+        else if(strcmp(argv[i], "--min-time") == 0 && hasValue)
+            settings.mMinTime = std::chrono::milliseconds(strtoll(argv[++i], nullptr, 10));
+        else if(strcmp(argv[i], "--max-instances") == 0 && hasValue)
+            settings.mMaxInstances = strtoull(argv[++i], nullptr, 10);
+        else if(strcmp(argv[i], "--baseline") == 0 && hasValue)
+            baselinePath = argv[++i];
+        else if(strcmp(argv[i], "--threshold") == 0 && hasValue)
+            threshold = strtod(argv[++i], nullptr);
+        else
+        {
+            printf("usage: %s [--filter <substring>] [--out <file>] [--min-time <ms>] [--max-instances <count>] [--baseline <file> [--threshold <percent>]]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    BenchmarkRegistry registry{};
+    registerCoreBenchmarks(registry);
+    registerEngineBenchmarks(registry);
+
+    const std::vector<BenchmarkResult> results = registry.run(settings, filter);
+
+    FILE* output = stdout;
+    if(outputPath)
+    {
+        output = fopen(outputPath, "w");
+        if(!output)
+        {
+            printf("Failed to open %s\n", outputPath);
+            return 1;
+        }
+    }
+
+    writeBenchmarkResults(output, settings, results);
+
+    if(output != stdout)
+        fclose(output);
+
+    if(!baselinePath)
+        return 0;
+
+    // Benchmarks missing from either side are skipped, so adding or removing one doesn't fail the comparison.
+    const std::vector<std::pair<std::string, double>> baseline = readBenchmarkBaseline(baselinePath);
+    uint32_t regressions = 0;
+    for(const BenchmarkResult& result : results)
+    {
+        auto previous = std::find_if(baseline.begin(), baseline.end(), [&result](const auto& entry) { return entry.first == result.mName; });
+        if(previous == baseline.end() || previous->second <= 0.0)
+            continue;
+
+        const double change = ((result.mMedianNs - previous->second) / previous->second) * 100.0;
+        if(change > threshold)
+        {
+            fprintf(stderr, "Regression: %s %.0f ns -> %.0f ns (+%.1f%%)\n", result.mName.c_str(), previous->second, result.mMedianNs, change);
+            ++regressions;
+        }
+    }
+
+    fprintf(stderr, "%u regressions against %s (threshold %.1f%%)\n", regressions, baselinePath, threshold);
+
+    return regressions > 0 ? 1 : 0;
+}
@@ -6,6 +6,8 @@
 #include "Core/Vulkan/VulkanAccelerationStructures.hpp"
 #elif defined(DX_12)
 // TODO
+#elif defined(NULL_DEVICE)
+#include "Core/Null/NullAccelerationStructures.hpp"
 #endif
 
 BottomLevelAccelerationStructureBase::BottomLevelAccelerationStructureBase(RenderEngine* eng, const StaticMesh &,
@@ -31,6 +33,8 @@ BottomLevelAccelerationStructure::BottomLevelAccelerationStructure(RenderEngine*
         mBase = std::make_shared<VulkanBottomLevelAccelerationStructure>(eng, mesh, name);
 #elif defined(DX_12)
     // TODO
+#elif defined(NULL_DEVICE)
+    mBase = std::make_shared<NullBottomLevelAccelerationStructure>(eng, mesh, name);
 #endif
 }
 
@@ -45,5 +49,7 @@ TopLevelAccelerationStructure::TopLevelAccelerationStructure(RenderEngine* eng)
     mBase = std::make_shared<VulkanTopLevelAccelerationStructure>(eng);
 #elif defined(DX_12)
     // TODO
+#elif defined(NULL_DEVICE)
+    mBase = std::make_shared<NullTopLevelAccelerationStructure>(eng);
 #endif
 }
\ No newline at end of file
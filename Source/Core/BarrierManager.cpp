@@ -9,6 +9,10 @@
 #include "Core/Vulkan/VulkanBarrierManager.hpp"
 #endif
 
+#ifdef NULL_DEVICE
+#include "Core/Null/NullBarrierManager.hpp"
+#endif
+
 #include <algorithm>
 
 
@@ -31,4 +35,8 @@ BarrierRecorder::BarrierRecorder(RenderDevice* dev)
 #ifdef VULKAN
 	mBase = std::make_shared<VulkanBarrierRecorder>(dev);
 #endif
+
+#ifdef NULL_DEVICE
+	mBase = std::make_shared<NullBarrierRecorder>(dev);
+#endif
 }
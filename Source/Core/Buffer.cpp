@@ -12,6 +12,10 @@
 #include "Core/DX_12/DX_12Buffer.hpp"
 #endif
 
+#ifdef NULL_DEVICE
+#include "Core/Null/NullBuffer.hpp"
+#endif
+
 BufferBase::BufferBase(RenderDevice* dev,
 	   BufferUsage usage,
 	   const uint32_t size,
@@ -72,4 +76,8 @@ Buffer::Buffer(RenderDevice* dev,
 #ifdef DX_12
 	mBase = std::make_shared<DX_12Buffer>(dev, usage, size, stride, name);
 #endif
+
+#ifdef NULL_DEVICE
+	mBase = std::make_shared<NullBuffer>(dev, usage, size, stride, name);
+#endif
 }
@@ -9,6 +9,10 @@
 #include "Core/DX_12/DX_12BufferView.hpp"
 #endif
 
+#ifdef NULL_DEVICE
+#include "Core/Null/NullBufferView.hpp"
+#endif
+
 BufferViewBase::BufferViewBase(Buffer& parentBuffer, const uint64_t offset, const uint64_t size) :
 	DeviceChild{parentBuffer->getDevice()},
 	mOffset{offset},
@@ -27,4 +31,8 @@ BufferView::BufferView(Buffer& buffer, const uint64_t offset, const uint64_t siz
 #ifdef DX_12
     mBase = std::make_shared<DX_12BufferView>(buffer, offset, size);
 #endif
+
+#ifdef NULL_DEVICE
+    mBase = std::make_shared<NullBufferView>(buffer, offset, size);
+#endif
 }
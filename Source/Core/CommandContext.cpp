@@ -5,7 +5,9 @@
 CommandContextBase::CommandContextBase(RenderDevice* dev, const QueueType type) :
     DeviceChild(dev),
     mQueueType(type),
-    mShouldSubmit(false)
+    mShouldSubmit(false),
+    mTimestampNames{},
+    mTimestampNameCount{0}
 {
 }
 
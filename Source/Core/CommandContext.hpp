@@ -2,9 +2,11 @@
 #define COMMAND_CONTEXT_HPP
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "DeviceChild.hpp"
+#include "Core/BellLogging.hpp"
 #include "RenderGraph/RenderGraph.hpp"
 
 class Executor;
@@ -25,6 +27,13 @@ public:
     virtual const std::vector<uint64_t>& getTimestamps() = 0;
     virtual void      reset() = 0;
 
+    // Name of the task each pair of timestamps was written around.
+    const std::string& getTimestampName(const uint32_t pairIndex) const
+    {
+        BELL_ASSERT(pairIndex < mTimestampNameCount, "Timestamp pair wasn't named")
+        return mTimestampNames[pairIndex];
+    }
+
     bool getSubmitFlag() const
     {
         return mShouldSubmit;
@@ -37,10 +46,31 @@ public:
 
 protected:
 
+    // Names are reused between frames to avoid reallocating them.
+    void addTimestampName(const std::string& name)
+    {
+        if(mTimestampNameCount < mTimestampNames.size())
+            mTimestampNames[mTimestampNameCount] = name;
+        else
+            mTimestampNames.push_back(name);
+
+        ++mTimestampNameCount;
+    }
+
+    void clearTimestampNames()
+    {
+        mTimestampNameCount = 0;
+    }
+
     std::vector<Executor*> mFreeExecutors;
     QueueType mQueueType;
 
     bool mShouldSubmit;
+
+private:
+
+    std::vector<std::string> mTimestampNames;
+    uint32_t mTimestampNameCount;
 };
 
 #endif
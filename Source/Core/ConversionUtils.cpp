@@ -151,6 +151,21 @@ vk::Format getVulkanImageFormat(const Format format)
     case Format::RGBA16Float:
         return vk::Format::eR16G16B16A16Sfloat;
 
+    case Format::BC1UNorm:
+        return vk::Format::eBc1RgbUnormBlock;
+
+    case Format::BC3UNorm:
+        return vk::Format::eBc3UnormBlock;
+
+    case Format::BC4UNorm:
+        return vk::Format::eBc4UnormBlock;
+
+    case Format::BC5UNorm:
+        return vk::Format::eBc5UnormBlock;
+
+    case Format::BC7UNorm:
+        return vk::Format::eBc7UnormBlock;
+
 	default:
         BELL_TRAP;
 		return vk::Format::eR8G8B8A8Srgb;
@@ -426,6 +441,21 @@ DXGI_FORMAT getDX12ImageFormat(const Format format)
 	case Format::R16UInt:
 		return DXGI_FORMAT_R16_UINT;
 
+	case Format::BC1UNorm:
+		return DXGI_FORMAT_BC1_UNORM;
+
+	case Format::BC3UNorm:
+		return DXGI_FORMAT_BC3_UNORM;
+
+	case Format::BC4UNorm:
+		return DXGI_FORMAT_BC4_UNORM;
+
+	case Format::BC5UNorm:
+		return DXGI_FORMAT_BC5_UNORM;
+
+	case Format::BC7UNorm:
+		return DXGI_FORMAT_BC7_UNORM;
+
 	default:
 		return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
 	}
@@ -628,6 +658,35 @@ uint32_t getPixelSize(const Format format)
 }
 
 
+uint32_t getBlockSize(const Format format)
+{
+	switch(format)
+	{
+	case Format::BC1UNorm:
+	case Format::BC4UNorm:
+		return 8;
+
+	case Format::BC3UNorm:
+	case Format::BC5UNorm:
+	case Format::BC7UNorm:
+		return 16;
+
+	default:
+		return 0;
+	}
+}
+
+
+uint32_t getImageDataSize(const Format format, const uint32_t x, const uint32_t y, const uint32_t z)
+{
+	const uint32_t blockSize = getBlockSize(format);
+	if(blockSize > 0)
+		return ((x + 3) / 4) * ((y + 3) / 4) * z * blockSize;
+
+	return x * y * z * getPixelSize(format);
+}
+
+
 SyncPoint getSyncPoint(const AttachmentType type)
 {
 	switch (type)
@@ -56,6 +56,11 @@ AttachmentType getAttachmentType(const ImageLayout);
 
 uint32_t getPixelSize(const Format);
 
+// Size in bytes of a 4x4 block for block compressed formats, 0 otherwise.
+uint32_t getBlockSize(const Format);
+
+uint32_t getImageDataSize(const Format, const uint32_t x, const uint32_t y, const uint32_t z);
+
 SyncPoint getSyncPoint(const AttachmentType);
 
 const char* getLayoutName(const ImageLayout);
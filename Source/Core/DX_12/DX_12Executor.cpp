@@ -49,6 +49,13 @@ void DX12_Executor::indexedIndirectDraw(const uint32_t drawCalls, const BufferVi
 }
 
 
+void DX12_Executor::indexedIndirectDrawCount(const uint32_t maxDrawCalls, const BufferView& drawCommands, const uint32_t firstDrawCall,
+                                             const BufferView& count, const uint32_t countIndex)
+{
+
+}
+
+
 void DX12_Executor::insertPushConsatnt(const void* val, const size_t size)
 {
 
@@ -24,6 +24,9 @@ public:
 
     virtual void indexedIndirectDraw(const uint32_t drawCalls, const BufferView&) override final;
 
+    virtual void indexedIndirectDrawCount(const uint32_t maxDrawCalls, const BufferView& drawCommands, const uint32_t firstDrawCall,
+                                          const BufferView& count, const uint32_t countIndex) override final;
+
     virtual void insertPushConstant(const void* val, const size_t size) override final;
 
     virtual void dispatch(const uint32_t x, const uint32_t y, const uint32_t z) override final;
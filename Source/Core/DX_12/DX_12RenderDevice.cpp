@@ -180,13 +180,19 @@ bool DX_12RenderDevice::getHasCommandPredicationSupport() const
 }
 
 
+bool DX_12RenderDevice::getHasIndirectDrawCountSupport() const
+{
+    return false;
+}
+
+
 bool DX_12RenderDevice::getHasAsyncComputeSupport() const
 {
     return false;
 }
 
 
-const std::vector<uint64_t>& DX_12RenderDevice::getAvailableTimestamps() const
+const std::vector<TaskTimestamp>& DX_12RenderDevice::getAvailableTimestamps() const
 {
 	return mTimeStamps;
 }
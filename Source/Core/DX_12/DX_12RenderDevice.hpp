@@ -46,9 +46,10 @@ public:
 
 	virtual size_t					   getMinStorageBufferAlignment() const override;
     virtual bool                       getHasCommandPredicationSupport() const override;
+    virtual bool                       getHasIndirectDrawCountSupport() const override;
     virtual bool                       getHasAsyncComputeSupport() const override;
 
-	virtual const std::vector<uint64_t>& getAvailableTimestamps() const override;
+	virtual const std::vector<TaskTimestamp>& getAvailableTimestamps() const override;
 	virtual float                      getTimeStampPeriod() const override;
 
 	void							   createResource(	const D3D12_RESOURCE_DESC& desc, 
@@ -81,7 +82,7 @@ private:
 
 	std::vector<ID3D12Fence*> mFrameComplete;
 
-	std::vector<uint64_t> mTimeStamps;
+	std::vector<TaskTimestamp> mTimeStamps;
 };
 
 #endif
@@ -19,4 +19,10 @@ DX_12ShaderResourceSet::~DX_12ShaderResourceSet()
 void DX_12ShaderResourceSet::finalise()
 {
 
-}
\ No newline at end of file
+}
+
+
+void DX_12ShaderResourceSet::updateArrayElements()
+{
+
+}
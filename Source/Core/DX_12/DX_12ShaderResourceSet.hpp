@@ -14,6 +14,7 @@ public:
 	~DX_12ShaderResourceSet();
 
 	virtual void finalise() override final;
+	virtual void updateArrayElements() override final;
 
 private:
 
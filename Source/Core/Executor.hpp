@@ -35,6 +35,11 @@ public:
 
 	virtual void indexedIndirectDraw(const uint32_t drawCalls, const BufferView&) = 0;
 
+    // Draws up to maxDrawCalls commands starting at firstDrawCall, the number actually drawn is read from the
+    // uint at countIndex in the count buffer.
+    virtual void indexedIndirectDrawCount(const uint32_t maxDrawCalls, const BufferView& drawCommands, const uint32_t firstDrawCall,
+                                          const BufferView& count, const uint32_t countIndex) = 0;
+
     virtual void insertPushConstant(const void* val, const size_t size) = 0;
 
 	virtual void dispatch(const uint32_t x, const uint32_t y, const uint32_t z) = 0;
@@ -11,6 +11,10 @@
 #include "Core/DX_12/DX_12Image.hpp"
 #endif
 
+#ifdef NULL_DEVICE
+#include "Core/Null/NullImage.hpp"
+#endif
+
 ImageBase::ImageBase(RenderDevice* dev,
 			 const Format format,
 			 const ImageUsage usage,
@@ -46,7 +50,7 @@ ImageBase::ImageBase(RenderDevice* dev,
             subInfo.mLayout = ImageLayout::Undefined;
             subInfo.mExtent = extent;
 
-            extent = ImageExtent{extent.width / 2, extent.height / 2, std::max(extent.depth / 2, 1u)};
+            extent = ImageExtent{std::max(extent.width / 2, 1u), std::max(extent.height / 2, 1u), std::max(extent.depth / 2, 1u)};
 
 			mSubResourceInfo->push_back(subInfo);
         }
@@ -118,4 +122,8 @@ Image::Image(RenderDevice* dev,
 #ifdef DX_12
 	mBase = std::make_shared<DX_12Image>(dev, format, usage, x, y, z, mips, levels, samples, name);
 #endif
+
+#ifdef NULL_DEVICE
+	mBase = std::make_shared<NullImage>(dev, format, usage, x, y, z, mips, levels, samples, name);
+#endif
 }
@@ -11,6 +11,10 @@
 #include "Core/DX_12/DX_12ImageView.hpp"
 #endif
 
+#ifdef NULL_DEVICE
+#include "Core/Null/NullImageView.hpp"
+#endif
+
 
 ImageViewBase::ImageViewBase(Image& parentImage,
 					 const ImageViewType viewType,
@@ -68,4 +72,8 @@ ImageView::ImageView(Image& image,
 #ifdef DX_12
 	mBase = std::make_shared<DX_12ImageView>(image, type, level, levelCount, lod, lodCount);
 #endif
+
+#ifdef NULL_DEVICE
+	mBase = std::make_shared<NullImageView>(image, type, level, levelCount, lod, lodCount);
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,341 @@
+#include "Core/Instrumentation.hpp"
+#include "Core/BellLogging.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+
+
+namespace
+{
+    struct CPUEvent
+    {
+        const char* mName;
+        uint64_t mStartNs;
+        uint64_t mEndNs;
+    };
+
+    // Only ever written by the thread that owns it. Buffers are kept after their thread exits so captures can
+    // still see what it recorded.
+    struct ThreadBuffer
+    {
+        uint32_t mThreadID;
+        std::string mName;
+        std::atomic<uint64_t> mWritten;
+        std::atomic<uint64_t> mCaptureStart; // Events before this were recorded before the capture started.
+        std::unique_ptr<CPUEvent[]> mEvents;
+    };
+
+    struct FrameRecord
+    {
+        uint64_t mFrame;
+        uint64_t mStartNs;
+        uint64_t mEndNs;
+        std::vector<Instrumentation::GPUTaskTime> mGPUTasks;
+    };
+
+    std::mutex gThreadsLock;
+    std::vector<std::unique_ptr<ThreadBuffer>> gThreads;
+    thread_local ThreadBuffer* tThreadBuffer = nullptr;
+
+    // Frames are only bracketed from the render thread, the lock is for reading them from elsewhere.
+    std::mutex gFramesLock;
+    std::vector<FrameRecord> gFrames; // Ring of the last kStatisticsWindow frames.
+    uint64_t gFrameCount = 0;
+    uint64_t gFrameStartNs = 0;
+    std::vector<Instrumentation::GPUTaskTime> gFrameGPUTasks;
+    Instrumentation::MetricsCallback gMetricsCallback;
+
+    const uint64_t gEpochNs = Instrumentation::getTimeNs();
+
+    ThreadBuffer& getThreadBuffer()
+    {
+        if(!tThreadBuffer)
+        {
+            std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+            buffer->mEvents = std::make_unique<CPUEvent[]>(Instrumentation::kEventsPerThread);
+            buffer->mWritten = 0;
+            buffer->mCaptureStart = 0;
+
+            std::lock_guard<std::mutex> lock{gThreadsLock};
+            buffer->mThreadID = static_cast<uint32_t>(gThreads.size());
+            buffer->mName = "Thread " + std::to_string(buffer->mThreadID);
+            tThreadBuffer = buffer.get();
+            gThreads.push_back(std::move(buffer));
+        }
+
+        return *tThreadBuffer;
+    }
+
+    double toMicroseconds(const uint64_t ns)
+    {
+        return double(ns - std::min(ns, gEpochNs)) / 1000.0;
+    }
+
+    void writeJSONString(FILE* file, const char* str)
+    {
+        fputc('"', file);
+        for(; *str; ++str)
+        {
+            if(*str == '"' || *str == '\\')
+                fprintf(file, "\\%c", *str);
+            else if(static_cast<unsigned char>(*str) < 0x20)
+                fprintf(file, "\\u%04x", *str);
+            else
+                fputc(*str, file);
+        }
+        fputc('"', file);
+    }
+
+    Instrumentation::Statistic calculateStatistic(std::vector<double>& samples)
+    {
+        Instrumentation::Statistic statistic{};
+        statistic.mSamples = static_cast<uint32_t>(samples.size());
+        if(samples.empty())
+            return statistic;
+
+        std::sort(samples.begin(), samples.end());
+
+        double total = 0.0;
+        for(const double sample : samples)
+            total += sample;
+
+        statistic.mMean = total / double(samples.size());
+        statistic.mP50 = samples[samples.size() / 2];
+        statistic.mP99 = samples[std::min(samples.size() - 1, (samples.size() * 99) / 100)];
+        statistic.mMax = samples.back();
+
+        return statistic;
+    }
+}
+
+
+namespace Instrumentation
+{
+
+std::atomic<bool> gEnabled{false};
+
+
+void setEnabled(const bool enabled)
+{
+    if(enabled && !isEnabled())
+    {
+        {
+            std::lock_guard<std::mutex> lock{gThreadsLock};
+            for(const std::unique_ptr<ThreadBuffer>& buffer : gThreads)
+                buffer->mCaptureStart.store(buffer->mWritten.load(std::memory_order_acquire), std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> lock{gFramesLock};
+        gFrames.clear();
+        gFrameGPUTasks.clear();
+        gFrameStartNs = 0;
+    }
+
+    gEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+
+void setThreadName(const char* name)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+
+    std::lock_guard<std::mutex> lock{gThreadsLock};
+    buffer.mName = name;
+}
+
+
+uint64_t getTimeNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+
+void recordCPUEvent(const char* name, const uint64_t startNs, const uint64_t endNs)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+
+    const uint64_t index = buffer.mWritten.load(std::memory_order_relaxed);
+    buffer.mEvents[index % kEventsPerThread] = CPUEvent{name, startNs, endNs};
+    buffer.mWritten.store(index + 1, std::memory_order_release);
+}
+
+
+void setMetricsCallback(MetricsCallback callback)
+{
+    std::lock_guard<std::mutex> lock{gFramesLock};
+    gMetricsCallback = std::move(callback);
+}
+
+
+void beginFrame()
+{
+    if(!isEnabled())
+        return;
+
+    std::lock_guard<std::mutex> lock{gFramesLock};
+    gFrameStartNs = getTimeNs();
+    gFrameGPUTasks.clear();
+}
+
+
+void recordGPUTasks(const std::vector<GPUTaskTime>& tasks)
+{
+    if(!isEnabled())
+        return;
+
+    std::lock_guard<std::mutex> lock{gFramesLock};
+    gFrameGPUTasks.insert(gFrameGPUTasks.end(), tasks.begin(), tasks.end());
+}
+
+
+void endFrame()
+{
+    if(!isEnabled())
+        return;
+
+    MetricsCallback callback{};
+    FrameRecord record{};
+    {
+        std::lock_guard<std::mutex> lock{gFramesLock};
+
+        // Enabled part way through the frame.
+        if(gFrameStartNs == 0)
+            return;
+
+        record.mFrame = gFrameCount++;
+        record.mStartNs = gFrameStartNs;
+        record.mEndNs = getTimeNs();
+        record.mGPUTasks = gFrameGPUTasks;
+
+        if(gFrames.size() < kStatisticsWindow)
+            gFrames.push_back(record);
+        else
+            gFrames[record.mFrame % kStatisticsWindow] = record;
+
+        callback = gMetricsCallback;
+    }
+
+    recordCPUEvent("Frame", record.mStartNs, record.mEndNs);
+
+    if(callback)
+    {
+        double gpuTime = 0.0;
+        for(const GPUTaskTime& task : record.mGPUTasks)
+            gpuTime += task.mMilliseconds;
+
+        callback(FrameMetrics{record.mFrame, double(record.mEndNs - record.mStartNs) / 1000000.0, gpuTime, record.mGPUTasks});
+    }
+}
+
+
+std::vector<std::pair<std::string, Statistic>> getStatistics()
+{
+    std::vector<double> cpuFrame{};
+    std::vector<double> gpuFrame{};
+    std::map<std::string, std::vector<double>> gpuTasks{};
+    {
+        std::lock_guard<std::mutex> lock{gFramesLock};
+        for(const FrameRecord& frame : gFrames)
+        {
+            cpuFrame.push_back(double(frame.mEndNs - frame.mStartNs) / 1000000.0);
+
+            // Tasks recorded more than once in a frame are summed.
+            std::map<std::string, double> frameTasks{};
+            double gpuTime = 0.0;
+            for(const GPUTaskTime& task : frame.mGPUTasks)
+            {
+                frameTasks[task.mTaskName] += task.mMilliseconds;
+                gpuTime += task.mMilliseconds;
+            }
+
+            if(!frame.mGPUTasks.empty())
+                gpuFrame.push_back(gpuTime);
+
+            for(const auto& [name, time] : frameTasks)
+                gpuTasks[name].push_back(time);
+        }
+    }
+
+    std::vector<std::pair<std::string, Statistic>> statistics{};
+    statistics.push_back({"cpu/frame", calculateStatistic(cpuFrame)});
+    statistics.push_back({"gpu/frame", calculateStatistic(gpuFrame)});
+    for(auto& [name, samples] : gpuTasks)
+        statistics.push_back({"gpu/" + name, calculateStatistic(samples)});
+
+    return statistics;
+}
+
+
+bool writeChromeTrace(const char* path)
+{
+    FILE* file = fopen(path, "w");
+    if(!file)
+    {
+        BELL_LOG_ARGS("Unable to open %s for writing", path)
+        return false;
+    }
+
+    // GPU tasks go on their own track after the CPU threads.
+    uint32_t gpuThreadID = 0;
+
+    fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+    fprintf(file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"Bell\"}}");
+    {
+        std::vector<CPUEvent> events{};
+
+        std::lock_guard<std::mutex> lock{gThreadsLock};
+        for(const std::unique_ptr<ThreadBuffer>& buffer : gThreads)
+        {
+            fprintf(file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": ", buffer->mThreadID);
+            writeJSONString(file, buffer->mName.c_str());
+            fprintf(file, "}}");
+
+            // The owning thread may still be writing, so anything it could have overwritten whilst copying is dropped.
+            const uint64_t written = buffer->mWritten.load(std::memory_order_acquire);
+            const uint64_t first = std::max(buffer->mCaptureStart.load(std::memory_order_relaxed), written - std::min<uint64_t>(written, kEventsPerThread));
+            events.clear();
+            for(uint64_t i = first; i < written; ++i)
+                events.push_back(buffer->mEvents[i % kEventsPerThread]);
+
+            const uint64_t writtenAfterCopy = buffer->mWritten.load(std::memory_order_acquire);
+            const uint64_t overwritten = writtenAfterCopy - std::min<uint64_t>(writtenAfterCopy, kEventsPerThread);
+            for(uint64_t i = std::max(first, overwritten); i < written; ++i)
+            {
+                const CPUEvent& event = events[i - first];
+                fprintf(file, ",\n{\"name\": ");
+                writeJSONString(file, event.mName);
+                fprintf(file, ", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                        buffer->mThreadID, toMicroseconds(event.mStartNs), double(event.mEndNs - event.mStartNs) / 1000.0);
+            }
+        }
+
+        gpuThreadID = static_cast<uint32_t>(gThreads.size());
+    }
+
+    fprintf(file, ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"GPU\"}}", gpuThreadID);
+    {
+        std::lock_guard<std::mutex> lock{gFramesLock};
+        for(const FrameRecord& frame : gFrames)
+        {
+            double start = toMicroseconds(frame.mStartNs);
+            for(const GPUTaskTime& task : frame.mGPUTasks)
+            {
+                fprintf(file, ",\n{\"name\": ");
+                writeJSONString(file, task.mTaskName.c_str());
+                fprintf(file, ", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f, \"args\": {\"frame\": %llu}}",
+                        gpuThreadID, start, task.mMilliseconds * 1000.0, static_cast<unsigned long long>(frame.mFrame));
+                start += task.mMilliseconds * 1000.0;
+            }
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    return true;
+}
+
+}
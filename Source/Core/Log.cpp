@@ -0,0 +1,594 @@
+#include "Core/Log.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+    struct RecordHeader
+    {
+        uint32_t mSize; // Including the header and padding.
+        uint32_t mArgumentSize;
+        uint64_t mTimeNs;
+        const char* mFormat; // nullptr for padding at the end of the buffer.
+        const char* mFile;
+        uint32_t mLine;
+        Log::Severity mSeverity;
+        Log::Category mCategory;
+    };
+
+    constexpr uint32_t kRecordAllignment = alignof(RecordHeader);
+    static_assert((Log::kBufferSize % kRecordAllignment) == 0, "Records must never straddle the end of the buffer");
+
+    // Single producer single consumer ring, only the owning thread writes and drains are serialised by gDrainLock.
+    struct ThreadBuffer
+    {
+        uint32_t mThreadID;
+        std::atomic<uint64_t> mWritten;
+        std::atomic<uint64_t> mRead;
+        std::atomic<uint64_t> mDropped;
+        std::unique_ptr<unsigned char[]> mData;
+    };
+
+    struct PendingRecord
+    {
+        uint64_t mTimeNs;
+        uint32_t mThreadID;
+        Log::Severity mSeverity;
+        Log::Category mCategory;
+        const char* mFile;
+        uint32_t mLine;
+        std::string mMessage;
+    };
+
+    // Buffers outlive their threads, so messages logged just before a thread exits still get written.
+    std::mutex gThreadsLock;
+    std::vector<std::unique_ptr<ThreadBuffer>> gThreads;
+    thread_local ThreadBuffer* tThreadBuffer = nullptr;
+
+    std::mutex gSinksLock;
+    std::mutex gDrainLock;
+
+    uint64_t getTimeNs()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    const uint64_t gEpochNs = getTimeNs();
+
+    template<typename T>
+    T readArgument(const unsigned char*& arguments)
+    {
+        T value;
+        std::memcpy(&value, arguments, sizeof(T));
+        arguments += sizeof(T);
+        return value;
+    }
+
+    // Does the printf formatting one conversion at a time, as the arguments only exist as packed values.
+    void formatMessage(const char* format, const unsigned char* arguments, const uint32_t argumentSize, std::string& message)
+    {
+        const unsigned char* argumentsEnd = arguments + argumentSize;
+        char buffer[512];
+
+        while(*format)
+        {
+            const char* percent = strchr(format, '%');
+            if(!percent)
+            {
+                message.append(format);
+                break;
+            }
+
+            message.append(format, percent - format);
+            format = percent + 1;
+
+            if(*format == '%')
+            {
+                message.push_back('%');
+                ++format;
+                continue;
+            }
+
+            // Keep the flags, width and precision, the length modifiers are replaced to match the packed type.
+            std::string specifier = "%";
+            while(*format && strchr("-+ #0123456789.", *format))
+                specifier.push_back(*format++);
+            while(*format && strchr("hljztL", *format))
+                ++format;
+
+            const char conversion = *format;
+            if(conversion == '\0')
+                break;
+            ++format;
+
+            if(arguments >= argumentsEnd)
+            {
+                message.append("<missing>");
+                continue;
+            }
+
+            const Log::ArgumentPacker::Tag tag = static_cast<Log::ArgumentPacker::Tag>(*arguments++);
+            std::string string{};
+            uint64_t value = 0;
+            double floatValue = 0.0;
+            switch(tag)
+            {
+                case Log::ArgumentPacker::Tag::String:
+                {
+                    const uint32_t length = readArgument<uint32_t>(arguments);
+                    string.assign(reinterpret_cast<const char*>(arguments), length);
+                    arguments += length;
+                    break;
+                }
+
+                case Log::ArgumentPacker::Tag::Float:
+                    floatValue = readArgument<double>(arguments);
+                    value = static_cast<uint64_t>(floatValue);
+                    break;
+
+                default:
+                    value = readArgument<uint64_t>(arguments);
+                    floatValue = tag == Log::ArgumentPacker::Tag::Signed ? double(int64_t(value)) : double(value);
+                    break;
+            }
+
+            int written = 0;
+            switch(conversion)
+            {
+                case 'd':
+                case 'i':
+                    written = snprintf(buffer, sizeof(buffer), (specifier + "lld").c_str(), static_cast<long long>(value));
+                    break;
+
+                case 'u':
+                case 'o':
+                case 'x':
+                case 'X':
+                    written = snprintf(buffer, sizeof(buffer), (specifier + "ll" + conversion).c_str(), static_cast<unsigned long long>(value));
+                    break;
+
+                case 'c':
+                    written = snprintf(buffer, sizeof(buffer), (specifier + "c").c_str(), static_cast<int>(value));
+                    break;
+
+                case 'f':
+                case 'F':
+                case 'e':
+                case 'E':
+                case 'g':
+                case 'G':
+                case 'a':
+                case 'A':
+                    written = snprintf(buffer, sizeof(buffer), (specifier + conversion).c_str(), floatValue);
+                    break;
+
+                case 'p':
+                    written = snprintf(buffer, sizeof(buffer), (specifier + "p").c_str(), reinterpret_cast<void*>(value));
+                    break;
+
+                case 's':
+                case 'S':
+                    // Strings can be longer than the buffer, so only pad them.
+                    if(tag != Log::ArgumentPacker::Tag::String)
+                        string = "<not a string>";
+                    written = snprintf(nullptr, 0, (specifier + "s").c_str(), string.c_str());
+                    if(written > 0 && written >= int(sizeof(buffer)))
+                    {
+                        message.append(string);
+                        written = 0;
+                    }
+                    else
+                        written = snprintf(buffer, sizeof(buffer), (specifier + "s").c_str(), string.c_str());
+                    break;
+
+                default:
+                    break;
+            }
+
+            if(written > 0)
+                message.append(buffer, std::min<size_t>(written, sizeof(buffer) - 1));
+        }
+    }
+
+    std::vector<std::unique_ptr<Log::Sink>>& getSinks()
+    {
+        static std::vector<std::unique_ptr<Log::Sink>> sinks = []()
+        {
+            std::vector<std::unique_ptr<Log::Sink>> defaultSinks{};
+            defaultSinks.push_back(std::make_unique<Log::ConsoleSink>());
+            return defaultSinks;
+        }();
+
+        return sinks;
+    }
+
+    void writeToSinks(const PendingRecord& pending)
+    {
+        const Log::Record record{pending.mTimeNs - std::min(pending.mTimeNs, gEpochNs), pending.mThreadID, pending.mSeverity, pending.mCategory,
+                                 pending.mFile, pending.mLine, pending.mMessage};
+
+        for(const std::unique_ptr<Log::Sink>& sink : getSinks())
+            sink->write(record);
+    }
+
+    // Takes every record written so far, formats them and hands them to the sinks in the order they were logged.
+    void drain()
+    {
+        std::lock_guard<std::mutex> drainLock{gDrainLock};
+        static std::vector<PendingRecord> pendingRecords{};
+
+        std::vector<ThreadBuffer*> buffers{};
+        {
+            std::lock_guard<std::mutex> lock{gThreadsLock};
+            for(const std::unique_ptr<ThreadBuffer>& buffer : gThreads)
+                buffers.push_back(buffer.get());
+        }
+
+        uint64_t dropped = 0;
+        for(ThreadBuffer* buffer : buffers)
+        {
+            const uint64_t written = buffer->mWritten.load(std::memory_order_acquire);
+            uint64_t read = buffer->mRead.load(std::memory_order_relaxed);
+
+            while(read < written)
+            {
+                const uint64_t offset = read % Log::kBufferSize;
+                if((Log::kBufferSize - offset) < sizeof(RecordHeader))
+                {
+                    read += Log::kBufferSize - offset;
+                    continue;
+                }
+
+                RecordHeader header;
+                std::memcpy(&header, buffer->mData.get() + offset, sizeof(RecordHeader));
+                if(header.mFormat)
+                {
+                    PendingRecord& pending = pendingRecords.emplace_back();
+                    pending.mTimeNs = header.mTimeNs;
+                    pending.mThreadID = buffer->mThreadID;
+                    pending.mSeverity = header.mSeverity;
+                    pending.mCategory = header.mCategory;
+                    pending.mFile = header.mFile;
+                    pending.mLine = header.mLine;
+                    formatMessage(header.mFormat, buffer->mData.get() + offset + sizeof(RecordHeader), header.mArgumentSize, pending.mMessage);
+                }
+
+                read += header.mSize;
+            }
+
+            buffer->mRead.store(read, std::memory_order_release);
+            dropped += buffer->mDropped.exchange(0, std::memory_order_relaxed);
+        }
+
+        if(pendingRecords.empty() && dropped == 0)
+            return;
+
+        std::stable_sort(pendingRecords.begin(), pendingRecords.end(), [](const PendingRecord& lhs, const PendingRecord& rhs) { return lhs.mTimeNs < rhs.mTimeNs; });
+
+        std::lock_guard<std::mutex> sinksLock{gSinksLock};
+        for(const PendingRecord& pending : pendingRecords)
+            writeToSinks(pending);
+
+        if(dropped > 0)
+            writeToSinks({getTimeNs(), 0, Log::Severity::Warning, Log::Category::General, __FILE__, __LINE__,
+                          std::to_string(dropped) + " log messages dropped, a threads log buffer was full"});
+
+        for(const std::unique_ptr<Log::Sink>& sink : getSinks())
+            sink->flush();
+
+        pendingRecords.clear();
+    }
+
+    // Drains every few milliseconds, or straight away for errors. Stopped at exit after a final drain.
+    class Writer
+    {
+    public:
+
+        Writer() :
+            mStop{false},
+            mWake{false},
+            mThread{[this]() { run(); }} {}
+
+        ~Writer()
+        {
+            {
+                std::lock_guard<std::mutex> lock{mLock};
+                mStop = true;
+            }
+            mCondition.notify_one();
+            mThread.join();
+
+            drain();
+        }
+
+        void wake()
+        {
+            {
+                std::lock_guard<std::mutex> lock{mLock};
+                mWake = true;
+            }
+            mCondition.notify_one();
+        }
+
+    private:
+
+        void run()
+        {
+            std::unique_lock<std::mutex> lock{mLock};
+            while(!mStop)
+            {
+                mCondition.wait_for(lock, std::chrono::milliseconds(5), [this]() { return mStop || mWake; });
+                mWake = false;
+
+                lock.unlock();
+                drain();
+                lock.lock();
+            }
+        }
+
+        std::mutex mLock;
+        std::condition_variable mCondition;
+        bool mStop;
+        bool mWake;
+        std::thread mThread;
+    };
+
+    Writer& getWriter()
+    {
+        // The writers final drain uses the sinks, so they need to be constructed first to be destroyed after it.
+        getSinks();
+        static Writer writer{};
+        return writer;
+    }
+
+    ThreadBuffer& getThreadBuffer()
+    {
+        if(!tThreadBuffer)
+        {
+            // Start the writer before registering, so it's destroyed (and does its final drain) first.
+            getWriter();
+
+            std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+            buffer->mData = std::make_unique<unsigned char[]>(Log::kBufferSize);
+            buffer->mWritten = 0;
+            buffer->mRead = 0;
+            buffer->mDropped = 0;
+
+            std::lock_guard<std::mutex> lock{gThreadsLock};
+            buffer->mThreadID = static_cast<uint32_t>(gThreads.size());
+            tThreadBuffer = buffer.get();
+            gThreads.push_back(std::move(buffer));
+        }
+
+        return *tThreadBuffer;
+    }
+
+    void writeLine(FILE* file, const Log::Record& record)
+    {
+        fprintf(file, "[%10.3f][%s][%s][%u] %.*s\n", double(record.mTimeNs) / 1000000.0, Log::getSeverityName(record.mSeverity),
+                Log::getCategoryName(record.mCategory), record.mThreadID, static_cast<int>(record.mMessage.size()), record.mMessage.data());
+    }
+}
+
+
+namespace Log
+{
+
+std::atomic<uint8_t> gMinimumSeverity[static_cast<uint32_t>(Category::Count)] =
+{
+    {static_cast<uint8_t>(Severity::Info)},
+    {static_cast<uint8_t>(Severity::Info)},
+    {static_cast<uint8_t>(Severity::Info)},
+    {static_cast<uint8_t>(Severity::Info)},
+    {static_cast<uint8_t>(Severity::Info)},
+    {static_cast<uint8_t>(Severity::Info)}
+};
+static_assert(static_cast<uint32_t>(Category::Count) == 6, "Need a default severity for every category");
+
+
+const char* getSeverityName(const Severity severity)
+{
+    switch(severity)
+    {
+        case Severity::Trace:
+            return "Trace";
+        case Severity::Info:
+            return "Info";
+        case Severity::Warning:
+            return "Warning";
+        case Severity::Error:
+            return "Error";
+        case Severity::Fatal:
+            return "Fatal";
+        default:
+            return "Unknown";
+    }
+}
+
+
+const char* getCategoryName(const Category category)
+{
+    switch(category)
+    {
+        case Category::General:
+            return "General";
+        case Category::Device:
+            return "Device";
+        case Category::RenderGraph:
+            return "RenderGraph";
+        case Category::Engine:
+            return "Engine";
+        case Category::Assets:
+            return "Assets";
+        case Category::Shaders:
+            return "Shaders";
+        default:
+            return "Unknown";
+    }
+}
+
+
+void setMinimumSeverity(const Severity severity)
+{
+    for(std::atomic<uint8_t>& minimum : gMinimumSeverity)
+        minimum.store(static_cast<uint8_t>(severity), std::memory_order_relaxed);
+}
+
+
+void setMinimumSeverity(const Category category, const Severity severity)
+{
+    gMinimumSeverity[static_cast<uint32_t>(category)].store(static_cast<uint8_t>(severity), std::memory_order_relaxed);
+}
+
+
+void ConsoleSink::write(const Record& record)
+{
+    writeLine(record.mSeverity >= Severity::Error ? stderr : stdout, record);
+}
+
+
+void ConsoleSink::flush()
+{
+    fflush(stdout);
+}
+
+
+FileSink::FileSink(const char* path) :
+    mFile{fopen(path, "w")}
+{
+}
+
+
+FileSink::~FileSink()
+{
+    if(mFile)
+        fclose(mFile);
+}
+
+
+void FileSink::write(const Record& record)
+{
+    if(mFile)
+        writeLine(mFile, record);
+}
+
+
+void FileSink::flush()
+{
+    if(mFile)
+        fflush(mFile);
+}
+
+
+Sink* addSink(std::unique_ptr<Sink> sink)
+{
+    std::lock_guard<std::mutex> lock{gSinksLock};
+    std::vector<std::unique_ptr<Sink>>& sinks = getSinks();
+    sinks.push_back(std::move(sink));
+    return sinks.back().get();
+}
+
+
+void removeSink(const Sink* sink)
+{
+    std::lock_guard<std::mutex> lock{gSinksLock};
+    std::vector<std::unique_ptr<Sink>>& sinks = getSinks();
+    sinks.erase(std::remove_if(sinks.begin(), sinks.end(), [sink](const std::unique_ptr<Sink>& entry) { return entry.get() == sink; }), sinks.end());
+}
+
+
+void clearSinks()
+{
+    std::lock_guard<std::mutex> lock{gSinksLock};
+    getSinks().clear();
+}
+
+
+void flush()
+{
+    drain();
+}
+
+
+void ArgumentPacker::addString(const char* str)
+{
+    if(!str)
+        str = "(null)";
+
+    if(mSize + 1 + sizeof(uint32_t) > kMaxArgumentSize)
+        return;
+
+    const uint32_t length = static_cast<uint32_t>(std::min<size_t>(strlen(str), kMaxArgumentSize - mSize - 1 - sizeof(uint32_t)));
+    mData[mSize++] = static_cast<unsigned char>(Tag::String);
+    std::memcpy(mData + mSize, &length, sizeof(uint32_t));
+    mSize += sizeof(uint32_t);
+    std::memcpy(mData + mSize, str, length);
+    mSize += length;
+}
+
+
+void ArgumentPacker::addWideString(const wchar_t* str)
+{
+    // Only used for device names, so anything outside ASCII is replaced.
+    std::string narrow{};
+    for(; str && *str; ++str)
+        narrow.push_back(*str < 0x80 ? static_cast<char>(*str) : '?');
+
+    addString(narrow.c_str());
+}
+
+
+void submit(const Severity severity, const Category category, const char* file, const uint32_t line, const char* format, const ArgumentPacker& arguments)
+{
+    ThreadBuffer& buffer = getThreadBuffer();
+
+    const uint32_t size = ((sizeof(RecordHeader) + arguments.getSize() + kRecordAllignment - 1) / kRecordAllignment) * kRecordAllignment;
+
+    const uint64_t previousWritten = buffer.mWritten.load(std::memory_order_relaxed);
+    const uint64_t read = buffer.mRead.load(std::memory_order_acquire);
+    uint64_t written = previousWritten;
+
+    // Records are contiguous, so skip to the start of the buffer if there isn't room before the end.
+    const uint64_t offset = written % kBufferSize;
+    const uint64_t remaining = kBufferSize - offset;
+    const uint64_t required = remaining < size ? remaining + size : size;
+    if((written + required - read) > kBufferSize)
+    {
+        buffer.mDropped.fetch_add(1, std::memory_order_relaxed);
+        getWriter().wake();
+        return;
+    }
+
+    if(remaining < size)
+    {
+        if(remaining >= sizeof(RecordHeader))
+        {
+            const RecordHeader padding{static_cast<uint32_t>(remaining), 0, 0, nullptr, nullptr, 0, severity, category};
+            std::memcpy(buffer.mData.get() + offset, &padding, sizeof(RecordHeader));
+        }
+        written += remaining;
+    }
+
+    const RecordHeader header{size, arguments.getSize(), getTimeNs(), format, file, line, severity, category};
+    unsigned char* record = buffer.mData.get() + (written % kBufferSize);
+    std::memcpy(record, &header, sizeof(RecordHeader));
+    std::memcpy(record + sizeof(RecordHeader), arguments.getData(), arguments.getSize());
+
+    buffer.mWritten.store(written + size, std::memory_order_release);
+
+    // Wake the writer early once the buffer is half full, rather than waiting and dropping messages.
+    const bool filledHalf = (previousWritten - read) <= (kBufferSize / 2) && (written + size - read) > (kBufferSize / 2);
+    if(severity == Severity::Fatal)
+        flush();
+    else if(severity >= Severity::Error || filledHalf)
+        getWriter().wake();
+}
+
+}
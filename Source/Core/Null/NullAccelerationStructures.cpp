@@ -0,0 +1,36 @@
+#include "NullAccelerationStructures.hpp"
+
+
+NullBottomLevelAccelerationStructure::NullBottomLevelAccelerationStructure(RenderEngine* eng, const StaticMesh& mesh, const std::string& name) :
+    BottomLevelAccelerationStructureBase(eng, mesh, name)
+{
+}
+
+
+NullTopLevelAccelerationStructure::NullTopLevelAccelerationStructure(RenderEngine* eng) :
+    TopLevelAccelerationStructureBase(eng),
+    mInstances{}
+{
+}
+
+
+void NullTopLevelAccelerationStructure::reset()
+{
+    mInstances.clear();
+}
+
+
+void NullTopLevelAccelerationStructure::addInstance(const MeshInstance* instance)
+{
+    mInstances.push_back(instance);
+}
+
+
+void NullTopLevelAccelerationStructure::buildStructureOnCPU(RenderEngine*)
+{
+}
+
+
+void NullTopLevelAccelerationStructure::buildStructureOnGPU(Executor*)
+{
+}
@@ -0,0 +1,43 @@
+#ifndef NULL_ACCELERATION_STRUCTURES_HPP
+#define NULL_ACCELERATION_STRUCTURES_HPP
+
+#include "Core/AccelerationStructures.hpp"
+
+#include <vector>
+
+class MeshInstance;
+
+
+class NullBottomLevelAccelerationStructure : public BottomLevelAccelerationStructureBase
+{
+public:
+    NullBottomLevelAccelerationStructure(RenderEngine*, const StaticMesh&, const std::string&);
+    ~NullBottomLevelAccelerationStructure() = default;
+};
+
+
+// Only keeps the instances added, nothing is built.
+class NullTopLevelAccelerationStructure : public TopLevelAccelerationStructureBase
+{
+public:
+    NullTopLevelAccelerationStructure(RenderEngine*);
+    ~NullTopLevelAccelerationStructure() = default;
+
+    virtual void reset() override final;
+
+    virtual void addInstance(const MeshInstance*) override final;
+
+    virtual void buildStructureOnCPU(RenderEngine*) override final;
+    virtual void buildStructureOnGPU(Executor*) override final;
+
+    const std::vector<const MeshInstance*>& getInstances() const
+    {
+        return mInstances;
+    }
+
+private:
+
+    std::vector<const MeshInstance*> mInstances;
+};
+
+#endif
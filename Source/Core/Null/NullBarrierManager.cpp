@@ -0,0 +1,101 @@
+#include "NullBarrierManager.hpp"
+#include "Core/Image.hpp"
+#include "Core/ImageView.hpp"
+#include "Core/Buffer.hpp"
+#include "Core/BufferView.hpp"
+
+
+NullBarrierRecorder::NullBarrierRecorder(RenderDevice* device) :
+	BarrierRecorderBase(device),
+    mBarriers{},
+    mHasSemaphoreOps{false}
+{}
+
+
+void NullBarrierRecorder::addBarrier(const NullBarrierType type, const Hazard hazard, const SyncPoint src, const SyncPoint dst, const uint64_t resource,
+                                     const ImageLayout layout, const QueueType queue)
+{
+    updateSyncPoints(src, dst);
+
+    mBarriers.push_back({type, hazard, src, dst, layout, queue, resource});
+}
+
+
+void NullBarrierRecorder::transferResourceToQueue(Image& image, const QueueType queueType, const Hazard hazard, const SyncPoint src, const SyncPoint dst)
+{
+    addBarrier(NullBarrierType::ImageQueueTransfer, hazard, src, dst, reinterpret_cast<uint64_t>(image.getBase()), ImageLayout::Undefined, queueType);
+}
+
+
+void NullBarrierRecorder::transferResourceToQueue(Buffer& buffer, const QueueType queueType, const Hazard hazard, const SyncPoint src, const SyncPoint dst)
+{
+    addBarrier(NullBarrierType::BufferQueueTransfer, hazard, src, dst, reinterpret_cast<uint64_t>(buffer.getBase()), ImageLayout::Undefined, queueType);
+}
+
+
+void NullBarrierRecorder::memoryBarrier(Image& img, const Hazard hazard, const SyncPoint src, const SyncPoint dst)
+{
+    addBarrier(NullBarrierType::Image, hazard, src, dst, reinterpret_cast<uint64_t>(img.getBase()));
+}
+
+
+void NullBarrierRecorder::memoryBarrier(ImageView& img, const Hazard hazard, const SyncPoint src, const SyncPoint dst)
+{
+    addBarrier(NullBarrierType::ImageView, hazard, src, dst, reinterpret_cast<uint64_t>(img.getBase()));
+}
+
+
+void NullBarrierRecorder::memoryBarrier(Buffer& buf, const Hazard hazard, const SyncPoint src, const SyncPoint dst)
+{
+    addBarrier(NullBarrierType::Buffer, hazard, src, dst, reinterpret_cast<uint64_t>(buf.getBase()));
+}
+
+
+void NullBarrierRecorder::memoryBarrier(BufferView& buf, const Hazard hazard, const SyncPoint src, const SyncPoint dst)
+{
+    addBarrier(NullBarrierType::BufferView, hazard, src, dst, reinterpret_cast<uint64_t>(buf.getBase()));
+}
+
+
+void NullBarrierRecorder::memoryBarrier(const Hazard hazard, const SyncPoint src, const SyncPoint dst)
+{
+    addBarrier(NullBarrierType::Memory, hazard, src, dst, 0);
+}
+
+
+void NullBarrierRecorder::transitionLayout(Image& img, const ImageLayout newLayout, const Hazard hazard, const SyncPoint src, const SyncPoint dst)
+{
+    // Layouts are tracked when the barrier is recorded, the same as the other backends.
+    for(SubResourceInfo& info : *img->mSubResourceInfo)
+        info.mLayout = newLayout;
+
+    addBarrier(NullBarrierType::ImageTransition, hazard, src, dst, reinterpret_cast<uint64_t>(img.getBase()), newLayout);
+}
+
+
+void NullBarrierRecorder::transitionLayout(ImageView& img, const ImageLayout newLayout, const Hazard hazard, const SyncPoint src, const SyncPoint dst)
+{
+    for (uint32_t i = img->getBaseLevel(); i < img->getBaseLevel() + img->getLevelCount(); ++i)
+    {
+        for (uint32_t j = img->getBaseMip(); j < img->getBaseMip() + img->getMipsCount(); ++j)
+        {
+            img->mSubResourceInfo[(i * img->mTotalMips) + j].mLayout = newLayout;
+        }
+    }
+
+    addBarrier(NullBarrierType::ImageViewTransition, hazard, src, dst, reinterpret_cast<uint64_t>(img.getBase()), newLayout);
+}
+
+
+void NullBarrierRecorder::signalAsyncQueueSemaphore(const uint64_t val)
+{
+    mHasSemaphoreOps = true;
+    mBarriers.push_back({NullBarrierType::SignalSemaphore, Hazard::ReadAfterWrite, SyncPoint::BottomOfPipe, SyncPoint::BottomOfPipe, ImageLayout::Undefined, QueueType::Graphics, val});
+}
+
+
+void NullBarrierRecorder::waitOnAsyncQueueSemaphore(const uint64_t val)
+{
+    mHasSemaphoreOps = true;
+    mBarriers.push_back({NullBarrierType::WaitSemaphore, Hazard::ReadAfterWrite, SyncPoint::TopOfPipe, SyncPoint::TopOfPipe, ImageLayout::Undefined, QueueType::Graphics, val});
+}
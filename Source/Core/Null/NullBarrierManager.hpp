@@ -0,0 +1,47 @@
+#ifndef NULL_BARRIER_MANAGER_HPP
+#define NULL_BARRIER_MANAGER_HPP
+
+#include "Core/BarrierManager.hpp"
+#include "NullCommandStream.hpp"
+
+
+class NullBarrierRecorder : public BarrierRecorderBase
+{
+public:
+	NullBarrierRecorder(RenderDevice* device);
+
+	virtual void transferResourceToQueue(Image&, const QueueType, const Hazard, const SyncPoint src, const SyncPoint dst) override;
+	virtual void transferResourceToQueue(Buffer&, const QueueType, const Hazard, const SyncPoint src, const SyncPoint dst) override;
+
+    virtual void memoryBarrier(Image& img, const Hazard, const SyncPoint src, const SyncPoint dst) override;
+    virtual void memoryBarrier(ImageView& img, const Hazard, const SyncPoint src, const SyncPoint dst) override;
+    virtual void memoryBarrier(Buffer& img, const Hazard, const SyncPoint src, const SyncPoint dst) override;
+    virtual void memoryBarrier(BufferView& img, const Hazard, const SyncPoint src, const SyncPoint dst) override;
+    virtual void memoryBarrier(const Hazard, const SyncPoint src, const SyncPoint dst) override;
+
+    virtual void transitionLayout(Image& img, const ImageLayout, const Hazard, const SyncPoint src, const SyncPoint dst) override;
+    virtual void transitionLayout(ImageView& img, const ImageLayout, const Hazard, const SyncPoint src, const SyncPoint dst) override;
+
+    virtual void signalAsyncQueueSemaphore(const uint64_t val) override;
+    virtual void waitOnAsyncQueueSemaphore(const uint64_t val) override;
+
+    const std::vector<NullBarrier>& getBarriers() const
+    {
+        return mBarriers;
+    }
+
+    bool hasSemaphoreOps() const
+    {
+        return mHasSemaphoreOps;
+    }
+
+private:
+
+    void addBarrier(const NullBarrierType, const Hazard, const SyncPoint src, const SyncPoint dst, const uint64_t resource,
+                    const ImageLayout layout = ImageLayout::Undefined, const QueueType queue = QueueType::Graphics);
+
+    std::vector<NullBarrier> mBarriers;
+    bool mHasSemaphoreOps;
+};
+
+#endif
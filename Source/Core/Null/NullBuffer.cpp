@@ -0,0 +1,76 @@
+#include "NullBuffer.hpp"
+#include "Core/BellLogging.hpp"
+
+#include <cstring>
+
+
+NullBuffer::NullBuffer(RenderDevice* dev,
+               BufferUsage usage,
+               const uint32_t size,
+               const uint32_t stride,
+               const std::string& name) :
+    BufferBase(dev, usage, size, stride, name),
+    mContents(size, 0)
+{
+}
+
+
+void NullBuffer::swap(BufferBase& other)
+{
+    BufferBase::swap(other);
+
+    NullBuffer& nullOther = static_cast<NullBuffer&>(other);
+    mContents.swap(nullOther.mContents);
+}
+
+
+bool NullBuffer::resize(const uint32_t newSize, const bool)
+{
+    if(newSize <= mSize)
+        return false;
+
+    // Growing a vector always keeps its contents, which is a superset of what's asked for.
+    mContents.resize(newSize, 0);
+    mSize = newSize;
+
+    return true;
+}
+
+
+uint64_t NullBuffer::getDeviceAddress() const
+{
+    return reinterpret_cast<uint64_t>(mContents.data());
+}
+
+
+void NullBuffer::setContents(const void* data, const uint32_t size, const uint32_t offset)
+{
+    BELL_ASSERT(offset + size <= mSize, "Writing outside of buffer")
+
+    memcpy(mContents.data() + offset, data, size);
+
+    updateLastAccessed();
+}
+
+
+void NullBuffer::setContents(const int data, const uint32_t size, const uint32_t offset)
+{
+    BELL_ASSERT(offset + size <= mSize, "Writing outside of buffer")
+
+    memset(mContents.data() + offset, data, size);
+
+    updateLastAccessed();
+}
+
+
+void* NullBuffer::map(MapInfo& mapInfo)
+{
+    BELL_ASSERT(mapInfo.mOffset + mapInfo.mSize <= mSize, "Mapping outside of buffer")
+
+    return mContents.data() + mapInfo.mOffset;
+}
+
+
+void NullBuffer::unmap()
+{
+}
@@ -0,0 +1,49 @@
+#ifndef NULL_BUFFER_HPP
+#define NULL_BUFFER_HPP
+
+#include "Core/Buffer.hpp"
+
+#include <vector>
+
+
+// Backed by host memory, so contents written by the CPU can be read back.
+class NullBuffer : public BufferBase
+{
+public:
+    NullBuffer(RenderDevice* dev,
+           BufferUsage usage,
+           const uint32_t size,
+           const uint32_t stride,
+           const std::string& = "");
+
+    ~NullBuffer() = default;
+
+    virtual void swap(BufferBase&) override final;
+
+    virtual bool resize(const uint32_t newSize, const bool preserContents) override final;
+
+    virtual uint64_t getDeviceAddress() const override final;
+
+    virtual void setContents(const void* data,
+                     const uint32_t size,
+                     const uint32_t offset = 0) override final;
+
+    // Repeat the data in the range (start + offset, start + offset + size]
+    virtual void setContents(const int data,
+                     const uint32_t size,
+                     const uint32_t offset = 0) override final;
+
+    virtual void*   map(MapInfo &mapInfo) override final;
+    virtual void    unmap() override final;
+
+    const unsigned char* getContents() const
+    {
+        return mContents.data();
+    }
+
+private:
+
+    std::vector<unsigned char> mContents;
+};
+
+#endif
@@ -0,0 +1,8 @@
+#include "NullBufferView.hpp"
+
+
+NullBufferView::NullBufferView(Buffer& parentBuffer, const uint64_t offset, const uint64_t size) :
+	BufferViewBase(parentBuffer, offset, size),
+	mBuffer{parentBuffer.getBase()}
+{
+}
@@ -0,0 +1,25 @@
+#ifndef NULL_BUFFER_VIEW_HPP
+#define NULL_BUFFER_VIEW_HPP
+
+#include "Core/BufferView.hpp"
+#include "Core/Buffer.hpp"
+
+
+class NullBufferView : public BufferViewBase
+{
+public:
+
+	NullBufferView(Buffer&, const uint64_t offset = 0, const uint64_t size = ~0ull);
+	~NullBufferView() = default;
+
+	const BufferBase* getBuffer() const
+	{
+		return mBuffer;
+	}
+
+private:
+
+	const BufferBase* mBuffer;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#include "NullCommandContext.hpp"
+#include "NullExecutor.hpp"
+
+
+NullCommandContext::NullCommandContext(RenderDevice* dev, const QueueType queue) :
+    CommandContextBase(dev, queue),
+    mStream{},
+    mTimeStamps{}
+{
+}
+
+
+void NullCommandContext::setupState(const RenderGraph& graph, uint32_t taskIndex, Executor* exec, const uint64_t prefixHash)
+{
+    const RenderTask& task = graph.getTask(taskIndex);
+
+    static_cast<NullExecutor*>(exec)->beginTask(taskIndex, static_cast<uint32_t>(task.taskType()), prefixHash);
+}
+
+
+Executor* NullCommandContext::allocateExecutor(const bool)
+{
+    if(!mFreeExecutors.empty())
+    {
+        Executor* exec = mFreeExecutors.back();
+        mFreeExecutors.pop_back();
+
+        return exec;
+    }
+
+    return new NullExecutor(getDevice(), &mStream);
+}
+
+
+void NullCommandContext::freeExecutor(Executor* exec)
+{
+    NullExecutor* nullExec = static_cast<NullExecutor*>(exec);
+    nullExec->endTask();
+
+    mShouldSubmit = mShouldSubmit || exec->getSubmitFlag() || nullExec->getAndClearSemaphoreOps();
+    exec->clearSubmitFlag();
+
+    mFreeExecutors.push_back(exec);
+}
+
+
+const std::vector<uint64_t>& NullCommandContext::getTimestamps()
+{
+    return mTimeStamps;
+}
+
+
+void NullCommandContext::reset()
+{
+    mStream.clear();
+    mShouldSubmit = false;
+}
@@ -0,0 +1,39 @@
+#ifndef NULL_COMMAND_CONTEXT_HPP
+#define NULL_COMMAND_CONTEXT_HPP
+
+#include "Core/CommandContext.hpp"
+#include "NullCommandStream.hpp"
+
+
+// All executors allocated from a context record in to the same stream, in the order they are freed.
+class NullCommandContext : public CommandContextBase
+{
+public:
+
+    NullCommandContext(RenderDevice* dev, const QueueType);
+    ~NullCommandContext() = default;
+
+    virtual void      setupState(const RenderGraph&, uint32_t taskIndex, Executor*, const uint64_t prefixHash) override final;
+
+    virtual Executor* allocateExecutor(const bool timeStamp = false) override final;
+    virtual void      freeExecutor(Executor*) override final;
+
+    virtual const std::vector<uint64_t>& getTimestamps() override final;
+    virtual void      reset() override final;
+
+    const NullCommandStream& getStream() const
+    {
+        return mStream;
+    }
+
+    NullCommandStream& getStream()
+    {
+        return mStream;
+    }
+
+private:
+    NullCommandStream mStream;
+    std::vector<uint64_t> mTimeStamps;
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef NULL_COMMAND_STREAM_HPP
+#define NULL_COMMAND_STREAM_HPP
+
+#include "Core/BarrierManager.hpp"
+#include "Core/GPUResource.hpp"
+
+#include <cstdint>
+#include <vector>
+
+
+enum class NullCommandType : uint8_t
+{
+    BeginTask,
+    EndTask,
+    Draw,
+    InstancedDraw,
+    IndexedDraw,
+    IndexedInstancedDraw,
+    IndirectDraw,
+    IndexedIndirectDraw,
+    IndexedIndirectDrawCount,
+    PushConstant,
+    Dispatch,
+    DispatchIndirect,
+    BindVertexBuffer,
+    BindIndexBuffer,
+    Barriers,
+    StartPredication,
+    EndPredication,
+    SetGraphicsShaders,
+    SetComputeShader,
+    SetGraphicsPipeline,
+    SetComputePipeline,
+    CopyDataToBuffer,
+    BlitImage
+};
+
+// mArgs holds the commands parameters in the order the Executor takes them.
+// mResource is the pipeline handle, or the address of the resource base a command reads, if it has either.
+struct NullCommand
+{
+    NullCommandType mType;
+    uint32_t mArgs[4];
+    uint64_t mResource;
+};
+
+enum class NullBarrierType : uint8_t
+{
+    Memory,
+    Image,
+    ImageView,
+    Buffer,
+    BufferView,
+    ImageTransition,
+    ImageViewTransition,
+    ImageQueueTransfer,
+    BufferQueueTransfer,
+    SignalSemaphore,
+    WaitSemaphore
+};
+
+struct NullBarrier
+{
+    NullBarrierType mType;
+    Hazard mHazard;
+    SyncPoint mSource;
+    SyncPoint mDestination;
+    ImageLayout mLayout; // New layout of transitions.
+    QueueType mQueue; // Destination of queue transfers.
+    uint64_t mResource; // Address of the resource base, or the semaphore value.
+};
+
+// Everything recorded in to a command context. A Barriers command covers mArgs[1] barriers starting at
+// mArgs[0], and a PushConstant command mArgs[1] bytes of mPushConstants starting at mArgs[0].
+struct NullCommandStream
+{
+    std::vector<NullCommand> mCommands;
+    std::vector<NullBarrier> mBarriers;
+    std::vector<unsigned char> mPushConstants;
+
+    void clear()
+    {
+        mCommands.clear();
+        mBarriers.clear();
+        mPushConstants.clear();
+    }
+};
+
+#endif
@@ -0,0 +1,215 @@
+#include "NullExecutor.hpp"
+#include "NullBarrierManager.hpp"
+#include "NullBuffer.hpp"
+#include "Core/BufferView.hpp"
+#include "Core/ImageView.hpp"
+#include "Core/Shader.hpp"
+#include "Core/HashUtils.hpp"
+#include "RenderGraph/GraphicsTask.hpp"
+#include "RenderGraph/ComputeTask.hpp"
+
+#include <algorithm>
+
+
+NullExecutor::NullExecutor(RenderDevice* dev, NullCommandStream* stream) :
+    Executor(dev),
+    mStream{stream},
+    mSemaphoreOps{false}
+{
+    mRecordedCommands = 0;
+}
+
+
+void NullExecutor::record(const NullCommandType type, const uint64_t resource, const uint32_t arg0, const uint32_t arg1, const uint32_t arg2, const uint32_t arg3)
+{
+    mStream->mCommands.push_back({type, {arg0, arg1, arg2, arg3}, resource});
+}
+
+
+void NullExecutor::draw(const uint32_t vertexOffset, const uint32_t vertexCount)
+{
+    record(NullCommandType::Draw, 0, vertexOffset, vertexCount);
+    ++mRecordedCommands;
+}
+
+
+void NullExecutor::instancedDraw(const uint32_t vertexOffset, const uint32_t vertexCount, const uint32_t instanceCount)
+{
+    record(NullCommandType::InstancedDraw, 0, vertexOffset, vertexCount, instanceCount);
+    ++mRecordedCommands;
+}
+
+
+void NullExecutor::indexedDraw(const uint32_t vertexOffset, const uint32_t indexOffset, const uint32_t numberOfIndicies)
+{
+    record(NullCommandType::IndexedDraw, 0, vertexOffset, indexOffset, numberOfIndicies);
+    ++mRecordedCommands;
+}
+
+
+void NullExecutor::indexedInstancedDraw(const uint32_t vertexOffset, const uint32_t indexOffset, const uint32_t numberOfInstances, const uint32_t numberOfIndicies)
+{
+    record(NullCommandType::IndexedInstancedDraw, 0, vertexOffset, indexOffset, numberOfInstances, numberOfIndicies);
+    ++mRecordedCommands;
+}
+
+
+void NullExecutor::indirectDraw(const uint32_t drawCalls, const BufferView& view)
+{
+    record(NullCommandType::IndirectDraw, reinterpret_cast<uint64_t>(view.getBase()), drawCalls);
+    ++mRecordedCommands;
+}
+
+
+void NullExecutor::indexedIndirectDraw(const uint32_t drawCalls, const BufferView& view)
+{
+    record(NullCommandType::IndexedIndirectDraw, reinterpret_cast<uint64_t>(view.getBase()), drawCalls);
+    ++mRecordedCommands;
+}
+
+
+void NullExecutor::indexedIndirectDrawCount(const uint32_t maxDrawCalls, const BufferView& drawCommands, const uint32_t firstDrawCall,
+                                            const BufferView&, const uint32_t countIndex)
+{
+    record(NullCommandType::IndexedIndirectDrawCount, reinterpret_cast<uint64_t>(drawCommands.getBase()), maxDrawCalls, firstDrawCall, countIndex);
+    ++mRecordedCommands;
+}
+
+
+void NullExecutor::insertPushConstant(const void* val, const size_t size)
+{
+    const size_t offset = mStream->mPushConstants.size();
+    const unsigned char* data = static_cast<const unsigned char*>(val);
+    mStream->mPushConstants.insert(mStream->mPushConstants.end(), data, data + size);
+
+    record(NullCommandType::PushConstant, 0, static_cast<uint32_t>(offset), static_cast<uint32_t>(size));
+}
+
+
+void NullExecutor::dispatch(const uint32_t x, const uint32_t y, const uint32_t z)
+{
+    record(NullCommandType::Dispatch, 0, x, y, z);
+    ++mRecordedCommands;
+}
+
+
+void NullExecutor::dispatchIndirect(const BufferView& view)
+{
+    record(NullCommandType::DispatchIndirect, reinterpret_cast<uint64_t>(view.getBase()));
+    ++mRecordedCommands;
+}
+
+
+void NullExecutor::bindVertexBuffer(const BufferView& view, const size_t offset)
+{
+    record(NullCommandType::BindVertexBuffer, reinterpret_cast<uint64_t>(view.getBase()), static_cast<uint32_t>(offset), 0);
+}
+
+
+void NullExecutor::bindVertexBuffer(const BufferView* views, const size_t* offsets, const uint32_t count)
+{
+    for(uint32_t i = 0; i < count; ++i)
+        record(NullCommandType::BindVertexBuffer, reinterpret_cast<uint64_t>(views[i].getBase()), static_cast<uint32_t>(offsets[i]), i);
+}
+
+
+void NullExecutor::bindIndexBuffer(const BufferView& view, const size_t offset)
+{
+    record(NullCommandType::BindIndexBuffer, reinterpret_cast<uint64_t>(view.getBase()), static_cast<uint32_t>(offset));
+}
+
+
+void NullExecutor::recordBarriers(BarrierRecorder& recorder)
+{
+    const NullBarrierRecorder* nullRecorder = static_cast<const NullBarrierRecorder*>(recorder.getBase());
+    const std::vector<NullBarrier>& barriers = nullRecorder->getBarriers();
+    if(barriers.empty())
+        return;
+
+    mSemaphoreOps = mSemaphoreOps || nullRecorder->hasSemaphoreOps();
+
+    const uint32_t firstBarrier = static_cast<uint32_t>(mStream->mBarriers.size());
+    mStream->mBarriers.insert(mStream->mBarriers.end(), barriers.begin(), barriers.end());
+
+    record(NullCommandType::Barriers, 0, firstBarrier, static_cast<uint32_t>(barriers.size()));
+}
+
+
+void NullExecutor::startCommandPredication(const BufferView& buf, const uint32_t index)
+{
+    record(NullCommandType::StartPredication, reinterpret_cast<uint64_t>(buf.getBase()), index);
+}
+
+
+void NullExecutor::endCommandPredication()
+{
+    record(NullCommandType::EndPredication);
+}
+
+
+void NullExecutor::copyDataToBuffer(const void* data, const size_t size, const size_t offset, Buffer& buffer)
+{
+    // Nothing can be reading the buffer, so the copy happens straight away.
+    buffer->setContents(data, static_cast<uint32_t>(size), static_cast<uint32_t>(offset));
+
+    record(NullCommandType::CopyDataToBuffer, reinterpret_cast<uint64_t>(buffer.getBase()), static_cast<uint32_t>(size), static_cast<uint32_t>(offset));
+}
+
+
+void NullExecutor::blitImage(const ImageView& dst, const ImageView& src, const SamplerType type)
+{
+    record(NullCommandType::BlitImage, reinterpret_cast<uint64_t>(dst.getBase()), static_cast<uint32_t>(type));
+    record(NullCommandType::BlitImage, reinterpret_cast<uint64_t>(src.getBase()), static_cast<uint32_t>(type));
+}
+
+
+void NullExecutor::setGraphicsShaders(const GraphicsTask& task,
+                                      const RenderGraph&,
+                                      const Shader& vertexShader,
+                                      const Shader*,
+                                      const Shader*,
+                                      const Shader*,
+                                      const Shader& fragmentShader)
+{
+    BELL_ASSERT(vertexShader->getCompiledDefinesHash() == fragmentShader->getCompiledDefinesHash(), "Shaders compiled with different prefix hashes")
+
+    uint64_t pipelineKey = 0;
+    hash_combine(pipelineKey, task.getName(), vertexShader->getFilePath(), fragmentShader->getFilePath(), vertexShader->getCompiledDefinesHash());
+
+    record(NullCommandType::SetGraphicsShaders, pipelineKey);
+}
+
+
+void NullExecutor::setComputeShader(const ComputeTask& task,
+                                    const RenderGraph&,
+                                    const Shader& computeShader)
+{
+    uint64_t pipelineKey = 0;
+    hash_combine(pipelineKey, task.getName(), computeShader->getFilePath(), computeShader->getCompiledDefinesHash());
+
+    record(NullCommandType::SetComputeShader, pipelineKey);
+}
+
+
+void NullExecutor::setGraphicsPipeline(const uint64_t pipelineHandle)
+{
+    record(NullCommandType::SetGraphicsPipeline, pipelineHandle);
+}
+
+
+void NullExecutor::setComputePipeline(const uint64_t pipelineHandle)
+{
+    record(NullCommandType::SetComputePipeline, pipelineHandle);
+}
+
+
+void NullExecutor::beginTask(const uint32_t taskIndex, const uint32_t taskType, const uint64_t prefixHash)
+{
+    record(NullCommandType::BeginTask, prefixHash, taskIndex, taskType);
+}
+
+
+void NullExecutor::endTask()
+{
+    record(NullCommandType::EndTask);
+}
@@ -0,0 +1,90 @@
+#ifndef NULL_EXECUTOR_HPP
+#define NULL_EXECUTOR_HPP
+
+#include "Core/Executor.hpp"
+#include "NullCommandStream.hpp"
+
+
+class NullExecutor : public Executor
+{
+public:
+    NullExecutor(RenderDevice* dev, NullCommandStream* stream);
+
+	virtual void draw(const uint32_t vertexOffset, const uint32_t vertexCount) override;
+
+	virtual void instancedDraw(const uint32_t vertexOffset, const uint32_t vertexCount, const uint32_t instanceCount) override;
+
+	virtual void indexedDraw(const uint32_t vertexOffset, const uint32_t indexOffset, const uint32_t numberOfIndicies) override;
+
+	virtual void indexedInstancedDraw(const uint32_t vertexOffset, const uint32_t indexOffset, const uint32_t numberOfInstances, const uint32_t numberOfIndicies) override;
+
+    virtual void indirectDraw(const uint32_t drawCalls, const BufferView&) override;
+
+	virtual void indexedIndirectDraw(const uint32_t drawCalls, const BufferView&) override;
+
+    virtual void indexedIndirectDrawCount(const uint32_t maxDrawCalls, const BufferView& drawCommands, const uint32_t firstDrawCall,
+                                          const BufferView& count, const uint32_t countIndex) override;
+
+    virtual void insertPushConstant(const void* val, const size_t size) override;
+
+	virtual void dispatch(const uint32_t x, const uint32_t y, const uint32_t z) override;
+
+	virtual void dispatchIndirect(const BufferView&) override;
+
+    virtual void bindVertexBuffer(const BufferView&, const size_t offset) override;
+
+    virtual void bindVertexBuffer(const BufferView*, const size_t* offsets, const uint32_t) override;
+
+    virtual void bindIndexBuffer(const BufferView&, const size_t offset) override;
+
+    virtual void recordBarriers(BarrierRecorder&) override;
+
+    virtual void startCommandPredication(const BufferView &buf, const uint32_t index) override;
+
+    virtual void endCommandPredication() override;
+
+    virtual void copyDataToBuffer(const void*, const size_t size, const size_t offset, Buffer&) override;
+
+    virtual void blitImage(const ImageView& dst, const ImageView& src, const SamplerType) override;
+
+    virtual void setGraphicsShaders(const GraphicsTask &task,
+                                    const RenderGraph& graph,
+                                    const Shader& vertexShader,
+                                    const Shader* geometryShader,
+                                    const Shader* tessControl,
+                                    const Shader* tessEval,
+                                    const Shader& fragmentShader) override;
+
+    virtual void setComputeShader(const ComputeTask& task,
+                                  const RenderGraph& graph,
+                                  const Shader&) override;
+
+    virtual void setGraphicsPipeline(const uint64_t) override;
+
+    virtual void setComputePipeline(const uint64_t) override;
+
+    // Records the start and end of the task the executor is recording.
+    void beginTask(const uint32_t taskIndex, const uint32_t taskType, const uint64_t prefixHash);
+    void endTask();
+
+    bool getAndClearSemaphoreOps()
+    {
+        const bool semaphoreOps = mSemaphoreOps;
+        mSemaphoreOps = false;
+        return semaphoreOps;
+    }
+
+    void setStream(NullCommandStream* stream)
+    {
+        mStream = stream;
+    }
+
+private:
+
+    void record(const NullCommandType, const uint64_t resource = 0, const uint32_t arg0 = 0, const uint32_t arg1 = 0, const uint32_t arg2 = 0, const uint32_t arg3 = 0);
+
+    NullCommandStream* mStream;
+    bool mSemaphoreOps;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#include "NullImage.hpp"
+
+
+NullImage::NullImage(RenderDevice* dev,
+			 const Format format,
+			 const ImageUsage usage,
+             const uint32_t x,
+             const uint32_t y,
+             const uint32_t z,
+             const uint32_t mips,
+             const uint32_t levels,
+             const uint32_t samples,
+			 const std::string& debugName) :
+	ImageBase(dev, format, usage, x, y, z, mips, levels, samples, debugName)
+{
+}
+
+
+void NullImage::setContents(const void*,
+                        const uint32_t,
+                        const uint32_t,
+                        const uint32_t,
+                        const uint32_t level,
+                        const uint32_t lod,
+                        const int32_t,
+                        const int32_t,
+                        const int32_t)
+{
+	(*mSubResourceInfo)[(level * mNumberOfMips) + lod].mLayout = ImageLayout::Sampled;
+
+    updateLastAccessed();
+}
+
+
+void NullImage::clear(const float4&)
+{
+	for (auto& resource : *mSubResourceInfo)
+		resource.mLayout = ImageLayout::TransferDst;
+
+	updateLastAccessed();
+}
+
+
+void NullImage::generateMips()
+{
+    updateLastAccessed();
+}
+
+
+void NullImage::generateMips(Executor*)
+{
+    updateLastAccessed();
+}
@@ -0,0 +1,41 @@
+#ifndef NULL_IMAGE_HPP
+#define NULL_IMAGE_HPP
+
+#include "Core/Image.hpp"
+
+
+// Only tracks layouts, image contents are never stored.
+class NullImage : public ImageBase
+{
+public:
+
+	NullImage(RenderDevice* dev,
+		const Format format,
+		const ImageUsage usage,
+		const uint32_t x,
+		const uint32_t y,
+		const uint32_t z = 1,
+		const uint32_t mips = 1,
+		const uint32_t levels = 1,
+		const uint32_t samples = 1,
+		const std::string& debugName = "");
+
+	~NullImage() = default;
+
+	virtual void setContents(const void* data,
+		const uint32_t xsize,
+		const uint32_t ysize,
+		const uint32_t zsize,
+		const uint32_t level = 0,
+		const uint32_t lod = 0,
+		const int32_t offsetx = 0,
+		const int32_t offsety = 0,
+		const int32_t offsetz = 0) override;
+
+    virtual void clear(const float4&) override;
+
+    virtual void generateMips() override;
+    virtual void generateMips(Executor*) override;
+};
+
+#endif
@@ -0,0 +1,13 @@
+#include "NullImageView.hpp"
+
+
+NullImageView::NullImageView(Image& parentImage,
+					 const ImageViewType viewType,
+					 const uint32_t level,
+					 const uint32_t levelCount,
+					 const uint32_t lod,
+					 const uint32_t lodCount) :
+	ImageViewBase(parentImage, viewType, level, levelCount, lod, lodCount),
+	mImage{parentImage.getBase()}
+{
+}
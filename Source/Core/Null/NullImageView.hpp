@@ -0,0 +1,30 @@
+#ifndef NULL_IMAGE_VIEW_HPP
+#define NULL_IMAGE_VIEW_HPP
+
+#include "Core/Image.hpp"
+#include "Core/ImageView.hpp"
+
+
+class NullImageView : public ImageViewBase
+{
+public:
+
+	NullImageView(Image&,
+		const ImageViewType,
+		const uint32_t level = 0,
+		const uint32_t levelCount = 1,
+		const uint32_t lod = 0,
+		const uint32_t lodCount = 1);
+	~NullImageView() = default;
+
+	const ImageBase* getImage() const
+	{
+		return mImage;
+	}
+
+private:
+
+	const ImageBase* mImage;
+};
+
+#endif
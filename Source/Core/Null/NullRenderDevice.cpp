@@ -0,0 +1,117 @@
+#include "NullRenderDevice.hpp"
+#include "NullCommandContext.hpp"
+#include "NullSwapChain.hpp"
+#include "Core/Shader.hpp"
+#include "Core/HashUtils.hpp"
+#include "RenderGraph/GraphicsTask.hpp"
+#include "RenderGraph/ComputeTask.hpp"
+
+
+NullRenderDevice::NullRenderDevice(const uint32_t width, const uint32_t height, const uint32_t deviceFeatures) :
+	RenderDevice(deviceFeatures),
+    mGraphicsCommandContexts{},
+    mAsyncComputeCommandContexts{},
+    mSubmissions{},
+    mFinishedTimeStamps{}
+{
+    mSwapChain = new NullSwapChain(this, width, height);
+
+    // Match the Vulkan device so resources see the same submission indicies on either backend.
+    mCurrentSubmission = mSwapChain->getNumberOfSwapChainImages();
+
+    mGraphicsCommandContexts.resize(mSwapChain->getNumberOfSwapChainImages());
+    mAsyncComputeCommandContexts.resize(mSwapChain->getNumberOfSwapChainImages());
+    mSubmissions.resize(mSwapChain->getNumberOfSwapChainImages());
+}
+
+
+NullRenderDevice::~NullRenderDevice()
+{
+    mSwapChain->destroy();
+	delete mSwapChain;
+
+    for(auto& frameContexts : mGraphicsCommandContexts)
+    {
+        for(auto* context : frameContexts)
+            delete context;
+    }
+
+    for (auto& frameContexts : mAsyncComputeCommandContexts)
+    {
+        for (auto* context : frameContexts)
+            delete context;
+    }
+}
+
+
+CommandContextBase* NullRenderDevice::getCommandContext(const uint32_t index, const QueueType queue)
+{
+    std::vector<CommandContextBase*>& frameContexts = queue == QueueType::Compute ? mAsyncComputeCommandContexts[mCurrentFrameIndex] : mGraphicsCommandContexts[mCurrentFrameIndex];
+    while(frameContexts.size() <= index)
+    {
+        frameContexts.push_back(new NullCommandContext(this, queue));
+    }
+
+    return frameContexts[index];
+}
+
+
+PipelineHandle NullRenderDevice::compileGraphicsPipeline(const GraphicsTask& task,
+                                                         const RenderGraph&,
+                                                         const int vertexAttributes,
+                                                         const Shader& vertexShader,
+                                                         const Shader*,
+                                                         const Shader*,
+                                                         const Shader*,
+                                                         const Shader& fragmentShader)
+{
+    uint64_t pipelineKey = 0;
+    hash_combine(pipelineKey, task.getName(), vertexAttributes, vertexShader->getFilePath(), fragmentShader->getFilePath(),
+                 vertexShader->getCompiledDefinesHash(), fragmentShader->getCompiledDefinesHash());
+
+    // Zero is used as the invalid handle.
+    return pipelineKey == 0 ? 1 : pipelineKey;
+}
+
+
+PipelineHandle NullRenderDevice::compileComputePipeline(const ComputeTask& task,
+                                                        const RenderGraph&,
+                                                        const Shader& computeShader)
+{
+    uint64_t pipelineKey = 0;
+    hash_combine(pipelineKey, task.getName(), computeShader->getFilePath(), computeShader->getCompiledDefinesHash());
+
+    return pipelineKey == 0 ? 1 : pipelineKey;
+}
+
+
+void NullRenderDevice::startFrame()
+{
+	mCurrentFrameIndex = mSwapChain->getNextImageIndex();
+
+    for(CommandContextBase* context : mGraphicsCommandContexts[mCurrentFrameIndex])
+        context->reset();
+
+    for(CommandContextBase* context : mAsyncComputeCommandContexts[mCurrentFrameIndex])
+        context->reset();
+
+    mSubmissions[mCurrentFrameIndex].clear();
+
+    ++mCurrentSubmission;
+    ++mFinishedSubmission;
+}
+
+
+void NullRenderDevice::submitContext(CommandContextBase* context, const bool finalSubmission)
+{
+    NullCommandStream& stream = static_cast<NullCommandContext*>(context)->getStream();
+
+    mSubmissions[mCurrentFrameIndex].push_back({context->getQueueType(), finalSubmission, std::move(stream)});
+    stream.clear();
+}
+
+
+void NullRenderDevice::swap()
+{
+    mSwapChain->present(QueueType::Graphics);
+}
@@ -0,0 +1,110 @@
+#ifndef NULL_RENDERDEVICE_HPP
+#define NULL_RENDERDEVICE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Core/RenderDevice.hpp"
+#include "NullCommandStream.hpp"
+
+
+// A submitted command context, kept until the next frame using the same swapchain image starts.
+struct NullSubmission
+{
+    QueueType mQueue;
+    bool mFinalSubmission;
+    NullCommandStream mStream;
+};
+
+
+// Records everything in to in memory command streams without touching a GPU, for benchmarking the CPU side of
+// the renderer and inspecting what a frame would submit. Every optional feature is reported as supported so
+// that all paths are exercised.
+class NullRenderDevice : public RenderDevice
+{
+public:
+	NullRenderDevice(const uint32_t width, const uint32_t height, const uint32_t deviceFeatures);
+    ~NullRenderDevice();
+
+    virtual CommandContextBase*        getCommandContext(const uint32_t index, const QueueType) override;
+
+    virtual PipelineHandle             compileGraphicsPipeline(const GraphicsTask& task,
+                                                               const RenderGraph& graph,
+                                                               const int vertexAttributes,
+                                                               const Shader& vertexShader,
+                                                               const Shader* geometryShader,
+                                                               const Shader* tessControl,
+                                                               const Shader* tessEval,
+                                                               const Shader& fragmentShader) override;
+
+    virtual PipelineHandle             compileComputePipeline(const ComputeTask& task,
+                                                              const RenderGraph& graph,
+                                                              const Shader& computeShader) override;
+
+    virtual void                       startFrame() override;
+    virtual void                       endFrame() override {}
+
+    // Nothing is ever in flight, so resources can go straight away.
+    virtual void                       destroyImage(ImageBase&) override {}
+    virtual void                       destroyImageView(ImageViewBase&) override {}
+    virtual void                       destroyBuffer(BufferBase&) override {}
+    virtual void                       destroyShaderResourceSet(const ShaderResourceSetBase&) override {}
+    virtual void                       destroyBottomLevelAccelerationStructure(BottomLevelAccelerationStructureBase&) override {}
+    virtual void                       destroyTopLevelAccelerationStructure(TopLevelAccelerationStructureBase&) override {}
+
+    virtual void                       setDebugName(const std::string&, const uint64_t, const uint64_t) override {}
+
+    virtual void                       flushWait() const override {}
+    virtual void                       invalidatePipelines() override {}
+
+    virtual void                       submitContext(CommandContextBase*, const bool finalSubmission = false) override;
+    virtual void                       swap() override;
+
+    virtual size_t                     getMinStorageBufferAlignment() const override
+    {
+        return 256;
+    }
+
+    virtual bool                       getHasCommandPredicationSupport() const override
+    {
+        return true;
+    }
+
+    virtual bool                       getHasIndirectDrawCountSupport() const override
+    {
+        return true;
+    }
+
+    virtual bool                       getHasAsyncComputeSupport() const override
+    {
+        return true;
+    }
+
+    virtual const std::vector<TaskTimestamp>& getAvailableTimestamps() const override
+    {
+        return mFinishedTimeStamps;
+    }
+
+    virtual float                      getTimeStampPeriod() const override
+    {
+        return 1.0f;
+    }
+
+    // Everything submitted for the current frame, in submission order.
+    const std::vector<NullSubmission>& getSubmissions() const
+    {
+        return mSubmissions[mCurrentFrameIndex];
+    }
+
+private:
+
+    std::vector<std::vector<CommandContextBase*>> mGraphicsCommandContexts;
+    std::vector<std::vector<CommandContextBase*>> mAsyncComputeCommandContexts;
+
+    std::vector<std::vector<NullSubmission>> mSubmissions;
+
+    std::vector<TaskTimestamp> mFinishedTimeStamps;
+};
+
+#endif
@@ -0,0 +1,16 @@
+#include "NullRenderInstance.hpp"
+#include "NullRenderDevice.hpp"
+
+
+NullRenderInstance::NullRenderInstance(GLFWwindow* window, const uint32_t width, const uint32_t height) :
+    RenderInstance(window),
+    mWidth{width},
+    mHeight{height}
+{
+}
+
+
+RenderDevice* NullRenderInstance::createRenderDevice(int DeviceFeatureFlags, const bool)
+{
+    return new NullRenderDevice(mWidth, mHeight, static_cast<uint32_t>(DeviceFeatureFlags));
+}
@@ -0,0 +1,24 @@
+#ifndef NULL_INSTANCE_HPP
+#define NULL_INSTANCE_HPP
+
+#include "Core/RenderDevice.hpp"
+#include "Core/RenderInstance.hpp"
+
+
+// The window is optional, without one the swapchain is sized from width and height.
+class NullRenderInstance : public RenderInstance
+{
+public:
+    NullRenderInstance(GLFWwindow*, const uint32_t width, const uint32_t height);
+    ~NullRenderInstance() = default;
+
+    RenderDevice* createRenderDevice(int DeviceFeatureFlags = 0, const bool vsync = false) override;
+
+private:
+
+    uint32_t mWidth;
+    uint32_t mHeight;
+};
+
+
+#endif
@@ -0,0 +1,28 @@
+#include "NullShader.hpp"
+
+
+NullShader::NullShader(RenderDevice* device, const std::string& path) :
+    ShaderBase{device, path}
+{
+}
+
+
+bool NullShader::compile(const std::vector<ShaderDefine>& prefix)
+{
+    updateCompiledDefineHash(prefix);
+    mCompiled = true;
+
+    return true;
+}
+
+
+bool NullShader::reload()
+{
+    if (std::filesystem::last_write_time(mFilePath) > mLastFileAccessTime)
+    {
+        mLastFileAccessTime = std::filesystem::last_write_time(mFilePath);
+        return true;
+    }
+
+    return false;
+}
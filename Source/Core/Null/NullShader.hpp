@@ -0,0 +1,19 @@
+#ifndef NULL_SHADER_HPP
+#define NULL_SHADER_HPP
+
+#include "Core/Shader.hpp"
+
+
+// Nothing executes the shaders, so compiling them only records the defines used.
+class NullShader : public ShaderBase
+{
+public:
+
+    NullShader(RenderDevice*, const std::string&);
+	~NullShader() = default;
+
+    virtual bool compile(const std::vector<ShaderDefine>& prefix = {}) override;
+	virtual bool reload() override;
+};
+
+#endif
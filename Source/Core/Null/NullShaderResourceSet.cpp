@@ -0,0 +1,21 @@
+#include "NullShaderResourceSet.hpp"
+#include "Core/ImageView.hpp"
+#include "Core/BufferView.hpp"
+
+
+NullShaderResourceSet::NullShaderResourceSet(RenderDevice* dev, const uint32_t maxDescriptors) :
+	ShaderResourceSetBase(dev, maxDescriptors)
+{
+}
+
+
+void NullShaderResourceSet::finalise()
+{
+	mPendingElementUpdates.clear();
+}
+
+
+void NullShaderResourceSet::updateArrayElements()
+{
+	mPendingElementUpdates.clear();
+}
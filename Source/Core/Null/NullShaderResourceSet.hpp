@@ -0,0 +1,17 @@
+#ifndef NULL_SHADER_RESOURCE_SET_HPP
+#define NULL_SHADER_RESOURCE_SET_HPP
+
+#include "Core/ShaderResourceSet.hpp"
+
+
+class NullShaderResourceSet : public ShaderResourceSetBase
+{
+public:
+	NullShaderResourceSet(RenderDevice*, const uint32_t maxDescriptors);
+	~NullShaderResourceSet() = default;
+
+	virtual void finalise() override final;
+	virtual void updateArrayElements() override final;
+};
+
+#endif
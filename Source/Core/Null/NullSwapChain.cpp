@@ -0,0 +1,35 @@
+#include "NullSwapChain.hpp"
+#include "NullImage.hpp"
+
+
+NullSwapChain::NullSwapChain(RenderDevice* device, const uint32_t width, const uint32_t height) :
+	SwapChainBase(device, nullptr)
+{
+	mSwapChainExtent = ImageExtent{width, height, 1};
+	mSwapChainFormat = Format::BGRA8UNorm;
+
+	for(uint32_t i = 0; i < kSwapChainImageCount; ++i)
+	{
+		NullImage* image = new NullImage(getDevice(),
+			mSwapChainFormat,
+			ImageUsage::ColourAttachment,
+			width,
+			height,
+			1, 1, 1, 1, "SwapChain");
+
+		mSwapChainImages.push_back(image);
+		mImageViews.push_back(ImageView(mSwapChainImages.back(), ImageViewType::Colour));
+	}
+}
+
+
+uint32_t NullSwapChain::getNextImageIndex()
+{
+	return mCurrentImageIndex;
+}
+
+
+void NullSwapChain::present(const QueueType)
+{
+	mCurrentImageIndex = (mCurrentImageIndex + 1) % mSwapChainImages.size();
+}
@@ -0,0 +1,22 @@
+#ifndef NULL_SWAPCHAIN_HPP
+#define NULL_SWAPCHAIN_HPP
+
+#include "Core/SwapChain.hpp"
+
+
+// A fixed size set of off screen images that are cycled through on present.
+class NullSwapChain : public SwapChainBase
+{
+public:
+	NullSwapChain(RenderDevice* Device, const uint32_t width, const uint32_t height);
+	~NullSwapChain() = default;
+
+	virtual uint32_t getNextImageIndex() override;
+	virtual void present(const QueueType queueIndex) override;
+
+private:
+
+	static constexpr uint32_t kSwapChainImageCount = 3;
+};
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <string>
+#include <vector>
 
 #include "BarrierManager.hpp"
 #include "SwapChain.hpp"
@@ -30,6 +32,13 @@ class CommandContextBase;
 
 using PipelineHandle = uint64_t;
 
+// GPU time a task took in timestamp ticks, see getTimeStampPeriod.
+struct TaskTimestamp
+{
+    std::string mTaskName;
+    uint64_t mDuration;
+};
+
 class RenderDevice
 {
 public:
@@ -84,9 +93,11 @@ public:
 
 	virtual size_t					   getMinStorageBufferAlignment() const = 0;
     virtual bool                       getHasCommandPredicationSupport() const = 0;
+    virtual bool                       getHasIndirectDrawCountSupport() const = 0;
     virtual bool                       getHasAsyncComputeSupport() const = 0;
 
-    virtual const std::vector<uint64_t>& getAvailableTimestamps() const = 0;
+    // Timings of the tasks from the last time this frame index was recorded, so are a few frames old.
+    virtual const std::vector<TaskTimestamp>& getAvailableTimestamps() const = 0;
     virtual float                      getTimeStampPeriod() const = 0;
 
 	Image& getSwapChainImage()
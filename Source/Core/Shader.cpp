@@ -15,6 +15,10 @@
 #include "Core/DX_12/DX_12Shader.hpp"
 #endif
 
+#ifdef NULL_DEVICE
+#include "Core/Null/NullShader.hpp"
+#endif
+
 
 ShaderBase::ShaderBase(RenderDevice* device, const std::string& path) :
     DeviceChild{device},
@@ -42,6 +46,10 @@ Shader::Shader(RenderDevice* dev, const std::string& path)
 #ifdef DX_12
     mBase = std::make_shared<DX_12Shader>(dev, path, prefixHash);
 #endif
+
+#ifdef NULL_DEVICE
+    mBase = std::make_shared<NullShader>(dev, path);
+#endif
 }
 
 // std::hash<ShaderDefine> definition
@@ -110,10 +110,10 @@ IDxcBlob* ShaderCompiler::compileShader(const std::filesystem::path& path,
             hr = result->GetErrorBuffer(&errorsBlob);
             if (SUCCEEDED(hr) && errorsBlob)
             {
-                BELL_LOG_ARGS("Compilation failed with errors:\n%s\n",
-                              (const char*)errorsBlob->GetBufferPointer())
+                BELL_LOG_ERROR(Shaders, "Compilation failed with errors:\n%s\n",
+                               (const char*)errorsBlob->GetBufferPointer())
 
-                fflush(stdout);
+                Log::flush();
                 BELL_TRAP;
             }
         }
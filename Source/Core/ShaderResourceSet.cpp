@@ -4,6 +4,7 @@
 #include "Core/ImageView.hpp"
 #include "Core/BufferView.hpp"
 #include "Core/Sampler.hpp"
+#include "Core/BellLogging.hpp"
 
 #ifdef VULKAN
 #include "Core/Vulkan/VulkanShaderResourceSet.hpp"
@@ -13,10 +14,15 @@
 #include "Core/DX_12/DX_12ShaderResourceSet.hpp"
 #endif
 
+#ifdef NULL_DEVICE
+#include "Core/Null/NullShaderResourceSet.hpp"
+#endif
+
 ShaderResourceSetBase::ShaderResourceSetBase(RenderDevice* dev, const uint32_t maxDescriptors) :
 	DeviceChild(dev),
 	GPUResource(getDevice()->getCurrentSubmissionIndex()),
-    mMaxDescriptors{maxDescriptors}
+    mMaxDescriptors{maxDescriptors},
+    mUpdateAfterBind{false}
 {}
 
 
@@ -91,6 +97,24 @@ void ShaderResourceSetBase::addDataBufferROArray(const BufferViewArray& views)
 }
 
 
+void ShaderResourceSetBase::addBindlessSampledImageArray(const ImageViewArray& views)
+{
+    addSampledImageArray(views);
+    mUpdateAfterBind = true;
+}
+
+
+void ShaderResourceSetBase::setSampledImageArrayElement(const uint32_t binding, const uint32_t element, const ImageView& view)
+{
+    BELL_ASSERT(mUpdateAfterBind, "Only bindless arrays can be updated after creation")
+    BELL_ASSERT(binding < mResources.size() && mResources[binding].mType == AttachmentType::TextureArray, "Binding isn't an image array")
+    BELL_ASSERT(element < mResources[binding].mArraySize, "Array element out of bounds")
+
+    mImageArrays[mResources[binding].mIndex][element] = view;
+    mPendingElementUpdates.push_back({binding, element});
+}
+
+
 void ShaderResourceSetBase::updateLastAccessed()
 {
     const uint64_t submissionIndex = getDevice()->getCurrentSubmissionIndex();
@@ -114,6 +138,10 @@ ShaderResourceSet::ShaderResourceSet(RenderDevice* dev, const uint32_t maxDescri
 #ifdef DX_12
     mBase = std::make_shared<DX_12ShaderResourceSet>(dev, maxDescriptors);
 #endif
+
+#ifdef NULL_DEVICE
+    mBase = std::make_shared<NullShaderResourceSet>(dev, maxDescriptors);
+#endif
 }
 
 
@@ -128,4 +156,8 @@ void ShaderResourceSet::reset(RenderDevice* dev, const uint32_t maxDescriptors)
 #ifdef DX_12
     mBase = std::make_shared<DX_12ShaderResourceSet>(dev, maxDescriptors);
 #endif
+
+#ifdef NULL_DEVICE
+    mBase = std::make_shared<NullShaderResourceSet>(dev, maxDescriptors);
+#endif
 }
@@ -3,14 +3,24 @@
 #include "VulkanBufferView.hpp"
 #include "Core/ConversionUtils.hpp"
 #include "Core/BellLogging.hpp"
+#include "Core/HashUtils.hpp"
 
 #include <iostream>
 #include <numeric>
 #include <cstdint>
 
 
+namespace
+{
+    // Resets of the owning context a cached set can go unused before being freed.
+    constexpr uint64_t kCachedSetRetention = 8;
+    constexpr size_t kMaxCachedSets = 512;
+}
+
+
 DescriptorManager::DescriptorManager(RenderDevice* dev) :
-	DeviceChild{ dev }
+	DeviceChild{ dev },
+    mResetCount{0}
 {
 	for (uint32_t i = 0; i < getDevice()->getSwapChainImageCount(); ++i)
 	{
@@ -37,6 +47,16 @@ DescriptorManager::~DescriptorManager()
 	{
 		device->destroyDescriptorPool(pool.mPool);
 	}
+
+    for (auto& pool : mUpdateAfterBindPools)
+    {
+        device->destroyDescriptorPool(pool.mPool);
+    }
+
+    for (auto& pool : mCachePools)
+    {
+        device->destroyDescriptorPool(pool.mPool);
+    }
 }
 
 
@@ -44,7 +64,7 @@ std::vector<vk::DescriptorSet> DescriptorManager::getDescriptors(const RenderGra
 {
     const RenderTask& task = graph.getTask(taskIndex);
 
-    vk::DescriptorSet descSet = allocateDescriptorSet(task, layout);
+    vk::DescriptorSet descSet = getCachedDescriptorSet(graph, taskIndex, layout);
 
     std::vector<vk::DescriptorSet> descSets{};
     descSets.push_back(descSet);
@@ -63,6 +83,194 @@ std::vector<vk::DescriptorSet> DescriptorManager::getDescriptors(const RenderGra
 }
 
 
+vk::DescriptorSet DescriptorManager::getCachedDescriptorSet(const RenderGraph& graph, const uint32_t taskIndex, const vk::DescriptorSetLayout layout)
+{
+    const RenderTask& task = graph.getTask(taskIndex);
+
+    buildCacheKey(graph, task, layout);
+
+    size_t hash = 0;
+    hash_combine(hash, mCacheKey);
+
+    auto lookup = mCachedSetLookup.find(hash);
+    if(lookup != mCachedSetLookup.end())
+    {
+        CachedSetIterator cachedSet = lookup->second;
+        if(cachedSet->mKey == mCacheKey)
+        {
+            cachedSet->mLastUsed = mResetCount;
+            mCachedSets.splice(mCachedSets.begin(), mCachedSets, cachedSet);
+
+            return cachedSet->mSet;
+        }
+
+        // A hash collision, the set can only be replaced if it isn't referenced by work recorded this frame.
+        if(cachedSet->mLastUsed != mResetCount)
+            freeCachedDescriptorSet(cachedSet);
+    }
+
+    // Sets used this frame can't be evicted, so fall back to a set that only lives for this frame.
+    const bool canCache = mCachedSetLookup.find(hash) == mCachedSetLookup.end() &&
+            (mCachedSets.size() < kMaxCachedSets || mCachedSets.back().mLastUsed != mResetCount);
+    if(!canCache)
+    {
+        vk::DescriptorSet descSet = allocateDescriptorSet(task, layout);
+        writeDescriptors(graph, taskIndex, descSet);
+
+        return descSet;
+    }
+
+    if(mCachedSets.size() >= kMaxCachedSets)
+        freeCachedDescriptorSet(std::prev(mCachedSets.end()));
+
+    const auto& attachments = task.getInputAttachments();
+
+    DescriptorPool& pool = findSuitablePool(attachments, mCachePools, true);
+
+    vk::DescriptorSetAllocateInfo allocInfo{};
+    allocInfo.setDescriptorPool(pool.mPool);
+    allocInfo.setDescriptorSetCount(1);
+    allocInfo.setPSetLayouts(&layout);
+
+    vk::DescriptorSet descSet = static_cast<VulkanRenderDevice*>(getDevice())->allocateDescriptorSet(allocInfo)[0];
+    writeDescriptors(graph, taskIndex, descSet);
+
+    const uint32_t poolIndex = static_cast<uint32_t>(&pool - mCachePools.data());
+    mCachedSets.push_front({mCacheKey, descSet, poolIndex, getRequiredDescriptors(attachments), mResetCount});
+    mCachedSetLookup[hash] = mCachedSets.begin();
+
+    return descSet;
+}
+
+
+void DescriptorManager::buildCacheKey(const RenderGraph& graph, const RenderTask& task, const vk::DescriptorSetLayout layout)
+{
+    // Everything that ends up in the descriptor writes, so equal keys always produce identical sets.
+    mCacheKey.clear();
+    mCacheKey.push_back(reinterpret_cast<uint64_t>(VkDescriptorSetLayout(layout)));
+
+    for(const auto& bindingInfo : task.getInputAttachments())
+    {
+        const AttachmentType attachmentType = bindingInfo.mType;
+
+        switch(attachmentType)
+        {
+        case AttachmentType::Image1D:
+        case AttachmentType::Image2D:
+        case AttachmentType::Image3D:
+        case AttachmentType::Texture1D:
+        case AttachmentType::Texture2D:
+        case AttachmentType::Texture3D:
+        case AttachmentType::CubeMap:
+        {
+            auto& imageView = graph.getImageView(bindingInfo.mName);
+            const VulkanImageView& VKView = static_cast<const VulkanImageView&>(*imageView.getBase());
+            const vk::ImageView handle = attachmentType == AttachmentType::CubeMap ? VKView.getCubeMapImageView() : VKView.getImageView();
+
+            mCacheKey.push_back(static_cast<uint64_t>(attachmentType));
+            mCacheKey.push_back(reinterpret_cast<uint64_t>(VkImageView(handle)));
+            mCacheKey.push_back(static_cast<uint64_t>(imageView->getType()));
+            break;
+        }
+
+        case AttachmentType::TextureArray:
+        {
+            const auto& imageViews = graph.getImageArrayViews(bindingInfo.mName);
+
+            mCacheKey.push_back(static_cast<uint64_t>(attachmentType));
+            mCacheKey.push_back(imageViews.size());
+            for(auto& view : imageViews)
+            {
+                mCacheKey.push_back(reinterpret_cast<uint64_t>(VkImageView(static_cast<const VulkanImageView&>(*view.getBase()).getImageView())));
+            }
+            break;
+        }
+
+        case AttachmentType::Sampler:
+        {
+            const vk::Sampler sampler = static_cast<VulkanRenderDevice*>(getDevice())->getImmutableSampler(graph.getSampler(bindingInfo.mName));
+
+            mCacheKey.push_back(static_cast<uint64_t>(attachmentType));
+            mCacheKey.push_back(reinterpret_cast<uint64_t>(VkSampler(sampler)));
+            break;
+        }
+
+        case AttachmentType::UniformBuffer:
+        case AttachmentType::DataBufferRO:
+        case AttachmentType::DataBufferWO:
+        case AttachmentType::DataBufferRW:
+        {
+            auto& bufferView = graph.getBuffer(bindingInfo.mName);
+
+            mCacheKey.push_back(static_cast<uint64_t>(attachmentType));
+            mCacheKey.push_back(reinterpret_cast<uint64_t>(VkBuffer(static_cast<const VulkanBufferView&>(*bufferView.getBase()).getBuffer())));
+            mCacheKey.push_back(bufferView->getOffset());
+            mCacheKey.push_back(bufferView->getSize());
+            break;
+        }
+
+        case AttachmentType::DataBufferROArray:
+        {
+            const auto& bufferViews = graph.getBufferArrayViews(bindingInfo.mName);
+
+            mCacheKey.push_back(static_cast<uint64_t>(attachmentType));
+            mCacheKey.push_back(bufferViews.size());
+            for(auto& view : bufferViews)
+            {
+                mCacheKey.push_back(reinterpret_cast<uint64_t>(VkBuffer(static_cast<const VulkanBufferView&>(*view.getBase()).getBuffer())));
+                mCacheKey.push_back(view->getOffset());
+                mCacheKey.push_back(view->getSize());
+            }
+            break;
+        }
+
+        case AttachmentType::AccelerationStructure:
+        {
+            auto& accelerationStructure = graph.getAccelerationStructure(bindingInfo.mName);
+            const vk::AccelerationStructureKHR handle = static_cast<const VulkanTopLevelAccelerationStructure*>(accelerationStructure.getBase())->getAccelerationStructureHandle();
+
+            mCacheKey.push_back(static_cast<uint64_t>(attachmentType));
+            mCacheKey.push_back(reinterpret_cast<uint64_t>(VkAccelerationStructureKHR(handle)));
+            break;
+        }
+
+        default:
+            break; // Not written to the set, see writeDescriptors.
+        }
+    }
+}
+
+
+void DescriptorManager::freeCachedDescriptorSet(const CachedSetIterator cachedSet)
+{
+    DescriptorPool& pool = mCachePools[cachedSet->mPoolIndex];
+    static_cast<VulkanRenderDevice*>(getDevice())->freeDescriptorSet(pool.mPool, cachedSet->mSet);
+
+    const DescriptorPool& counts = cachedSet->mDescriptorCounts;
+    pool.mStorageImageCount += counts.mStorageImageCount;
+    pool.mSampledImageCount += counts.mSampledImageCount;
+    pool.mSamplerCount += counts.mSamplerCount;
+    pool.mUniformBufferCount += counts.mUniformBufferCount;
+    pool.mStorageBufferCount += counts.mStorageBufferCount;
+    pool.mAccelerationStructureCount += counts.mAccelerationStructureCount;
+
+    size_t hash = 0;
+    hash_combine(hash, cachedSet->mKey);
+    mCachedSetLookup.erase(hash);
+
+    mCachedSets.erase(cachedSet);
+}
+
+
+void DescriptorManager::clearCache()
+{
+    while(!mCachedSets.empty())
+    {
+        freeCachedDescriptorSet(mCachedSets.begin());
+    }
+}
+
+
 void DescriptorManager::writeDescriptors(const RenderGraph& graph, const uint32_t taskIndex, vk::DescriptorSet descSet)
 {
     const RenderTask& task           = graph.getTask(taskIndex);
@@ -244,7 +452,8 @@ void DescriptorManager::writeDescriptors(const RenderGraph& graph, const uint32_
 }
 
 
-vk::DescriptorSet DescriptorManager::writeShaderResourceSet(const vk::DescriptorSetLayout layout, const std::vector<WriteShaderResourceSet>& writes, vk::DescriptorPool& outPool)
+vk::DescriptorSet DescriptorManager::writeShaderResourceSet(const vk::DescriptorSetLayout layout, const std::vector<WriteShaderResourceSet>& writes, vk::DescriptorPool& outPool,
+                                                            const bool updateAfterBind)
 {
 	std::vector<vk::WriteDescriptorSet> descSetWrites;
 	std::vector<vk::DescriptorImageInfo> imageInfos;
@@ -265,7 +474,7 @@ vk::DescriptorSet DescriptorManager::writeShaderResourceSet(const vk::Descriptor
 	imageInfos.reserve(maxImages);
 	bufferInfos.reserve(maxBuffers);
 
-    vk::DescriptorSet descSet = allocatePersistentDescriptorSet(layout, writes, outPool);
+    vk::DescriptorSet descSet = allocatePersistentDescriptorSet(layout, writes, outPool, updateAfterBind);
 
 	for (uint32_t i = 0; i < writes.size(); ++i)
 	{
@@ -427,9 +636,45 @@ vk::DescriptorSet DescriptorManager::writeShaderResourceSet(const vk::Descriptor
 }
 
 
-vk::DescriptorSet DescriptorManager::allocatePersistentDescriptorSet(const vk::DescriptorSetLayout layout, const std::vector<WriteShaderResourceSet>& writes, vk::DescriptorPool& outPool)
+void DescriptorManager::writeImageArrayElements(const vk::DescriptorSet set, const uint32_t binding, const std::vector<uint32_t>& elements, const ImageView* views)
 {
-	DescriptorPool pool = findSuitablePool(writes, mPersistentPools);
+    std::vector<vk::WriteDescriptorSet> descSetWrites;
+    std::vector<vk::DescriptorImageInfo> imageInfos;
+    imageInfos.reserve(elements.size());
+
+    // Elements are expected to be sorted.
+    for(uint32_t i = 0; i < elements.size();)
+    {
+        const uint32_t firstElement = elements[i];
+        const size_t firstInfo = imageInfos.size();
+
+        uint32_t count = 0;
+        while(i < elements.size() && elements[i] == firstElement + count)
+        {
+            imageInfos.push_back(generateDescriptorImageInfo(views[elements[i]], vk::ImageLayout::eShaderReadOnlyOptimal, AttachmentType::TextureArray));
+            ++count;
+            ++i;
+        }
+
+        vk::WriteDescriptorSet descWrite{};
+        descWrite.setDstSet(set);
+        descWrite.setDstBinding(binding);
+        descWrite.setDstArrayElement(firstElement);
+        descWrite.setDescriptorType(vk::DescriptorType::eSampledImage);
+        descWrite.setDescriptorCount(count);
+        descWrite.setPImageInfo(&imageInfos[firstInfo]);
+
+        descSetWrites.push_back(descWrite);
+    }
+
+    static_cast<VulkanRenderDevice*>(getDevice())->writeDescriptorSets(descSetWrites);
+}
+
+
+vk::DescriptorSet DescriptorManager::allocatePersistentDescriptorSet(const vk::DescriptorSetLayout layout, const std::vector<WriteShaderResourceSet>& writes, vk::DescriptorPool& outPool,
+                                                                     const bool updateAfterBind)
+{
+	DescriptorPool pool = updateAfterBind ? findSuitablePool(writes, mUpdateAfterBindPools, true) : findSuitablePool(writes, mPersistentPools);
     outPool = pool.mPool;
 
 	vk::DescriptorSetAllocateInfo allocInfo{};
@@ -463,7 +708,7 @@ vk::DescriptorSet DescriptorManager::allocateDescriptorSet(const RenderTask& tas
 }
 
 
-DescriptorManager::DescriptorPool DescriptorManager::createDescriptorPool(const bool allowIndividualReset)
+DescriptorManager::DescriptorPool DescriptorManager::createDescriptorPool(const bool allowIndividualReset, const bool updateAfterBind, const uint32_t sampledImageCount)
 {
     // This pool size had been picked pretty randomly so may need to change this in the future.
     vk::DescriptorPoolSize uniformBufferDescPoolSize{};
@@ -480,7 +725,7 @@ DescriptorManager::DescriptorPool DescriptorManager::createDescriptorPool(const
 
     vk::DescriptorPoolSize imageDescPoolSize{};
     imageDescPoolSize.setType(vk::DescriptorType::eSampledImage);
-    imageDescPoolSize.setDescriptorCount(100);
+    imageDescPoolSize.setDescriptorCount(sampledImageCount);
 
     vk::DescriptorPoolSize storageImageDescPoolSize{};
     storageImageDescPoolSize.setType(vk::DescriptorType::eStorageImage);
@@ -502,11 +747,13 @@ DescriptorManager::DescriptorPool DescriptorManager::createDescriptorPool(const
 	DescPoolInfo.setPPoolSizes(descPoolSizes.data());
 	DescPoolInfo.setMaxSets(300);
 	DescPoolInfo.setFlags(allowIndividualReset ? vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet : vk::DescriptorPoolCreateFlags{});
+    if(updateAfterBind)
+        DescPoolInfo.setFlags(DescPoolInfo.flags | vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind);
 
 	DescriptorPool newPool
 	{
 		100,
-		100,
+		sampledImageCount,
 		100,
 		100,
 		100,
@@ -556,10 +803,35 @@ void DescriptorManager::reset()
 		pool.mUniformBufferCount = 100;
 		pool.mAccelerationStructureCount = 5;
 	}
+
+    ++mResetCount;
+
+    // Cached sets referencing destroyed resources can't be used again, the handles may be reused by new resources.
+    const std::vector<uint64_t>& destroyedHandles = static_cast<VulkanRenderDevice*>(getDevice())->getDestroyedDescriptorHandles();
+    if(!destroyedHandles.empty())
+    {
+        for(auto it = mCachedSets.begin(); it != mCachedSets.end();)
+        {
+            const bool referencesDestroyed = std::any_of(it->mKey.begin(), it->mKey.end(), [&destroyedHandles](const uint64_t handle)
+            {
+                return std::find(destroyedHandles.begin(), destroyedHandles.end(), handle) != destroyedHandles.end();
+            });
+
+            auto next = std::next(it);
+            if(referencesDestroyed)
+                freeCachedDescriptorSet(it);
+            it = next;
+        }
+    }
+
+    while(!mCachedSets.empty() && (mCachedSets.back().mLastUsed + kCachedSetRetention) < mResetCount)
+    {
+        freeCachedDescriptorSet(std::prev(mCachedSets.end()));
+    }
 }
 
 
-DescriptorManager::DescriptorPool& DescriptorManager::findSuitablePool(const std::vector<WriteShaderResourceSet>& attachments, std::vector<DescriptorPool>& pools)
+DescriptorManager::DescriptorPool& DescriptorManager::findSuitablePool(const std::vector<WriteShaderResourceSet>& attachments, std::vector<DescriptorPool>& pools, const bool updateAfterBind)
 {
 	size_t requiredStorageImageDescriptors = 0;
 	size_t requiredSampledImageDescriptors = 0;
@@ -642,7 +914,11 @@ DescriptorManager::DescriptorPool& DescriptorManager::findSuitablePool(const std
 	}
 	else
 	{
-		pools.push_back(createDescriptorPool());
+        // Bindless arrays can be much larger than the default pool size.
+        if(updateAfterBind)
+            pools.push_back(createDescriptorPool(true, true, std::max(static_cast<uint32_t>(requiredSampledImageDescriptors), 100u)));
+        else
+            pools.push_back(createDescriptorPool());
 
 		DescriptorPool& pool = pools.back();
 
@@ -658,14 +934,9 @@ DescriptorManager::DescriptorPool& DescriptorManager::findSuitablePool(const std
 }
 
 
-DescriptorManager::DescriptorPool& DescriptorManager::findSuitablePool(const std::vector<RenderTask::InputAttachmentInfo>& attachments, std::vector<DescriptorPool>& pools)
+DescriptorManager::DescriptorPool DescriptorManager::getRequiredDescriptors(const std::vector<RenderTask::InputAttachmentInfo>& attachments) const
 {
-    size_t requiredStorageImageDescriptors = 0;
-    size_t requiredSampledImageDescriptors = 0;
-    size_t requiredSamplerDescriptors = 0;
-    size_t requiredUniformBufferDescriptors = 0;
-    size_t requiredStorageBufferDescriptors = 0;
-    size_t requiredAccelerationStructureDescriptors = 0;
+    DescriptorPool required{0, 0, 0, 0, 0, 0, nullptr};
 
     for (const auto& attachment : attachments)
     {
@@ -675,28 +946,28 @@ DescriptorManager::DescriptorPool& DescriptorManager::findSuitablePool(const std
         case AttachmentType::DataBufferRO:
         case AttachmentType::DataBufferRW:
         case AttachmentType::DataBufferWO:
-            requiredStorageBufferDescriptors++;
+            required.mStorageBufferCount++;
             break;
 
         case AttachmentType::UniformBuffer:
-            requiredUniformBufferDescriptors++;
+            required.mUniformBufferCount++;
             break;
 
         case AttachmentType::DataBufferROArray:
-            requiredStorageBufferDescriptors += attachment.mArraySize;
+            required.mStorageBufferCount += attachment.mArraySize;
             break;
 
         case AttachmentType::Texture1D:
         case AttachmentType::Texture2D:
         case AttachmentType::Texture3D:
         case AttachmentType::CubeMap:
-            requiredSampledImageDescriptors++;
+            required.mSampledImageCount++;
             break;
 
         case AttachmentType::Image1D:
         case AttachmentType::Image2D:
         case AttachmentType::Image3D:
-            requiredStorageImageDescriptors++;
+            required.mStorageImageCount++;
             break;
 
         case AttachmentType::TextureArray:
@@ -706,54 +977,50 @@ DescriptorManager::DescriptorPool& DescriptorManager::findSuitablePool(const std
             break;
 
         case AttachmentType::Sampler:
-            requiredSamplerDescriptors++;
+            required.mSamplerCount++;
             break;
 
         case AttachmentType::AccelerationStructure:
-            requiredAccelerationStructureDescriptors++;
+            required.mAccelerationStructureCount++;
 
         default:
             break;
         }
     }
 
-    auto it = std::find_if(pools.begin(), pools.end(), [=](const DescriptorPool& p)
+    return required;
+}
+
+
+DescriptorManager::DescriptorPool& DescriptorManager::findSuitablePool(const std::vector<RenderTask::InputAttachmentInfo>& attachments, std::vector<DescriptorPool>& pools,
+                                                                       const bool allowIndividualReset)
+{
+    const DescriptorPool required = getRequiredDescriptors(attachments);
+
+    auto it = std::find_if(pools.begin(), pools.end(), [&required](const DescriptorPool& p)
         {
-            return	requiredStorageImageDescriptors <= p.mStorageImageCount &&
-                    requiredSampledImageDescriptors <= p.mSampledImageCount &&
-                    requiredSamplerDescriptors <= p.mSamplerCount &&
-                    requiredUniformBufferDescriptors <= p.mUniformBufferCount &&
-                    requiredStorageBufferDescriptors <= p.mStorageBufferCount &&
-                    requiredAccelerationStructureDescriptors <= p.mAccelerationStructureCount;
+            return	required.mStorageImageCount <= p.mStorageImageCount &&
+                    required.mSampledImageCount <= p.mSampledImageCount &&
+                    required.mSamplerCount <= p.mSamplerCount &&
+                    required.mUniformBufferCount <= p.mUniformBufferCount &&
+                    required.mStorageBufferCount <= p.mStorageBufferCount &&
+                    required.mAccelerationStructureCount <= p.mAccelerationStructureCount;
         });
 
-    if (it != pools.end())
+    if (it == pools.end())
     {
-        DescriptorPool& pool = *it;
-
-        pool.mStorageImageCount -= requiredStorageImageDescriptors;
-        pool.mSampledImageCount -= requiredSampledImageDescriptors;
-        pool.mSamplerCount		-= requiredSamplerDescriptors;
-        pool.mUniformBufferCount -= requiredUniformBufferDescriptors;
-        pool.mStorageBufferCount -= requiredStorageBufferDescriptors;
-        pool.mAccelerationStructureCount -= requiredAccelerationStructureDescriptors;
-
-        return pool;
+        pools.push_back(createDescriptorPool(allowIndividualReset));
+        it = std::prev(pools.end());
     }
-    else
-    {
-        pools.push_back(createDescriptorPool());
 
-        DescriptorPool& pool = pools.back();
+    DescriptorPool& pool = *it;
 
-        pool.mStorageImageCount -= requiredStorageImageDescriptors;
-        pool.mSampledImageCount -= requiredSampledImageDescriptors;
-        pool.mSamplerCount -= requiredSamplerDescriptors;
-        pool.mUniformBufferCount -= requiredUniformBufferDescriptors;
-        pool.mStorageBufferCount -= requiredStorageBufferDescriptors;
-        pool.mAccelerationStructureCount -= requiredAccelerationStructureDescriptors;
+    pool.mStorageImageCount -= required.mStorageImageCount;
+    pool.mSampledImageCount -= required.mSampledImageCount;
+    pool.mSamplerCount		-= required.mSamplerCount;
+    pool.mUniformBufferCount -= required.mUniformBufferCount;
+    pool.mStorageBufferCount -= required.mStorageBufferCount;
+    pool.mAccelerationStructureCount -= required.mAccelerationStructureCount;
 
-        return pool;
-    }
+    return pool;
 }
-
@@ -8,8 +8,10 @@
 #include <vulkan/vulkan.hpp>
 
 #include <algorithm>
+#include <list>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 
 class RenderDevice;
@@ -38,19 +40,28 @@ struct WriteShaderResourceSet
 };
 
 
+// Task descriptor sets are cached on the layout and handles they were written with, so tasks whose bindings haven't
+// changed reuse the set from a previous frame instead of allocating and writing a new one. Every command context
+// owns a manager, so recording threads never share a cache or pool.
 class DescriptorManager : public DeviceChild
 {
 public:
 	DescriptorManager(RenderDevice* dev);
     ~DescriptorManager();
 
+    // The first set is written (or reused from the cache) for the task, followed by any shader resource sets.
     std::vector<vk::DescriptorSet>	 getDescriptors(const RenderGraph&, const uint32_t taskIndex, const vk::DescriptorSetLayout);
     void     writeDescriptors(const RenderGraph&, const uint32_t taskIndex, vk::DescriptorSet);
 
 
-    vk::DescriptorSet	writeShaderResourceSet(const vk::DescriptorSetLayout layout, const std::vector<WriteShaderResourceSet>&, vk::DescriptorPool& outPool);
+    vk::DescriptorSet	writeShaderResourceSet(const vk::DescriptorSetLayout layout, const std::vector<WriteShaderResourceSet>&, vk::DescriptorPool& outPool,
+                                           const bool updateAfterBind = false);
+    // Rewrite individual elements of an image array, consecutive elements are written together.
+    void                writeImageArrayElements(const vk::DescriptorSet set, const uint32_t binding, const std::vector<uint32_t>& elements, const ImageView* views);
 
 	void	 reset();
+    // Only safe to call once none of the cached sets are in use by the GPU.
+    void     clearCache();
 
 private:
 
@@ -58,7 +69,8 @@ private:
 	vk::DescriptorBufferInfo    generateDescriptorBufferInfo(const BufferView &) const;
 
     vk::DescriptorSet			allocateDescriptorSet(const RenderTask&, const vk::DescriptorSetLayout);
-    vk::DescriptorSet			allocatePersistentDescriptorSet(const vk::DescriptorSetLayout layout, const std::vector<WriteShaderResourceSet>&, vk::DescriptorPool &pool);
+    vk::DescriptorSet			allocatePersistentDescriptorSet(const vk::DescriptorSetLayout layout, const std::vector<WriteShaderResourceSet>&, vk::DescriptorPool &pool,
+                                                                const bool updateAfterBind);
 
 	struct DescriptorPool
 	{
@@ -71,13 +83,38 @@ private:
 		vk::DescriptorPool mPool;
 	};
 
-    DescriptorPool& findSuitablePool(const std::vector<WriteShaderResourceSet>&, std::vector<DescriptorPool>&);
-    DescriptorPool& findSuitablePool(const std::vector<RenderTask::InputAttachmentInfo>&, std::vector<DescriptorPool>&);
+    DescriptorPool& findSuitablePool(const std::vector<WriteShaderResourceSet>&, std::vector<DescriptorPool>&, const bool updateAfterBind = false);
+    DescriptorPool& findSuitablePool(const std::vector<RenderTask::InputAttachmentInfo>&, std::vector<DescriptorPool>&, const bool allowIndividualReset = false);
+    DescriptorPool  getRequiredDescriptors(const std::vector<RenderTask::InputAttachmentInfo>&) const;
 
-	DescriptorPool	createDescriptorPool(const bool allowIndividualReset = false);
+    struct CachedDescriptorSet
+    {
+        std::vector<uint64_t> mKey;
+        vk::DescriptorSet mSet;
+        uint32_t mPoolIndex;
+        DescriptorPool mDescriptorCounts;
+        uint64_t mLastUsed;
+    };
+    using CachedSetIterator = std::list<CachedDescriptorSet>::iterator;
+
+    vk::DescriptorSet           getCachedDescriptorSet(const RenderGraph&, const uint32_t taskIndex, const vk::DescriptorSetLayout);
+    void                        buildCacheKey(const RenderGraph&, const RenderTask&, const vk::DescriptorSetLayout);
+    void                        freeCachedDescriptorSet(const CachedSetIterator);
+
+	DescriptorPool	createDescriptorPool(const bool allowIndividualReset = false, const bool updateAfterBind = false, const uint32_t sampledImageCount = 100);
 
     std::vector<std::vector<DescriptorPool>> mPerFramePools;
 	std::vector<DescriptorPool> mPersistentPools;
+    // Sets with bindless arrays have to come from pools created with update after bind.
+    std::vector<DescriptorPool> mUpdateAfterBindPools;
+
+    // Most recently used at the front. Sets stay cached until they go unused for kCachedSetRetention resets,
+    // or are the least recently used set once the cache is full.
+    std::list<CachedDescriptorSet> mCachedSets;
+    std::unordered_map<uint64_t, CachedSetIterator> mCachedSetLookup;
+    std::vector<DescriptorPool> mCachePools;
+    std::vector<uint64_t> mCacheKey;
+    uint64_t mResetCount;
 };
 
 
@@ -9,6 +9,7 @@
 #include <list>
 #include <iostream>
 #include <algorithm>
+#include <tuple>
 
 
 #define DEVICE_LOCAL_POOL_SIZE (1024ULL * 1024ULL * 1024ULL)
@@ -366,6 +367,39 @@ void MemoryManager::Free(Allocation alloc)
 }
 
 
+void MemoryManager::Free(std::vector<Allocation>& allocs)
+{
+    auto poolOrder = [](const Allocation& lhs, const Allocation& rhs)
+    {
+        return std::tie(lhs.hostMappable, lhs.pool, lhs.fragOffset) < std::tie(rhs.hostMappable, rhs.pool, rhs.fragOffset);
+    };
+    std::sort(allocs.begin(), allocs.end(), poolOrder);
+
+    for(auto first = allocs.begin(); first != allocs.end();)
+    {
+        auto last = std::find_if(first, allocs.end(), [first](const Allocation& alloc)
+        {
+            return alloc.hostMappable != first->hostMappable || alloc.pool != first->pool;
+        });
+
+        auto& pools = first->hostMappable ? mHostMappablePools : mDeviceLocalPools;
+        auto& pool = pools[first->pool];
+
+        for(auto& frag : pool)
+        {
+            auto freed = std::lower_bound(first, last, frag.offset, [](const Allocation& alloc, const uint64_t offset)
+            {
+                return alloc.fragOffset < offset;
+            });
+            if(freed != last && freed->fragOffset == frag.offset)
+                frag.free = true;
+        }
+
+        first = last;
+    }
+}
+
+
 void MemoryManager::BindBuffer(vk::Buffer &buffer, const Allocation& alloc)
 {
 	const std::vector<MappableMemoryInfo>& pools = alloc.hostMappable ? mHostMappableMemoryBackers : mDeviceMemoryBackers ;
@@ -51,6 +51,8 @@ public:
 
     Allocation Allocate(const uint64_t size, const unsigned long allignment, const bool hostMappable, const std::string& name = "");
     void       Free(Allocation alloc);
+    // Frees a batch with one pass over each pool touched, allocs is sorted in the process.
+    void       Free(std::vector<Allocation>& allocs);
 
     void       BindImage(vk::Image& image, const Allocation& alloc);
     void       BindBuffer(vk::Buffer& buffer, const Allocation& alloc);
@@ -58,7 +58,28 @@ void VulkanBuffer::swap(BufferBase& other)
 
 void VulkanBuffer::setContents(const void* data, const uint32_t size, const uint32_t offset)
 {
-    setContents(static_cast<VulkanRenderDevice*>(getDevice())->getPrefixCommandBuffer(), data, size, offset);
+    BELL_ASSERT(offset + size <= mSize, "Attempting to upload more data than buffer can hold")
+
+    if (isMappable())
+    {
+        MapInfo mapInfo {};
+        mapInfo.mOffset = offset;
+        mapInfo.mSize = size;
+
+        void* mappedBuffer = map(mapInfo);
+
+        std::memcpy(mappedBuffer, data, size);
+
+        unmap();
+    }
+    else
+    {
+        BELL_ASSERT((mUsage & BufferUsage::TransferDest) != 0, "Buffer needs usage transfer dest")
+
+        static_cast<VulkanRenderDevice*>(getDevice())->getStagingRing()->uploadToBuffer(mBuffer, data, size, offset);
+    }
+
+    updateLastAccessed();
 }
 
 void VulkanBuffer::setContents(vk::CommandBuffer cmd,
@@ -68,45 +89,18 @@ void VulkanBuffer::setContents(vk::CommandBuffer cmd,
 {
     BELL_ASSERT(offset + size <= mSize, "Attempting to upload more data than buffer can hold")
 
-        if (isMappable())
-        {
-            BELL_ASSERT(size <= mSize, "Attempting to map a larger range than the buffer supports.")
-
-                MapInfo mapInfo {};
-            mapInfo.mOffset = offset;
-            mapInfo.mSize = size;
-
-            void* mappedBuffer = map(mapInfo);
-
-            std::memcpy(mappedBuffer, data, size);
-
-            unmap();
-        }
-        else
-        {
-            BELL_ASSERT((mUsage & BufferUsage::TransferDest) != 0, "Buffer needs usage transfer dest")
-
-                // Copy the data in to the command buffer and then perform the copy from there.
-                if (size <= 1 << 16)
-                {
-                    cmd.updateBuffer(mBuffer, offset, size, data);
-                }
-                else
-                {
-                    VulkanBuffer stagingBuffer(getDevice(), BufferUsage::TransferSrc, size, mStride, "Staging Buffer");
-
-                    stagingBuffer.setContents(data, size);
+    if (isMappable())
+    {
+        setContents(data, size, offset);
+    }
+    else
+    {
+        BELL_ASSERT((mUsage & BufferUsage::TransferDest) != 0, "Buffer needs usage transfer dest")
 
-                    vk::BufferCopy copyInfo{};
-                    copyInfo.setSize(size);
-                    copyInfo.setSrcOffset(0);
-                    copyInfo.setDstOffset(offset);
+        static_cast<VulkanRenderDevice*>(getDevice())->getStagingRing()->recordUploadToBuffer(cmd, mBuffer, data, size, offset);
 
-                    cmd.copyBuffer(stagingBuffer.getBuffer(), getBuffer(), copyInfo);
-                    stagingBuffer.updateLastAccessed();
-                }
-       }
-    updateLastAccessed();
+        updateLastAccessed();
+    }
 }
 
 void VulkanBuffer::setContents(const int data,
@@ -39,6 +39,7 @@ public:
 	virtual void* map(MapInfo& mapInfo) override;
 	virtual void    unmap() override;
 
+	// Records the upload in to cmd rather than the prefix command buffer.
 	void setContents(vk::CommandBuffer cmd,
 		const void* data,
 		const uint32_t size,
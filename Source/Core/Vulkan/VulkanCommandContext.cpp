@@ -4,6 +4,12 @@
 #include "Core/Profiling.hpp"
 
 
+namespace
+{
+    // A start and end timestamp per task, tasks after the pool fills up aren't timed.
+    constexpr uint32_t kMaxTimestamps = 50;
+}
+
 VulkanCommandContext::VulkanCommandContext(RenderDevice* dev, const QueueType queue) :
     CommandContextBase(dev, queue),
     mCommandPool(dev, queue),
@@ -13,7 +19,7 @@ VulkanCommandContext::VulkanCommandContext(RenderDevice* dev, const QueueType qu
     mActiveRenderPass(nullptr)
 {
     VulkanRenderDevice* vkDev = static_cast<VulkanRenderDevice*>(getDevice());
-    mTimeStampPool = vkDev->createTimeStampPool(50);
+    mTimeStampPool = vkDev->createTimeStampPool(kMaxTimestamps);
 }
 
 
@@ -38,6 +44,9 @@ void VulkanCommandContext::setupState(const RenderGraph& graph, uint32_t taskInd
     vk::PipelineBindPoint bindPoint = vk::PipelineBindPoint::eCompute;
     const RenderTask& task = graph.getTask(taskIndex);
 
+    if(mActiveQuery)
+        addTimestampName(task.getName());
+
     if(resources.mRenderPass)
     {
         mActiveRenderPass = *resources.mRenderPass;
@@ -76,9 +85,8 @@ void VulkanCommandContext::setupState(const RenderGraph& graph, uint32_t taskInd
         bindPoint = vk::PipelineBindPoint::eGraphics;
     }
 
-    //allocate and write descriptor sets.
+    // Sets are only written when the cache doesn't already have one with the same bindings.
     std::vector<vk::DescriptorSet> descriptorSets = mDescriptorManager.getDescriptors(graph, taskIndex, resources.mDescSetLayout[0]);
-    mDescriptorManager.writeDescriptors(graph, taskIndex, descriptorSets[0]);
 
     cmdBuffer.bindDescriptorSets(bindPoint, resources.mPipelineTemplate->getLayoutHandle(), 0, descriptorSets.size(), descriptorSets.data(), 0, nullptr);
 }
@@ -86,7 +94,7 @@ void VulkanCommandContext::setupState(const RenderGraph& graph, uint32_t taskInd
 
 Executor* VulkanCommandContext::allocateExecutor(const bool timeStamp)
 {
-    mActiveQuery = timeStamp;
+    mActiveQuery = timeStamp && (mTimeStamps.size() + 2) <= kMaxTimestamps;
     Executor* exec = nullptr;
 
     if(!mFreeExecutors.empty())
@@ -163,6 +171,7 @@ void VulkanCommandContext::reset()
     mDescriptorManager.reset();
 
     mTimeStamps.clear();
+    clearTimestampNames();
     mShouldSubmit = false;
 
     mMaxSemaphoreRead = ~0ULL;
@@ -23,6 +23,11 @@ public:
 
     vk::CommandBuffer getPrefixCommandBuffer();
 
+    void clearDescriptorCache()
+    {
+        mDescriptorManager.clearCache();
+    }
+
     uint64_t getSemaphoreSignalRead() const
     {
         return mMaxSemaphoreRead;
@@ -18,6 +18,7 @@ VulkanExecutor::VulkanExecutor(RenderDevice *dev, vk::CommandBuffer cmdBuffer) :
     vk::Instance inst = static_cast<VulkanRenderDevice*>(getDevice())->getParentInstance();
     mBeginConditionalRenderingFPtr = reinterpret_cast<PFN_vkCmdBeginConditionalRenderingEXT>(inst.getProcAddr("vkCmdBeginConditionalRenderingEXT"));
     mEndConditionalRenderingFPtr = reinterpret_cast<PFN_vkCmdEndConditionalRenderingEXT>(inst.getProcAddr("vkCmdEndConditionalRenderingEXT"));
+    mDrawIndexedIndirectCountFPtr = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(inst.getProcAddr("vkCmdDrawIndexedIndirectCountKHR"));
 }
 
 
@@ -65,6 +66,21 @@ void VulkanExecutor::indexedIndirectDraw(const uint32_t drawCalls, const BufferV
 }
 
 
+void VulkanExecutor::indexedIndirectDrawCount(const uint32_t maxDrawCalls, const BufferView& drawCommands, const uint32_t firstDrawCall,
+                                              const BufferView& count, const uint32_t countIndex)
+{
+    const VulkanBufferView& VKDrawBuffer = static_cast<const VulkanBufferView&>(*drawCommands.getBase());
+    const VulkanBufferView& VKCountBuffer = static_cast<const VulkanBufferView&>(*count.getBase());
+
+    BELL_ASSERT(mDrawIndexedIndirectCountFPtr, "Unable to find function ptr")
+    mDrawIndexedIndirectCountFPtr(mCommandBuffer,
+                                  VKDrawBuffer.getBuffer(), drawCommands->getOffset() + (firstDrawCall * sizeof(vk::DrawIndexedIndirectCommand)),
+                                  VKCountBuffer.getBuffer(), count->getOffset() + (countIndex * sizeof(uint32_t)),
+                                  maxDrawCalls, sizeof(vk::DrawIndexedIndirectCommand));
+    ++mRecordedCommands;
+}
+
+
 void VulkanExecutor::insertPushConstant(const void *val, const size_t size)
 {
     BELL_ASSERT(size <= 128, "Max push constants size exceeded")
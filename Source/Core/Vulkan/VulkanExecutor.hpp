@@ -27,6 +27,9 @@ public:
 
 	virtual void indexedIndirectDraw(const uint32_t drawCalls, const BufferView&) override;
 
+    virtual void indexedIndirectDrawCount(const uint32_t maxDrawCalls, const BufferView& drawCommands, const uint32_t firstDrawCall,
+                                          const BufferView& count, const uint32_t countIndex) override;
+
     virtual void insertPushConstant(const void* val, const size_t size) override;
 
 	virtual void dispatch(const uint32_t x, const uint32_t y, const uint32_t z) override;
@@ -94,6 +97,7 @@ private:
 
     PFN_vkCmdBeginConditionalRenderingEXT mBeginConditionalRenderingFPtr;
     PFN_vkCmdEndConditionalRenderingEXT   mEndConditionalRenderingFPtr;
+    PFN_vkCmdDrawIndexedIndirectCountKHR  mDrawIndexedIndirectCountFPtr;
 
     uint64_t mMaxSemaphoreReadSignal;
     uint64_t mMaxSemaphoreWriteSignal;
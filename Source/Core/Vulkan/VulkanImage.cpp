@@ -125,10 +125,7 @@ void VulkanImage::setContents(const void* data,
 {
 	VulkanRenderDevice* device = static_cast<VulkanRenderDevice*>(getDevice());
 
-    const uint32_t size = xsize * ysize * zsize * getPixelSize(mFormat);
-    VulkanBuffer stagingBuffer(getDevice(), BufferUsage::TransferSrc, size, 1, "Staging Buffer");
-
-	stagingBuffer.setContents(data, size, 0);
+    const uint32_t size = getImageDataSize(mFormat, xsize, ysize, zsize);
 
     vk::BufferImageCopy copyInfo{};
     copyInfo.setBufferOffset(0);
@@ -137,51 +134,15 @@ void VulkanImage::setContents(const void* data,
 
 	copyInfo.setImageSubresource({vk::ImageAspectFlagBits::eColor, lod, level, 1});
 
-    copyInfo.setImageOffset({offsetx, offsety, offsetz}); // copy to the VulkanImage starting at the start (0, 0, 0)
-	ImageExtent ex = getExtent(level, lod);
-	vk::Extent3D extent{ ex.width, ex.height, ex.depth };
+    copyInfo.setImageOffset({offsetx, offsety, offsetz});
+	vk::Extent3D extent{ xsize, ysize, zsize };
     copyInfo.setImageExtent(extent);
 
-    auto CmdBuffer = device->getPrefixCommandBuffer();
-
-	{
-		vk::ImageMemoryBarrier barrier{};
-		barrier.setSrcAccessMask(vk::AccessFlagBits::eMemoryRead);
-		barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
-		barrier.setOldLayout(getVulkanImageLayout(getLayout(level, lod)));
-		barrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
-		barrier.setSubresourceRange({ vk::ImageAspectFlagBits::eColor, lod, 1, level, 1 });
-		barrier.setImage(mImage);
-
-
-		CmdBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer,
-				vk::DependencyFlagBits::eByRegion, {}, {}, { barrier });
-	}
-
-		CmdBuffer.copyBufferToImage(stagingBuffer.getBuffer(),
-                                    getImage(),
-                                    vk::ImageLayout::eTransferDstOptimal,
-                                    copyInfo);
-
-	{
-		vk::ImageMemoryBarrier barrier{};
-		barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
-		barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
-		barrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal);
-		barrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
-		barrier.setSubresourceRange({ vk::ImageAspectFlagBits::eColor, lod, 1, level, 1 });
-		barrier.setImage(mImage);
-
-
-		CmdBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eVertexShader,
-			vk::DependencyFlagBits::eByRegion, {}, {}, { barrier });
-	}
+    // The staging ring records the layout transitions around the copy.
+    device->getStagingRing()->uploadToImage(mImage, getVulkanImageLayout(getLayout(level, lod)), data, size, copyInfo);
 
 	(*mSubResourceInfo)[(level * mNumberOfMips) + lod].mLayout = ImageLayout::Sampled;
 
-    // Maybe try to implement a staging buffer cache so that we don't have to create one
-    // each time.
-    stagingBuffer.updateLastAccessed();
     updateLastAccessed();
 }
 
@@ -15,6 +15,9 @@
 
 #include <vulkan/vulkan.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <limits>
 #include <memory>
 #include <vector>
@@ -63,6 +66,7 @@ VulkanRenderDevice::VulkanRenderDevice(vk::Instance instance,
     mFrameFinished.reserve(mSwapChain->getNumberOfSwapChainImages());
     mGraphicsCommandContexts.resize(mSwapChain->getNumberOfSwapChainImages());
     mAsyncComputeCommandContexts.resize(mSwapChain->getNumberOfSwapChainImages());
+    mDestroyedDescriptorHandles.resize(mSwapChain->getNumberOfSwapChainImages());
     for (uint32_t i = 0; i < mSwapChain->getNumberOfSwapChainImages(); ++i)
     {
         mFrameFinished.push_back(createFence(true));
@@ -75,12 +79,24 @@ VulkanRenderDevice::VulkanRenderDevice(vk::Instance instance,
 
     // Check for conditional rendering support.
     vk::PhysicalDeviceConditionalRenderingFeaturesEXT conditionalRenderingInfo{};
+    vk::PhysicalDeviceShaderDrawParametersFeatures drawParametersInfo{};
+    conditionalRenderingInfo.pNext = &drawParametersInfo;
     vk::PhysicalDeviceFeatures2 features2{};
     features2.pNext = &conditionalRenderingInfo;
     mPhysicalDevice.getFeatures2(&features2);
     if(conditionalRenderingInfo.conditionalRendering == true)
         mHasConditionalRenderingSupport = true;
 
+    // GPU driven rendering also needs the draw parameters and indirect first instance, which are enabled where available.
+    const auto deviceExtensions = mPhysicalDevice.enumerateDeviceExtensionProperties();
+    const bool hasDrawIndirectCount = std::any_of(deviceExtensions.begin(), deviceExtensions.end(), [](const vk::ExtensionProperties& extension)
+    {
+        return strcmp(extension.extensionName, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME) == 0;
+    });
+    const vk::PhysicalDeviceFeatures features = mPhysicalDevice.getFeatures();
+    mHasIndirectDrawCountSupport = hasDrawIndirectCount && features.multiDrawIndirect && features.drawIndirectFirstInstance &&
+                                   drawParametersInfo.shaderDrawParameters;
+
     // Create semaphores for synchronising with ansyn compute queue.
     if(getHasAsyncComputeSupport())
     {
@@ -96,6 +112,8 @@ VulkanRenderDevice::VulkanRenderDevice(vk::Instance instance,
             mAsyncQueueSemaphores.push_back(mDevice.createSemaphore(createInfo));
         }
     }
+
+    mStagingRing = std::make_unique<VulkanStagingRing>(this, kStagingRingSize);
 }
 
 
@@ -103,6 +121,9 @@ VulkanRenderDevice::~VulkanRenderDevice()
 {
 	flushWait();
 
+    // Adds the ring and any overflow buffers to the deferred destruction queue.
+    mStagingRing.reset();
+
     // destroy the swapchain first so that is can add it's image views to the deferred destruction queue.
     mSwapChain->destroy();
 	delete mSwapChain;
@@ -119,39 +140,13 @@ VulkanRenderDevice::~VulkanRenderDevice()
             delete context;
     }
 
-    // We can ignore lastUsed as we have just waited till all work has finished.
-    for(auto& [lastUsed, handle, memory] : mImagesPendingDestruction)
-    {
-        mDevice.destroyImage(handle);
-		mMemoryManager.Free(memory);
-    }
-    mImagesPendingDestruction.clear();
-
-    for (const auto& [lastyUSed, view, cubeView] : mImageViewsPendingDestruction)
-	{
-		mDevice.destroyImageView(view);
-        if(cubeView != vk::ImageView{nullptr})
-            mDevice.destroyImageView(cubeView);
-	}
-	mImageViewsPendingDestruction.clear();
-
-    for(auto& [lastUsed, handle, memory] : mBuffersPendingDestruction)
-    {
-        mDevice.destroyBuffer(handle);
-        mMemoryManager.Free(memory);
-    }
-    mBuffersPendingDestruction.clear();
-
-    for(auto& [imageViews, frameBuffer] : mFrameBufferCache)
+    mFrameBufferCache.clear([this](vk::Framebuffer frameBuffer, const uint64_t lastUsed)
     {
-            mDevice.destroyFramebuffer(frameBuffer);
-    }
-    mFrameBufferCache.clear();
+        destroyFrameBuffer(frameBuffer, lastUsed);
+    });
 
-	for(const auto& [lastUsed, frameBuffer] : mFramebuffersPendingDestruction)
-    {
-        mDevice.destroyFramebuffer(frameBuffer);
-    }
+    // We can ignore lastUsed as we have just waited till all work has finished.
+    clearDeferredResources(true);
 
     mMemoryManager.Destroy();
 
@@ -166,27 +161,15 @@ VulkanRenderDevice::~VulkanRenderDevice()
     }
     mVulkanResources.clear();
 
-	for (auto& [submission, pool, layout, set] : mSRSPendingDestruction)
-	{
-		mDevice.destroyDescriptorSetLayout(layout);
-	}
-	mSRSPendingDestruction.clear();
-
-    for(auto& [submission, handle] : mAccelerationStructuresPendingDestruction)
-    {
-        mDevice.destroyAccelerationStructureKHR(handle);
-    }
-    mAccelerationStructuresPendingDestruction.clear();
-
     for(auto& fence : mFrameFinished)
     {
         mDevice.destroyFence(fence);
     }
 
-    for(auto& [samplerType, sampler] : mImmutableSamplerCache)
+    mImmutableSamplerCache.clear([this](vk::Sampler sampler, const uint64_t)
     {
         mDevice.destroySampler(sampler);
-    }
+    });
 
 #ifndef NDEBUG
     mDevice.destroyEvent(mDebugEvent);
@@ -206,6 +189,10 @@ CommandContextBase* VulkanRenderDevice::getCommandContext(const uint32_t index,
         }
     }
 
+    // Record any queued uploads before work that may depend on them.
+    if(index == 0 && queue == QueueType::Graphics && mStagingRing)
+        mStagingRing->flush(static_cast<VulkanCommandContext*>(frameContexts[0])->getPrefixCommandBuffer());
+
     return frameContexts[index];
 }
 
@@ -423,12 +410,14 @@ vk::RenderPass	VulkanRenderDevice::generateRenderPass(const GraphicsTask& task)
 
 
 template<typename B>
-vk::DescriptorSetLayout VulkanRenderDevice::generateDescriptorSetLayoutBindings(const std::vector<B>& bindings, const TaskType taskType)
+vk::DescriptorSetLayout VulkanRenderDevice::generateDescriptorSetLayoutBindings(const std::vector<B>& bindings, const TaskType taskType, const bool updateAfterBind)
 {
     PROFILER_EVENT();
 
 	std::vector<vk::DescriptorSetLayoutBinding> layoutBindings{};
 	layoutBindings.reserve(bindings.size());
+    std::vector<vk::DescriptorBindingFlags> bindingFlags{};
+    bindingFlags.reserve(bindings.size());
 
 	uint32_t currentBinding = 0;
 
@@ -502,12 +491,28 @@ vk::DescriptorSetLayout VulkanRenderDevice::generateDescriptorSetLayoutBindings(
 		layoutBinding.setStageFlags(stages);
 
 		layoutBindings.push_back(layoutBinding);
+
+        // Only image arrays can be written after binding, the elements that are unused can be left unwritten.
+        if(updateAfterBind && type == AttachmentType::TextureArray)
+            bindingFlags.push_back(vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateAfterBind |
+                                   vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending);
+        else
+            bindingFlags.push_back(vk::DescriptorBindingFlags{});
 	}
 
 	vk::DescriptorSetLayoutCreateInfo descSetLayoutInfo{};
 	descSetLayoutInfo.setPBindings(layoutBindings.data());
 	descSetLayoutInfo.setBindingCount(static_cast<uint32_t>(layoutBindings.size()));
 
+    vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    if(updateAfterBind)
+    {
+        bindingFlagsInfo.setBindingCount(static_cast<uint32_t>(bindingFlags.size()));
+        bindingFlagsInfo.setPBindingFlags(bindingFlags.data());
+        descSetLayoutInfo.setFlags(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool);
+        descSetLayoutInfo.setPNext(&bindingFlagsInfo);
+    }
+
 	return  mDevice.createDescriptorSetLayout(descSetLayoutInfo);
 }
 
@@ -645,33 +650,31 @@ vk::Framebuffer VulkanRenderDevice::createFrameBuffer(const RenderGraph& graph,
     const GraphicsPipelineDescription& pipelineDesc = task.getPipelineDescription();
     const auto& outputBindings = task.getOuputAttachments();
 
-    std::vector<vk::ImageView> imageViews{};
-    ImageExtent imageExtent = {pipelineDesc.mViewport.x, pipelineDesc.mViewport.y, 1u};
+    FrameBufferKey key{};
+    key.mRenderPass = renderPass;
+    key.mWidth = pipelineDesc.mViewport.x;
+    key.mHeight = pipelineDesc.mViewport.y;
+    key.mAttachmentCount = 0;
 
+    BELL_ASSERT(outputBindings.size() <= FrameBufferKey::kMaxAttachments, "Too many framebuffer attachments")
     for(const auto& bindingInfo : outputBindings)
     {
             const auto& imageView = graph.getImageView(bindingInfo.mName);
-            imageViews.push_back(static_cast<const VulkanImageView&>(*imageView.getBase()).getImageView());
+            key.mAttachments[key.mAttachmentCount++] = static_cast<const VulkanImageView&>(*imageView.getBase()).getImageView();
     }
 
-    if(mFrameBufferCache.find(imageViews) != mFrameBufferCache.end())
+    return mFrameBufferCache.get(key, getCurrentSubmissionIndex(), [&]()
     {
-        return mFrameBufferCache[imageViews];
-    }
-
-    vk::FramebufferCreateInfo info{};
-    info.setRenderPass(renderPass);
-    info.setAttachmentCount(static_cast<uint32_t>(imageViews.size()));
-    info.setPAttachments(imageViews.data());
-    info.setWidth(imageExtent.width);
-    info.setHeight(imageExtent.height);
-    info.setLayers(imageExtent.depth);
-
-    vk::Framebuffer newFrameBuffer =  mDevice.createFramebuffer(info);
-
-    mFrameBufferCache.insert({imageViews, newFrameBuffer});
-
-    return newFrameBuffer;
+        vk::FramebufferCreateInfo info{};
+        info.setRenderPass(renderPass);
+        info.setAttachmentCount(key.mAttachmentCount);
+        info.setPAttachments(key.mAttachments.data());
+        info.setWidth(key.mWidth);
+        info.setHeight(key.mHeight);
+        info.setLayers(1);
+
+        return mDevice.createFramebuffer(info);
+    });
 }
 
 
@@ -708,11 +711,15 @@ vk::Sampler VulkanRenderDevice::getImmutableSampler(const Sampler& samplerDesc)
 {
     PROFILER_EVENT();
 
-    vk::Sampler sampler = mImmutableSamplerCache[samplerDesc];
+    return mImmutableSamplerCache.get(samplerDesc, getCurrentSubmissionIndex(), [&]()
+    {
+        return createImmutableSampler(samplerDesc);
+    });
+}
 
-    if(sampler != vk::Sampler(nullptr))
-        return sampler;
 
+vk::Sampler VulkanRenderDevice::createImmutableSampler(const Sampler& samplerDesc)
+{
     const vk::Filter filterMode = [&samplerDesc]()
     {
         switch(samplerDesc.getSamplerType())
@@ -762,10 +769,7 @@ vk::Sampler VulkanRenderDevice::getImmutableSampler(const Sampler& samplerDesc)
     info.setMinLod(0.0f);
     info.setMaxLod(16.0f);
 
-    sampler =  createSampler(info);
-    mImmutableSamplerCache[samplerDesc] = sampler;
-
-    return sampler;
+    return createSampler(info);
 }
 
 
@@ -774,28 +778,41 @@ void VulkanRenderDevice::startFrame()
     PROFILER_EVENT();
 
     frameSyncSetup();
+    // Destroy resources before the contexts reset, so their cached descriptor sets see what was destroyed.
+    clearDeferredResources();
     // update timestampts.
     mFinishedTimeStamps.clear();
-    for(CommandContextBase* context : mGraphicsCommandContexts[mCurrentFrameIndex])
+    auto resolveTimestamps = [this](CommandContextBase* context)
     {
         const std::vector<uint64_t>& timeStamps = context->getTimestamps();
-        uint32_t i = 0;
-        while(i < timeStamps.size())
+        for(uint32_t i = 0; (i + 1) < timeStamps.size(); i += 2)
         {
-            const uint64_t start = timeStamps[i++];
-            const uint64_t end = timeStamps[i++];
+            const uint64_t start = timeStamps[i];
+            const uint64_t end = timeStamps[i + 1];
 
-            const uint64_t duration = end - start;
-            mFinishedTimeStamps.push_back(duration);
+            mFinishedTimeStamps.push_back({context->getTimestampName(i / 2), end - start});
         }
         context->reset();
+    };
+    for(CommandContextBase* context : mGraphicsCommandContexts[mCurrentFrameIndex])
+    {
+        resolveTimestamps(context);
     }
     for (CommandContextBase* context : mAsyncComputeCommandContexts[mCurrentFrameIndex])
     {
-        context->reset();
+        resolveTimestamps(context);
     }
-    clearDeferredResources();
     mPermanentDescriptorManager.reset();
+    mDestroyedDescriptorHandles[mCurrentFrameIndex].clear();
+
+    // Framebuffers for passes that have been disabled or resized away from.
+    if(mCurrentSubmission > kFrameBufferRetention)
+    {
+        mFrameBufferCache.evictUnused(mCurrentSubmission - kFrameBufferRetention, [this](vk::Framebuffer frameBuffer, const uint64_t lastUsed)
+        {
+            destroyFrameBuffer(frameBuffer, lastUsed);
+        });
+    }
     ++mCurrentSubmission;
     ++mFinishedSubmission;
     mSubmissionCount = 0;
@@ -812,6 +829,9 @@ void VulkanRenderDevice::submitContext(CommandContextBase *context, const bool f
     PROFILER_EVENT();
 
     vk::CommandBuffer primaryCmdBuffer = static_cast<VulkanCommandContext*>(context)->getPrefixCommandBuffer();
+    // Catch any uploads queued whilst the first context was being recorded.
+    if(context == mGraphicsCommandContexts[mCurrentFrameIndex][0])
+        mStagingRing->flush(primaryCmdBuffer);
     primaryCmdBuffer.end();
 
     const VulkanSwapChain* swapChain = static_cast<VulkanSwapChain*>(mSwapChain);
@@ -889,95 +909,113 @@ void VulkanRenderDevice::frameSyncSetup()
 }
 
 
-void VulkanRenderDevice::clearDeferredResources()
+void VulkanRenderDevice::clearDeferredResources(const bool destroyAll)
 {
     PROFILER_EVENT();
 
-    for(uint32_t i = 0; i < mFramebuffersPendingDestruction.size(); ++i)
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<vk::ImageView> destroyedViews{};
+
+    uint32_t destroyedCount = 0;
+    while(!mRetiredObjects.empty())
     {
-        auto& [submission, frameBuffer] = mFramebuffersPendingDestruction.front();
+        const RetiredObject& object = mRetiredObjects.top();
 
-        if(submission <= mFinishedSubmission)
+        if(!destroyAll)
         {
-            mDevice.destroyFramebuffer(frameBuffer);
-            mFramebuffersPendingDestruction.pop_front();
+            if(object.mLastUsed > mFinishedSubmission)
+                break;
+
+            // Only check the time every few objects, most are very cheap to destroy.
+            if(destroyedCount >= kMinRetiredObjectsPerFrame && (destroyedCount % 16) == 0)
+            {
+                const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+                if(static_cast<uint64_t>(elapsed.count()) >= kRetirementBudgetMicroSeconds)
+                    break;
+            }
         }
-        else
-            break;
+
+        destroyRetiredObject(object, destroyedViews);
+        mRetiredObjects.pop();
+        ++destroyedCount;
     }
 
-    for(uint32_t i = 0; i < mImagesPendingDestruction.size(); ++i)
+    if(!mRetiredAllocations.empty())
     {
-        const auto& [submission, image, memory] = mImagesPendingDestruction.front();
+        mMemoryManager.Free(mRetiredAllocations);
+        mRetiredAllocations.clear();
+    }
 
-        if(submission <= mFinishedSubmission)
+    // The views handles may be reused, so framebuffers created with them can't be.
+    if(!destroyedViews.empty())
+    {
+        mFrameBufferCache.evictIf([&destroyedViews](const FrameBufferKey& key, const uint64_t)
         {
-            destroyImage(image);
-            getMemoryManager()->Free(memory);
-            mImagesPendingDestruction.pop_front();
-        }
-        else
-            break;
+            return std::any_of(key.mAttachments.begin(), key.mAttachments.begin() + key.mAttachmentCount, [&destroyedViews](const vk::ImageView view)
+            {
+                return std::find(destroyedViews.begin(), destroyedViews.end(), view) != destroyedViews.end();
+            });
+        },
+        [this](vk::Framebuffer frameBuffer, const uint64_t lastUsed)
+        {
+            destroyFrameBuffer(frameBuffer, lastUsed);
+        });
     }
+}
 
-	for (uint32_t i = 0; i < mImageViewsPendingDestruction.size(); ++i)
-	{
-        const auto& [submission, view, cubeView] = mImageViewsPendingDestruction.front();
-
-		if (submission <= mFinishedSubmission)
-		{
-			mDevice.destroyImageView(view);
-            if(cubeView != vk::ImageView{nullptr})
-                mDevice.destroyImageView(cubeView);
-			mImageViewsPendingDestruction.pop_front();
-		}
-		else
-			break;
-	}
 
-    for(uint32_t i = 0; i < mBuffersPendingDestruction.size(); ++i)
+void VulkanRenderDevice::destroyRetiredObject(const RetiredObject& object, std::vector<vk::ImageView>& destroyedViews)
+{
+    switch(object.mType)
     {
-        const auto& [submission, buffer, memory] = mBuffersPendingDestruction.front();
+        case RetiredObject::Type::FrameBuffer:
+            mDevice.destroyFramebuffer(object.mFrameBuffer);
+            break;
 
-        if(submission <= mFinishedSubmission)
-        {
-            destroyBuffer(buffer);
-            getMemoryManager()->Free(memory);
-            mBuffersPendingDestruction.pop_front();
-        }
-        else
+        case RetiredObject::Type::Image:
+            destroyImage(object.mImage);
+            mRetiredAllocations.push_back(object.mMemory);
             break;
-    }
 
-	for (uint32_t i = 0; i < mSRSPendingDestruction.size(); ++i)
-	{
-		auto& [submission, pool, layout, set] = mSRSPendingDestruction.front();
+        case RetiredObject::Type::ImageView:
+            retireDescriptorHandle(reinterpret_cast<uint64_t>(VkImageView(object.mImageView)));
+            destroyedViews.push_back(object.mImageView);
+            mDevice.destroyImageView(object.mImageView);
+            if(object.mCubeMapImageView != vk::ImageView{nullptr})
+            {
+                retireDescriptorHandle(reinterpret_cast<uint64_t>(VkImageView(object.mCubeMapImageView)));
+                mDevice.destroyImageView(object.mCubeMapImageView);
+            }
+            break;
 
-		if (submission <= mFinishedSubmission)
-		{
-			mDevice.destroyDescriptorSetLayout(layout);
-            mDevice.freeDescriptorSets(pool, 1, &set);
-			mSRSPendingDestruction.pop_front();
-		}
-		else
-			break;
-	}
+        case RetiredObject::Type::Buffer:
+            retireDescriptorHandle(reinterpret_cast<uint64_t>(VkBuffer(object.mBuffer)));
+            destroyBuffer(object.mBuffer);
+            mRetiredAllocations.push_back(object.mMemory);
+            break;
 
-    for (uint32_t i = 0; i < mAccelerationStructuresPendingDestruction.size(); ++i)
-    {
-        auto& [submission, handle] = mAccelerationStructuresPendingDestruction.front();
+        case RetiredObject::Type::ShaderResourceSet:
+            mDevice.destroyDescriptorSetLayout(object.mDescriptorSetLayout);
+            mDevice.freeDescriptorSets(object.mDescriptorPool, 1, &object.mDescriptorSet);
+            break;
 
-        if (submission <= mFinishedSubmission)
-        {
-            mDevice.destroyAccelerationStructureKHR(handle);
-            mAccelerationStructuresPendingDestruction.pop_front();
-        }
-        else
+        case RetiredObject::Type::AccelerationStructure:
+            retireDescriptorHandle(reinterpret_cast<uint64_t>(VkAccelerationStructureKHR(object.mAccelerationStructure)));
+            mDevice.destroyAccelerationStructureKHR(object.mAccelerationStructure);
             break;
     }
 }
 
 
+void VulkanRenderDevice::retireDescriptorHandle(const uint64_t handle)
+{
+    for(auto& destroyedHandles : mDestroyedDescriptorHandles)
+    {
+        destroyedHandles.push_back(handle);
+    }
+}
+
+
 void VulkanRenderDevice::setDebugName(const std::string& name, const uint64_t handle, const uint64_t objectType)
 {
     VkDebugUtilsObjectNameInfoEXT lableInfo{};
@@ -1002,6 +1040,16 @@ void VulkanRenderDevice::invalidatePipelines()
 
     mDevice.waitIdle();
 
+    // The layouts cached sets were allocated with are about to be destroyed.
+    for(auto& frameContexts : {&mGraphicsCommandContexts, &mAsyncComputeCommandContexts})
+    {
+        for(auto& contexts : *frameContexts)
+        {
+            for(CommandContextBase* context : contexts)
+                static_cast<VulkanCommandContext*>(context)->clearDescriptorCache();
+        }
+    }
+
     for(auto& [hash, handles] : mVulkanResources)
     {
         mDevice.destroyPipelineLayout(handles.mPipelineTemplate->getLayoutHandle());
@@ -1013,11 +1061,10 @@ void VulkanRenderDevice::invalidatePipelines()
     }
     mVulkanResources.clear();
 
-    for(auto& [imageViews, frameBuffer] : mFrameBufferCache)
+    mFrameBufferCache.clear([this](vk::Framebuffer frameBuffer, const uint64_t lastUsed)
     {
-        destroyFrameBuffer(frameBuffer, mCurrentSubmission);
-        mFrameBufferCache.erase(imageViews);
-    }
+        destroyFrameBuffer(frameBuffer, lastUsed);
+    });
 }
 
 
@@ -1096,4 +1143,4 @@ void    VulkanRenderDevice::bindImageMemory(vk::Image& image, vk::DeviceMemory m
 
 
 template
-vk::DescriptorSetLayout VulkanRenderDevice::generateDescriptorSetLayoutBindings(const std::vector<ShaderResourceSetBase::ResourceInfo>&, const TaskType);
+vk::DescriptorSetLayout VulkanRenderDevice::generateDescriptorSetLayoutBindings(const std::vector<ShaderResourceSetBase::ResourceInfo>&, const TaskType, const bool);
@@ -1,9 +1,11 @@
 #ifndef VK_RENDERDEVICE_HPP
 #define VK_RENDERDEVICE_HPP
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <queue>
 #include <unordered_map>
 #include <unordered_map>
 #include <vector>
@@ -11,6 +13,8 @@
 #include <vulkan/vulkan.hpp>
 
 #include "Core/Profiling.hpp"
+#include "Core/ObjectCache.hpp"
+#include "Core/HashUtils.hpp"
 #include "Core/RenderDevice.hpp"
 #include "Core/BarrierManager.hpp"
 #include "MemoryManager.hpp"
@@ -22,6 +26,7 @@
 #include "VulkanPipeline.hpp"
 #include "VulkanBuffer.hpp"
 #include "VulkanImage.hpp"
+#include "VulkanStagingRing.hpp"
 #include "VulkanSwapChain.hpp"
 #include "VulkanRenderInstance.hpp"
 #include "VulkanAccelerationStructures.hpp"
@@ -55,6 +60,40 @@ struct vulkanResources
 };
 
 
+// Framebuffers can be used with any render pass compatible with the one they were created with, keying on the
+// pass a task was compiled with keeps that trivially true.
+struct FrameBufferKey
+{
+    static constexpr uint32_t kMaxAttachments = 10;
+
+    vk::RenderPass mRenderPass;
+    uint32_t mWidth;
+    uint32_t mHeight;
+    uint32_t mAttachmentCount;
+    std::array<vk::ImageView, kMaxAttachments> mAttachments;
+
+    bool operator==(const FrameBufferKey& other) const
+    {
+        return mRenderPass == other.mRenderPass && mWidth == other.mWidth && mHeight == other.mHeight &&
+                mAttachmentCount == other.mAttachmentCount &&
+                std::equal(mAttachments.begin(), mAttachments.begin() + mAttachmentCount, other.mAttachments.begin());
+    }
+};
+
+struct FrameBufferKeyHasher
+{
+    size_t operator()(const FrameBufferKey& key) const
+    {
+        size_t hash = 0;
+        hash_combine(hash, reinterpret_cast<uint64_t>(VkRenderPass(key.mRenderPass)), key.mWidth, key.mHeight);
+        for(uint32_t i = 0; i < key.mAttachmentCount; ++i)
+            hash_combine(hash, reinterpret_cast<uint64_t>(VkImageView(key.mAttachments[i])));
+
+        return hash;
+    }
+};
+
+
 struct GraphicsPipelineHandles
 {
     std::shared_ptr<PipelineTemplate> mGraphicsPipelineTemplate;
@@ -103,12 +142,18 @@ public:
     virtual void                       destroyImage(ImageBase& image) override 
 	{	
 		VulkanImage& vkImg = static_cast<VulkanImage&>(image);
-		mImagesPendingDestruction.push_back({image.getLastAccessed(), vkImg.getImage(), vkImg.getMemory()});
+        RetiredObject object{RetiredObject::Type::Image, image.getLastAccessed()};
+        object.mImage = vkImg.getImage();
+        object.mMemory = vkImg.getMemory();
+        mRetiredObjects.push(object);
 	}
     virtual void                       destroyImageView(ImageViewBase& view) override
 	{
 		VulkanImageView& vkView = static_cast<VulkanImageView&>(view);
-        mImageViewsPendingDestruction.push_back({view.getLastAccessed(), vkView.getImageView(), vkView.getCubeMapImageView()});
+        RetiredObject object{RetiredObject::Type::ImageView, view.getLastAccessed()};
+        object.mImageView = vkView.getImageView();
+        object.mCubeMapImageView = vkView.getCubeMapImageView();
+        mRetiredObjects.push(object);
 	}
 
     vk::ImageView                      createImageView(const vk::ImageViewCreateInfo& info)
@@ -122,13 +167,20 @@ public:
     virtual void                       destroyBuffer(BufferBase& buffer) override
 	{ 
 		VulkanBuffer& vkBuffer = static_cast<VulkanBuffer&>(buffer);
-		mBuffersPendingDestruction.push_back({buffer.getLastAccessed(), vkBuffer.getBuffer(), vkBuffer.getMemory()});
+        RetiredObject object{RetiredObject::Type::Buffer, buffer.getLastAccessed()};
+        object.mBuffer = vkBuffer.getBuffer();
+        object.mMemory = vkBuffer.getMemory();
+        mRetiredObjects.push(object);
 	}
 
 	virtual void						destroyShaderResourceSet(const ShaderResourceSetBase& set) override
 	{ 
 		const VulkanShaderResourceSet& VkSRS = static_cast<const VulkanShaderResourceSet&>(set);
-		mSRSPendingDestruction.push_back({ set.getLastAccessed(), VkSRS.getPool(), VkSRS.getLayout(), VkSRS.getDescriptorSet() });
+        RetiredObject object{RetiredObject::Type::ShaderResourceSet, set.getLastAccessed()};
+        object.mDescriptorPool = VkSRS.getPool();
+        object.mDescriptorSetLayout = VkSRS.getLayout();
+        object.mDescriptorSet = VkSRS.getDescriptorSet();
+        mRetiredObjects.push(object);
 	}
 
 	vk::AccelerationStructureKHR createAccelerationStructure(const vk::AccelerationStructureCreateInfoKHR& info) const
@@ -139,12 +191,16 @@ public:
     virtual void                       destroyBottomLevelAccelerationStructure(BottomLevelAccelerationStructureBase& structure) override
     {
         VulkanBottomLevelAccelerationStructure& VKAccel = static_cast<VulkanBottomLevelAccelerationStructure&>(structure);
-        mAccelerationStructuresPendingDestruction.push_back({getCurrentSubmissionIndex(), VKAccel.getAccelerationStructureHandle()});
+        RetiredObject object{RetiredObject::Type::AccelerationStructure, getCurrentSubmissionIndex()};
+        object.mAccelerationStructure = VKAccel.getAccelerationStructureHandle();
+        mRetiredObjects.push(object);
     }
     virtual void                       destroyTopLevelAccelerationStructure(TopLevelAccelerationStructureBase& structure) override
     {
         VulkanTopLevelAccelerationStructure& VKAccel = static_cast<VulkanTopLevelAccelerationStructure&>(structure);
-        mAccelerationStructuresPendingDestruction.push_back({structure.getLastAccessed(), VKAccel.getAccelerationStructureHandle()});
+        RetiredObject object{RetiredObject::Type::AccelerationStructure, structure.getLastAccessed()};
+        object.mAccelerationStructure = VKAccel.getAccelerationStructureHandle();
+        mRetiredObjects.push(object);
     }
 
     void buildAccelerationStructure(const uint32_t count,
@@ -157,7 +213,11 @@ public:
     }
 
     void                               destroyFrameBuffer(vk::Framebuffer& frameBuffer, uint64_t frameIndex)
-                                            { mFramebuffersPendingDestruction.push_back({frameIndex, frameBuffer}); }
+    {
+        RetiredObject object{RetiredObject::Type::FrameBuffer, frameIndex};
+        object.mFrameBuffer = frameBuffer;
+        mRetiredObjects.push(object);
+    }
 
     void                              destroyPipeline(const vk::Pipeline pipeline)
                                             { mDevice.destroyPipeline(pipeline); }
@@ -172,12 +232,17 @@ public:
         return mHasConditionalRenderingSupport;
     }
 
+    virtual bool                        getHasIndirectDrawCountSupport() const override
+    {
+        return mHasIndirectDrawCountSupport;
+    }
+
     virtual bool                       getHasAsyncComputeSupport() const override
     {
         return mGraphicsQueue != mComputeQueue;
     }
 
-    virtual const std::vector<uint64_t>& getAvailableTimestamps() const override
+    virtual const std::vector<TaskTimestamp>& getAvailableTimestamps() const override
     {
         return mFinishedTimeStamps;
     }
@@ -222,6 +287,13 @@ public:
     std::vector<vk::DescriptorSet>     allocateDescriptorSet(const vk::DescriptorSetAllocateInfo& info)
                                             { return mDevice.allocateDescriptorSets(info); }
 
+    void                               freeDescriptorSet(const vk::DescriptorPool pool, const vk::DescriptorSet set)
+                                            { mDevice.freeDescriptorSets(pool, 1, &set); }
+
+    // Resources destroyed since the contexts for this frame were last reset, the handles may be reused.
+    const std::vector<uint64_t>&       getDestroyedDescriptorHandles() const
+                                            { return mDestroyedDescriptorHandles[getCurrentFrameIndex()]; }
+
     void                               writeDescriptorSets(std::vector<vk::WriteDescriptorSet>& writes)
                                             { mDevice.updateDescriptorSets(writes, {}); }
 
@@ -286,6 +358,7 @@ public:
     MemoryManager*                     getMemoryManager() { return &mMemoryManager; }
     vk::PhysicalDevice*                getPhysicalDevice() { return &mPhysicalDevice; }
     DescriptorManager*				   getDescriptorManager() { return &mPermanentDescriptorManager; }
+    VulkanStagingRing*                 getStagingRing() { return mStagingRing.get(); }
 
     // Only these two can do usefull work when const
     const vk::PhysicalDevice*                getPhysicalDevice() const { return &mPhysicalDevice; }
@@ -330,7 +403,7 @@ public:
     }
 
 	template<typename B>
-	vk::DescriptorSetLayout										generateDescriptorSetLayoutBindings(const std::vector<B>&, const TaskType type);
+	vk::DescriptorSetLayout										generateDescriptorSetLayoutBindings(const std::vector<B>&, const TaskType type, const bool updateAfterBind = false);
 
     vulkanResources                                             getTaskResources(const RenderGraph&, const RenderTask& task, const uint64_t prefixHash);
     vulkanResources                                             getTaskResources(const RenderGraph&, const uint32_t taskIndex, const uint64_t prefixHash);
@@ -389,7 +462,13 @@ private:
 
 	std::vector<vk::DescriptorSetLayout>						generateShaderResourceSetLayouts(const RenderTask&, const RenderGraph&);
 
-    void                                                        clearDeferredResources();
+    // Destroys the retired objects the GPU has finished with, or every one if destroyAll is set.
+    void                                                        clearDeferredResources(const bool destroyAll = false);
+    void                                                        destroyRetiredObject(const RetiredObject&, std::vector<vk::ImageView>& destroyedViews);
+
+    void                                                        retireDescriptorHandle(const uint64_t handle);
+
+    vk::Sampler                                                 createImmutableSampler(const Sampler&);
 
     void														frameSyncSetup();
 
@@ -413,52 +492,57 @@ public:
 private:
 #endif
 
-    std::deque<std::pair<uint64_t, vk::Framebuffer>> mFramebuffersPendingDestruction;
-
-    struct ImageDestructionInfo
+    // Objects waiting for the GPU to finish with them, ordered by the submission they were last used in.
+    struct RetiredObject
     {
+        enum class Type : uint8_t
+        {
+            FrameBuffer,
+            Image,
+            ImageView,
+            Buffer,
+            ShaderResourceSet,
+            AccelerationStructure
+        };
+
+        Type mType;
         uint64_t mLastUsed;
-        vk::Image mImageHandle;
-        Allocation mImageMemory;
-    };
-    std::deque<ImageDestructionInfo> mImagesPendingDestruction;
 
-	struct ImageViewDestructionInfo
-	{
-		uint64_t mLastUsed;
-		vk::ImageView mView;
-        vk::ImageView mCubeMapView;
-	};
-	std::deque<ImageViewDestructionInfo> mImageViewsPendingDestruction;
-
-    struct BufferDestructionInfo
-    {
-        uint64_t mLastUsed;
-        vk::Buffer mBufferHandle;
-        Allocation mBufferMemory;
+        // Only the handles for the type are set.
+        vk::Framebuffer mFrameBuffer{nullptr};
+        vk::Image mImage{nullptr};
+        vk::ImageView mImageView{nullptr};
+        vk::ImageView mCubeMapImageView{nullptr};
+        vk::Buffer mBuffer{nullptr};
+        vk::DescriptorPool mDescriptorPool{nullptr};
+        vk::DescriptorSetLayout mDescriptorSetLayout{nullptr};
+        vk::DescriptorSet mDescriptorSet{nullptr};
+        vk::AccelerationStructureKHR mAccelerationStructure{nullptr};
+        Allocation mMemory{};
     };
-    std::deque<BufferDestructionInfo> mBuffersPendingDestruction;
 
-	struct ShaderResourceSetsInfo
-	{
-		uint64_t mLastUsed;
-		vk::DescriptorPool mPool;
-		vk::DescriptorSetLayout mLayout;
-		vk::DescriptorSet mDescSet;
-	};
-	std::deque<ShaderResourceSetsInfo> mSRSPendingDestruction;
-
-	struct AccelerationStructureDestructionInfo
+    struct RetiredObjectOrder
     {
-	    uint64_t mLastused;
-	    vk::AccelerationStructureKHR mAccelerationStructure;
+        bool operator()(const RetiredObject& lhs, const RetiredObject& rhs) const
+        {
+            return lhs.mLastUsed > rhs.mLastUsed;
+        }
     };
-	std::deque<AccelerationStructureDestructionInfo> mAccelerationStructuresPendingDestruction;
+
+    // Objects destroyed per frame are time sliced, so unloading a scene or rebuilding the graph doesn't cause a hitch.
+    // At least kMinRetiredObjectsPerFrame are destroyed so the queue always drains.
+    static constexpr uint32_t kMinRetiredObjectsPerFrame = 64;
+    static constexpr uint64_t kRetirementBudgetMicroSeconds = 500;
+
+    std::priority_queue<RetiredObject, std::vector<RetiredObject>, RetiredObjectOrder> mRetiredObjects;
+    std::vector<Allocation> mRetiredAllocations;
 
     std::shared_mutex mResourcesLock;
     std::unordered_map<uint64_t, vulkanResources> mVulkanResources;
 
-    std::map<std::vector<vk::ImageView>, vk::Framebuffer> mFrameBufferCache;
+    // Framebuffers unused for this many submissions are destroyed.
+    static constexpr uint64_t kFrameBufferRetention = 16;
+    ObjectCache<FrameBufferKey, vk::Framebuffer, FrameBufferKeyHasher> mFrameBufferCache;
 
     // underlying devices
     vk::Device mDevice;
@@ -487,8 +571,9 @@ private:
 
     vk::PhysicalDeviceLimits mLimits;
     bool mHasConditionalRenderingSupport;
+    bool mHasIndirectDrawCountSupport;
 
-    std::unordered_map<Sampler, vk::Sampler> mImmutableSamplerCache;
+    ObjectCache<Sampler, vk::Sampler> mImmutableSamplerCache;
 
 	struct SwapChainInitializer
 	{
@@ -501,13 +586,20 @@ private:
     MemoryManager mMemoryManager;
     DescriptorManager mPermanentDescriptorManager;
 
+    // All uploads are staged through this, sized to cover a few frames worth of per frame data.
+    static constexpr uint32_t kStagingRingSize = 32 * 1024 * 1024;
+    std::unique_ptr<VulkanStagingRing> mStagingRing;
+
     std::vector<std::vector<CommandContextBase*>> mGraphicsCommandContexts;
     std::vector<std::vector<CommandContextBase*>> mAsyncComputeCommandContexts;
     uint32_t mSubmissionCount;
 
+    // Per frame index, cleared once that frames contexts have been reset.
+    std::vector<std::vector<uint64_t>> mDestroyedDescriptorHandles;
+
     std::vector<vk::Semaphore> mAsyncQueueSemaphores;
 
-    std::vector<uint64_t> mFinishedTimeStamps;
+    std::vector<TaskTimestamp> mFinishedTimeStamps;
 };
 
 #endif
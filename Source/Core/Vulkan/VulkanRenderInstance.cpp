@@ -25,7 +25,7 @@ static VKAPI_ATTR VkBool32 debugCallbackFunc(
         void*)
 {
 
-    BELL_LOG_ARGS("VALIDATION LAYER: %s", pCallbackData->pMessage)
+    BELL_LOG_WARNING(Device, "VALIDATION LAYER: %s", pCallbackData->pMessage)
 
 	BELL_TRAP;
 
@@ -215,7 +215,8 @@ std::pair<vk::PhysicalDevice, vk::Device> VulkanRenderInstance::findSuitableDevi
                                                               VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME
 															 };
 
-    std::vector<const char*> optionalDeviceExtensions = {VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME};
+    std::vector<const char*> optionalDeviceExtensions = {VK_EXT_CONDITIONAL_RENDERING_EXTENSION_NAME,
+                                                         VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME};
     if (rayTracingWanted) // Ray tracing using compute for now.
     {
         // extensions needed for ray tracing.
@@ -264,10 +265,18 @@ std::pair<vk::PhysicalDevice, vk::Device> VulkanRenderInstance::findSuitableDevi
     physicalFeatures.setShaderImageGatherExtended(true);
     physicalFeatures.setFillModeNonSolid(true);
     physicalFeatures.setFragmentStoresAndAtomics(true);
+    // Needed for GPU generated draws, which index their per draw data with the first instance.
+    const vk::PhysicalDeviceFeatures availableFeatures = physicalDevice.getFeatures();
+    physicalFeatures.setMultiDrawIndirect(availableFeatures.multiDrawIndirect);
+    physicalFeatures.setDrawIndirectFirstInstance(availableFeatures.drawIndirectFirstInstance);
 
 	vk::PhysicalDeviceDescriptorIndexingFeaturesEXT descriptorIndexingInfo{};
 	descriptorIndexingInfo.setShaderSampledImageArrayNonUniformIndexing(true);
 	descriptorIndexingInfo.setRuntimeDescriptorArray(true);
+    // Needed for the bindless material array, which is written whilst frames are in flight.
+    descriptorIndexingInfo.setDescriptorBindingPartiallyBound(true);
+    descriptorIndexingInfo.setDescriptorBindingSampledImageUpdateAfterBind(true);
+    descriptorIndexingInfo.setDescriptorBindingUpdateUnusedWhilePending(true);
 
     vk::PhysicalDeviceTimelineSemaphoreFeatures timeLineSepahmoreFeature{};
     timeLineSepahmoreFeature.setTimelineSemaphore(true);
@@ -286,6 +295,15 @@ std::pair<vk::PhysicalDevice, vk::Device> VulkanRenderInstance::findSuitableDevi
     rayPipelineFeature.rayTraversalPrimitiveCulling = rayTracingWanted;
     accelerationStructureFeature.setPNext(&rayPipelineFeature);
 
+    // Enabled if available, the query leaves the struct ready to chain.
+    vk::PhysicalDeviceShaderDrawParametersFeatures drawParametersFeature{};
+    {
+        vk::PhysicalDeviceFeatures2 availableFeatures2{};
+        availableFeatures2.pNext = &drawParametersFeature;
+        physicalDevice.getFeatures2(&availableFeatures2);
+    }
+    rayPipelineFeature.setPNext(&drawParametersFeature);
+
     descriptorIndexingInfo.setPNext(&timeLineSepahmoreFeature);
 
     vk::DeviceCreateInfo deviceInfo{};
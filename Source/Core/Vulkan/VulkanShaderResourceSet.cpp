@@ -4,6 +4,9 @@
 #include "VulkanImageView.hpp"
 #include "VulkanBufferView.hpp"
 #include "Core/Sampler.hpp"
+#include "Core/BellLogging.hpp"
+
+#include <algorithm>
 
 
 VulkanShaderResourceSet::VulkanShaderResourceSet(RenderDevice* dev, const uint32_t maxDescriptors) :
@@ -24,7 +27,7 @@ void VulkanShaderResourceSet::finalise()
 {
 	VulkanRenderDevice* device = static_cast<VulkanRenderDevice*>(getDevice());
 
-	mLayout = device->generateDescriptorSetLayoutBindings(mResources, TaskType::All);
+	mLayout = device->generateDescriptorSetLayoutBindings(mResources, TaskType::All, mUpdateAfterBind);
 
 	std::vector<WriteShaderResourceSet> writes{};
 	uint32_t binding = 0;
@@ -74,5 +77,35 @@ void VulkanShaderResourceSet::finalise()
 		++binding;
 	}
 
-    mDescSet = device->getDescriptorManager()->writeShaderResourceSet(mLayout, writes, mPool);
+    mDescSet = device->getDescriptorManager()->writeShaderResourceSet(mLayout, writes, mPool, mUpdateAfterBind);
+    // Everything has just been written.
+    mPendingElementUpdates.clear();
+}
+
+
+void VulkanShaderResourceSet::updateArrayElements()
+{
+    if(mPendingElementUpdates.empty())
+        return;
+
+    BELL_ASSERT(mDescSet != vk::DescriptorSet{nullptr}, "Set needs to be finalised before updating elements")
+
+    std::sort(mPendingElementUpdates.begin(), mPendingElementUpdates.end());
+    mPendingElementUpdates.erase(std::unique(mPendingElementUpdates.begin(), mPendingElementUpdates.end()), mPendingElementUpdates.end());
+
+    VulkanRenderDevice* device = static_cast<VulkanRenderDevice*>(getDevice());
+
+    std::vector<uint32_t> elements{};
+    for(uint32_t i = 0; i < mPendingElementUpdates.size();)
+    {
+        const uint32_t binding = mPendingElementUpdates[i].first;
+
+        elements.clear();
+        for(; i < mPendingElementUpdates.size() && mPendingElementUpdates[i].first == binding; ++i)
+            elements.push_back(mPendingElementUpdates[i].second);
+
+        device->getDescriptorManager()->writeImageArrayElements(mDescSet, binding, elements, mImageArrays[mResources[binding].mIndex].data());
+    }
+
+    mPendingElementUpdates.clear();
 }
@@ -17,6 +17,7 @@ public:
 	~VulkanShaderResourceSet();
 
 	virtual void finalise() override;
+	virtual void updateArrayElements() override;
 
 	vk::DescriptorSetLayout getLayout() const
 	{
@@ -0,0 +1,307 @@
+#include "VulkanStagingRing.hpp"
+#include "VulkanRenderDevice.hpp"
+#include "Core/BellLogging.hpp"
+#include "Core/Profiling.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+VulkanStagingRing::VulkanStagingRing(RenderDevice* dev, const uint32_t size) :
+    mDevice(dev),
+    mRingBuffer(dev, BufferUsage::TransferSrc, size, size, "Staging Ring"),
+    mBaseAddress(nullptr),
+    mSize(size),
+    mLock(),
+    mAllocatedTotal(0),
+    mReleasedTotal(0),
+    mFencedTotal(0),
+    mFences{},
+    mPendingBufferUploads{},
+    mPendingImageUploads{},
+    mOverflowUploads(0)
+{
+    BELL_ASSERT((size % kAlignment) == 0, "Staging ring size must be a multiple of the alignment")
+
+    // Host mappable memory is persistently mapped, so this stays valid for the lifetime of the ring.
+    MapInfo mapInfo{};
+    mapInfo.mOffset = 0;
+    mapInfo.mSize = size;
+    mBaseAddress = static_cast<unsigned char*>(mRingBuffer.map(mapInfo));
+}
+
+
+void VulkanStagingRing::uploadToBuffer(const vk::Buffer dst, const void* data, const uint32_t size, const uint32_t offset)
+{
+    std::unique_lock<std::mutex> lock(mLock);
+
+    StagingAllocation src = stage(lock, data, size);
+
+    vk::BufferCopy region{};
+    region.setSrcOffset(src.mOffset);
+    region.setDstOffset(offset);
+    region.setSize(size);
+
+    mPendingBufferUploads.push_back({std::move(src), dst, region});
+}
+
+
+void VulkanStagingRing::uploadToImage(const vk::Image dst, const vk::ImageLayout currentLayout, const void* data, const uint32_t size, const vk::BufferImageCopy& region)
+{
+    std::unique_lock<std::mutex> lock(mLock);
+
+    StagingAllocation src = stage(lock, data, size);
+
+    vk::BufferImageCopy copyInfo = region;
+    copyInfo.setBufferOffset(src.mOffset);
+
+    mPendingImageUploads.push_back({std::move(src), dst, currentLayout, copyInfo});
+}
+
+
+void VulkanStagingRing::recordUploadToBuffer(vk::CommandBuffer cmd, const vk::Buffer dst, const void* data, const uint32_t size, const uint32_t offset)
+{
+    StagingAllocation src{};
+    {
+        std::unique_lock<std::mutex> lock(mLock);
+        src = stage(lock, data, size);
+    }
+
+    vk::BufferCopy region{};
+    region.setSrcOffset(src.mOffset);
+    region.setDstOffset(offset);
+    region.setSize(size);
+
+    cmd.copyBuffer(src.mBuffer, dst, region);
+
+    // Ring space is fenced on the next flush, which is never before the submission this is recorded in.
+    if(src.mOverflowBuffer)
+        src.mOverflowBuffer->updateLastAccessed();
+}
+
+
+void VulkanStagingRing::flush(vk::CommandBuffer cmd)
+{
+    PROFILER_EVENT();
+
+    std::lock_guard<std::mutex> lock(mLock);
+
+    if(!mPendingBufferUploads.empty() || !mPendingImageUploads.empty())
+    {
+        // Transition every uploaded subresource once up front, and back again once all the copies are done.
+        std::vector<vk::ImageMemoryBarrier> toTransferDst;
+        std::vector<vk::ImageMemoryBarrier> toShaderRead;
+        for(const ImageUpload& upload : mPendingImageUploads)
+        {
+            const vk::ImageSubresourceLayers& layers = upload.mRegion.imageSubresource;
+            const vk::ImageSubresourceRange range{layers.aspectMask, layers.mipLevel, 1, layers.baseArrayLayer, layers.layerCount};
+
+            const bool seen = std::any_of(toTransferDst.begin(), toTransferDst.end(), [&](const vk::ImageMemoryBarrier& barrier)
+            {
+                return barrier.image == upload.mDst && barrier.subresourceRange == range;
+            });
+            if(seen)
+                continue;
+
+            vk::ImageMemoryBarrier barrier{};
+            barrier.setSrcAccessMask(vk::AccessFlagBits::eMemoryRead);
+            barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+            barrier.setOldLayout(upload.mCurrentLayout);
+            barrier.setNewLayout(vk::ImageLayout::eTransferDstOptimal);
+            barrier.setSubresourceRange(range);
+            barrier.setImage(upload.mDst);
+            toTransferDst.push_back(barrier);
+
+            barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+            barrier.setDstAccessMask(vk::AccessFlagBits::eShaderRead);
+            barrier.setOldLayout(vk::ImageLayout::eTransferDstOptimal);
+            barrier.setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+            toShaderRead.push_back(barrier);
+        }
+
+        if(!toTransferDst.empty())
+        {
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer,
+                                vk::DependencyFlags{}, {}, {}, toTransferDst);
+        }
+
+        // Copies that write the same range need a barrier between them, anything else can go in one batch.
+        struct WrittenRange
+        {
+            uint64_t mHandle;
+            uint64_t mBegin;
+            uint64_t mEnd;
+        };
+        std::vector<WrittenRange> written;
+        auto hazard = [&written](const uint64_t handle, const uint64_t begin, const uint64_t end)
+        {
+            const bool overlaps = std::any_of(written.begin(), written.end(), [=](const WrittenRange& range)
+            {
+                return range.mHandle == handle && range.mBegin < end && begin < range.mEnd;
+            });
+            if(overlaps)
+                written.clear();
+
+            written.push_back({handle, begin, end});
+
+            return overlaps;
+        };
+        auto transferBarrier = [cmd]()
+        {
+            vk::MemoryBarrier barrier{};
+            barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+            barrier.setDstAccessMask(vk::AccessFlagBits::eTransferWrite);
+
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
+                                vk::DependencyFlags{}, {barrier}, {}, {});
+        };
+
+        // Consecutive uploads to the same buffer are merged in to a single copy.
+        std::vector<vk::BufferCopy> regions;
+        vk::Buffer batchSrc = nullptr;
+        vk::Buffer batchDst = nullptr;
+        auto recordBufferBatch = [&]()
+        {
+            if(!regions.empty())
+                cmd.copyBuffer(batchSrc, batchDst, regions);
+
+            regions.clear();
+        };
+        for(const BufferUpload& upload : mPendingBufferUploads)
+        {
+            const uint64_t handle = reinterpret_cast<uint64_t>(VkBuffer(upload.mDst));
+            const bool overlaps = hazard(handle, upload.mRegion.dstOffset, upload.mRegion.dstOffset + upload.mRegion.size);
+            if(overlaps || upload.mSrc.mBuffer != batchSrc || upload.mDst != batchDst)
+                recordBufferBatch();
+
+            if(overlaps)
+                transferBarrier();
+
+            batchSrc = upload.mSrc.mBuffer;
+            batchDst = upload.mDst;
+            regions.push_back(upload.mRegion);
+        }
+        recordBufferBatch();
+
+        for(const ImageUpload& upload : mPendingImageUploads)
+        {
+            const vk::ImageSubresourceLayers& layers = upload.mRegion.imageSubresource;
+            const uint64_t handle = reinterpret_cast<uint64_t>(VkImage(upload.mDst));
+            const uint64_t subresource = (uint64_t(layers.mipLevel) << 32) | layers.baseArrayLayer;
+            if(hazard(handle, subresource, subresource + layers.layerCount))
+                transferBarrier();
+
+            cmd.copyBufferToImage(upload.mSrc.mBuffer, upload.mDst, vk::ImageLayout::eTransferDstOptimal, upload.mRegion);
+        }
+
+        vk::MemoryBarrier barrier{};
+        barrier.setSrcAccessMask(vk::AccessFlagBits::eTransferWrite);
+        barrier.setDstAccessMask(vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite);
+
+        cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands,
+                            vk::DependencyFlags{}, {barrier}, {}, toShaderRead);
+
+        // Overflow buffers go through deferred destruction once these copies have finished.
+        for(BufferUpload& upload : mPendingBufferUploads)
+        {
+            if(upload.mSrc.mOverflowBuffer)
+                upload.mSrc.mOverflowBuffer->updateLastAccessed();
+        }
+        for(ImageUpload& upload : mPendingImageUploads)
+        {
+            if(upload.mSrc.mOverflowBuffer)
+                upload.mSrc.mOverflowBuffer->updateLastAccessed();
+        }
+
+        mPendingBufferUploads.clear();
+        mPendingImageUploads.clear();
+    }
+
+    // Fence everything staged up to now, including uploads recorded directly in to other command buffers.
+    if(mAllocatedTotal != mFencedTotal)
+    {
+        const uint64_t submission = mDevice->getCurrentSubmissionIndex();
+        if(!mFences.empty() && mFences.back().mSubmission == submission)
+            mFences.back().mAllocatedTotal = mAllocatedTotal;
+        else
+            mFences.push_back({mAllocatedTotal, submission});
+
+        mFencedTotal = mAllocatedTotal;
+    }
+
+    mRingBuffer.updateLastAccessed();
+}
+
+
+VulkanStagingRing::Stats VulkanStagingRing::getStats()
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    return {mAllocatedTotal - mReleasedTotal, mSize, mOverflowUploads};
+}
+
+
+VulkanStagingRing::StagingAllocation VulkanStagingRing::stage(std::unique_lock<std::mutex>& lock, const void* data, const uint32_t size)
+{
+    uint32_t offset = 0;
+    if(allocate(size, offset))
+    {
+        std::memcpy(mBaseAddress + offset, data, size);
+
+        MapInfo writtenRange{};
+        writtenRange.mOffset = offset;
+        writtenRange.mSize = size;
+        static_cast<VulkanRenderDevice*>(mDevice)->getMemoryManager()->UnMapAllocation(writtenRange, mRingBuffer.getMemory());
+
+        return {mRingBuffer.getBuffer(), offset, nullptr};
+    }
+
+    ++mOverflowUploads;
+
+    lock.unlock();
+
+    auto overflowBuffer = std::make_unique<VulkanBuffer>(mDevice, BufferUsage::TransferSrc, size, size, "Overflow Staging Buffer");
+    overflowBuffer->setContents(data, size, 0);
+
+    lock.lock();
+
+    const vk::Buffer buffer = overflowBuffer->getBuffer();
+    return {buffer, 0, std::move(overflowBuffer)};
+}
+
+
+bool VulkanStagingRing::allocate(const uint32_t size, uint32_t& offset)
+{
+    const uint64_t alignedSize = (uint64_t(size) + kAlignment - 1) & ~uint64_t(kAlignment - 1);
+
+    // Large uploads would starve everything else of ring space, so always give them their own buffer.
+    if(alignedSize > mSize / 4)
+        return false;
+
+    releaseFinished();
+
+    // Allocations never straddle the end of the ring, skip to the start instead.
+    const uint64_t head = mAllocatedTotal % mSize;
+    const uint64_t padding = (head + alignedSize) > mSize ? mSize - head : 0;
+
+    if((mAllocatedTotal - mReleasedTotal) + padding + alignedSize > mSize)
+        return false;
+
+    mAllocatedTotal += padding;
+    offset = static_cast<uint32_t>(mAllocatedTotal % mSize);
+    mAllocatedTotal += alignedSize;
+
+    return true;
+}
+
+
+void VulkanStagingRing::releaseFinished()
+{
+    const uint64_t finishedSubmission = mDevice->getFinishedSubmissionIndex();
+
+    while(!mFences.empty() && mFences.front().mSubmission <= finishedSubmission)
+    {
+        mReleasedTotal = mFences.front().mAllocatedTotal;
+        mFences.pop_front();
+    }
+}
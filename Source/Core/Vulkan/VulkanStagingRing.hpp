@@ -0,0 +1,102 @@
+#ifndef VK_STAGING_RING_HPP
+#define VK_STAGING_RING_HPP
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <vulkan/vulkan.hpp>
+
+#include "VulkanBuffer.hpp"
+
+
+class RenderDevice;
+
+
+// Persistently mapped ring of host visible memory that all CPU to GPU uploads are staged through.
+// Space is handed out linearly and handed back once the submission that copied out of it has finished.
+// Uploads can be made from any thread, they are queued and recorded in one batch when the ring is flushed
+// in to the prefix command buffer. Uploads that don't fit in the ring get their own staging buffer.
+class VulkanStagingRing
+{
+public:
+    VulkanStagingRing(RenderDevice* dev, const uint32_t size);
+
+    void uploadToBuffer(const vk::Buffer dst, const void* data, const uint32_t size, const uint32_t offset);
+    void uploadToImage(const vk::Image dst, const vk::ImageLayout currentLayout, const void* data, const uint32_t size, const vk::BufferImageCopy& region);
+
+    // Records the copy straight in to cmd, for uploads that need to be ordered with the other commands in it.
+    void recordUploadToBuffer(vk::CommandBuffer cmd, const vk::Buffer dst, const void* data, const uint32_t size, const uint32_t offset);
+
+    // Records all queued uploads and fences the ring space used so far against the current submission.
+    void flush(vk::CommandBuffer cmd);
+
+    struct Stats
+    {
+        uint64_t mUsedBytes;
+        uint64_t mCapacity;
+        uint64_t mOverflowUploads;
+    };
+    Stats getStats();
+
+    // All allocations are aligned to this so that the offsets are valid for any texel or block size we upload.
+    static constexpr uint32_t kAlignment = 16;
+
+private:
+
+    struct StagingAllocation
+    {
+        vk::Buffer mBuffer;
+        uint32_t mOffset;
+        std::unique_ptr<VulkanBuffer> mOverflowBuffer;
+    };
+
+    // Copies data in to the ring, or in to a new overflow buffer if there isn't space.
+    // Must be called with the lock held, it's dropped whilst creating an overflow buffer.
+    StagingAllocation stage(std::unique_lock<std::mutex>& lock, const void* data, const uint32_t size);
+
+    bool allocate(const uint32_t size, uint32_t& offset);
+    void releaseFinished();
+
+    RenderDevice* mDevice;
+
+    VulkanBuffer mRingBuffer;
+    unsigned char* mBaseAddress;
+    uint64_t mSize;
+
+    std::mutex mLock;
+
+    // Monotonic byte counts, the ring offset is the count modulo the size.
+    uint64_t mAllocatedTotal;
+    uint64_t mReleasedTotal;
+    uint64_t mFencedTotal;
+
+    struct Fence
+    {
+        uint64_t mAllocatedTotal;
+        uint64_t mSubmission;
+    };
+    std::deque<Fence> mFences;
+
+    struct BufferUpload
+    {
+        StagingAllocation mSrc;
+        vk::Buffer mDst;
+        vk::BufferCopy mRegion;
+    };
+    std::vector<BufferUpload> mPendingBufferUploads;
+
+    struct ImageUpload
+    {
+        StagingAllocation mSrc;
+        vk::Image mDst;
+        vk::ImageLayout mCurrentLayout;
+        vk::BufferImageCopy mRegion;
+    };
+    std::vector<ImageUpload> mPendingImageUploads;
+
+    uint64_t mOverflowUploads;
+};
+
+#endif
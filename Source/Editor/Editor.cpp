@@ -257,6 +257,15 @@ namespace
                 return newNode;
             }
 
+            case NodeTypes::IndirectDrawCulling:
+            {
+                std::shared_ptr<EditorNode> newNode = std::make_shared<PassNode>("Indirect draw culling", passType);
+                newNode->mInputs.push_back(Pin{ 0, newNode, kPreviousLinearDepth, PinType::Texture, PinKind::Input });
+                newNode->mInputs.push_back(Pin{ 0, newNode, kIndirectDrawCandidates, PinType::Texture, PinKind::Input });
+                newNode->mOutputs.push_back(Pin{ 0, newNode, kIndirectDrawCommands, PinType::Texture, PinKind::Output });
+                return newNode;
+            }
+
             case NodeTypes::PathTracing:
             {
                 std::shared_ptr<EditorNode> newNode = std::make_shared<PassNode>("PathTracing", passType);
@@ -757,6 +766,7 @@ void Editor::drawAssistantWindow()
            drawPassContextMenu(PassType::Voxelize);
            drawPassContextMenu(PassType::VisualizeLightProbes);
            drawPassContextMenu(PassType::OcclusionCulling);
+           drawPassContextMenu(PassType::IndirectDrawCulling);
            drawPassContextMenu(PassType::PathTracing);
            drawPassContextMenu(PassType::DownSampleColour);
 
@@ -864,22 +874,33 @@ void Editor::drawAssistantWindow()
        if(ImGui::TreeNode("Profiling"))
        {
            RenderDevice* dev = mEngine.getDevice();
-           const RenderGraph& graph = mEngine.getRenderGraph();
-           const std::vector<uint64_t> timeStamps = dev->getAvailableTimestamps();
-           // There is a 3 frame delay on timestamps so graph could have been rebuilt by now.
-           if(timeStamps.size() == graph.taskCount())
+           // Timestamps are a few frames old, but are named so still line up if the graph has been rebuilt since.
+           const std::vector<TaskTimestamp>& timeStamps = dev->getAvailableTimestamps();
+           float totalGPUTime = 0.0f;
+           for(const TaskTimestamp& timeStamp : timeStamps)
            {
-               float totalGPUTime = 0.0f;
-               for(uint32_t i = 0; i < timeStamps.size(); ++i)
-               {
-                   const RenderTask& task = graph.getTask(i);
-                   const float taskTime = dev->getTimeStampPeriod() * (float(timeStamps[i]) / 1000000.0f);
-                   ImGui::Text("%s : %f ms", task.getName().c_str(), taskTime);
-                   totalGPUTime += taskTime;
-               }
+               const float taskTime = dev->getTimeStampPeriod() * (float(timeStamp.mDuration) / 1000000.0f);
+               ImGui::Text("%s : %f ms", timeStamp.mTaskName.c_str(), taskTime);
+               totalGPUTime += taskTime;
+           }
+
+           ImGui::Text("Total GPU time %f ms", totalGPUTime);
+           ImGui::Text("Total CPU time %f ms", double(mEngine.getLastFrameTime().count()) / 1000.0);
+
+           if(ImGui::Button("Capture frame"))
+               mEngine.captureNextFrame("BellFrame.bframe");
+
+           bool instrumentationEnabled = Instrumentation::isEnabled();
+           if(ImGui::Checkbox("Record instrumentation", &instrumentationEnabled))
+               Instrumentation::setEnabled(instrumentationEnabled);
+
+           if(instrumentationEnabled)
+           {
+               if(ImGui::Button("Save trace"))
+                   Instrumentation::writeChromeTrace("BellTrace.json");
 
-               ImGui::Text("Total GPU time %f ms", totalGPUTime);
-               ImGui::Text("Total CPU time %f ms", double(mEngine.getLastFrameTime().count()) / 1000.0);
+               for(const auto& [name, statistic] : Instrumentation::getStatistics())
+                   ImGui::Text("%s : mean %.3f p50 %.3f p99 %.3f ms", name.c_str(), statistic.mMean, statistic.mP50, statistic.mP99);
            }
 
            ImGui::TreePop();
@@ -6,7 +6,7 @@ int main(int argc, char* *argv)
 
     glfwInit();
 
-#if defined(VULKAN)
+#if defined(VULKAN) || defined(NULL_DEVICE)
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
 #elif defined(OPENGL)
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_OPENGL_API);
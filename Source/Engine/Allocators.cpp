@@ -1,8 +1,10 @@
 #include "Allocators.hpp"
 #include "Core/BellLogging.hpp"
 
-#include <cmath>
+#include <algorithm>
 #include <cstring>
+#include <new>
+#include <thread>
 
 namespace
 {
@@ -12,260 +14,741 @@ namespace
     }
 }
 
-SlabAllocator::SlabAllocator(const uint64_t startingSize) :
-    mResource{nullptr},
-    mOffset{0},
-    mSize{startingSize}
+struct Allocator::Slab
 {
-    mResource = static_cast<unsigned char*>(malloc(mSize));
-}
+    struct FreeBlock
+    {
+        FreeBlock* mNext;
+    };
+
+    ThreadCache* mOwner;
+    Slab* mNext;
+    Slab* mPrev;
 
+    // Only touched by the owning thread.
+    FreeBlock* mFreeList;
+    unsigned char* mBump;
+    unsigned char* mEnd;
+    uint32_t mUsedCount; // Includes remote frees that haven't been reclaimed yet.
+    uint32_t mSizeClass;
+    uint32_t mBlockSize;
+    bool mFull;
 
-SlabAllocator::~SlabAllocator()
+    std::atomic<FreeBlock*> mRemoteFrees;
+};
+
+
+struct Allocator::ThreadCache
 {
-    free(mResource);
-}
+    // The head of each partial list is the slab currently being allocated from.
+    Slab* mPartialSlabs[kSizeClassCount];
+    Slab* mFullSlabs[kSizeClassCount];
 
+    // Written by the thread using the cache, read when gathering stats.
+    std::atomic<int64_t> mAllocatedBytes;
+    std::atomic<uint64_t> mAllocationCount;
+};
 
-SlabAllocator& SlabAllocator::operator=(SlabAllocator&& other) noexcept
+
+// Each thread keeps the cache it uses for every allocator it has touched, the caches are handed back to their
+// allocators when the thread exits.
+struct Allocator::ThreadCacheRegistry
 {
-    mResource = other.mResource;
-    mOffset = other.mOffset;
-    mSize = other.mSize;
+    static constexpr uint32_t kMaxEntries = 8;
+
+    struct Entry
+    {
+        uint64_t mAllocatorID;
+        ThreadCache* mCache;
+    };
+
+    ~ThreadCacheRegistry();
+
+    Entry mEntries[kMaxEntries] = {};
+};
+
+
+namespace
+{
+    std::atomic<uint64_t> gNextAllocatorID{1};
+
+    std::mutex& getLiveAllocatorsLock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+
+    // Allocator IDs are never reused, so a stale thread cache entry can't refer to a new allocator.
+    std::vector<std::pair<uint64_t, Allocator*>>& getLiveAllocators()
+    {
+        static std::vector<std::pair<uint64_t, Allocator*>> allocators;
+        return allocators;
+    }
 
-    other.mResource = nullptr;
+    Allocator* findLiveAllocator(const uint64_t id)
+    {
+        for(const auto& [allocatorID, allocator] : getLiveAllocators())
+        {
+            if(allocatorID == id)
+                return allocator;
+        }
+
+        return nullptr;
+    }
+
+    uint32_t ceilLog2(const uint64_t x)
+    {
+        if(x <= 1)
+            return 0;
+
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, x - 1);
+        return index + 1;
+#else
+        return 64 - __builtin_clzll(x - 1);
+#endif
+    }
+
+    // Returns kSizeClassCount for allocations that are too big or too aligned for a slab.
+    uint32_t getSizeClass(const uint64_t size, const uint64_t alignment)
+    {
+        // Blocks are aligned to their size, slabs are aligned to kSlabSize.
+        const uint64_t blockSize = std::max(std::max(size, alignment), Allocator::kMinSmallSize);
+        if(blockSize > Allocator::kMaxSmallSize)
+            return Allocator::kSizeClassCount;
+
+        return ceilLog2(blockSize) - ceilLog2(Allocator::kMinSmallSize);
+    }
+
+    void* allocateAligned(const uint64_t size, const uint64_t alignment)
+    {
+#ifdef _MSC_VER
+        return _aligned_malloc(size, alignment);
+#else
+        // aligned_alloc needs the size to be a multiple of the alignment.
+        return std::aligned_alloc(alignment, nextAlignedAddress(size, alignment));
+#endif
+    }
+
+    void freeAligned(void* p)
+    {
+#ifdef _MSC_VER
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
 
-    return *this;
 }
 
 
-SlabAllocator::SlabAllocator(SlabAllocator&& other) noexcept
+thread_local Allocator::ThreadCacheRegistry Allocator::tThreadCaches;
+
+
+Allocator::ThreadCacheRegistry::~ThreadCacheRegistry()
 {
-    mResource = other.mResource;
-    mOffset = other.mOffset;
-    mSize = other.mSize;
+    std::lock_guard<std::mutex> lock(getLiveAllocatorsLock());
+    for(const Entry& entry : mEntries)
+    {
+        if(!entry.mCache)
+            continue;
 
-    other.mResource = nullptr;
+        if(Allocator* allocator = findLiveAllocator(entry.mAllocatorID))
+            allocator->releaseThreadCache(entry.mCache);
+    }
 }
 
-void* SlabAllocator::allocate(size_t size, size_t alignment)
+
+Allocator::Allocator() :
+    mID(gNextAllocatorID++),
+    mLock{},
+    mFreeSlabs{},
+    mThreadCaches{},
+    mAbandonedCaches{},
+    mSlabCount{0},
+    mPeakSlabCount{0},
+    mLargeAllocatedBytes{0},
+    mLargeAllocationCount{0}
 {
-    unsigned char* nextAddress = reinterpret_cast<unsigned char*>(nextAlignedAddress( uintptr_t(mResource), alignment));
+    std::lock_guard<std::mutex> lock(getLiveAllocatorsLock());
+    getLiveAllocators().push_back({mID, this});
+}
+
 
-    void* address = nullptr;
-    if(nextAddress + size <= mResource + mSize)
+Allocator::~Allocator()
+{
     {
-        address = nextAddress;
-        mOffset = (nextAddress + size) - mResource;
+        std::lock_guard<std::mutex> lock(getLiveAllocatorsLock());
+        auto& allocators = getLiveAllocators();
+        allocators.erase(std::remove_if(allocators.begin(), allocators.end(), [this](const auto& entry) { return entry.first == mID; }), allocators.end());
     }
 
-    return address;
+    for(Slab* slab : mFreeSlabs)
+        freeAligned(slab);
+
+    for(auto& cache : mThreadCaches)
+    {
+        for(uint32_t i = 0; i < kSizeClassCount; ++i)
+        {
+            for(Slab* list : {cache->mPartialSlabs[i], cache->mFullSlabs[i]})
+            {
+                while(list)
+                {
+                    Slab* next = list->mNext;
+                    freeAligned(list);
+                    list = next;
+                }
+            }
+        }
+    }
 }
 
 
-bool SlabAllocator::is_equal(const SlabAllocator& other) const
+Allocator::Stats Allocator::getStats() const
 {
-    return mResource == other.mResource;
-}
+    Stats stats{};
+    stats.mLargeAllocatedBytes = mLargeAllocatedBytes.load(std::memory_order_relaxed);
+    stats.mAllocationCount = mLargeAllocationCount.load(std::memory_order_relaxed);
 
+    std::lock_guard<std::mutex> lock(mLock);
 
-RAIISlabAllocator::RAIISlabAllocator(SlabAllocator& allocator) :
-    mStartOffset(allocator.mOffset),
-    mSize(allocator.mSize),
-    mOffset(allocator.mOffset),
-    mResource(allocator.mResource) {}
+    // Frees can land on a different thread's cache to the allocation, so only the sum is meaningful.
+    int64_t allocatedBytes = 0;
+    for(const auto& cache : mThreadCaches)
+    {
+        allocatedBytes += cache->mAllocatedBytes.load(std::memory_order_relaxed);
+        stats.mAllocationCount += cache->mAllocationCount.load(std::memory_order_relaxed);
+    }
+    stats.mAllocatedBytes = uint64_t(std::max<int64_t>(allocatedBytes, 0));
 
+    stats.mReservedBytes = mSlabCount * kSlabSize;
+    stats.mPeakReservedBytes = mPeakSlabCount * kSlabSize;
+    stats.mSlabCount = mSlabCount;
+    stats.mThreadCacheCount = static_cast<uint32_t>(mThreadCaches.size());
 
-RAIISlabAllocator::~RAIISlabAllocator()
-{
-    mOffset = mStartOffset;
+    return stats;
 }
 
 
-RAIISlabAllocator& RAIISlabAllocator::operator=(RAIISlabAllocator&& other) noexcept
+void* Allocator::do_allocate(const std::size_t size, const std::size_t alignment)
 {
-    mStartOffset = other.mStartOffset;
-    mSize = other.mStartOffset;
-    mResource = other.mResource;
-    mOffset = other.mOffset;
+    const uint32_t sizeClass = getSizeClass(size, alignment);
+    if(sizeClass == kSizeClassCount)
+    {
+        void* p = allocateAligned(size, std::max<uint64_t>(alignment, sizeof(void*)));
+        BELL_ASSERT(p, "System allocation failed")
+
+        mLargeAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        mLargeAllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+        return p;
+    }
 
-    other.mResource = nullptr;
+    ThreadCache* cache = getThreadCache();
+    void* p = allocateSmall(*cache, sizeClass);
 
-    return *this;
+    cache->mAllocatedBytes.fetch_add(int64_t(kMinSmallSize << sizeClass), std::memory_order_relaxed);
+    cache->mAllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    return p;
 }
 
 
-RAIISlabAllocator::RAIISlabAllocator(RAIISlabAllocator&& other) noexcept :
-    mOffset(other.mOffset)
+void Allocator::do_deallocate(void* p, std::size_t size, std::size_t alignment)
 {
-    mStartOffset = other.mStartOffset;
-    mSize = other.mStartOffset;
-    mResource = other.mResource;
+    if(!p)
+        return;
+
+    const uint32_t sizeClass = getSizeClass(size, alignment);
+    if(sizeClass == kSizeClassCount)
+    {
+        freeAligned(p);
+        mLargeAllocatedBytes.fetch_sub(size, std::memory_order_relaxed);
+
+        return;
+    }
 
-    other.mResource = nullptr;
+    ThreadCache* cache = getThreadCache();
+    deallocateSmall(*cache, p);
+
+    cache->mAllocatedBytes.fetch_sub(int64_t(kMinSmallSize << sizeClass), std::memory_order_relaxed);
 }
 
 
+bool Allocator::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
 
-void* RAIISlabAllocator::allocate(size_t size, size_t alignment)
+
+Allocator::ThreadCache* Allocator::getThreadCache()
 {
-    unsigned char* nextAddress = reinterpret_cast<unsigned char*>(nextAlignedAddress( uintptr_t(mResource), alignment));
+    for(const auto& entry : tThreadCaches.mEntries)
+    {
+        if(entry.mAllocatorID == mID)
+            return entry.mCache;
+    }
 
-    void* address = nullptr;
-    if(nextAddress + size <= mResource + mSize)
+    // First use from this thread. Take an empty entry, or one left by an allocator that has since been destroyed.
+    ThreadCacheRegistry::Entry* freeEntry = nullptr;
     {
-        address = nextAddress;
-        mOffset = (nextAddress + size) - mResource;
+        std::lock_guard<std::mutex> lock(getLiveAllocatorsLock());
+        for(auto& entry : tThreadCaches.mEntries)
+        {
+            if(!entry.mCache || !findLiveAllocator(entry.mAllocatorID))
+            {
+                freeEntry = &entry;
+                break;
+            }
+        }
     }
+    BELL_ASSERT(freeEntry, "Too many allocators used from a single thread")
+
+    std::lock_guard<std::mutex> lock(mLock);
 
-    return address;
+    ThreadCache* cache = nullptr;
+    if(!mAbandonedCaches.empty())
+    {
+        cache = mAbandonedCaches.back();
+        mAbandonedCaches.pop_back();
+    }
+    else
+    {
+        mThreadCaches.push_back(std::make_unique<ThreadCache>());
+        cache = mThreadCaches.back().get();
+    }
+
+    freeEntry->mAllocatorID = mID;
+    freeEntry->mCache = cache;
+
+    return cache;
 }
 
 
-bool RAIISlabAllocator::is_equal(const RAIISlabAllocator& other) const
+void Allocator::releaseThreadCache(ThreadCache* cache)
 {
-    return mResource == other.mResource;
+    // The slabs stay with the cache, frees from other threads still find their way back through the remote lists.
+    std::lock_guard<std::mutex> lock(mLock);
+    mAbandonedCaches.push_back(cache);
 }
 
 
-PoolAllocator::PoolAllocator(const uint64_t size, const uint64_t count) :
-        mCount(count),
-        mSize(size)
+void* Allocator::allocateSmall(ThreadCache& cache, const uint32_t sizeClass)
 {
-    mResource = static_cast<unsigned char*>(malloc(mCount * mSize));
-    mActiveSlots = static_cast<uint64_t*>(malloc(((mCount + 63) / 64) * sizeof(uint64_t)));
-    std::memset(mActiveSlots, 1, ((mCount + 63) / 64) * sizeof(uint64_t));
+    auto popBlock = [](Slab* slab) -> void*
+    {
+        if(!slab->mFreeList)
+        {
+            if(slab->mBump < slab->mEnd)
+            {
+                void* block = slab->mBump;
+                slab->mBump += slab->mBlockSize;
+                ++slab->mUsedCount;
+
+                return block;
+            }
+
+            // Reclaim anything freed by other threads.
+            Slab::FreeBlock* remoteFrees = slab->mRemoteFrees.exchange(nullptr, std::memory_order_acquire);
+            slab->mFreeList = remoteFrees;
+            for(; remoteFrees; remoteFrees = remoteFrees->mNext)
+                --slab->mUsedCount;
+
+            if(!slab->mFreeList)
+                return nullptr;
+        }
+
+        Slab::FreeBlock* block = slab->mFreeList;
+        slab->mFreeList = block->mNext;
+        ++slab->mUsedCount;
+
+        return block;
+    };
+
+    Slab*& head = cache.mPartialSlabs[sizeClass];
+    while(head)
+    {
+        if(void* block = popBlock(head))
+            return block;
+
+        // Out of space, park it on the full list until it gets some blocks back.
+        Slab* full = head;
+        unlinkSlab(head, full);
+        full->mFull = true;
+        full->mNext = cache.mFullSlabs[sizeClass];
+        if(full->mNext)
+            full->mNext->mPrev = full;
+        cache.mFullSlabs[sizeClass] = full;
+    }
+
+    Slab* slab = acquireSlab(cache, sizeClass);
+    slab->mNext = nullptr;
+    slab->mPrev = nullptr;
+    head = slab;
+
+    return popBlock(slab);
 }
 
 
-PoolAllocator::~PoolAllocator()
+void Allocator::deallocateSmall(ThreadCache& cache, void* p)
 {
-    free(mResource);
-    free(mActiveSlots);
+    Slab* slab = reinterpret_cast<Slab*>(uintptr_t(p) & ~uintptr_t(kSlabSize - 1));
+    Slab::FreeBlock* block = static_cast<Slab::FreeBlock*>(p);
+
+    if(slab->mOwner != &cache)
+    {
+        Slab::FreeBlock* remoteFrees = slab->mRemoteFrees.load(std::memory_order_relaxed);
+        do
+        {
+            block->mNext = remoteFrees;
+        } while(!slab->mRemoteFrees.compare_exchange_weak(remoteFrees, block, std::memory_order_release, std::memory_order_relaxed));
+
+        return;
+    }
+
+    block->mNext = slab->mFreeList;
+    slab->mFreeList = block;
+    --slab->mUsedCount;
+
+    const uint32_t sizeClass = slab->mSizeClass;
+    Slab*& head = cache.mPartialSlabs[sizeClass];
+    if(slab->mFull)
+    {
+        // Has space again, put it behind the current slab.
+        unlinkSlab(cache.mFullSlabs[sizeClass], slab);
+        slab->mFull = false;
+        if(head)
+        {
+            slab->mPrev = head;
+            slab->mNext = head->mNext;
+            if(slab->mNext)
+                slab->mNext->mPrev = slab;
+            head->mNext = slab;
+        }
+        else
+        {
+            slab->mPrev = nullptr;
+            slab->mNext = nullptr;
+            head = slab;
+        }
+    }
+
+    if(slab->mUsedCount == 0 && slab != head)
+    {
+        unlinkSlab(head, slab);
+        releaseSlab(slab);
+    }
 }
 
 
-PoolAllocator& PoolAllocator::operator=(PoolAllocator&& other) noexcept
+Allocator::Slab* Allocator::acquireSlab(ThreadCache& cache, const uint32_t sizeClass)
 {
-    mResource = other.mResource;
-    mCount = other.mCount;
-    mSize = other.mSize;
-    mActiveSlots = other.mActiveSlots;
+    // Before growing check if any full slabs have had blocks freed remotely.
+    for(Slab* slab = cache.mFullSlabs[sizeClass]; slab; slab = slab->mNext)
+    {
+        if(slab->mRemoteFrees.load(std::memory_order_relaxed))
+        {
+            unlinkSlab(cache.mFullSlabs[sizeClass], slab);
+            slab->mFull = false;
 
-    other.mResource = nullptr;
-    other.mCount = 0;
-    other.mSize = 0;
-    other.mActiveSlots = nullptr;
+            return slab;
+        }
+    }
 
-    return *this;
+    Slab* slab = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mLock);
+        if(!mFreeSlabs.empty())
+        {
+            slab = mFreeSlabs.back();
+            mFreeSlabs.pop_back();
+        }
+        else
+        {
+            slab = static_cast<Slab*>(allocateAligned(kSlabSize, kSlabSize));
+            BELL_ASSERT(slab, "Unable to allocate slab")
+
+            ++mSlabCount;
+            mPeakSlabCount = std::max(mPeakSlabCount, mSlabCount);
+        }
+    }
+
+    const uint32_t blockSize = uint32_t(kMinSmallSize << sizeClass);
+    new (slab) Slab{};
+    slab->mOwner = &cache;
+    slab->mFreeList = nullptr;
+    slab->mBump = reinterpret_cast<unsigned char*>(slab) + nextAlignedAddress(sizeof(Slab), blockSize);
+    slab->mEnd = reinterpret_cast<unsigned char*>(slab) + kSlabSize;
+    slab->mUsedCount = 0;
+    slab->mSizeClass = sizeClass;
+    slab->mBlockSize = blockSize;
+    slab->mFull = false;
+    slab->mRemoteFrees.store(nullptr, std::memory_order_relaxed);
+
+    return slab;
+}
+
+
+void Allocator::releaseSlab(Slab* slab)
+{
+    slab->~Slab();
+
+    // Keep a few spare slabs around rather than going back to the system for every new one.
+    constexpr size_t kMaxFreeSlabs = 64;
+
+    std::lock_guard<std::mutex> lock(mLock);
+    if(mFreeSlabs.size() < kMaxFreeSlabs)
+    {
+        mFreeSlabs.push_back(slab);
+    }
+    else
+    {
+        freeAligned(slab);
+        --mSlabCount;
+    }
 }
 
 
-PoolAllocator::PoolAllocator(PoolAllocator&& other) noexcept
+
+void Allocator::unlinkSlab(Slab*& head, Slab* slab)
 {
-    mResource = other.mResource;
-    mCount = other.mCount;
-    mSize = other.mSize;
-    mActiveSlots = other.mActiveSlots;
+    if(slab->mPrev)
+        slab->mPrev->mNext = slab->mNext;
+    else
+        head = slab->mNext;
+
+    if(slab->mNext)
+        slab->mNext->mPrev = slab->mPrev;
 
-    other.mResource = nullptr;
-    other.mCount = 0;
-    other.mSize = 0;
-    other.mActiveSlots = nullptr;
+    slab->mNext = nullptr;
+    slab->mPrev = nullptr;
 }
 
 
-void* PoolAllocator::allocate()
+struct FrameAllocator::Arena
 {
-    const uint64_t slotCount = (mCount + 63) / 64;
-    for(uint64_t i = 0; i < slotCount; ++i)
+    struct Block
     {
-        if(mActiveSlots[i] == 0)
-            continue;
+        unsigned char* mMemory;
+        uint64_t mSize;
+    };
 
-#ifdef _MSC_VER
-        unsigned long firstFreeIndex;
-        _BitScanForward64(&firstFreeIndex, mActiveSlots[i]);
-#else
-        const uint64_t firstFreeIndex = __builtin_ctzll(mActiveSlots[i]);
-#endif
+    std::vector<Block> mBlocks;
+    uint32_t mCurrentBlock = 0;
+    uint64_t mOffset = 0;
 
-        mActiveSlots[i] &= ~(1ULL << firstFreeIndex);
-        return mResource + ((i * 64) + firstFreeIndex) * mSize;
-    }
+    // Written by the owning thread, read when gathering stats.
+    std::atomic<uint64_t> mUsed{0};
+    std::atomic<uint64_t> mPeak{0};
+};
 
-    return nullptr;
+
+struct FrameAllocator::ThreadArenas
+{
+    std::thread::id mThread;
+    std::unique_ptr<Arena[]> mFrames;
+};
+
+
+namespace
+{
+    // The arenas the calling thread last used, so the lookup only takes a lock the first time a thread allocates.
+    struct ThreadArenaCache
+    {
+        uint64_t mAllocatorID;
+        void* mArenas;
+    };
+
+    thread_local ThreadArenaCache tFrameArenas{0, nullptr};
 }
 
 
-void PoolAllocator::deallocate(const void* p)
+FrameAllocator::Scope::Scope(FrameAllocator& allocator) :
+    mAllocator(allocator),
+    mFrame(allocator.mFrame.load(std::memory_order_relaxed))
 {
-    const uint64_t index = (static_cast<const unsigned char*>(p) - mResource) / mSize;
-    const uint64_t slotIndex = index / 64;
-    const uint64_t slotOffset = index % 64;
+    Arena& arena = mAllocator.getThreadArena();
+    mBlock = arena.mCurrentBlock;
+    mOffset = arena.mOffset;
+    mUsed = arena.mUsed.load(std::memory_order_relaxed);
+}
 
-    mActiveSlots[slotIndex] |= (1ULL << slotOffset);
+
+FrameAllocator::Scope::~Scope()
+{
+    BELL_ASSERT(mFrame == mAllocator.mFrame.load(std::memory_order_relaxed), "Frame allocator scope outlived its frame")
+
+    Arena& arena = mAllocator.getThreadArena();
+    arena.mCurrentBlock = mBlock;
+    arena.mOffset = mOffset;
+    arena.mUsed.store(mUsed, std::memory_order_relaxed);
 }
 
 
-Allocator::Allocator() :
-    mAllocatorPools{{1ULL << 3, 10 * 1024 * 1024},
-                    {1ULL << 4, 10 * 1024 * 1024},
-                    {1ULL << 5, 10 * 1024},
-                    {1ULL << 6, 10 * 1024},
-                    {1ULL << 7, 10 * 1024},
-                    {1ULL << 8, 10 * 1024},
-                    {1ULL << 9, 10 * 1024},
-                    {1ULL << 10, 10 * 1024}}
+FrameAllocator::FrameAllocator(const uint32_t frameCount, const uint64_t blockSize) :
+    mID(gNextAllocatorID++),
+    mFrameCount(frameCount),
+    mBlockSize(blockSize),
+    mFrame{0},
+    mLock{},
+    mThreadArenas{},
+    mReservedBytes{0},
+    mHighWaterMark{0}
+{
+    BELL_ASSERT(mFrameCount > 0, "Need at least one frame")
+}
+
+
+FrameAllocator::~FrameAllocator()
 {
+    for(auto& threadArenas : mThreadArenas)
+    {
+        for(uint32_t i = 0; i < mFrameCount; ++i)
+        {
+            for(const Arena::Block& block : threadArenas->mFrames[i].mBlocks)
+                std::free(block.mMemory);
+        }
+    }
 }
 
 
-Allocator& Allocator::operator=(Allocator&& other)
+void FrameAllocator::nextFrame()
 {
-    std::memcpy(mAllocatorPools, other.mAllocatorPools, sizeof(PoolAllocator) * 8);
+    std::lock_guard<std::mutex> lock(mLock);
+
+    const uint64_t frame = mFrame.load(std::memory_order_relaxed);
+
+    uint64_t frameUsed = 0;
+    for(const auto& threadArenas : mThreadArenas)
+        frameUsed += threadArenas->mFrames[frame % mFrameCount].mPeak.load(std::memory_order_relaxed);
+    mHighWaterMark = std::max(mHighWaterMark, frameUsed);
 
-    return *this;
+    const uint64_t nextFrame = frame + 1;
+    for(auto& threadArenas : mThreadArenas)
+    {
+        Arena& arena = threadArenas->mFrames[nextFrame % mFrameCount];
+
+        // Merge chained blocks in to one, so once a thread's usage settles it only touches a single block.
+        if(arena.mBlocks.size() > 1)
+        {
+            uint64_t totalSize = 0;
+            for(const Arena::Block& block : arena.mBlocks)
+            {
+                totalSize += block.mSize;
+                std::free(block.mMemory);
+            }
+
+            unsigned char* memory = static_cast<unsigned char*>(std::malloc(totalSize));
+            BELL_ASSERT(memory, "Unable to allocate frame arena block")
+            arena.mBlocks.clear();
+            arena.mBlocks.push_back({memory, totalSize});
+        }
+
+        arena.mCurrentBlock = 0;
+        arena.mOffset = 0;
+        arena.mUsed.store(0, std::memory_order_relaxed);
+        arena.mPeak.store(0, std::memory_order_relaxed);
+    }
+
+    mFrame.store(nextFrame, std::memory_order_relaxed);
 }
 
 
-Allocator::Allocator(Allocator&& other) :
-        mAllocatorPools{std::move(other.mAllocatorPools[0]),
-                        std::move(other.mAllocatorPools[1]),
-                        std::move(other.mAllocatorPools[2]),
-                        std::move(other.mAllocatorPools[3]),
-                        std::move(other.mAllocatorPools[4]),
-                        std::move(other.mAllocatorPools[5]),
-                        std::move(other.mAllocatorPools[6]),
-                        std::move(other.mAllocatorPools[7])}
-{}
+FrameAllocator::Stats FrameAllocator::getStats() const
+{
+    std::lock_guard<std::mutex> lock(mLock);
+
+    const uint64_t frame = mFrame.load(std::memory_order_relaxed) % mFrameCount;
+
+    Stats stats{};
+    uint64_t framePeak = 0;
+    for(const auto& threadArenas : mThreadArenas)
+    {
+        stats.mUsedBytes += threadArenas->mFrames[frame].mUsed.load(std::memory_order_relaxed);
+        framePeak += threadArenas->mFrames[frame].mPeak.load(std::memory_order_relaxed);
+    }
+    stats.mReservedBytes = mReservedBytes.load(std::memory_order_relaxed);
+    stats.mHighWaterMark = std::max(mHighWaterMark, framePeak);
+    stats.mArenaCount = static_cast<uint32_t>(mThreadArenas.size() * mFrameCount);
+
+    return stats;
+}
 
 
-void* Allocator::do_allocate(const uint64_t size, const uint64_t alignment)
+void* FrameAllocator::do_allocate(const std::size_t size, const std::size_t alignment)
 {
-    uint32_t pool = std::log2(size);
+    Arena& arena = getThreadArena();
 
-    // Min pool size is 1 << 3.
-    pool = std::max(pool, 3u) - 3u;
-    BELL_ASSERT(pool < 8, "larger pools need adding")
+    while(true)
+    {
+        if(arena.mCurrentBlock < arena.mBlocks.size())
+        {
+            const Arena::Block& block = arena.mBlocks[arena.mCurrentBlock];
+            const uintptr_t base = uintptr_t(block.mMemory);
+            const uint64_t start = nextAlignedAddress(base + arena.mOffset, alignment) - base;
+            if(start + size <= block.mSize)
+            {
+                arena.mOffset = start + size;
+
+                const uint64_t used = arena.mUsed.load(std::memory_order_relaxed) + size;
+                arena.mUsed.store(used, std::memory_order_relaxed);
+                if(used > arena.mPeak.load(std::memory_order_relaxed))
+                    arena.mPeak.store(used, std::memory_order_relaxed);
+
+                return block.mMemory + start;
+            }
+
+            // Move on to the next block, the end of this one goes unused until the arena is reset.
+            ++arena.mCurrentBlock;
+            arena.mOffset = 0;
+            continue;
+        }
 
-    void* addr = mAllocatorPools[pool].allocate();
+        // Out of blocks so chain on a new one.
+        const uint64_t blockSize = std::max<uint64_t>(mBlockSize, size + alignment);
+        unsigned char* memory = static_cast<unsigned char*>(std::malloc(blockSize));
+        BELL_ASSERT(memory, "Unable to allocate frame arena block")
 
-    return  reinterpret_cast<void*>(nextAlignedAddress( uintptr_t(addr), alignment));
+        arena.mBlocks.push_back({memory, blockSize});
+        mReservedBytes.fetch_add(blockSize, std::memory_order_relaxed);
+    }
 }
 
 
-void Allocator::do_deallocate(void* p, std::size_t size, std::size_t)
+void FrameAllocator::do_deallocate(void*, std::size_t, std::size_t)
 {
-    uint32_t pool = std::log2(size);
+    // Memory is reclaimed when the arena is reset.
+}
+
 
-    // Min pool size is 1 << 3.
-    pool = std::max(pool, 3u) - 3u;
-    mAllocatorPools[pool].deallocate(p);
+bool FrameAllocator::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
 }
 
 
-bool Allocator::do_is_equal(const std::pmr::memory_resource&) const noexcept
+FrameAllocator::Arena& FrameAllocator::getThreadArena()
 {
-    return true;
+    const uint64_t frame = mFrame.load(std::memory_order_relaxed) % mFrameCount;
+
+    if(tFrameArenas.mAllocatorID != mID)
+    {
+        const std::thread::id thread = std::this_thread::get_id();
+
+        std::lock_guard<std::mutex> lock(mLock);
+        auto it = std::find_if(mThreadArenas.begin(), mThreadArenas.end(), [thread](const auto& arenas) { return arenas->mThread == thread; });
+        if(it == mThreadArenas.end())
+        {
+            auto arenas = std::make_unique<ThreadArenas>();
+            arenas->mThread = thread;
+            arenas->mFrames = std::make_unique<Arena[]>(mFrameCount);
+            mThreadArenas.push_back(std::move(arenas));
+            it = mThreadArenas.end() - 1;
+        }
+
+        tFrameArenas = {mID, it->get()};
+    }
+
+    return static_cast<ThreadArenas*>(tFrameArenas.mArenas)->mFrames[frame];
 }
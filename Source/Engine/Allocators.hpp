@@ -1,152 +1,167 @@
 #ifndef BELL_CPU_ALLOCATORS_HPP
 #define BELL_CPU_ALLOCATORS_HPP
 
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
+#include <memory>
 #include <memory_resource>
+#include <mutex>
+#include <vector>
 
 
-class SlabAllocator
+// Per frame scratch memory.
+// Every thread gets its own arena for each buffered frame, so allocating never takes a lock. Arenas are chains of
+// blocks and a new block is chained on when one fills up rather than failing. Frees are ignored, an arena is reset
+// when its frame comes round again, so with frameCount at least the number of frames in flight anything allocated
+// during a frame stays valid until the GPU has finished with it.
+class FrameAllocator : public std::pmr::memory_resource
 {
 public:
-    friend class RAIISlabAllocator;
 
-    SlabAllocator(const uint64_t startingSize);
-    ~SlabAllocator();
-
-    SlabAllocator& operator=(const SlabAllocator&) noexcept = delete;
-    SlabAllocator(const SlabAllocator&) noexcept = delete;
-
-    SlabAllocator& operator=(SlabAllocator&&) noexcept;
-    SlabAllocator(SlabAllocator&&) noexcept;
-
-    void reset()
+    struct Stats
     {
-        mOffset = 0;
-    }
-
-    void* allocate(size_t size, size_t alignment);
-    bool is_equal(const SlabAllocator& other) const;
+        uint64_t mUsedBytes; // Allocated so far this frame, across all threads.
+        uint64_t mReservedBytes;
+        uint64_t mHighWaterMark; // Most used by a single frame.
+        uint32_t mArenaCount;
+    };
+
+    // Rewinds the calling threads arena when it goes out of scope, for scratch memory that doesn't need to last the frame.
+    // Scopes need to be destroyed in the reverse order they were created on each thread.
+    class Scope
+    {
+    public:
+        Scope(FrameAllocator&);
+        ~Scope();
 
-private:
+        Scope& operator=(const Scope&) = delete;
+        Scope(const Scope&) = delete;
 
-    unsigned char* mResource;
-    uint64_t mOffset;
-    uint64_t mSize;
-};
+    private:
 
+        FrameAllocator& mAllocator;
+        uint64_t mFrame;
+        uint32_t mBlock;
+        uint64_t mOffset;
+        uint64_t mUsed;
+    };
 
-class RAIISlabAllocator
-{
-public:
+    FrameAllocator(const uint32_t frameCount, const uint64_t blockSize);
+    ~FrameAllocator();
 
-    RAIISlabAllocator(SlabAllocator&);
-    ~RAIISlabAllocator();
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+    FrameAllocator(const FrameAllocator&) = delete;
 
-    RAIISlabAllocator& operator=(const RAIISlabAllocator&) noexcept = delete;
-    RAIISlabAllocator(const RAIISlabAllocator&) noexcept = delete;
+    FrameAllocator& operator=(FrameAllocator&&) = delete;
+    FrameAllocator(FrameAllocator&&) = delete;
 
-    RAIISlabAllocator& operator=(RAIISlabAllocator&&) noexcept;
-    RAIISlabAllocator(RAIISlabAllocator&&) noexcept;
+    // Moves on to the next frame and resets its arenas. Must not be called whilst any thread is allocating.
+    void nextFrame();
 
+    Stats getStats() const;
 
-    void* allocate(size_t size, size_t alignment);
-    bool is_equal(const RAIISlabAllocator& other) const;
+    uint32_t getFrameCount() const
+    {
+        return mFrameCount;
+    }
 
 private:
 
-    uint64_t mStartOffset;
-    uint64_t mSize;
-    uint64_t& mOffset;
-    unsigned char* mResource;
-};
-
-
-// Pool allocators
-class PoolAllocator
-{
-public:
-
-    PoolAllocator(const uint64_t size, const uint64_t count);
+    struct Arena;
+    struct ThreadArenas;
 
-    ~PoolAllocator();
+    virtual void* do_allocate(const std::size_t size, const std::size_t alignment) final;
+    virtual void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) final;
+    virtual bool do_is_equal(const std::pmr::memory_resource&) const noexcept final;
 
-    PoolAllocator& operator=(const PoolAllocator&) noexcept = delete;
-    PoolAllocator(const PoolAllocator&) noexcept = delete;
+    Arena& getThreadArena();
 
-    PoolAllocator& operator=(PoolAllocator&&) noexcept;
-    PoolAllocator(PoolAllocator&&) noexcept;
+    const uint64_t mID;
+    const uint32_t mFrameCount;
+    const uint64_t mBlockSize;
 
-    void* allocate();
+    std::atomic<uint64_t> mFrame;
 
-    void deallocate(const void* p);
+    mutable std::mutex mLock;
+    std::vector<std::unique_ptr<ThreadArenas>> mThreadArenas;
 
-private:
-
-    unsigned char* mResource;
-    uint64_t mCount;
-    uint64_t mSize;
-    uint64_t* mActiveSlots;
+    std::atomic<uint64_t> mReservedBytes;
+    uint64_t mHighWaterMark;
 };
 
 
-template<typename T>
-class TypedPoolAllocator
+// General allocator.
+// Small allocations come from size class slabs owned by per thread caches, so the common path takes no locks.
+// Blocks freed on a thread that doesn't own their slab are pushed on to a lock free list in the slab, which the
+// owner reclaims once it runs out of space. Slabs come from a central pool that grows on demand and anything
+// over kMaxSmallSize goes straight to the system allocator.
+class Allocator : public std::pmr::memory_resource
 {
 public:
 
-    TypedPoolAllocator(const uint64_t count) : mPool(sizeof(T), count) {}
-    ~TypedPoolAllocator() = default;
+    static constexpr uint64_t kSlabSize = 64 * 1024;
+    static constexpr uint64_t kMinSmallSize = 8;
+    static constexpr uint64_t kMaxSmallSize = 4096;
+    static constexpr uint32_t kSizeClassCount = 10; // Powers of 2 from kMinSmallSize to kMaxSmallSize.
 
-    TypedPoolAllocator& operator=(const TypedPoolAllocator&) noexcept = delete;
-    TypedPoolAllocator(const TypedPoolAllocator&) noexcept = delete;
-
-    TypedPoolAllocator& operator=(TypedPoolAllocator&& other) noexcept
+    struct Stats
     {
-        mPool = other.mPool;
+        uint64_t mAllocatedBytes; // Live small allocations, rounded up to their size class.
+        uint64_t mLargeAllocatedBytes;
+        uint64_t mReservedBytes; // Slab memory, used or not.
+        uint64_t mPeakReservedBytes;
+        uint64_t mAllocationCount;
+        uint32_t mSlabCount;
+        uint32_t mThreadCacheCount;
+    };
 
-        return *this;
-    }
+    Allocator();
+    ~Allocator();
 
-    TypedPoolAllocator(TypedPoolAllocator&& other) noexcept : mPool(other.mPool) {}
+    Allocator& operator=(const Allocator&) = delete;
+    Allocator(const Allocator&) = delete;
 
-    T* allocate()
-    {
-        return static_cast<T*>(mPool.allocate());
-    }
+    // Thread caches hold a pointer to their allocator, so it can't move.
+    Allocator& operator=(Allocator&&) = delete;
+    Allocator(Allocator&&) = delete;
 
-    void deallocate(const T* p)
-    {
-        mPool.deallocate(p);
-    }
+    Stats getStats() const;
 
 private:
 
-    PoolAllocator mPool;
-};
+    struct Slab;
+    struct ThreadCache;
+    struct ThreadCacheRegistry;
+
+    virtual void* do_allocate(const std::size_t size, const std::size_t alignment) final;
+    virtual void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) final;
+    virtual bool do_is_equal(const std::pmr::memory_resource&) const noexcept final;
 
+    ThreadCache* getThreadCache();
+    void releaseThreadCache(ThreadCache*);
 
-// General allocators
-class Allocator : public std::pmr::memory_resource
-{
-public:
-    Allocator();
-    ~Allocator() = default;
+    void* allocateSmall(ThreadCache&, const uint32_t sizeClass);
+    void  deallocateSmall(ThreadCache&, void* p);
 
-    Allocator& operator=(const Allocator&) = delete;
-    Allocator(const Allocator&) = delete;
+    Slab* acquireSlab(ThreadCache&, const uint32_t sizeClass);
+    void  releaseSlab(Slab*);
+    static void unlinkSlab(Slab*& head, Slab* slab);
 
-    Allocator& operator=(Allocator&&);
-    Allocator(Allocator&&);
+    static thread_local ThreadCacheRegistry tThreadCaches;
 
-private:
+    const uint64_t mID;
 
-    virtual void* do_allocate(const uint64_t size, const uint64_t alignment) final;
-    virtual void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) final;
-    virtual bool do_is_equal(const std::pmr::memory_resource&) const noexcept final;
+    mutable std::mutex mLock;
+    std::vector<Slab*> mFreeSlabs;
+    std::vector<std::unique_ptr<ThreadCache>> mThreadCaches;
+    // Caches from threads that have exited, picked up by the next new thread.
+    std::vector<ThreadCache*> mAbandonedCaches;
+    uint32_t mSlabCount;
+    uint32_t mPeakSlabCount;
 
-    // Pools for various power of 2 pools.
-    PoolAllocator mAllocatorPools[8];
+    std::atomic<uint64_t> mLargeAllocatedBytes;
+    std::atomic<uint64_t> mLargeAllocationCount;
 };
 
-#endif
\ No newline at end of file
+#endif
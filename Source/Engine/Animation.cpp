@@ -1,5 +1,6 @@
 #include "Engine/Animation.hpp"
 #include "Engine/StaticMesh.h"
+#include "Engine/CookedMesh.hpp"
 #include "Core/ConversionUtils.hpp"
 
 #include "Core/BellLogging.hpp"
@@ -47,12 +48,48 @@ SkeletalAnimation::SkeletalAnimation(const StaticMesh& mesh, const aiAnimation*
 }
 
 
-std::vector<float4x4> SkeletalAnimation::calculateBoneMatracies(const StaticMesh& mesh, const double tick) const
+SkeletalAnimation::SkeletalAnimation(CookedMesh::Reader& reader) :
+        mName(reader.readString()),
+        mNumTicks(reader.read<double>()),
+        mTicksPerSec(reader.read<double>()),
+        mRootTransform(reader.read<float4x4>()),
+        mBones()
 {
-    const std::vector<SubMesh>& subMeshes = mesh.getSubMeshes();
-    std::vector<float4x4> boneTransforms{};
-    boneTransforms.reserve(mesh.getBoneCount());
+    const uint64_t boneCount = reader.read<uint64_t>();
+    for(uint64_t i = 0; i < boneCount && reader.isValid(); ++i)
+    {
+        std::string boneName = reader.readString();
+
+        BoneTransform transforms{};
+        transforms.mPositions = reader.readVector<BoneTransform::PositionKey>();
+        transforms.mScales = reader.readVector<BoneTransform::ScaleKey>();
+        transforms.mRotations = reader.readVector<BoneTransform::RotationKey>();
+
+        mBones[std::move(boneName)] = std::move(transforms);
+    }
+}
 
+
+void SkeletalAnimation::serialise(CookedMesh::Writer& writer) const
+{
+    writer.writeString(mName);
+    writer.write(mNumTicks);
+    writer.write(mTicksPerSec);
+    writer.write(mRootTransform);
+
+    writer.write<uint64_t>(mBones.size());
+    for(const auto& [boneName, transforms] : mBones)
+    {
+        writer.writeString(boneName);
+        writer.writeVector(transforms.mPositions);
+        writer.writeVector(transforms.mScales);
+        writer.writeVector(transforms.mRotations);
+    }
+}
+
+
+void SkeletalAnimation::calculateBoneMatracies(const StaticMesh& mesh, const double tick, float4x4* boneTransforms) const
+{
     const auto &bones = mesh.getSkeleton();
     for (const auto &bone : bones)
     {
@@ -80,10 +117,8 @@ std::vector<float4x4> SkeletalAnimation::calculateBoneMatracies(const StaticMesh
             parent = parentBone.mParentIndex;
         }
 
-        boneTransforms.emplace_back(rootTransform * transform * bone.mInverseBindPose);
+        *boneTransforms++ = rootTransform * transform * bone.mInverseBindPose;
     }
-
-    return boneTransforms;
 }
 
 
@@ -340,6 +375,30 @@ MeshBlend::MeshBlend(const aiAnimMesh* mesh)
 }
 
 
+MeshBlend::MeshBlend(CookedMesh::Reader& reader) :
+    mPosition{reader.readVector<float3>()},
+    mNormals{reader.readVector<float4>()},
+    mTangents{reader.readVector<float4>()},
+    mUV{reader.readVector<float2>()},
+    mColours{reader.readVector<uint32_t>()},
+    mName{reader.readString()},
+    mWeight{reader.read<float>()}
+{
+}
+
+
+void MeshBlend::serialise(CookedMesh::Writer& writer) const
+{
+    writer.writeVector(mPosition);
+    writer.writeVector(mNormals);
+    writer.writeVector(mTangents);
+    writer.writeVector(mUV);
+    writer.writeVector(mColours);
+    writer.writeString(mName);
+    writer.write(mWeight);
+}
+
+
 BlendMeshAnimation::BlendMeshAnimation(const aiAnimation* anim, const aiScene* sceneRoot) :
     mName{anim->mName.C_Str()},
     mTicksPerSecond{ anim->mTicksPerSecond },
@@ -366,6 +425,41 @@ BlendMeshAnimation::BlendMeshAnimation(const aiAnimation* anim, const aiScene* s
 }
 
 
+BlendMeshAnimation::BlendMeshAnimation(CookedMesh::Reader& reader) :
+    mName{reader.readString()},
+    mTicksPerSecond{reader.read<double>()},
+    mNumTicks{reader.read<double>()},
+    mTicks{}
+{
+    const uint64_t tickCount = reader.read<uint64_t>();
+    for(uint64_t i = 0; i < tickCount && reader.isValid(); ++i)
+    {
+        Tick tick{};
+        tick.mTime = reader.read<double>();
+        tick.mVertexIndex = reader.readVector<uint32_t>();
+        tick.mWeight = reader.readVector<double>();
+
+        mTicks.push_back(std::move(tick));
+    }
+}
+
+
+void BlendMeshAnimation::serialise(CookedMesh::Writer& writer) const
+{
+    writer.writeString(mName);
+    writer.write(mTicksPerSecond);
+    writer.write(mNumTicks);
+
+    writer.write<uint64_t>(mTicks.size());
+    for(const Tick& tick : mTicks)
+    {
+        writer.write(tick.mTime);
+        writer.writeVector(tick.mVertexIndex);
+        writer.writeVector(tick.mWeight);
+    }
+}
+
+
 std::vector<unsigned char> BlendMeshAnimation::getBlendedVerticies(const StaticMesh& mesh, const double tick) const
 {
     uint32_t frameIndex = 0;
@@ -11,13 +11,23 @@
 
 class StaticMesh;
 
+namespace CookedMesh
+{
+    class Writer;
+    class Reader;
+}
+
 class SkeletalAnimation
 {
 public:
     SkeletalAnimation(const StaticMesh &mesh, const aiAnimation*, const aiScene*);
+    SkeletalAnimation(CookedMesh::Reader&);
     ~SkeletalAnimation() = default;
 
-    std::vector<float4x4> calculateBoneMatracies(const StaticMesh&, const double tick) const;
+    void serialise(CookedMesh::Writer&) const;
+
+    // Writes a matrix for every bone in the meshes skeleton.
+    void calculateBoneMatracies(const StaticMesh&, const double tick, float4x4* boneTransforms) const;
 
     double getTicksPerSec() const
     {
@@ -91,6 +101,9 @@ private:
 struct MeshBlend
 {
     MeshBlend(const aiAnimMesh*);
+    MeshBlend(CookedMesh::Reader&);
+
+    void serialise(CookedMesh::Writer&) const;
 
     std::vector<float3> mPosition;
     std::vector<float4> mNormals;
@@ -107,8 +120,11 @@ class BlendMeshAnimation
 {
 public:
     BlendMeshAnimation(const aiAnimation*, const aiScene*);
+    BlendMeshAnimation(CookedMesh::Reader&);
     ~BlendMeshAnimation() = default;
 
+    void serialise(CookedMesh::Writer&) const;
+
     double getTicksPerSec() const
     {
         return mTicksPerSecond;
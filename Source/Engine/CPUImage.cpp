@@ -1,278 +1,340 @@
 #include "Engine/CPUImage.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
 
-CPUImage::~CPUImage()
-{
-
-}
 
-float CPUImage::sample(const float2& uv) const
+namespace
 {
-    const unsigned char* data = getDataPtr(uv);
+    constexpr uint32_t kTileSize = CPUImage::kTileSize;
 
-    if(mPixelSize == 4)
+    // Index of a texel within a face of a tiled level.
+    inline uint64_t getTexelIndex(const CPUImage::MipLevel& level, const uint32_t x, const uint32_t y)
     {
-        const float* pix = reinterpret_cast<const float*>(data);
-        float c = pix[0];
-
-        return c;
+        const uint64_t tile = (uint64_t(y / kTileSize) * level.mTilesX) + (x / kTileSize);
+        return (tile * kTileSize * kTileSize) + ((y % kTileSize) * kTileSize) + (x % kTileSize);
     }
-    else if(mPixelSize == 1)
+
+    inline uint32_t wrapCoord(const int32_t coord, const uint32_t size)
     {
-        const uint8_t* pix = reinterpret_cast<const uint8_t*>(data);
-        float c = pix[0] / 255.0f;
-        return c;
+        const int32_t wrapped = coord % int32_t(size);
+        return uint32_t(wrapped < 0 ? wrapped + int32_t(size) : wrapped);
     }
 
-    BELL_TRAP;
-    return 0.0f;
-}
-
+    inline uint32_t clampCoord(const int32_t coord, const uint32_t size)
+    {
+        return uint32_t(std::clamp(coord, 0, int32_t(size) - 1));
+    }
 
-float2 CPUImage::sample2(const float2& uv) const
-{
-    const unsigned char* data = getDataPtr(uv);
 
-    if(mPixelSize == 8)
+    template<typename T, uint32_t Channels>
+    struct TexelFormat
     {
-        const float* pix = reinterpret_cast<const float*>(data);
-        float2 c;
-        c.x = pix[0];
-        c.y = pix[1];
+        static float4 load(const unsigned char* data)
+        {
+            const T* pix = reinterpret_cast<const T*>(data);
+
+            float4 result{0.0f, 0.0f, 0.0f, 1.0f};
+            for(uint32_t i = 0; i < Channels; ++i)
+            {
+                if constexpr (std::is_same_v<T, uint8_t>)
+                    result[i] = pix[i] / 255.0f;
+                else
+                    result[i] = pix[i];
+            }
+
+            return result;
+        }
+
+        static void store(const float4& texel, unsigned char* data)
+        {
+            T* pix = reinterpret_cast<T*>(data);
+
+            for(uint32_t i = 0; i < Channels; ++i)
+            {
+                if constexpr (std::is_same_v<T, uint8_t>)
+                    pix[i] = uint8_t((std::clamp(texel[i], 0.0f, 1.0f) * 255.0f) + 0.5f);
+                else
+                    pix[i] = texel[i];
+            }
+        }
+
+        static float4 sampleBilinear(const unsigned char* data, const CPUImage::MipLevel& level, const float2& uv, const bool wrap)
+        {
+            // Wrap before converting to texels so large uvs can't overflow.
+            const float u = wrap ? uv.x - std::floor(uv.x) : uv.x;
+            const float v = wrap ? uv.y - std::floor(uv.y) : uv.y;
+
+            const float x = (u * level.mWidth) - 0.5f;
+            const float y = (v * level.mHeight) - 0.5f;
+            const float xFloor = std::floor(x);
+            const float yFloor = std::floor(y);
+            const float xBlend = x - xFloor;
+            const float yBlend = y - yFloor;
+
+            uint32_t x0, x1, y0, y1;
+            if(wrap)
+            {
+                x0 = wrapCoord(int32_t(xFloor), level.mWidth);
+                x1 = wrapCoord(int32_t(xFloor) + 1, level.mWidth);
+                y0 = wrapCoord(int32_t(yFloor), level.mHeight);
+                y1 = wrapCoord(int32_t(yFloor) + 1, level.mHeight);
+            }
+            else
+            {
+                x0 = clampCoord(int32_t(xFloor), level.mWidth);
+                x1 = clampCoord(int32_t(xFloor) + 1, level.mWidth);
+                y0 = clampCoord(int32_t(yFloor), level.mHeight);
+                y1 = clampCoord(int32_t(yFloor) + 1, level.mHeight);
+            }
+
+            constexpr uint32_t pixelSize = sizeof(T) * Channels;
+            const float4 topLeft = load(data + (getTexelIndex(level, x0, y0) * pixelSize));
+            const float4 topRight = load(data + (getTexelIndex(level, x1, y0) * pixelSize));
+            const float4 bottomLeft = load(data + (getTexelIndex(level, x0, y1) * pixelSize));
+            const float4 bottomRight = load(data + (getTexelIndex(level, x1, y1) * pixelSize));
+
+            return glm::mix(glm::mix(topLeft, topRight, xBlend), glm::mix(bottomLeft, bottomRight, xBlend), yBlend);
+        }
+    };
+
+
+    struct FormatFunctions
+    {
+        CPUImage::BilinearFunction mSampleBilinear;
+        CPUImage::StoreFunction mStore;
+        uint32_t mPixelSize;
+    };
 
-        return c;
+    template<typename T, uint32_t Channels>
+    FormatFunctions getFormatFunctions()
+    {
+        return {&TexelFormat<T, Channels>::sampleBilinear, &TexelFormat<T, Channels>::store, uint32_t(sizeof(T) * Channels)};
     }
-    else if(mPixelSize == 2)
+
+    FormatFunctions getFormatFunctions(const Format format)
     {
-        const uint8_t* pix = reinterpret_cast<const uint8_t*>(data);
-        float2 c;
-        c.x = pix[0] / 255.0f;
-        c.y = pix[1] / 255.0f;
+        switch(format)
+        {
+            case Format::R8UNorm:
+                return getFormatFunctions<uint8_t, 1>();
 
-        return c;
-    }
+            case Format::RG8UNorm:
+                return getFormatFunctions<uint8_t, 2>();
 
-    BELL_TRAP;
-    return float2(0.0f, 0.0f);
-}
+            case Format::RGB8UNorm:
+            case Format::RGB8SRGB:
+                return getFormatFunctions<uint8_t, 3>();
 
+            case Format::RGBA8UNorm:
+            case Format::RGBA8SRGB:
+            case Format::RGBA8Uint:
+                return getFormatFunctions<uint8_t, 4>();
 
-float3 CPUImage::sample3(const float2& uv) const
-{
-    const unsigned char* data = getDataPtr(uv);
+            case Format::R32Float:
+                return getFormatFunctions<float, 1>();
 
-    if(mPixelSize == 12)
-    {
-        const float* pix = reinterpret_cast<const float*>(data);
-        float3 c;
-        c.x = pix[0];
-        c.y = pix[1];
-        c.z = pix[2];
+            case Format::RG32Float:
+                return getFormatFunctions<float, 2>();
 
-        return c;
-    }
-    else if(mPixelSize == 3)
-    {
-        const uint8_t* pix = reinterpret_cast<const uint8_t*>(data);
-        float3 c;
-        c.x = pix[0] / 255.0f;
-        c.y = pix[1] / 255.0f;
-        c.z = pix[2] / 255.0f;
+            case Format::RGB32SFloat:
+                return getFormatFunctions<float, 3>();
 
-        return c;
-    }
+            case Format::RGBA32Float:
+            case Format::RGBA32SFloat:
+                return getFormatFunctions<float, 4>();
 
-    BELL_TRAP;
-    return float3{0.0f, 0.0f, 0.0f};
+            default:
+                BELL_ASSERT(false, "Unsupported CPU image format")
+                return getFormatFunctions<uint8_t, 4>();
+        }
+    }
 }
 
 
-float4 CPUImage::sample4(const float2& uv) const
+CPUImage::CPUImage(std::vector<unsigned char>&& data, const ImageExtent& extent, const Format format) :
+    mData{},
+    mMips{},
+    mExtent(extent),
+    mFormat(format),
+    mPixelSize(0),
+    mSampleBilinear(nullptr),
+    mStore(nullptr)
 {
-    const unsigned char* data = getDataPtr(uv);
-
-    if(mPixelSize == 16)
-    {
-        const float* pix = reinterpret_cast<const float*>(data);
-        float4 c;
-        c.x = pix[0];
-        c.y = pix[1];
-        c.z = pix[2];
-        c.w = pix[3];
-
-        return c;
-    }
-    else if(mPixelSize == 4)
-    {
-        const uint8_t* pix = reinterpret_cast<const uint8_t*>(data);
-        float4 c;
-        c.x = pix[0] / 255.0f;
-        c.y = pix[1] / 255.0f;
-        c.z = pix[2] / 255.0f;
-        c.w = pix[3] / 255.0f;
-
-        return c;
-    }
+    const FormatFunctions functions = getFormatFunctions(mFormat);
+    mSampleBilinear = functions.mSampleBilinear;
+    mStore = functions.mStore;
+    mPixelSize = functions.mPixelSize;
 
-    BELL_TRAP;
-    return float4{0.0f, 0.0f, 0.0f, 0.0f};
+    buildMipChain(data);
 }
 
 
-float CPUImage::sampleCube(const float3& d) const
+float CPUImage::sample(const float2& uv, const float lod) const
 {
-    uint32_t faceIndex;
-    float2 uv;
-    resolveCubemapUV(d, faceIndex, uv);
+    return sampleLevels(uv, 0, lod, true).x;
+}
 
-    const unsigned char* data = getDataPtr(uv, faceIndex);
 
-    if(mPixelSize == 4)
-    {
-        const float* pix = reinterpret_cast<const float*>(data);
-        float c = pix[0];
+float2 CPUImage::sample2(const float2& uv, const float lod) const
+{
+    return float2(sampleLevels(uv, 0, lod, true));
+}
 
-        return c;
-    }
-    else if(mPixelSize == 1)
-    {
-        const uint8_t* pix = reinterpret_cast<const uint8_t*>(data);
-        float c = pix[0] / 255.0f;
-        return c;
-    }
 
-    BELL_TRAP;
-    return 0.0f;
+float3 CPUImage::sample3(const float2& uv, const float lod) const
+{
+    return float3(sampleLevels(uv, 0, lod, true));
 }
 
 
-float2 CPUImage::sampleCube2(const float3& d) const
+float4 CPUImage::sample4(const float2& uv, const float lod) const
 {
-    uint32_t faceIndex;
-    float2 uv;
-    resolveCubemapUV(d, faceIndex, uv);
-
-    const unsigned char* data = getDataPtr(uv, faceIndex);
+    return sampleLevels(uv, 0, lod, true);
+}
 
-    if(mPixelSize == 8)
-    {
-        const float* pix = reinterpret_cast<const float*>(data);
-        float2 c;
-        c.x = pix[0];
-        c.y = pix[1];
 
-        return c;
-    }
-    else if(mPixelSize == 2)
-    {
-        const uint8_t* pix = reinterpret_cast<const uint8_t*>(data);
-        float2 c;
-        c.x = pix[0] / 255.0f;
-        c.y = pix[1] / 255.0f;
+float CPUImage::sampleCube(const float3& d, const float lod) const
+{
+    return sampleCubeLevels(d, lod).x;
+}
 
-        return c;
-    }
 
-    BELL_TRAP;
-    return float2(0.0f, 0.0f);
+float2 CPUImage::sampleCube2(const float3& d, const float lod) const
+{
+    return float2(sampleCubeLevels(d, lod));
 }
 
 
-float3 CPUImage::sampleCube3(const float3& d) const
+float3 CPUImage::sampleCube3(const float3& d, const float lod) const
 {
-    uint32_t faceIndex;
-    float2 uv;
-    resolveCubemapUV(d, faceIndex, uv);
+    return float3(sampleCubeLevels(d, lod));
+}
 
-    const unsigned char* data = getDataPtr(uv, faceIndex);
 
-    if(mPixelSize == 12)
-    {
-        const float* pix = reinterpret_cast<const float*>(data);
-        float3 c;
-        c.x = pix[0];
-        c.y = pix[1];
-        c.z = pix[2];
+float4 CPUImage::sampleCube4(const float3& d, const float lod) const
+{
+    return sampleCubeLevels(d, lod);
+}
 
-        return c;
-    }
-    else if(mPixelSize == 3)
-    {
-        const uint8_t* pix = reinterpret_cast<const uint8_t*>(data);
-        float3 c;
-        c.x = pix[0] / 255.0f;
-        c.y = pix[1] / 255.0f;
-        c.z = pix[2] / 255.0f;
 
-        return c;
-    }
+float CPUImage::calculateLOD(const float triangleLOD, const float coneWidth, const float cosTheta) const
+{
+    if(coneWidth <= 0.0f)
+        return 0.0f;
 
-    BELL_TRAP;
-    return float3{0.0f, 0.0f, 0.0f};
+    // Ray cone LOD from "Texture Level of Detail Strategies for Real-Time Ray Tracing", Ray Tracing Gems.
+    return triangleLOD + (0.5f * std::log2(float(mExtent.width) * float(mExtent.height))) +
+            std::log2(coneWidth / std::max(std::abs(cosTheta), 0.01f));
 }
 
 
-float4 CPUImage::sampleCube4(const float3& d) const
+float CPUImage::calculateCubeLOD(const float spreadAngle) const
 {
-    uint32_t faceIndex;
-    float2 uv;
-    resolveCubemapUV(d, faceIndex, uv);
+    if(spreadAngle <= 0.0f)
+        return 0.0f;
+
+    // A texel in the middle of a face covers roughly 2 / width radians.
+    return std::log2(spreadAngle * float(mExtent.width) * 0.5f);
+}
 
-    const unsigned char* data = getDataPtr(uv, faceIndex);
 
-    if(mPixelSize == 16)
+void CPUImage::buildMipChain(const std::vector<unsigned char>& linearData)
+{
+    const uint32_t faceCount = std::max(mExtent.depth, 1u);
+    uint32_t width = std::max(mExtent.width, 1u);
+    uint32_t height = std::max(mExtent.height, 1u);
+
+    uint64_t offset = 0;
+    while(true)
     {
-        const float* pix = reinterpret_cast<const float*>(data);
-        float4 c;
-        c.x = pix[0];
-        c.y = pix[1];
-        c.z = pix[2];
-        c.w = pix[3];
-
-        return c;
+        const uint32_t tilesX = (width + kTileSize - 1) / kTileSize;
+        const uint32_t tilesY = (height + kTileSize - 1) / kTileSize;
+
+        MipLevel level{};
+        level.mWidth = width;
+        level.mHeight = height;
+        level.mTilesX = tilesX;
+        level.mOffset = offset;
+        level.mFaceSize = uint64_t(tilesX) * tilesY * kTileSize * kTileSize * mPixelSize;
+        mMips.push_back(level);
+
+        offset += level.mFaceSize * faceCount;
+
+        if(width == 1 && height == 1)
+            break;
+
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
     }
-    else if(mPixelSize == 4)
+    mData.resize(offset);
+
+    // Swizzle the top level in to tiles.
+    const MipLevel& topLevel = mMips.front();
+    BELL_ASSERT(linearData.size() >= uint64_t(topLevel.mWidth) * topLevel.mHeight * faceCount * mPixelSize, "Not enough image data")
+    for(uint32_t face = 0; face < faceCount; ++face)
     {
-        const uint8_t* pix = reinterpret_cast<const uint8_t*>(data);
-        float4 c;
-        c.x = pix[0] / 255.0f;
-        c.y = pix[1] / 255.0f;
-        c.z = pix[2] / 255.0f;
-        c.w = pix[3] / 255.0f;
-
-        return c;
+        unsigned char* faceData = mData.data() + topLevel.mOffset + (face * topLevel.mFaceSize);
+        for(uint32_t y = 0; y < topLevel.mHeight; ++y)
+        {
+            const unsigned char* row = linearData.data() + ((uint64_t(face) * topLevel.mHeight + y) * topLevel.mWidth * mPixelSize);
+            for(uint32_t x = 0; x < topLevel.mWidth; ++x)
+                std::memcpy(faceData + (getTexelIndex(topLevel, x, y) * mPixelSize), row + (x * mPixelSize), mPixelSize);
+        }
     }
 
-    BELL_TRAP;
-    return float4{0.0f, 0.0f, 0.0f, 0.0f};
+    // A bilinear lookup on the shared corner of a 2x2 block is the average of the block.
+    for(uint32_t i = 1; i < mMips.size(); ++i)
+    {
+        const MipLevel& src = mMips[i - 1];
+        const MipLevel& dst = mMips[i];
+
+        for(uint32_t face = 0; face < faceCount; ++face)
+        {
+            const unsigned char* srcData = mData.data() + src.mOffset + (face * src.mFaceSize);
+            unsigned char* dstData = mData.data() + dst.mOffset + (face * dst.mFaceSize);
+
+            for(uint32_t y = 0; y < dst.mHeight; ++y)
+            {
+                for(uint32_t x = 0; x < dst.mWidth; ++x)
+                {
+                    const float2 uv{float((x * 2) + 1) / float(src.mWidth), float((y * 2) + 1) / float(src.mHeight)};
+                    mStore(mSampleBilinear(srcData, src, uv, false), dstData + (getTexelIndex(dst, x, y) * mPixelSize));
+                }
+            }
+        }
+    }
 }
 
 
-const unsigned char* CPUImage::getDataPtr(const float2& uv) const
+float4 CPUImage::sampleLevels(const float2& uv, const uint32_t face, const float lod, const bool wrap) const
 {
-    const uint32_t x = uint32_t(uv.x * mExtent.width) % mExtent.width;
-    const uint32_t y = uint32_t(uv.y * mExtent.height) % mExtent.height;
+    const float maxLevel = float(mMips.size() - 1);
+    const float level = lod > 0.0f ? std::min(lod, maxLevel) : 0.0f; // Also catches NaNs.
+    const uint32_t firstLevel = uint32_t(level);
+    const float blend = level - float(firstLevel);
+
+    const MipLevel& first = mMips[firstLevel];
+    const float4 firstSample = mSampleBilinear(mData.data() + first.mOffset + (face * first.mFaceSize), first, uv, wrap);
+    if(blend == 0.0f)
+        return firstSample;
 
-    const unsigned char* data = mData.data();
-    const uint64_t offset = (mPixelSize * y * mExtent.width) + (mPixelSize * x);
-    BELL_ASSERT(offset < mData.size(), "Read out of bounds")
-    data += offset;
+    const MipLevel& second = mMips[firstLevel + 1];
+    const float4 secondSample = mSampleBilinear(mData.data() + second.mOffset + (face * second.mFaceSize), second, uv, wrap);
 
-    return data;
+    return glm::mix(firstSample, secondSample, blend);
 }
 
 
-const unsigned char* CPUImage::getDataPtr(const float2& uv, const uint32_t face) const
+float4 CPUImage::sampleCubeLevels(const float3& d, const float lod) const
 {
-    const uint32_t x = uint32_t(uv.x * mExtent.width) % mExtent.width;
-    const uint32_t y = uint32_t(uv.y * mExtent.height) % mExtent.height;
-
-    const unsigned char* data = mData.data();
-    const uint64_t offset = (mPixelSize * y * mExtent.width) + (mPixelSize * x) + (face * mExtent.width * mExtent.height * mPixelSize);
-    BELL_ASSERT(offset < mData.size(), "Read out of bounds")
-    data += offset;
+    uint32_t faceIndex;
+    float2 uv;
+    resolveCubemapUV(d, faceIndex, uv);
 
-    return data;
+    return sampleLevels(uv, faceIndex, lod, false);
 }
 
 
@@ -337,13 +337,17 @@ void CascadeShadowMappingTechnique::render(RenderGraph& graph, RenderEngine* eng
 
                     UberShaderStateCache stateCache(exec);
 
+                    // Pick LODs from the main camera, as that's where the shadows are seen from.
+                    const Camera& camera = eng->getScene()->getCamera();
+                    const float viewportHeight = eng->getSwapChainImage()->getExtent(0, 0).height;
+
                     for (const auto& mesh : nearCascadeMeshes)
                     {
                         // Don't render transparent geometry.
                         if (!(mesh->getInstanceFlags() & InstanceFlags::Draw))
                             continue;
 
-                        mesh->draw(exec, &stateCache);
+                        mesh->draw(exec, &stateCache, selectInstanceLOD(*mesh, camera, viewportHeight, kShadowLODBias));
                     }
                 }
     );
@@ -359,13 +363,17 @@ void CascadeShadowMappingTechnique::render(RenderGraph& graph, RenderEngine* eng
 
                     UberShaderStateCache stateCache(exec);
 
+                    // Pick LODs from the main camera, as that's where the shadows are seen from.
+                    const Camera& camera = eng->getScene()->getCamera();
+                    const float viewportHeight = eng->getSwapChainImage()->getExtent(0, 0).height;
+
                     for (const auto& mesh : midCascadeMeshes)
                     {
                         // Don't render transparent geometry.
                         if (!(mesh->getInstanceFlags() & InstanceFlags::Draw))
                             continue;
 
-                        mesh->draw(exec, &stateCache);
+                        mesh->draw(exec, &stateCache, selectInstanceLOD(*mesh, camera, viewportHeight, kShadowLODBias));
                     }
                 }
     );
@@ -381,13 +389,17 @@ void CascadeShadowMappingTechnique::render(RenderGraph& graph, RenderEngine* eng
 
                     UberShaderStateCache stateCache(exec);
 
+                    // Pick LODs from the main camera, as that's where the shadows are seen from.
+                    const Camera& camera = eng->getScene()->getCamera();
+                    const float viewportHeight = eng->getSwapChainImage()->getExtent(0, 0).height;
+
                     for (const auto& mesh : farCascadeMeshes)
                     {
                         // Don't render transparent geometry.
                         if (!(mesh->getInstanceFlags() & InstanceFlags::Draw))
                             continue;
 
-                        mesh->draw(exec, &stateCache);
+                        mesh->draw(exec, &stateCache, selectInstanceLOD(*mesh, camera, viewportHeight, kShadowLODBias));
                     }
                 }
     );
@@ -0,0 +1,120 @@
+#include "Engine/CookedMesh.hpp"
+
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace CookedMesh
+{
+
+    bool isCookedMesh(const std::string& path)
+    {
+        return std::filesystem::path(path).extension() == kFileExtension;
+    }
+
+
+    bool Writer::writeToFile(const std::string& path) const
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if(!file.is_open())
+        {
+            BELL_LOG_ARGS("Unable to open %s for writing", path.c_str())
+            return false;
+        }
+
+        file.write(reinterpret_cast<const char*>(mData.data()), mData.size());
+
+        return file.good();
+    }
+
+
+#ifdef _WIN32
+
+    MappedFile::MappedFile(const std::string& path) :
+        mData{nullptr},
+        mSize{0},
+        mFileHandle{INVALID_HANDLE_VALUE},
+        mMappingHandle{nullptr}
+    {
+        mFileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if(mFileHandle == INVALID_HANDLE_VALUE)
+        {
+            BELL_LOG_ARGS("Unable to open %s", path.c_str())
+            return;
+        }
+
+        LARGE_INTEGER fileSize;
+        if(!GetFileSizeEx(mFileHandle, &fileSize) || fileSize.QuadPart == 0)
+            return;
+
+        mMappingHandle = CreateFileMappingA(mFileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if(!mMappingHandle)
+            return;
+
+        mData = static_cast<const unsigned char*>(MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+        if(mData)
+            mSize = static_cast<size_t>(fileSize.QuadPart);
+    }
+
+
+    MappedFile::~MappedFile()
+    {
+        if(mData)
+            UnmapViewOfFile(mData);
+
+        if(mMappingHandle)
+            CloseHandle(mMappingHandle);
+
+        if(mFileHandle != INVALID_HANDLE_VALUE)
+            CloseHandle(mFileHandle);
+    }
+
+#else
+
+    MappedFile::MappedFile(const std::string& path) :
+        mData{nullptr},
+        mSize{0},
+        mFileDescriptor{-1}
+    {
+        mFileDescriptor = open(path.c_str(), O_RDONLY);
+        if(mFileDescriptor < 0)
+        {
+            BELL_LOG_ARGS("Unable to open %s", path.c_str())
+            return;
+        }
+
+        struct stat fileStats;
+        if(fstat(mFileDescriptor, &fileStats) != 0 || fileStats.st_size == 0)
+            return;
+
+        void* mapping = mmap(nullptr, fileStats.st_size, PROT_READ, MAP_PRIVATE, mFileDescriptor, 0);
+        if(mapping == MAP_FAILED)
+            return;
+
+        mData = static_cast<const unsigned char*>(mapping);
+        mSize = static_cast<size_t>(fileStats.st_size);
+    }
+
+
+    MappedFile::~MappedFile()
+    {
+        if(mData)
+            munmap(const_cast<unsigned char*>(mData), mSize);
+
+        if(mFileDescriptor >= 0)
+            close(mFileDescriptor);
+    }
+
+#endif
+
+}
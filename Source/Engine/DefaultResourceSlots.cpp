@@ -37,7 +37,7 @@ const char kMeshBoundsBuffer[] = "MeshBounds";
 const char kDownSampledColour[] = "DownSampledColour";
 const char kPreviousDownSampledColour[] ="Prev DownsampledColour";
 const char kTerrainVoxelGrid[] = "TerrainVoxels";
-const char kTerrainVertexBuffer[] = "TerrainVoxels";
+const char kTerrainVertexBuffer[] = "TerrainVertices";
 const char kTerrainIndirectBuffer[] = "TerrainIndirectArgs";
 const char kTerrainUniformBuffer[] = "TerrainUniforms";
 const char kInstanceIDBuffer[] = "InstanceIDBuffer";
@@ -51,6 +51,16 @@ const char kBoneTransforms[]        = "BonesBuffer";
 const char kMainCameraBVH[]               = "BVH";
 const char kInstanceTransformsBuffer[] = "InstanceTransforms";
 const char kPreviousInstanceTransformsBuffer[] = "PrevInstanceTransforms";
+const char kIndirectDrawCandidates[] = "IndirectDrawCandidates";
+const char kIndirectDrawCommands[] = "IndirectDrawCommands";
+const char kIndirectDrawCounts[] = "IndirectDrawCounts";
+const char kIndirectDrawEntries[] = "IndirectDrawEntries";
+const char kIndirectDrawWork[] = "IndirectDrawWork";
+const char kIndirectDrawOcclusionRetest[] = "IndirectDrawOcclusionRetest";
+const char kIndirectDrawLateCommands[] = "IndirectDrawLateCommands";
+const char kIndirectDrawLateCounts[] = "IndirectDrawLateCounts";
+const char kIndirectDrawLateEntries[] = "IndirectDrawLateEntries";
+const char kMeshlets[] = "Meshlets";
 
 const char kFrameBufer[]        = "FrameBuffer";
 const char kGlobalLighting[]	 = "GlobalLighting";
@@ -13,8 +13,13 @@
 #include "Core/DX_12/DX_12RenderInstance.hpp"
 #endif
 
+#ifdef NULL_DEVICE
+#include "Core/Null/NullRenderInstance.hpp"
+#endif
+
 #include "Engine/Engine.hpp"
 #include "Engine/TextureUtil.hpp"
+#include "Engine/FrameCapture.hpp"
 #include "Engine/PreDepthTechnique.hpp"
 #include "Engine/GBufferTechnique.hpp"
 #include "Engine/SSAOTechnique.hpp"
@@ -41,6 +46,7 @@
 #include "Engine/DeferredProbeGITechnique.hpp"
 #include "Engine/VisualizeLightProbesTechnique.hpp"
 #include "Engine/OcclusionCullingTechnique.hpp"
+#include "Engine/IndirectDrawCullingTechnique.hpp"
 #include "Engine/PathTracingTechnique.hpp"
 #include "Engine/DownSampleColourTechnique.hpp"
 #include "Engine/VoxelTerrainTechnique.hpp"
@@ -55,17 +61,51 @@
 #include <thread>
 
 
-RenderEngine::RenderEngine(GLFWwindow* windowPtr, const GraphicsOptions& options) :
-        mOptions(options),
-        mDefaultMemoryResource(),
-        mFrameAllocator(100 * 1024 * 1024),
-        mThreadPool(),
+namespace
+{
+    RenderInstance* createRenderInstance(GLFWwindow* window, const uint2 size)
+    {
 #ifdef VULKAN
-        mRenderInstance( new VulkanRenderInstance(windowPtr)),
+        BELL_ASSERT(window, "The vulkan backend needs a window to present to")
+        return new VulkanRenderInstance(window);
 #endif
 #ifdef DX_12
-    mRenderInstance(new DX_12RenderInstance(windowPtr)),
+        return new DX_12RenderInstance(window);
+#endif
+#ifdef NULL_DEVICE
+        return new NullRenderInstance(window, size.x, size.y);
 #endif
+    }
+
+    uint2 getWindowSize(GLFWwindow* window)
+    {
+        int width, height;
+        glfwGetWindowSize(window, &width, &height);
+
+        return uint2(width, height);
+    }
+}
+
+
+RenderEngine::RenderEngine(GLFWwindow* windowPtr, const GraphicsOptions& options) :
+    RenderEngine(windowPtr, getWindowSize(windowPtr), options)
+{
+}
+
+
+RenderEngine::RenderEngine(const uint32_t width, const uint32_t height, const GraphicsOptions& options) :
+    RenderEngine(nullptr, uint2(width, height), options)
+{
+}
+
+
+RenderEngine::RenderEngine(GLFWwindow* windowPtr, const uint2 size, const GraphicsOptions& options) :
+        mOptions(options),
+        mDefaultMemoryResource(),
+        mFrameAllocator(kFrameAllocatorFrameCount, 4 * 1024 * 1024),
+        mThreadPool(),
+        mTextureStreamer(this),
+        mRenderInstance(createRenderInstance(windowPtr, size)),
         mRenderDevice(mRenderInstance->createRenderDevice(mOptions.deviceFeatures, options.vsync)),
         mCurrentScene(nullptr),
         mCPURayTracedScene(nullptr),
@@ -74,7 +114,6 @@ RenderEngine::RenderEngine(GLFWwindow* windowPtr, const GraphicsOptions& options
         mDebugCamera({0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, 1.0f, 0.1f, 2000.0f),
         mAnimationVertexSize{0},
         mAnimationVertexBuilder(),
-        mMaterials{getDevice(), 200},
         mLTCMat(getDevice(), Format::RGBA32Float, ImageUsage::Sampled | ImageUsage::TransferDest, 64, 64, 1, 1, 1, 1, "LTC Mat"),
         mLTCMatView(mLTCMat, ImageViewType::Colour),
         mLTCAmp(getDevice(), Format::RG32Float, ImageUsage::Sampled | ImageUsage::TransferDest, 64, 64, 1, 1, 1, 1, "LTC Amp"),
@@ -84,16 +123,16 @@ RenderEngine::RenderEngine(GLFWwindow* windowPtr, const GraphicsOptions& options
         mBlueNoiseView(mBlueNoise, ImageViewType::Colour),
         mDefaultDiffuseTexture(getDevice(), Format::RGBA8UNorm, ImageUsage::Sampled | ImageUsage::TransferDest, 4, 4, 1, 1, 1, 1, "Default Diffuse"),
         mDefaultDiffuseView(mDefaultDiffuseTexture, ImageViewType::Colour),
+        mMaterialTable(getDevice(), mDefaultDiffuseView),
         mCurrentRenderGraph(),
         mCompileGraph(true),
         mTechniques{},
         mPassesRegisteredThisFrame{0},
         mCurrentRegisteredPasses{0},
         mShaderPrefix{},
-        mInstanceTransformsBuffer(getDevice(), BufferUsage::DataBuffer | BufferUsage::TransferDest, sizeof(float3x4) * 500, sizeof(float3x4) * 500, "Instance transforms"),
-        mInstanceTransformsBufferView(mInstanceTransformsBuffer),
-        mPrevInstanceTransformsBuffer(getDevice(), BufferUsage::DataBuffer | BufferUsage::TransferDest, sizeof(float3x4) * 500, sizeof(float3x4) * 500, "Instance transforms"),
-        mPrevInstanceTransformsBufferView(mInstanceTransformsBuffer),
+        mInstanceTable(getDevice()),
+        mGeometryPool(getDevice()),
+        mIndirectDrawList(getDevice()),
         mBoneBuffer(getDevice(), BufferUsage::DataBuffer | BufferUsage::TransferDest, sizeof(float4x4) * 1000, sizeof(float4x4) * 1000, "Bone buffer"),
         mMeshBoundsBuffer(getDevice(), BufferUsage::DataBuffer | BufferUsage::TransferDest, sizeof(float4) * 1000, sizeof(float4) * 1000, "Bounds buffer"),
         mDefaultSampler(SamplerType::Linear),
@@ -104,6 +143,9 @@ RenderEngine::RenderEngine(GLFWwindow* windowPtr, const GraphicsOptions& options
         mCameraBuffer{},
         mDeviceCameraBuffer{getDevice(), BufferUsage::Uniform, sizeof(CameraBuffer), sizeof(CameraBuffer), "Camera Buffer"},
         mShadowCastingLight(getDevice(), BufferUsage::Uniform, sizeof(Scene::ShadowingLight), sizeof(Scene::ShadowingLight), "ShadowingLight"),
+        mFrameCapturePath{},
+        mCapturedBoneMatrices{},
+        mReplayFrame{nullptr},
         mAccumilatedFrameUpdates(0),
         mMaxCommandThreads(1),
         mLightProbeResourceSet(mRenderDevice, 3),
@@ -111,6 +153,8 @@ RenderEngine::RenderEngine(GLFWwindow* windowPtr, const GraphicsOptions& options
         mAsyncTaskContextMappings{},
         mWindow(windowPtr)
 {
+    BELL_ASSERT(mRenderDevice->getSwapChainImageCount() <= kFrameAllocatorFrameCount, "Frame allocations could be reset whilst still in use")
+
     // calculate the TAA jitter.
     auto halton_2_3 = [](const uint32_t index) -> float2
     {
@@ -141,9 +185,7 @@ RenderEngine::RenderEngine(GLFWwindow* windowPtr, const GraphicsOptions& options
     mUnitSphere->initializeDeviceBuffers(this);
 
     // initialize debug camera
-    int width, height;
-    glfwGetWindowSize(windowPtr, &width, &height);
-    mDebugCamera.setAspect(float(width) / float(height));
+    mDebugCamera.setAspect(float(size.x) / float(size.y));
 }
 
 
@@ -164,27 +206,28 @@ void RenderEngine::setScene(Scene* scene)
 {
     mCurrentScene = scene;
 
+    // Any slots in the instance table belong to the previous scene.
+    mInstanceTable.clear();
+    mGeometryPool.clear();
+
     if(scene)
     {
-        // Set up the SRS for the materials.
-        auto& materials = mCurrentScene->getMaterials();
-        const uint32_t offset = materials.size();
-        materials.push_back(mDefaultDiffuseView);
-        mMaterials->addSampledImageArray(materials);
-        mMaterials->finalise();
+        // The scenes materials are already in the material table, so only the default material needs adding.
+        const uint32_t defaultMaterial = mMaterialTable.addMaterial(static_cast<uint32_t>(MaterialType::Diffuse), {mDefaultDiffuseView});
 
         std::vector<Scene::Material>& materialDescs = mCurrentScene->getMaterialDescriptions();
-        materialDescs.push_back(Scene::Material{"Default material", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, offset, static_cast<uint32_t>(MaterialType::Diffuse)});
+        materialDescs.push_back(Scene::Material{"Default material", nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, static_cast<uint32_t>(MaterialType::Diffuse), defaultMaterial});
 
         // Build mesh index + vertex device buffers.
         scene->initializeDeviceBuffers(this);
+        scene->resetTransformSlots();
     }
     else // We're clearing the scene so need to destroy the materials.
     {
-        mMaterials.reset(mRenderDevice, 200);
+        mTextureStreamer.clear();
+        // The material set layout is fixed size so pipelines don't need invalidating.
+        mMaterialTable.clear();
         mMeshBoundsCache.clear();
-        // need to invalidate render pipelines as the number of materials could change.
-        mRenderDevice->invalidatePipelines();
     }
 }
 
@@ -195,6 +238,59 @@ void RenderEngine::setCPURayTracingScene(CPURayTracingScene* scene)
 }
 
 
+bool RenderEngine::setReplayFrame(const FrameCapture::Frame* frame)
+{
+    if(!frame)
+    {
+        for(RenderView& view : mRenderViews)
+            view.unfreeze();
+
+        mReplayFrame = nullptr;
+        return true;
+    }
+
+    BELL_ASSERT(mCurrentScene, "Frames are replayed in to the scene they were captured from")
+
+    const auto& instanceMap = mCurrentScene->getInstanceMap();
+    for(const FrameCapture::Instance& captured : frame->mInstances)
+    {
+        if(instanceMap.find(captured.mID) == instanceMap.end())
+        {
+            BELL_LOG_ARGS("Captured instance %llu isn't in the scene", static_cast<unsigned long long>(captured.mID))
+            return false;
+        }
+    }
+
+    for(const FrameCapture::Instance& captured : frame->mInstances)
+    {
+        MeshInstance* instance = mCurrentScene->getMeshInstance(captured.mID);
+        instance->setPosition(captured.mPosition);
+        instance->setRotation(captured.mRotation);
+        instance->setScale(captured.mScale);
+        instance->setInstanceFlags(captured.mInstanceFlags);
+        instance->setGlobalBoneBufferOffset(captured.mBoneOffset);
+    }
+
+    FrameCapture::applyCamera(frame->mCamera, getCurrentSceneCamera());
+
+    for(uint32_t view_i = 0; view_i < kRenderView_Count; ++view_i)
+    {
+        const FrameCapture::View& view = frame->mViews[view_i];
+
+        std::vector<MeshInstance*> instances{};
+        instances.reserve(view.mInstances.size());
+        for(const InstanceID id : view.mInstances)
+            instances.push_back(mCurrentScene->getMeshInstance(id));
+
+        mRenderViews[view_i].freeze(instances, view.mLODs, view.mDraws);
+    }
+
+    mReplayFrame = frame;
+
+    return true;
+}
+
+
 Camera& RenderEngine::getCurrentSceneCamera()
 {
     return mDebugCameraActive ? mDebugCamera : mCurrentScene ? mCurrentScene->getCamera() : mDebugCamera;
@@ -362,6 +458,9 @@ std::unique_ptr<Technique> RenderEngine::getSingleTechnique(const PassType passT
         case PassType::OcclusionCulling:
             return std::make_unique<OcclusionCullingTechnique>(this, mCurrentRenderGraph);
 
+        case PassType::IndirectDrawCulling:
+            return std::make_unique<IndirectDrawCullingTechnique>(this, mCurrentRenderGraph);
+
         case PassType::PathTracing:
             return std::make_unique<PathTracingTechnique>(this, mCurrentRenderGraph);
 
@@ -435,15 +534,13 @@ void RenderEngine::execute(RenderGraph& graph)
     {
         graph.compile(mRenderDevice);
 
-        mCurrentRenderGraph.bindShaderResourceSet(kMaterials, mMaterials);
+        mCurrentRenderGraph.bindShaderResourceSet(kMaterials, mMaterialTable.getResourceSet());
         mCurrentRenderGraph.bindImage(kLTCMat, mLTCMatView);
         mCurrentRenderGraph.bindImage(kLTCAmp, mLTCAmpView);
         mCurrentRenderGraph.bindImage(kBlueNoise, mBlueNoiseView);
         mCurrentRenderGraph.bindSampler(kDefaultSampler, mDefaultSampler);
         mCurrentRenderGraph.bindSampler(kPointSampler, mDefaultPointSampler);
 
-        mCurrentRenderGraph.bindBuffer(kMeshBoundsBuffer, mMeshBoundsBuffer);
-
         if(mCurrentScene && mCurrentScene->getSkybox())
         {
             mCurrentRenderGraph.bindImage(kSkyBox, *mCurrentScene->getSkybox());
@@ -457,17 +554,26 @@ void RenderEngine::execute(RenderGraph& graph)
             mCurrentRenderGraph.bindShaderResourceSet(kLightProbes, mLightProbeResourceSet);
     }
 
+    // Rebound every frame, as growing the bounds replaces the buffer.
+    mCurrentRenderGraph.bindBuffer(kMeshBoundsBuffer, mMeshBoundsBuffer);
+
     for(const auto& tech : mTechniques)
     {
         tech->bindResources(mCurrentRenderGraph);
     }
 
-    mMaterials->updateLastAccessed();
+    if(mCurrentScene)
+    {
+        // Requests come from last frames main view, as it isn't updated until later in the frame.
+        mTextureStreamer.requestMips(mRenderViews[kRenderView_Main].getViewInstances(), mCurrentScene->getCamera(), getSwapChainImage()->getExtent(0, 0).height);
+        mTextureStreamer.update();
+    }
+
+    // Only writes the descriptors and table entries that have changed.
+    mMaterialTable.update();
     mCurrentRenderGraph.bindBuffer(kCameraBuffer, *mDeviceCameraBuffer);
     mCurrentRenderGraph.bindBuffer(kShadowingLights, *mShadowCastingLight);
     mCurrentRenderGraph.bindBuffer(kBoneTransforms, *mBoneBuffer);
-    mCurrentRenderGraph.bindBuffer(kInstanceTransformsBuffer, *mInstanceTransformsBufferView);
-    mCurrentRenderGraph.bindBuffer(kPreviousInstanceTransformsBuffer, *mPrevInstanceTransformsBufferView);
 
     if(mCompileGraph)
     {
@@ -480,20 +586,49 @@ void RenderEngine::execute(RenderGraph& graph)
     if(mCurrentScene && mCurrentScene->getSkybox())
         (*mCurrentScene->getSkybox())->updateLastAccessed();
 
-    mRenderViews[kRenderView_Main].updateView(mCurrentScene->getCamera());
+    mRenderViews[kRenderView_Main].updateView(mCurrentScene->getCamera(), getSwapChainImage()->getExtent(0, 0).height);
 
     // Get a deduplicated list of all meshes across all views to generate skinning info and transforms for.
-    std::vector<MeshInstance*> dedupedMeshInstances{};
+    std::pmr::vector<MeshInstance*> dedupedMeshInstances(&mFrameAllocator);
     {
-        std::set<MeshInstance*> meshInstanceSet{};
+        size_t instanceCount = 0;
+        for(uint8_t queue_i = 0; queue_i < kRenderView_Count; ++queue_i)
+            instanceCount += mRenderViews[queue_i].getViewInstances().size();
+
+        dedupedMeshInstances.reserve(instanceCount);
         for(uint8_t queue_i = 0; queue_i < kRenderView_Count; ++queue_i)
-            meshInstanceSet.insert(mRenderViews[queue_i].getViewInstances().begin(), mRenderViews[queue_i].getViewInstances().end());
+            dedupedMeshInstances.insert(dedupedMeshInstances.end(), mRenderViews[queue_i].getViewInstances().begin(), mRenderViews[queue_i].getViewInstances().end());
 
-        dedupedMeshInstances.insert(dedupedMeshInstances.end(), meshInstanceSet.begin(), meshInstanceSet.end());
+        std::sort(dedupedMeshInstances.begin(), dedupedMeshInstances.end());
+        dedupedMeshInstances.erase(std::unique(dedupedMeshInstances.begin(), dedupedMeshInstances.end()), dedupedMeshInstances.end());
     }
 
-    // upload culled instances transforms
-    updateInstanceTransformBuffers(dedupedMeshInstances);
+    // Only the transforms of instances that have moved are uploaded.
+    if(mCurrentScene)
+    {
+        for(const uint32_t baseSlot : mCurrentScene->takeReleasedTransformSlots())
+            mInstanceTable.releaseSlots(baseSlot);
+    }
+    mInstanceTable.updateInstances(dedupedMeshInstances);
+    // The table may have grown, so bind after updating.
+    mCurrentRenderGraph.bindBuffer(kInstanceTransformsBuffer, mInstanceTable.getTransformsView());
+    mCurrentRenderGraph.bindBuffer(kPreviousInstanceTransformsBuffer, mInstanceTable.getPreviousTransformsView());
+
+    // Only the main view is GPU driven for now.
+    if(isPassRegistered(PassType::IndirectDrawCulling))
+    {
+        mIndirectDrawList.build(mRenderViews[kRenderView_Main].getViewConstInstances(), mGeometryPool);
+        mCurrentRenderGraph.bindBuffer(kIndirectDrawCandidates, mIndirectDrawList.getCandidatesView());
+        mCurrentRenderGraph.bindBuffer(kIndirectDrawCommands, mIndirectDrawList.getCommandsView());
+        mCurrentRenderGraph.bindBuffer(kIndirectDrawCounts, mIndirectDrawList.getCountsView());
+        mCurrentRenderGraph.bindBuffer(kIndirectDrawEntries, mIndirectDrawList.getEntriesView());
+        mCurrentRenderGraph.bindBuffer(kIndirectDrawWork, mIndirectDrawList.getWorkView());
+        mCurrentRenderGraph.bindBuffer(kIndirectDrawOcclusionRetest, mIndirectDrawList.getOcclusionRetestView());
+        mCurrentRenderGraph.bindBuffer(kIndirectDrawLateCommands, mIndirectDrawList.getCommandsView());
+        mCurrentRenderGraph.bindBuffer(kIndirectDrawLateCounts, mIndirectDrawList.getCountsView());
+        mCurrentRenderGraph.bindBuffer(kIndirectDrawLateEntries, mIndirectDrawList.getEntriesView());
+        mCurrentRenderGraph.bindBuffer(kMeshlets, mGeometryPool.getMeshletBufferView());
+    }
     tickAnimations(dedupedMeshInstances);
 
     auto barriers = graph.generateBarriers(mRenderDevice);
@@ -582,14 +717,13 @@ void RenderEngine::execute(RenderGraph& graph)
             return context;
         };
 
-        RAIISlabAllocator tmpAllocator{mFrameAllocator};
-        Array<std::future<CommandContextBase*>> resultHandles(mSyncTaskContextMappings.size(), tmpAllocator);
+        Array<std::future<CommandContextBase*>> resultHandles(mSyncTaskContextMappings.size(), &mFrameAllocator);
         for (uint32_t i = 1; i < mSyncTaskContextMappings.size(); ++i)
         {
             resultHandles.push_back(mThreadPool.addTask(recordToContext, mSyncTaskContextMappings[i], i, QueueType::Graphics));
         }
 
-        Array<std::future<CommandContextBase*>> asyncResultHandles(mAsyncTaskContextMappings.size(), tmpAllocator);
+        Array<std::future<CommandContextBase*>> asyncResultHandles(mAsyncTaskContextMappings.size(), &mFrameAllocator);
         for(uint32_t i = 0; i < mAsyncTaskContextMappings.size(); ++i)
         {
             asyncResultHandles.push_back(mThreadPool.addTask(recordToContext, mAsyncTaskContextMappings[i], i, QueueType::Compute));
@@ -630,17 +764,58 @@ void RenderEngine::execute(RenderGraph& graph)
     context->freeExecutor(exec);
 
     mRenderDevice->submitContext(context, true);
+
+    if(!mFrameCapturePath.empty())
+    {
+        if(!FrameCapture::writeToFile(mFrameCapturePath, FrameCapture::captureFrame(*this, mCapturedBoneMatrices)))
+            BELL_LOG_ARGS("Failed to write frame capture %s", mFrameCapturePath.c_str())
+
+        mFrameCapturePath.clear();
+        mCapturedBoneMatrices.clear();
+    }
+}
+
+
+void RenderEngine::recordGPUTimings()
+{
+    const std::vector<TaskTimestamp>& timestamps = mRenderDevice->getAvailableTimestamps();
+    const double period = mRenderDevice->getTimeStampPeriod();
+
+    std::vector<Instrumentation::GPUTaskTime> tasks{};
+    tasks.reserve(timestamps.size());
+    for(const TaskTimestamp& timestamp : timestamps)
+        tasks.push_back({timestamp.mTaskName, period * (double(timestamp.mDuration) / 1000000.0)});
+
+    Instrumentation::recordGPUTasks(tasks);
 }
 
 
-void RenderEngine::tickAnimations(const std::vector<MeshInstance*>& instances)
+void RenderEngine::tickAnimations(const std::pmr::vector<MeshInstance*>& instances)
 {
     PROFILER_EVENT();
 
+    // Replayed instances already have the captured bone offsets.
+    if(mReplayFrame)
+    {
+        if(!mReplayFrame->mBoneMatrices.empty())
+            (*mBoneBuffer)->setContents(mReplayFrame->mBoneMatrices.data(), mReplayFrame->mBoneMatrices.size() * sizeof(float4x4));
+
+        return;
+    }
+
     double elapsedTime = mFrameUpdateDelta.count();
     elapsedTime /= 1000000.0;
     uint64_t boneOffset = 0;
-    std::vector<float4x4> boneMatracies{};
+    std::pmr::vector<float4x4> boneMatracies(&mFrameAllocator);
+
+    // Frame allocations can't be reused, so size it up front rather than growing it.
+    size_t boneCount = 0;
+    for(const auto* instance : instances)
+    {
+        if(instance->isSkinned())
+            boneCount += instance->getMesh()->getSkeleton().size();
+    }
+    boneMatracies.reserve(boneCount);
 
     for(auto* instance : instances)
     {
@@ -648,13 +823,16 @@ void RenderEngine::tickAnimations(const std::vector<MeshInstance*>& instances)
             continue;
 
         instance->setGlobalBoneBufferOffset(boneOffset);
-        std::vector<float4x4> matracies  = instance->tickAnimation(elapsedTime);
-        boneOffset += matracies.size();
-        boneMatracies.insert(boneMatracies.end(), matracies.begin(), matracies.end());
+        boneMatracies.resize(boneOffset + instance->getMesh()->getSkeleton().size());
+        instance->tickAnimation(elapsedTime, boneMatracies.data() + boneOffset);
+        boneOffset = boneMatracies.size();
     }
 
     if(!boneMatracies.empty())
         (*mBoneBuffer)->setContents(boneMatracies.data(), boneMatracies.size() * sizeof(float4x4));
+
+    if(!mFrameCapturePath.empty())
+        mCapturedBoneMatrices.assign(boneMatracies.begin(), boneMatracies.end());
 }
 
 
@@ -1179,37 +1357,4 @@ std::vector<float3> RenderEngine::IrradianceProbeVolume::getProbePositions() con
     }
 
     return positions;
-}
-
-
-void RenderEngine::updateInstanceTransformBuffers(const std::vector<MeshInstance*>& meshes)
-{
-    if(meshes.empty())
-        return;
-
-    std::vector<float3x4> instanceTransforms{};
-    std::vector<float3x4> prevInstanceTransforms{};
-
-    for(MeshInstance* inst : meshes)
-    {
-        inst->setBaseTransformsIndex(instanceTransforms.size());
-
-        float4x4 instanceTransform = inst->getTransMatrix();
-        float4x4 prevInstanceTransform = inst->getPreviousTransMatrix();
-        const std::vector<SubMesh>& subMeshes = inst->getMesh()->getSubMeshes();
-        for(auto& subMesh : subMeshes)
-        {
-            instanceTransforms.push_back(transpose(float4x3(instanceTransform * subMesh.mTransform)));
-            prevInstanceTransforms.push_back(transpose(float4x3(prevInstanceTransform * subMesh.mTransform)));
-        }
-    }
-    Buffer& instanceTransformsBuffer = *mInstanceTransformsBuffer;
-    Buffer& prevInstanceTransformsBuffer = *mPrevInstanceTransformsBuffer;
-    if((instanceTransforms.size() * sizeof(float3x4)) > instanceTransformsBuffer->getSize())
-        instanceTransformsBuffer->resize(instanceTransforms.size() * sizeof(float3x4), false);
-    if((instanceTransforms.size() * sizeof(float3x4)) > prevInstanceTransformsBuffer->getSize())
-        prevInstanceTransformsBuffer->resize(instanceTransforms.size() * sizeof(float3x4), false);
-
-    (*mInstanceTransformsBuffer)->setContents(instanceTransforms.data(), instanceTransforms.size() * sizeof(float3x4));
-    (*mPrevInstanceTransformsBuffer)->setContents(prevInstanceTransforms.data(), prevInstanceTransforms.size() * sizeof(float3x4));
 }
\ No newline at end of file
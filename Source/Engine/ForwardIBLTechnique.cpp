@@ -59,6 +59,8 @@ ForwardIBLTechnique::ForwardIBLTechnique(RenderEngine* eng, RenderGraph& graph)
 
                 UberShaderCachedPipelineStateCache stateCache(exec, mMaterialPipelineVariants);
 
+                const std::vector<uint32_t>& lods = eng->getRenderView(graph.getTask(taskIndex).getInputRenderQueueIndex()).getInstanceLODs();
+
                 for (uint32_t i = 0; i < meshes.size(); ++i)
                 {
                     const auto& mesh = meshes[i];
@@ -68,7 +70,7 @@ ForwardIBLTechnique::ForwardIBLTechnique(RenderEngine* eng, RenderGraph& graph)
 
                     exec->startCommandPredication(pred, i);
 
-                    mesh->draw(exec, &stateCache);
+                    mesh->draw(exec, &stateCache, lods[i]);
 
                     exec->endCommandPredication();
                 }
@@ -86,13 +88,7 @@ ForwardIBLTechnique::ForwardIBLTechnique(RenderEngine* eng, RenderGraph& graph)
 
                 UberShaderCachedPipelineStateCache stateCache(exec, mMaterialPipelineVariants);
 
-                for (const auto& mesh : meshes)
-                {
-                    if (!(mesh->getInstanceFlags() & InstanceFlags::Draw))
-                        continue;
-
-                    mesh->draw(exec, &stateCache);
-                }
+                eng->getRenderView(graph.getTask(taskIndex).getInputRenderQueueIndex()).recordSortedDraws(exec, &stateCache);
             }
         );
     }
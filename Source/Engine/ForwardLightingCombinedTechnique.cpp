@@ -65,6 +65,8 @@ ForwardCombinedLightingTechnique::ForwardCombinedLightingTechnique(RenderEngine*
 
                 UberShaderCachedPipelineStateCache stateCache(exec, mMaterialPipelineVariants);
 
+                const std::vector<uint32_t>& lods = eng->getRenderView(graph.getTask(taskIndex).getInputRenderQueueIndex()).getInstanceLODs();
+
                 for (uint32_t i = 0; i < meshes.size(); ++i)
                 {
                     const auto& mesh = meshes[i];
@@ -74,7 +76,7 @@ ForwardCombinedLightingTechnique::ForwardCombinedLightingTechnique(RenderEngine*
 
                     exec->startCommandPredication(pred, i);
 
-                    mesh->draw(exec, &stateCache);
+                    mesh->draw(exec, &stateCache, lods[i]);
 
                     exec->endCommandPredication();
                 }
@@ -92,13 +94,7 @@ ForwardCombinedLightingTechnique::ForwardCombinedLightingTechnique(RenderEngine*
 
                 UberShaderCachedPipelineStateCache stateCache(exec, mMaterialPipelineVariants);
 
-                for (const auto& mesh : meshes)
-                {
-                    if (!(mesh->getInstanceFlags() & InstanceFlags::Draw))
-                        continue;
-
-                    mesh->draw(exec, &stateCache);
-                }
+                eng->getRenderView(graph.getTask(taskIndex).getInputRenderQueueIndex()).recordSortedDraws(exec, &stateCache);
             }
         );
     }
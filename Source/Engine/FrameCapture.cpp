@@ -0,0 +1,380 @@
+#include "Engine/FrameCapture.hpp"
+#include "Engine/CookedMesh.hpp"
+#include "Engine/Engine.hpp"
+#include "Core/BellLogging.hpp"
+
+#include <algorithm>
+
+
+namespace
+{
+    FrameCapture::CameraState captureCamera(const Camera& camera)
+    {
+        FrameCapture::CameraState state{};
+        state.mPosition = camera.getPosition();
+        state.mDirection = camera.getDirection();
+        state.mUp = camera.getUp();
+        state.mOrthographicSize = camera.getOrthographicSize();
+        state.mNearPlane = camera.getNearPlane();
+        state.mFarPlane = camera.getFarPlane();
+        state.mFOV = camera.getFOV();
+        state.mAspect = camera.getAspect();
+        state.mMode = camera.getMode();
+
+        return state;
+    }
+
+
+    FrameCapture::BoundResource captureResource(const RenderGraph& graph, const char* slot, const RenderGraph::ResourceType type)
+    {
+        FrameCapture::BoundResource resource{slot, type, Format{}, {0, 0, 0}, 0, 1};
+
+        switch(type)
+        {
+            case RenderGraph::ResourceType::Image:
+            {
+                const ImageView& view = graph.getImageView(slot);
+                resource.mFormat = view->getImageViewFormat();
+                resource.mExtent = view->getImageExtent();
+                break;
+            }
+
+            case RenderGraph::ResourceType::ImageArray:
+            {
+                const ImageViewArray& views = graph.getImageArrayViews(slot);
+                resource.mArraySize = static_cast<uint32_t>(views.size());
+                if(!views.empty())
+                {
+                    resource.mFormat = views.front()->getImageViewFormat();
+                    resource.mExtent = views.front()->getImageExtent();
+                }
+                break;
+            }
+
+            case RenderGraph::ResourceType::Buffer:
+                resource.mSize = graph.getBuffer(slot)->getSize();
+                break;
+
+            case RenderGraph::ResourceType::BufferArray:
+            {
+                const BufferViewArray& views = graph.getBufferArrayViews(slot);
+                resource.mArraySize = static_cast<uint32_t>(views.size());
+                for(const BufferView& view : views)
+                    resource.mSize += view->getSize();
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        return resource;
+    }
+
+
+    void writeTask(CookedMesh::Writer& writer, const FrameCapture::Task& task)
+    {
+        writer.writeString(task.mName);
+        writer.write(task.mType);
+        writer.write(task.mRenderView);
+
+        writer.write<uint64_t>(task.mInputs.size());
+        for(const FrameCapture::TaskInput& input : task.mInputs)
+        {
+            writer.writeString(input.mSlot);
+            writer.write(input.mType);
+            writer.write(input.mArraySize);
+        }
+
+        writer.write<uint64_t>(task.mOutputs.size());
+        for(const FrameCapture::TaskOutput& output : task.mOutputs)
+        {
+            writer.writeString(output.mSlot);
+            writer.write(output.mType);
+            writer.write(output.mFormat);
+            writer.write(output.mSize);
+            writer.write(output.mLoadOp);
+            writer.write(output.mStoreOp);
+            writer.write(output.mUsage);
+        }
+    }
+
+
+    FrameCapture::Task readTask(CookedMesh::Reader& reader)
+    {
+        FrameCapture::Task task{};
+        task.mName = reader.readString();
+        task.mType = reader.read<TaskType>();
+        task.mRenderView = reader.read<uint8_t>();
+
+        const uint64_t inputCount = reader.read<uint64_t>();
+        for(uint64_t i = 0; i < inputCount && reader.isValid(); ++i)
+        {
+            FrameCapture::TaskInput input{};
+            input.mSlot = reader.readString();
+            input.mType = reader.read<AttachmentType>();
+            input.mArraySize = reader.read<uint64_t>();
+            task.mInputs.push_back(input);
+        }
+
+        const uint64_t outputCount = reader.read<uint64_t>();
+        for(uint64_t i = 0; i < outputCount && reader.isValid(); ++i)
+        {
+            FrameCapture::TaskOutput output{};
+            output.mSlot = reader.readString();
+            output.mType = reader.read<AttachmentType>();
+            output.mFormat = reader.read<Format>();
+            output.mSize = reader.read<SizeClass>();
+            output.mLoadOp = reader.read<LoadOp>();
+            output.mStoreOp = reader.read<StoreOp>();
+            output.mUsage = reader.read<ImageUsage>();
+            task.mOutputs.push_back(output);
+        }
+
+        return task;
+    }
+}
+
+
+namespace FrameCapture
+{
+
+    Frame captureFrame(RenderEngine& engine, const std::vector<float4x4>& boneMatrices)
+    {
+        Frame frame{};
+
+        const Scene* scene = engine.getScene();
+        if(scene)
+            frame.mScenePath = scene->getPath().string();
+
+        const ImageExtent extent = engine.getSwapChainImage()->getExtent(0, 0);
+        frame.mRegisteredPasses = engine.getRegisteredPasses();
+        frame.mWidth = extent.width;
+        frame.mHeight = extent.height;
+        frame.mFrameDelta = engine.getFrameUpdateDelta();
+        frame.mCamera = captureCamera(engine.getCurrentSceneCamera());
+
+        const RenderGraph& graph = engine.getRenderGraph();
+        for(TaskIterator task = graph.taskBegin(); task != graph.taskEnd(); ++task)
+        {
+            const RenderTask& renderTask = *task;
+
+            Task capturedTask{renderTask.getName(), renderTask.taskType(), renderTask.getInputRenderQueueIndex(), {}, {}};
+            for(const RenderTask::InputAttachmentInfo& input : renderTask.getInputAttachments())
+                capturedTask.mInputs.push_back({input.mName, input.mType, input.mArraySize});
+            for(const RenderTask::OutputAttachmentInfo& output : renderTask.getOuputAttachments())
+                capturedTask.mOutputs.push_back({output.mName, output.mType, output.mFormat, output.mSize, output.mLoadOp, output.mStoreOp, output.mUsage});
+
+            frame.mTasks.push_back(std::move(capturedTask));
+        }
+        frame.mDependancies = graph.getCompiledDependancies();
+
+        for(const auto& [slot, type] : graph.getBoundResources())
+            frame.mResources.push_back(captureResource(graph, slot, type));
+
+        // Bound resources come out of hash maps, so sort them to make captures comparable.
+        std::sort(frame.mResources.begin(), frame.mResources.end(), [](const BoundResource& lhs, const BoundResource& rhs) { return lhs.mSlot < rhs.mSlot; });
+
+        std::vector<const MeshInstance*> instances{};
+        for(uint32_t view_i = 0; view_i < kRenderView_Count; ++view_i)
+        {
+            const RenderView& renderView = engine.getRenderView(view_i);
+            View& view = frame.mViews[view_i];
+
+            for(const MeshInstance* instance : renderView.getViewConstInstances())
+            {
+                view.mInstances.push_back(instance->getID());
+                instances.push_back(instance);
+            }
+            view.mLODs = renderView.getInstanceLODs();
+            view.mDraws = renderView.getSortedDraws();
+        }
+
+        std::sort(instances.begin(), instances.end(), [](const MeshInstance* lhs, const MeshInstance* rhs) { return lhs->getID() < rhs->getID(); });
+        instances.erase(std::unique(instances.begin(), instances.end()), instances.end());
+
+        for(const MeshInstance* instance : instances)
+        {
+            frame.mInstances.push_back({instance->getID(), instance->getPosition(), instance->getRotation(), instance->getScale(),
+                                        instance->getTransMatrix(), instance->getInstanceFlags(), instance->getGlobalBoneBufferOffset()});
+        }
+
+        frame.mBoneMatrices = boneMatrices;
+
+        return frame;
+    }
+
+
+    bool writeToFile(const std::string& path, const Frame& frame)
+    {
+        CookedMesh::Writer writer{};
+        writer.write(kMagic);
+        writer.write(kVersion);
+
+        writer.writeString(frame.mScenePath);
+        writer.write(frame.mRegisteredPasses);
+        writer.write(frame.mWidth);
+        writer.write(frame.mHeight);
+        writer.write<int64_t>(frame.mFrameDelta.count());
+        writer.write(frame.mCamera);
+
+        writer.write<uint64_t>(frame.mTasks.size());
+        for(const Task& task : frame.mTasks)
+            writeTask(writer, task);
+
+        writer.write<uint64_t>(frame.mDependancies.size());
+        for(const auto& [dependancy, dependant] : frame.mDependancies)
+        {
+            writer.write(dependancy);
+            writer.write(dependant);
+        }
+
+        writer.write<uint64_t>(frame.mResources.size());
+        for(const BoundResource& resource : frame.mResources)
+        {
+            writer.writeString(resource.mSlot);
+            writer.write(resource.mType);
+            writer.write(resource.mFormat);
+            writer.write(resource.mExtent);
+            writer.write(resource.mSize);
+            writer.write(resource.mArraySize);
+        }
+
+        writer.writeVector(frame.mInstances);
+        for(const View& view : frame.mViews)
+        {
+            writer.writeVector(view.mInstances);
+            writer.writeVector(view.mLODs);
+            writer.writeVector(view.mDraws);
+        }
+        writer.writeVector(frame.mBoneMatrices);
+
+        return writer.writeToFile(path);
+    }
+
+
+    bool readFromFile(const std::string& path, Frame& frame)
+    {
+        CookedMesh::MappedFile file{path};
+        if(!file.isValid())
+        {
+            BELL_LOG_ARGS("Unable to open frame capture %s", path.c_str())
+            return false;
+        }
+
+        CookedMesh::Reader reader{file.getData(), file.getSize()};
+        const uint32_t magic = reader.read<uint32_t>();
+        const uint32_t version = reader.read<uint32_t>();
+        if(magic != kMagic || version != kVersion)
+        {
+            BELL_LOG_ARGS("%s is not a version %u frame capture", path.c_str(), kVersion)
+            return false;
+        }
+
+        frame = Frame{};
+        frame.mScenePath = reader.readString();
+        frame.mRegisteredPasses = reader.read<uint64_t>();
+        frame.mWidth = reader.read<uint32_t>();
+        frame.mHeight = reader.read<uint32_t>();
+        frame.mFrameDelta = std::chrono::microseconds(reader.read<int64_t>());
+        frame.mCamera = reader.read<CameraState>();
+
+        const uint64_t taskCount = reader.read<uint64_t>();
+        for(uint64_t i = 0; i < taskCount && reader.isValid(); ++i)
+            frame.mTasks.push_back(readTask(reader));
+
+        const uint64_t dependancyCount = reader.read<uint64_t>();
+        for(uint64_t i = 0; i < dependancyCount && reader.isValid(); ++i)
+        {
+            const uint32_t dependancy = reader.read<uint32_t>();
+            const uint32_t dependant = reader.read<uint32_t>();
+            frame.mDependancies.push_back({dependancy, dependant});
+        }
+
+        const uint64_t resourceCount = reader.read<uint64_t>();
+        for(uint64_t i = 0; i < resourceCount && reader.isValid(); ++i)
+        {
+            BoundResource resource{};
+            resource.mSlot = reader.readString();
+            resource.mType = reader.read<RenderGraph::ResourceType>();
+            resource.mFormat = reader.read<Format>();
+            resource.mExtent = reader.read<ImageExtent>();
+            resource.mSize = reader.read<uint64_t>();
+            resource.mArraySize = reader.read<uint32_t>();
+            frame.mResources.push_back(resource);
+        }
+
+        frame.mInstances = reader.readVector<Instance>();
+        for(View& view : frame.mViews)
+        {
+            view.mInstances = reader.readVector<InstanceID>();
+            view.mLODs = reader.readVector<uint32_t>();
+            view.mDraws = reader.readVector<ViewDraw>();
+        }
+        frame.mBoneMatrices = reader.readVector<float4x4>();
+
+        if(!reader.isValid())
+        {
+            BELL_LOG_ARGS("Frame capture %s is truncated", path.c_str())
+            return false;
+        }
+
+        return true;
+    }
+
+
+    void applyCamera(const CameraState& state, Camera& camera)
+    {
+        camera.setMode(state.mMode);
+        camera.setPosition(state.mPosition);
+        camera.setDirection(state.mDirection);
+        camera.setUp(state.mUp);
+        camera.setOrthographicSize(state.mOrthographicSize);
+        camera.setNearPlane(state.mNearPlane);
+        camera.setFarPlane(state.mFarPlane);
+        camera.setFOVDegrees(state.mFOV);
+        camera.setAspect(state.mAspect);
+    }
+
+
+    std::vector<std::string> compareGraphs(const Frame& expected, const Frame& actual)
+    {
+        std::vector<std::string> differences{};
+
+        if(expected.mTasks.size() != actual.mTasks.size())
+            differences.push_back("Task count " + std::to_string(expected.mTasks.size()) + " != " + std::to_string(actual.mTasks.size()));
+
+        const size_t taskCount = std::min(expected.mTasks.size(), actual.mTasks.size());
+        for(size_t i = 0; i < taskCount; ++i)
+        {
+            const Task& expectedTask = expected.mTasks[i];
+            const Task& actualTask = actual.mTasks[i];
+
+            if(expectedTask.mName != actualTask.mName)
+            {
+                differences.push_back("Task " + std::to_string(i) + " is " + actualTask.mName + " not " + expectedTask.mName);
+                continue;
+            }
+
+            const bool inputsMatch = std::equal(expectedTask.mInputs.begin(), expectedTask.mInputs.end(), actualTask.mInputs.begin(), actualTask.mInputs.end(),
+                                                [](const TaskInput& lhs, const TaskInput& rhs) { return lhs.mSlot == rhs.mSlot && lhs.mType == rhs.mType; });
+            const bool outputsMatch = std::equal(expectedTask.mOutputs.begin(), expectedTask.mOutputs.end(), actualTask.mOutputs.begin(), actualTask.mOutputs.end(),
+                                                 [](const TaskOutput& lhs, const TaskOutput& rhs) { return lhs.mSlot == rhs.mSlot && lhs.mType == rhs.mType && lhs.mFormat == rhs.mFormat; });
+            if(!inputsMatch || !outputsMatch)
+                differences.push_back("Task " + expectedTask.mName + " has different slots");
+        }
+
+        if(expected.mDependancies != actual.mDependancies)
+            differences.push_back("Task dependancies differ");
+
+        for(const BoundResource& resource : expected.mResources)
+        {
+            const bool bound = std::any_of(actual.mResources.begin(), actual.mResources.end(), [&resource](const BoundResource& other) { return other.mSlot == resource.mSlot; });
+            if(!bound)
+                differences.push_back("Slot " + resource.mSlot + " isn't bound");
+        }
+
+        return differences;
+    }
+
+}
@@ -4,6 +4,29 @@
 #include "Core/Executor.hpp"
 
 
+namespace
+{
+    void recordIndirectDraws(Executor* exec, RenderEngine* eng, UberShaderStateCache& stateCache)
+    {
+        const BufferView& commands = eng->getRenderGraph().getBuffer(kIndirectDrawLateCommands);
+        const BufferView& counts = eng->getRenderGraph().getBuffer(kIndirectDrawLateCounts);
+        const GeometryPool& pool = eng->getGeometryPool();
+
+        // One draw count per bucket, the culling passes have already compacted the visible draws from both phases.
+        const std::vector<IndirectDrawList::Bucket>& buckets = eng->getIndirectDrawList().getBuckets();
+        for(uint32_t i = 0; i < buckets.size(); ++i)
+        {
+            const IndirectDrawList::Bucket& bucket = buckets[i];
+            stateCache.update(bucket.mShadeFlags);
+
+            exec->bindVertexBuffer(pool.getVertexBufferView(bucket.mBlock), 0);
+            exec->bindIndexBuffer(pool.getIndexBufferView(bucket.mBlock), 0);
+            exec->indexedIndirectDrawCount(bucket.mMaxDraws, commands, bucket.mFirstDraw, counts, i);
+        }
+    }
+}
+
+
 GBufferTechnique::GBufferTechnique(RenderEngine* eng, RenderGraph& graph) :
 	Technique{"GBuffer", eng->getDevice()},
     mMaterialPipelineVariants{},
@@ -22,6 +45,13 @@ GBufferTechnique::GBufferTechnique(RenderEngine* eng, RenderGraph& graph) :
     task.addInput(kBoneTransforms, AttachmentType::DataBufferRO);
     task.addInput(kInstanceTransformsBuffer, AttachmentType::DataBufferRO);
     task.addInput(kPreviousInstanceTransformsBuffer, AttachmentType::DataBufferRO);
+    if(eng->isPassRegistered(PassType::IndirectDrawCulling))
+    {
+        // The late names order the pass after both culling phases.
+        task.addInput(kIndirectDrawLateEntries, AttachmentType::DataBufferRO);
+        task.addInput(kIndirectDrawLateCommands, AttachmentType::IndirectBuffer);
+        task.addInput(kIndirectDrawLateCounts, AttachmentType::IndirectBuffer);
+    }
     task.addInput(kMaterials, AttachmentType::ShaderResourceSet);
     task.addInput("Model Matrix", AttachmentType::PushConstants);
 
@@ -32,7 +62,24 @@ GBufferTechnique::GBufferTechnique(RenderEngine* eng, RenderGraph& graph) :
     task.addManagedOutput(kGBufferEmissiveOcclusion,   AttachmentType::RenderTarget2D, Format::RGBA8UNorm, SizeClass::Swapchain, LoadOp::Clear_ColourBlack_AlphaWhite);
     task.addManagedOutput(kGBufferDepth,      AttachmentType::Depth, Format::D32Float, SizeClass::Swapchain, LoadOp::Clear_Black, StoreOp::Store, ImageUsage::DepthStencil | ImageUsage::Sampled);
 
-    if(eng->isPassRegistered(PassType::OcclusionCulling))
+    if(eng->isPassRegistered(PassType::IndirectDrawCulling))
+    {
+        task.setRecordCommandsCallback(
+            [this](const RenderGraph& graph, const uint32_t taskIndex, Executor* exec, RenderEngine* eng, const std::vector<const MeshInstance*>&)
+            {
+                PROFILER_EVENT("gbuffer fill");
+                PROFILER_GPU_TASK(exec);
+                PROFILER_GPU_EVENT("gbuffer fill");
+
+                UberShaderCachedPipelineStateCache stateCache(exec, mMaterialPipelineVariants);
+
+                recordIndirectDraws(exec, eng, stateCache);
+
+                exec->setSubmitFlag();
+            }
+        );
+    }
+    else if(eng->isPassRegistered(PassType::OcclusionCulling))
     {
         task.setRecordCommandsCallback(
             [this](const RenderGraph& graph, const uint32_t taskIndex, Executor* exec, RenderEngine* eng, const std::vector<const MeshInstance*>& meshes)
@@ -45,6 +92,8 @@ GBufferTechnique::GBufferTechnique(RenderEngine* eng, RenderGraph& graph) :
 
                 UberShaderCachedPipelineStateCache stateCache(exec, mMaterialPipelineVariants);
 
+                const std::vector<uint32_t>& lods = eng->getRenderView(graph.getTask(taskIndex).getInputRenderQueueIndex()).getInstanceLODs();
+
                 for (uint32_t i = 0; i < meshes.size(); ++i)
                 {
                     const auto* mesh = meshes[i];
@@ -54,7 +103,7 @@ GBufferTechnique::GBufferTechnique(RenderEngine* eng, RenderGraph& graph) :
 
                     exec->startCommandPredication(pred, i);
 
-                    mesh->draw(exec, &stateCache);
+                    mesh->draw(exec, &stateCache, lods[i]);
 
                     exec->endCommandPredication();
                 }
@@ -74,14 +123,7 @@ GBufferTechnique::GBufferTechnique(RenderEngine* eng, RenderGraph& graph) :
 
                 UberShaderCachedPipelineStateCache stateCache(exec, mMaterialPipelineVariants);
 
-                for (const auto& mesh : meshes)
-                {
-                    if (!(mesh->getInstanceFlags() & InstanceFlags::Draw))
-                        continue;
-
-                    mesh->draw(exec, &stateCache);
-
-                }
+                eng->getRenderView(graph.getTask(taskIndex).getInputRenderQueueIndex()).recordSortedDraws(exec, &stateCache);
 
                 exec->setSubmitFlag();
             }
@@ -94,7 +136,8 @@ GBufferTechnique::GBufferTechnique(RenderEngine* eng, RenderGraph& graph) :
 
 void GBufferTechnique::postGraphCompilation(RenderGraph& graph, RenderEngine* engine)
 {
-    compileShadeFlagsPipelines(mMaterialPipelineVariants, "./Shaders/GBufferPassThrough.vert", "./Shaders/GBuffer.frag", engine, graph, mTaskID);
+    compileShadeFlagsPipelines(mMaterialPipelineVariants, "./Shaders/GBufferPassThrough.vert", "./Shaders/GBuffer.frag", engine, graph, mTaskID,
+                              engine->isPassRegistered(PassType::IndirectDrawCulling) ? kShade_IndirectDraw : 0);
 }
 
 
@@ -116,6 +159,13 @@ GBufferPreDepthTechnique::GBufferPreDepthTechnique(RenderEngine* eng, RenderGrap
     task.addInput(kBoneTransforms, AttachmentType::DataBufferRO);
     task.addInput(kInstanceTransformsBuffer, AttachmentType::DataBufferRO);
     task.addInput(kPreviousInstanceTransformsBuffer, AttachmentType::DataBufferRO);
+    if(eng->isPassRegistered(PassType::IndirectDrawCulling))
+    {
+        // The late names order the pass after both culling phases.
+        task.addInput(kIndirectDrawLateEntries, AttachmentType::DataBufferRO);
+        task.addInput(kIndirectDrawLateCommands, AttachmentType::IndirectBuffer);
+        task.addInput(kIndirectDrawLateCounts, AttachmentType::IndirectBuffer);
+    }
     task.addInput(kMaterials, AttachmentType::ShaderResourceSet);
     task.addInput("Model Matrix", AttachmentType::PushConstants);
 
@@ -126,7 +176,24 @@ GBufferPreDepthTechnique::GBufferPreDepthTechnique(RenderEngine* eng, RenderGrap
     task.addManagedOutput(kGBufferEmissiveOcclusion, AttachmentType::RenderTarget2D, Format::RGBA8UNorm, SizeClass::Swapchain, LoadOp::Clear_ColourBlack_AlphaWhite);
     task.addOutput(kGBufferDepth, AttachmentType::Depth, Format::D32Float, LoadOp::Preserve);
 
-    if(eng->isPassRegistered(PassType::OcclusionCulling))
+    if(eng->isPassRegistered(PassType::IndirectDrawCulling))
+    {
+        task.setRecordCommandsCallback(
+            [this](const RenderGraph& graph, const uint32_t taskIndex, Executor* exec, RenderEngine* eng, const std::vector<const MeshInstance*>&)
+            {
+                PROFILER_EVENT("gbuffer fill");
+                PROFILER_GPU_TASK(exec);
+                PROFILER_GPU_EVENT("gbuffer fill");
+
+                UberShaderCachedPipelineStateCache stateCache(exec, mMaterialPipelineVariants);
+
+                recordIndirectDraws(exec, eng, stateCache);
+
+                exec->setSubmitFlag();
+            }
+        );
+    }
+    else if(eng->isPassRegistered(PassType::OcclusionCulling))
     {
         task.setRecordCommandsCallback(
             [this](const RenderGraph& graph, const uint32_t taskIndex, Executor* exec, RenderEngine* eng, const std::vector<const MeshInstance*>& meshes)
@@ -139,6 +206,8 @@ GBufferPreDepthTechnique::GBufferPreDepthTechnique(RenderEngine* eng, RenderGrap
 
                 UberShaderCachedPipelineStateCache stateCache(exec, mMaterialPipelineVariants);
 
+                const std::vector<uint32_t>& lods = eng->getRenderView(graph.getTask(taskIndex).getInputRenderQueueIndex()).getInstanceLODs();
+
                 for (uint32_t i = 0; i < meshes.size(); ++i)
                 {
                     const auto& mesh = meshes[i];
@@ -148,7 +217,7 @@ GBufferPreDepthTechnique::GBufferPreDepthTechnique(RenderEngine* eng, RenderGrap
 
                     exec->startCommandPredication(pred, i);
 
-                    mesh->draw(exec, &stateCache);
+                    mesh->draw(exec, &stateCache, lods[i]);
 
                     exec->endCommandPredication();
                 }
@@ -168,13 +237,7 @@ GBufferPreDepthTechnique::GBufferPreDepthTechnique(RenderEngine* eng, RenderGrap
 
                 UberShaderCachedPipelineStateCache stateCache(exec, mMaterialPipelineVariants);
 
-                for (const auto& mesh : meshes)
-                {
-                    if (!(mesh->getInstanceFlags() & InstanceFlags::Draw))
-                        continue;
-
-                    mesh->draw(exec, &stateCache);
-                  }
+                eng->getRenderView(graph.getTask(taskIndex).getInputRenderQueueIndex()).recordSortedDraws(exec, &stateCache);
 
                 exec->setSubmitFlag();
             }
@@ -187,6 +250,7 @@ GBufferPreDepthTechnique::GBufferPreDepthTechnique(RenderEngine* eng, RenderGrap
 
 void GBufferPreDepthTechnique::postGraphCompilation(RenderGraph& graph, RenderEngine* engine)
 {
-    compileShadeFlagsPipelines(mMaterialPipelineVariants, "./Shaders/GBufferPassThrough.vert", "./Shaders/GBuffer.frag", engine, graph, mTaskID);
+    compileShadeFlagsPipelines(mMaterialPipelineVariants, "./Shaders/GBufferPassThrough.vert", "./Shaders/GBuffer.frag", engine, graph, mTaskID,
+                              engine->isPassRegistered(PassType::IndirectDrawCulling) ? kShade_IndirectDraw : 0);
 }
 
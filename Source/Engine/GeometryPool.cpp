@@ -0,0 +1,143 @@
+#include "Engine/GeometryPool.hpp"
+#include "Engine/StaticMesh.h"
+#include "Core/RenderDevice.hpp"
+#include "Core/BellLogging.hpp"
+#include "Core/Profiling.hpp"
+
+#include <algorithm>
+
+
+namespace
+{
+    constexpr uint32_t kInitialMeshletCapacity = 4096;
+}
+
+
+GeometryPool::Block::Block(RenderDevice* dev, const uint32_t vertexStride, const uint32_t vertexCapacity, const uint32_t indexCapacity) :
+    mVertexStride(vertexStride),
+    mVertexCapacity(vertexCapacity),
+    mVertexCount(0),
+    mIndexCapacity(indexCapacity),
+    mIndexCount(0),
+    mVertexBuffer(dev, BufferUsage::TransferDest | BufferUsage::Vertex | BufferUsage::DataBuffer, vertexStride * vertexCapacity, vertexStride * vertexCapacity, "Geometry pool vertex buffer"),
+    mVertexBufferView(mVertexBuffer),
+    mIndexBuffer(dev, BufferUsage::TransferDest | BufferUsage::Index, sizeof(uint32_t) * indexCapacity, sizeof(uint32_t) * indexCapacity, "Geometry pool index buffer"),
+    mIndexBufferView(mIndexBuffer)
+{
+}
+
+
+GeometryPool::GeometryPool(RenderDevice* dev) :
+    mDevice(dev),
+    mBlocks{},
+    mAllocations{},
+    mMeshlets{},
+    mMeshletBuffer(dev, BufferUsage::DataBuffer | BufferUsage::TransferDest, sizeof(Meshlet) * kInitialMeshletCapacity, sizeof(Meshlet), "Geometry pool meshlets"),
+    mMeshletBufferView(mMeshletBuffer)
+{
+}
+
+
+const GeometryPool::Allocation& GeometryPool::getAllocation(const StaticMesh* mesh)
+{
+    auto allocation = mAllocations.find(mesh);
+    if(allocation != mAllocations.end())
+        return allocation->second;
+
+    PROFILER_EVENT();
+
+    const std::vector<unsigned char>& vertexData = mesh->getVertexData();
+    const std::vector<uint32_t>& indexData = mesh->getIndexData();
+    const uint32_t vertexStride = mesh->getVertexStride();
+    const uint32_t vertexCount = static_cast<uint32_t>(vertexData.size() / vertexStride);
+    const uint32_t indexCount = static_cast<uint32_t>(indexData.size());
+
+    const uint32_t blockIndex = findBlock(vertexStride, vertexCount, indexCount);
+    Block& block = *mBlocks[blockIndex];
+
+    const Allocation newAllocation{blockIndex, block.mVertexCount, block.mIndexCount, static_cast<uint32_t>(mMeshlets.size())};
+
+    // Indices stay relative to the mesh, draws add the vertex offset.
+    block.mVertexBuffer->setContents(vertexData.data(), vertexCount * vertexStride, block.mVertexCount * vertexStride);
+    block.mIndexBuffer->setContents(indexData.data(), indexCount * sizeof(uint32_t), block.mIndexCount * sizeof(uint32_t));
+
+    addMeshlets(mesh->getMeshlets(), block.mIndexCount);
+
+    block.mVertexCount += vertexCount;
+    block.mIndexCount += indexCount;
+
+    return mAllocations.insert({mesh, newAllocation}).first->second;
+}
+
+
+void GeometryPool::updateLastAccessed()
+{
+    for(std::unique_ptr<Block>& block : mBlocks)
+    {
+        block->mVertexBuffer->updateLastAccessed();
+        block->mIndexBuffer->updateLastAccessed();
+    }
+
+    mMeshletBuffer->updateLastAccessed();
+}
+
+
+void GeometryPool::clear()
+{
+    mAllocations.clear();
+    mBlocks.clear();
+    mMeshlets.clear();
+}
+
+
+void GeometryPool::addMeshlets(const std::vector<Meshlet>& meshlets, const uint32_t indexOffset)
+{
+    if(meshlets.empty())
+        return;
+
+    const uint32_t firstMeshlet = static_cast<uint32_t>(mMeshlets.size());
+    for(const Meshlet& meshlet : meshlets)
+    {
+        mMeshlets.push_back(meshlet);
+        mMeshlets.back().mIndexOffset += indexOffset;
+    }
+
+    // Grow by doubling, the old buffer is kept alive until the frames in flight are done with it.
+    const uint64_t requiredSize = mMeshlets.size() * sizeof(Meshlet);
+    if(mMeshletBuffer->getSize() < requiredSize)
+    {
+        uint64_t newSize = mMeshletBuffer->getSize();
+        while(newSize < requiredSize)
+            newSize *= 2;
+
+        mMeshletBuffer->resize(static_cast<uint32_t>(newSize), false);
+        mMeshletBuffer->setContents(mMeshlets.data(), requiredSize);
+        mMeshletBufferView = BufferView(mMeshletBuffer);
+    }
+    else
+    {
+        mMeshletBuffer->setContents(mMeshlets.data() + firstMeshlet, meshlets.size() * sizeof(Meshlet), firstMeshlet * sizeof(Meshlet));
+    }
+}
+
+
+uint32_t GeometryPool::findBlock(const uint32_t vertexStride, const uint32_t vertexCount, const uint32_t indexCount)
+{
+    for(uint32_t i = 0; i < mBlocks.size(); ++i)
+    {
+        const Block& block = *mBlocks[i];
+        if(block.mVertexStride == vertexStride &&
+           (block.mVertexCount + vertexCount) <= block.mVertexCapacity &&
+           (block.mIndexCount + indexCount) <= block.mIndexCapacity)
+            return i;
+    }
+
+    // Meshes bigger than a block get one to themselves.
+    const uint32_t vertexCapacity = std::max(kBlockVertexBytes / vertexStride, vertexCount);
+    const uint32_t indexCapacity = std::max(kBlockIndexCount, indexCount);
+    mBlocks.push_back(std::make_unique<Block>(mDevice, vertexStride, vertexCapacity, indexCapacity));
+
+    BELL_LOG_ARGS("Geometry pool block %zu created, stride %u", mBlocks.size() - 1, vertexStride)
+
+    return static_cast<uint32_t>(mBlocks.size() - 1);
+}
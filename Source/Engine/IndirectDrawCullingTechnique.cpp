@@ -0,0 +1,248 @@
+#include "Engine/IndirectDrawCullingTechnique.hpp"
+#include "Engine/DefaultResourceSlots.hpp"
+#include "Engine/Engine.hpp"
+#include "Engine/UberShaderStateCache.hpp"
+#include "Engine/UtilityTasks.hpp"
+
+#include "Core/Executor.hpp"
+#include "Core/BarrierManager.hpp"
+
+#include <cmath>
+
+constexpr const char kIndirectDrawCullingSampler[] = "IndirectDrawCullingSampler";
+constexpr const char kIndirectDrawOcclusionDepth[] = "IndirectDrawOcclusionDepth";
+constexpr const char kIndirectDrawHiZ[] = "IndirectDrawHiZ";
+
+constexpr const char* kIndirectDrawHiZMipNames[] = {"IndirectDrawHiZ1", "IndirectDrawHiZ2", "IndirectDrawHiZ3", "IndirectDrawHiZ4", "IndirectDrawHiZ5", "IndirectDrawHiZ6",
+                                                    "IndirectDrawHiZ7", "IndirectDrawHiZ8", "IndirectDrawHiZ9", "IndirectDrawHiZ10", "IndirectDrawHiZ11"};
+
+
+namespace
+{
+    struct CullingConstants
+    {
+        uint32_t mDrawCount;
+        uint32_t mOcclusionCulling;
+        uint32_t mSecondPhase;
+    };
+
+    // Both phases use the same shader, so their inputs need to match up binding for binding.
+    void addCullingInputs(ComputeTask& task, const char* commands, const char* entries, const char* counts, const char* depth, const AttachmentType retestType)
+    {
+        task.addInput(kIndirectDrawCandidates, AttachmentType::DataBufferRO);
+        task.addInput(commands, AttachmentType::DataBufferWO);
+        task.addInput(entries, AttachmentType::DataBufferWO);
+        task.addInput(counts, AttachmentType::DataBufferRW);
+        task.addInput(kCameraBuffer, AttachmentType::UniformBuffer);
+        task.addInput(depth, AttachmentType::Texture2D);
+        task.addInput(kIndirectDrawCullingSampler, AttachmentType::Sampler);
+        task.addInput(kIndirectDrawWork, AttachmentType::DataBufferRO);
+        task.addInput(kMeshlets, AttachmentType::DataBufferRO);
+        task.addInput(kInstanceTransformsBuffer, AttachmentType::DataBufferRO);
+        task.addInput(kIndirectDrawOcclusionRetest, retestType);
+        task.addInput("CullingConstants", AttachmentType::PushConstants);
+    }
+}
+
+
+IndirectDrawCullingTechnique::IndirectDrawCullingTechnique(RenderEngine* eng, RenderGraph& graph) :
+    Technique("Indirect draw culling", eng->getDevice()),
+    mMipLevels{static_cast<uint32_t>(std::ceil(std::log2(eng->getSwapChainImage()->getExtent(0, 0).height)))},
+    mIndirectDrawCullingShader(eng->getShader("./Shaders/IndirectDrawCulling.comp")),
+    // The linearise depth shader already builds the min/max linear depth chain the culling shader reads.
+    mHierarchicalDepthShader(mMipLevels == 10 ? eng->getShader("./Shaders/LineariseDepth10.comp") : eng->getShader("./Shaders/LineariseDepth11.comp")),
+    mOcclusionSampler(SamplerType::Point),
+    mOcclusionDepthDescription{Rect{getDevice()->getSwapChain()->getSwapChainImageWidth(),
+                               getDevice()->getSwapChain()->getSwapChainImageHeight()},
+                         Rect{getDevice()->getSwapChain()->getSwapChainImageWidth(),
+                         getDevice()->getSwapChain()->getSwapChainImageHeight()},
+                         FaceWindingOrder::CW, BlendMode::None, BlendMode::None, true, DepthTest::GreaterEqual, FillMode::Fill, Primitive::TriangleList},
+    mOcclusionDepthPipelines{0, 0},
+    mHierarchicalDepth(eng->getDevice(), Format::RG16Float, ImageUsage::Sampled | ImageUsage::Storage, eng->getSwapChainImage()->getExtent(0, 0).width, eng->getSwapChainImage()->getExtent(0, 0).height,
+        1, mMipLevels, 1, 1, "Indirect draw Hi-Z"),
+    mHierarchicalDepthView(mHierarchicalDepth, ImageViewType::Colour, 0, 1, 0, mMipLevels),
+    mHierarchicalDepthMips{}
+{
+    BELL_ASSERT(getDevice()->getHasIndirectDrawCountSupport(), "Device does not have indirect draw count support")
+    BELL_ASSERT(mMipLevels < 12, "Need to add more shader varientas")
+
+    mOcclusionSampler.setAddressModeU(AddressMode::Clamp);
+    mOcclusionSampler.setAddressModeV(AddressMode::Clamp);
+
+    for(uint32_t i = 1; i < mMipLevels; ++i)
+        mHierarchicalDepthMips.push_back(ImageView(mHierarchicalDepth, ImageViewType::Colour, 0, 1, i, 1));
+
+    auto recordCulling = [this](const RenderGraph& graph, const uint32_t taskIndex, Executor* exec, RenderEngine* eng, const bool secondPhase)
+    {
+        // The draw list is built for the main view before recording starts.
+        const uint32_t drawCount = eng->getIndirectDrawList().getDrawCount();
+        if(drawCount == 0)
+            return;
+
+        // Last frames depth doesn't tell us anything about what the debug camera can see, so nothing is left to retest.
+        const bool occlusionCulling = !eng->getDebugCameraActive();
+        if(secondPhase && !occlusionCulling)
+            return;
+
+        const RenderTask& task = graph.getTask(taskIndex);
+        exec->setComputeShader(static_cast<const ComputeTask&>(task), graph, mIndirectDrawCullingShader);
+
+        // The second phase appends to the first phases counts, which the graph only sees under their early names.
+        if(secondPhase)
+        {
+            BarrierRecorder recorder{eng->getDevice()};
+            recorder->memoryBarrier(eng->getRenderGraph().getBuffer(kIndirectDrawLateCounts), Hazard::ReadAfterWrite, SyncPoint::ComputeShader, SyncPoint::ComputeShader);
+
+            exec->recordBarriers(recorder);
+        }
+
+        const CullingConstants constants{drawCount, occlusionCulling ? 1u : 0u, secondPhase ? 1u : 0u};
+
+        exec->insertPushConstant(&constants, sizeof(CullingConstants));
+        exec->dispatch(std::ceil(drawCount / 64.0f), 1, 1);
+    };
+
+    {
+        ComputeTask task{"Indirect draw culling"};
+        addCullingInputs(task, kIndirectDrawCommands, kIndirectDrawEntries, kIndirectDrawCounts, kPreviousLinearDepth, AttachmentType::DataBufferWO);
+        task.setRecordCommandsCallback(
+            [recordCulling](const RenderGraph& graph, const uint32_t taskIndex, Executor* exec, RenderEngine* eng, const std::vector<const MeshInstance*>&)
+            {
+                PROFILER_EVENT("Indirect draw culling");
+                PROFILER_GPU_TASK(exec);
+                PROFILER_GPU_EVENT("Indirect draw culling");
+
+                recordCulling(graph, taskIndex, exec, eng, false);
+            }
+        );
+
+        graph.addTask(task);
+    }
+
+    // Depth of everything the first phase kept, to build this frames Hi-Z from.
+    {
+        GraphicsTask task{"Indirect draw occlusion depth", mOcclusionDepthDescription};
+
+        task.setVertexAttributes(VertexAttributes::Position4 | VertexAttributes::Normals | VertexAttributes::Tangents | VertexAttributes::TextureCoordinates | VertexAttributes::Albedo);
+
+        task.addInput(kCameraBuffer, AttachmentType::UniformBuffer);
+        task.addInput(kDefaultSampler, AttachmentType::Sampler);
+        task.addInput(kBoneTransforms, AttachmentType::DataBufferRO);
+        task.addInput(kInstanceTransformsBuffer, AttachmentType::DataBufferRO);
+        task.addInput(kIndirectDrawEntries, AttachmentType::DataBufferRO);
+        task.addInput(kIndirectDrawCommands, AttachmentType::IndirectBuffer);
+        task.addInput(kIndirectDrawCounts, AttachmentType::IndirectBuffer);
+
+        task.addManagedOutput(kIndirectDrawOcclusionDepth, AttachmentType::Depth, Format::D32Float, SizeClass::Swapchain, LoadOp::Clear_Black, StoreOp::Store, ImageUsage::DepthStencil | ImageUsage::Sampled);
+
+        task.setRecordCommandsCallback(
+            [this](const RenderGraph& graph, const uint32_t, Executor* exec, RenderEngine* eng, const std::vector<const MeshInstance*>&)
+            {
+                PROFILER_EVENT("Indirect draw occlusion depth");
+                PROFILER_GPU_TASK(exec);
+                PROFILER_GPU_EVENT("Indirect draw occlusion depth");
+
+                if(eng->getDebugCameraActive())
+                    return;
+
+                const BufferView& commands = graph.getBuffer(kIndirectDrawCommands);
+                const BufferView& counts = graph.getBuffer(kIndirectDrawCounts);
+                const GeometryPool& pool = eng->getGeometryPool();
+
+                UberShaderSkinnedStateCache stateCache(exec, mOcclusionDepthPipelines);
+
+                const std::vector<IndirectDrawList::Bucket>& buckets = eng->getIndirectDrawList().getBuckets();
+                for(uint32_t i = 0; i < buckets.size(); ++i)
+                {
+                    const IndirectDrawList::Bucket& bucket = buckets[i];
+
+                    // Drawn without their alpha, so they would hide things through their holes.
+                    if(bucket.mShadeFlags & (kMaterial_AlphaTested | kMaterial_Transparent))
+                        continue;
+
+                    stateCache.update(bucket.mShadeFlags);
+
+                    exec->bindVertexBuffer(pool.getVertexBufferView(bucket.mBlock), 0);
+                    exec->bindIndexBuffer(pool.getIndexBufferView(bucket.mBlock), 0);
+                    exec->indexedIndirectDrawCount(bucket.mMaxDraws, commands, bucket.mFirstDraw, counts, i);
+                }
+            }
+        );
+
+        mOcclusionDepthTask = graph.addTask(task);
+    }
+
+    {
+        ComputeTask task{"Indirect draw Hi-Z"};
+        task.addInput(kIndirectDrawHiZ, AttachmentType::Image2D);
+        for(uint32_t i = 1; i < mMipLevels; ++i)
+            task.addInput(kIndirectDrawHiZMipNames[i - 1], AttachmentType::Image2D);
+        task.addInput(kIndirectDrawOcclusionDepth, AttachmentType::Texture2D);
+        task.addInput(kCameraBuffer, AttachmentType::UniformBuffer);
+        task.addInput(kIndirectDrawCullingSampler, AttachmentType::Sampler);
+
+        task.setRecordCommandsCallback(
+            [this](const RenderGraph& graph, const uint32_t taskIndex, Executor* exec, RenderEngine* eng, const std::vector<const MeshInstance*>&)
+            {
+                PROFILER_EVENT("Indirect draw Hi-Z");
+                PROFILER_GPU_TASK(exec);
+                PROFILER_GPU_EVENT("Indirect draw Hi-Z");
+
+                if(eng->getDebugCameraActive())
+                    return;
+
+                const RenderTask& task = graph.getTask(taskIndex);
+                exec->setComputeShader(static_cast<const ComputeTask&>(task), graph, mHierarchicalDepthShader);
+
+                const auto extent = eng->getDevice()->getSwapChainImageView()->getImageExtent();
+                exec->dispatch(std::ceil(extent.width / 16.0f), std::ceil(extent.height / 16.0f), 1);
+            }
+        );
+
+        graph.addTask(task);
+    }
+
+    {
+        ComputeTask task{"Indirect draw culling second phase"};
+        addCullingInputs(task, kIndirectDrawLateCommands, kIndirectDrawLateEntries, kIndirectDrawLateCounts, kIndirectDrawHiZ, AttachmentType::DataBufferRO);
+        task.setRecordCommandsCallback(
+            [recordCulling](const RenderGraph& graph, const uint32_t taskIndex, Executor* exec, RenderEngine* eng, const std::vector<const MeshInstance*>&)
+            {
+                PROFILER_EVENT("Indirect draw culling second phase");
+                PROFILER_GPU_TASK(exec);
+                PROFILER_GPU_EVENT("Indirect draw culling second phase");
+
+                recordCulling(graph, taskIndex, exec, eng, true);
+            }
+        );
+
+        graph.addTask(task);
+    }
+}
+
+
+void IndirectDrawCullingTechnique::render(RenderGraph&, RenderEngine*)
+{
+    mHierarchicalDepth->updateLastAccessed();
+    mHierarchicalDepthView->updateLastAccessed();
+    for(auto& mip : mHierarchicalDepthMips)
+        mip->updateLastAccessed();
+}
+
+
+void IndirectDrawCullingTechnique::bindResources(RenderGraph& graph)
+{
+    // The draw list buffers are bound by the engine each frame, as they're rebuilt after the resources are bound.
+    if(!graph.isResourceSlotBound(kIndirectDrawCullingSampler))
+        graph.bindSampler(kIndirectDrawCullingSampler, mOcclusionSampler);
+
+    graph.bindImage(kIndirectDrawHiZ, mHierarchicalDepthView);
+    for(uint32_t i = 0; i < mHierarchicalDepthMips.size(); ++i)
+        graph.bindImage(kIndirectDrawHiZMipNames[i], mHierarchicalDepthMips[i], BindingFlags::ManualBarriers);
+}
+
+
+void IndirectDrawCullingTechnique::postGraphCompilation(RenderGraph& graph, RenderEngine* engine)
+{
+    compileSkinnedPipelineVariants(mOcclusionDepthPipelines, "./Shaders/DepthOnly.vert", "./Shaders/Empty.frag", engine, graph, mOcclusionDepthTask, kShade_IndirectDraw);
+}
@@ -0,0 +1,169 @@
+#include "Engine/IndirectDrawList.hpp"
+#include "Engine/GeometryPool.hpp"
+#include "Engine/Scene.h"
+#include "Core/RenderDevice.hpp"
+#include "Core/Profiling.hpp"
+
+#include <algorithm>
+
+
+namespace
+{
+    constexpr uint32_t kInitialDrawCapacity = 1024;
+    constexpr uint32_t kInitialBucketCapacity = 64;
+
+    // Matches vk::DrawIndexedIndirectCommand.
+    constexpr uint32_t kDrawCommandSize = sizeof(uint32_t) * 5;
+}
+
+
+IndirectDrawList::IndirectDrawList(RenderDevice* dev) :
+    mDevice(dev),
+    mBuckets{},
+    mBucketLookup{},
+    mCandidates{},
+    mWork{},
+    mZeroCounts{},
+    mCandidatesBuffer(dev, BufferUsage::DataBuffer | BufferUsage::TransferDest, sizeof(IndirectDrawCandidate) * kInitialDrawCapacity, sizeof(IndirectDrawCandidate), "Indirect draw candidates"),
+    mCandidatesView(mCandidatesBuffer),
+    mWorkBuffer(dev, BufferUsage::DataBuffer | BufferUsage::TransferDest, sizeof(uint2) * kInitialDrawCapacity, sizeof(uint2), "Indirect draw work"),
+    mWorkView(mWorkBuffer),
+    mCommandsBuffer(dev, BufferUsage::DataBuffer | BufferUsage::IndirectArgs, kDrawCommandSize * kInitialDrawCapacity, kDrawCommandSize, "Indirect draw commands"),
+    mCommandsView(mCommandsBuffer),
+    mCountsBuffer(dev, BufferUsage::DataBuffer | BufferUsage::IndirectArgs | BufferUsage::TransferDest, sizeof(uint32_t) * kInitialBucketCapacity, sizeof(uint32_t), "Indirect draw counts"),
+    mCountsView(mCountsBuffer),
+    mEntriesBuffer(dev, BufferUsage::DataBuffer, sizeof(MeshEntry) * kInitialDrawCapacity, sizeof(MeshEntry), "Indirect draw entries"),
+    mEntriesView(mEntriesBuffer),
+    mOcclusionRetestBuffer(dev, BufferUsage::DataBuffer, sizeof(uint32_t) * kInitialDrawCapacity, sizeof(uint32_t), "Indirect draw occlusion retest"),
+    mOcclusionRetestView(mOcclusionRetestBuffer)
+{
+    mCandidates.reserve(kInitialDrawCapacity);
+    mWork.reserve(kInitialDrawCapacity);
+}
+
+
+void IndirectDrawList::build(const std::vector<const MeshInstance*>& instances, GeometryPool& pool)
+{
+    PROFILER_EVENT();
+
+    mBuckets.clear();
+    mBucketLookup.clear();
+    mCandidates.clear();
+    mWork.clear();
+
+    for(const MeshInstance* instance : instances)
+    {
+        if(!(instance->getInstanceFlags() & InstanceFlags::Draw))
+            continue;
+
+        const StaticMesh* mesh = instance->getMesh();
+        const GeometryPool::Allocation& allocation = pool.getAllocation(mesh);
+        const AABB bounds = mesh->getAABB() * instance->getTransMatrix();
+
+        const std::vector<SubMesh>& subMeshes = mesh->getSubMeshes();
+        for(uint32_t subMesh_i = 0; subMesh_i < subMeshes.size(); ++subMesh_i)
+        {
+            const SubMesh& subMesh = subMeshes[subMesh_i];
+            const uint64_t shadeFlags = instance->getShadeFlags(subMesh_i);
+
+            // Shade flags only use the low 32 bits.
+            const uint64_t bucketKey = (uint64_t(allocation.mBlock) << 32) | shadeFlags;
+            auto bucket = mBucketLookup.find(bucketKey);
+            if(bucket == mBucketLookup.end())
+            {
+                bucket = mBucketLookup.insert({bucketKey, static_cast<uint32_t>(mBuckets.size())}).first;
+                mBuckets.push_back({shadeFlags, allocation.mBlock, 0, 0});
+            }
+
+            IndirectDrawCandidate candidate{};
+            candidate.mBoundsMin = bounds.getMin();
+            candidate.mBoundsMax = bounds.getMax();
+            candidate.mEntry = instance->getMeshShaderEntry(subMesh_i);
+            candidate.mIndexCount = subMesh.mIndexCount;
+            candidate.mFirstIndex = allocation.mIndexOffset + subMesh.mIndexOffset;
+            candidate.mVertexOffset = allocation.mVertexOffset + subMesh.mVertexOffset;
+            candidate.mBucket = bucket->second;
+
+            // Skinned meshes move away from their meshlet bounds, so are only culled as a whole.
+            const uint32_t candidateIndex = static_cast<uint32_t>(mCandidates.size());
+            if(subMesh.mMeshletCount > 0 && !instance->isSkinned())
+            {
+                const uint32_t firstMeshlet = allocation.mMeshletOffset + subMesh.mMeshletOffset;
+                for(uint32_t meshlet_i = 0; meshlet_i < subMesh.mMeshletCount; ++meshlet_i)
+                    mWork.push_back(uint2(candidateIndex, firstMeshlet + meshlet_i));
+
+                mBuckets[bucket->second].mMaxDraws += subMesh.mMeshletCount;
+            }
+            else
+            {
+                mWork.push_back(uint2(candidateIndex, kNoMeshlet));
+                ++mBuckets[bucket->second].mMaxDraws;
+            }
+
+            mCandidates.push_back(candidate);
+        }
+    }
+
+    uint32_t firstDraw = 0;
+    for(Bucket& bucket : mBuckets)
+    {
+        bucket.mFirstDraw = firstDraw;
+        firstDraw += bucket.mMaxDraws;
+    }
+
+    for(IndirectDrawCandidate& candidate : mCandidates)
+        candidate.mFirstDraw = mBuckets[candidate.mBucket].mFirstDraw;
+
+    pool.updateLastAccessed();
+
+    upload();
+}
+
+
+void IndirectDrawList::upload()
+{
+    const uint32_t frameIndex = mDevice->getCurrentFrameIndex();
+
+    // Commands, entries and retest flags are written on the GPU, so only need to be big enough. The contents of the
+    // other buffers are replaced every frame.
+    auto reserve = [frameIndex](PerFrameResource<Buffer>& buffer, PerFrameResource<BufferView>& view, const uint64_t requiredSize)
+    {
+        Buffer& frameBuffer = buffer.get(frameIndex);
+        if(frameBuffer->getSize() >= requiredSize)
+            return;
+
+        uint64_t newSize = frameBuffer->getSize();
+        while(newSize < requiredSize)
+            newSize *= 2;
+
+        frameBuffer->resize(static_cast<uint32_t>(newSize), false);
+        view.get(frameIndex) = BufferView(frameBuffer);
+    };
+
+    const uint64_t candidateCount = std::max<uint64_t>(mCandidates.size(), 1);
+    const uint64_t drawCount = std::max<uint64_t>(mWork.size(), 1);
+    const uint64_t bucketCount = std::max<uint64_t>(mBuckets.size(), 1);
+    reserve(mCandidatesBuffer, mCandidatesView, candidateCount * sizeof(IndirectDrawCandidate));
+    reserve(mWorkBuffer, mWorkView, drawCount * sizeof(uint2));
+    reserve(mCommandsBuffer, mCommandsView, drawCount * kDrawCommandSize);
+    reserve(mEntriesBuffer, mEntriesView, drawCount * sizeof(MeshEntry));
+    reserve(mOcclusionRetestBuffer, mOcclusionRetestView, drawCount * sizeof(uint32_t));
+    reserve(mCountsBuffer, mCountsView, bucketCount * sizeof(uint32_t));
+
+    if(!mCandidates.empty())
+    {
+        mCandidatesBuffer.get(frameIndex)->setContents(mCandidates.data(), mCandidates.size() * sizeof(IndirectDrawCandidate));
+        mWorkBuffer.get(frameIndex)->setContents(mWork.data(), mWork.size() * sizeof(uint2));
+
+        // Counts are accumulated by the culling pass so need resetting every frame.
+        mZeroCounts.resize(mBuckets.size(), 0);
+        mCountsBuffer.get(frameIndex)->setContents(mZeroCounts.data(), mBuckets.size() * sizeof(uint32_t));
+    }
+
+    mCandidatesBuffer.get(frameIndex)->updateLastAccessed();
+    mWorkBuffer.get(frameIndex)->updateLastAccessed();
+    mCommandsBuffer.get(frameIndex)->updateLastAccessed();
+    mCountsBuffer.get(frameIndex)->updateLastAccessed();
+    mEntriesBuffer.get(frameIndex)->updateLastAccessed();
+    mOcclusionRetestBuffer.get(frameIndex)->updateLastAccessed();
+}
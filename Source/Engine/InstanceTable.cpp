@@ -0,0 +1,263 @@
+#include "Engine/InstanceTable.hpp"
+#include "Engine/Scene.h"
+#include "Core/RenderDevice.hpp"
+#include "Core/BellLogging.hpp"
+#include "Core/Profiling.hpp"
+
+#include <algorithm>
+
+
+namespace
+{
+    constexpr uint32_t kInitialSlotCapacity = 512;
+}
+
+
+InstanceTable::InstanceTable(RenderDevice* dev) :
+    mDevice(dev),
+    mEntries{},
+    mTransforms{},
+    mPrevTransforms{},
+    mSlotCount(0),
+    mFreeSlots{},
+    mRetiredSlots{},
+    mSettlingSlots{},
+    mDirtyRanges{},
+    mSyncedFrame(dev->getSwapChainImageCount(), 0),
+    mNeedsFullUpload(dev->getSwapChainImageCount(), false),
+    mUploadedBytes(0),
+    mTransformsBuffer(dev, BufferUsage::DataBuffer | BufferUsage::TransferDest, sizeof(float3x4) * kInitialSlotCapacity, sizeof(float3x4), "Instance transforms"),
+    mTransformsView(mTransformsBuffer),
+    mPrevTransformsBuffer(dev, BufferUsage::DataBuffer | BufferUsage::TransferDest, sizeof(float3x4) * kInitialSlotCapacity, sizeof(float3x4), "Previous instance transforms"),
+    mPrevTransformsView(mPrevTransformsBuffer)
+{
+    mEntries.reserve(kInitialSlotCapacity);
+    mTransforms.reserve(kInitialSlotCapacity);
+    mPrevTransforms.reserve(kInitialSlotCapacity);
+}
+
+
+void InstanceTable::updateInstances(const std::pmr::vector<MeshInstance*>& instances)
+{
+    PROFILER_EVENT();
+
+    recycleRetired();
+
+    const uint64_t frame = mDevice->getCurrentSubmissionIndex();
+
+    for(MeshInstance* instance : instances)
+    {
+        const std::vector<SubMesh>& subMeshes = instance->getMesh()->getSubMeshes();
+
+        uint32_t baseSlot = instance->getBaseTransformsIndex();
+        if(baseSlot == MeshInstance::kInvalidTransformsIndex)
+        {
+            baseSlot = allocateSlots(static_cast<uint32_t>(subMeshes.size()));
+            instance->setBaseTransformsIndex(baseSlot);
+        }
+
+        SlotEntry& entry = mEntries[baseSlot];
+        BELL_ASSERT(entry.mCount == subMeshes.size(), "Instance doesn't match its slots")
+
+        // Instances that weren't drawn last frame have no valid previous transform, so don't give them any motion.
+        const bool drawnLastFrame = (entry.mLastSeen + 1) == frame;
+        entry.mLastSeen = frame;
+
+        const uint64_t version = instance->getTransformVersion();
+        if(version == entry.mVersion)
+            continue;
+
+        entry.mVersion = version;
+        entry.mLastMoved = frame;
+
+        const float4x4 transform = instance->getTransMatrix();
+        for(uint32_t i = 0; i < subMeshes.size(); ++i)
+        {
+            const float3x4 subMeshTransform = transpose(float4x3(transform * subMeshes[i].mTransform));
+            mPrevTransforms[baseSlot + i] = drawnLastFrame ? mTransforms[baseSlot + i] : subMeshTransform;
+            mTransforms[baseSlot + i] = subMeshTransform;
+        }
+        markDirty(baseSlot, baseSlot + entry.mCount);
+
+        if(!entry.mSettling)
+        {
+            entry.mSettling = true;
+            mSettlingSlots.push_back(baseSlot);
+        }
+    }
+
+    // Instances that moved in an earlier frame but not this one need their previous transforms catching up.
+    auto settled = std::remove_if(mSettlingSlots.begin(), mSettlingSlots.end(), [&](const uint32_t baseSlot)
+    {
+        SlotEntry& entry = mEntries[baseSlot];
+        if(!entry.mSettling)
+            return true;
+
+        if(entry.mLastMoved == frame)
+            return false;
+
+        std::copy(mTransforms.begin() + baseSlot, mTransforms.begin() + baseSlot + entry.mCount, mPrevTransforms.begin() + baseSlot);
+        markDirty(baseSlot, baseSlot + entry.mCount);
+        entry.mSettling = false;
+
+        return true;
+    });
+    mSettlingSlots.erase(settled, mSettlingSlots.end());
+
+    upload();
+}
+
+
+void InstanceTable::releaseSlots(const uint32_t baseSlot)
+{
+    BELL_ASSERT(baseSlot < mSlotCount && mEntries[baseSlot].mCount != 0, "Invalid instance slot")
+
+    mRetiredSlots.push_back({mDevice->getCurrentSubmissionIndex(), baseSlot});
+}
+
+
+void InstanceTable::clear()
+{
+    // Frames in flight still read the buffers, but nothing new will index them until slots are handed out again
+    // and every frames copy is refreshed before then.
+    mEntries.clear();
+    mTransforms.clear();
+    mPrevTransforms.clear();
+    mSlotCount = 0;
+    mFreeSlots.clear();
+    mRetiredSlots.clear();
+    mSettlingSlots.clear();
+    mDirtyRanges.clear();
+    std::fill(mSyncedFrame.begin(), mSyncedFrame.end(), 0);
+    std::fill(mNeedsFullUpload.begin(), mNeedsFullUpload.end(), true);
+}
+
+
+uint32_t InstanceTable::allocateSlots(const uint32_t count)
+{
+    uint32_t baseSlot = 0;
+
+    auto freeSlots = mFreeSlots.find(count);
+    if(freeSlots != mFreeSlots.end() && !freeSlots->second.empty())
+    {
+        baseSlot = freeSlots->second.back();
+        freeSlots->second.pop_back();
+    }
+    else
+    {
+        baseSlot = mSlotCount;
+        mSlotCount += count;
+
+        mEntries.resize(mSlotCount);
+        mTransforms.resize(mSlotCount);
+        mPrevTransforms.resize(mSlotCount);
+    }
+
+    mEntries[baseSlot] = SlotEntry{0, 0, 0, count, false};
+
+    return baseSlot;
+}
+
+
+void InstanceTable::recycleRetired()
+{
+    const uint64_t finishedSubmission = mDevice->getFinishedSubmissionIndex();
+
+    while(!mRetiredSlots.empty() && mRetiredSlots.front().first <= finishedSubmission)
+    {
+        const uint32_t baseSlot = mRetiredSlots.front().second;
+        SlotEntry& entry = mEntries[baseSlot];
+
+        mFreeSlots[entry.mCount].push_back(baseSlot);
+        entry.mSettling = false;
+        mRetiredSlots.pop_front();
+    }
+}
+
+
+void InstanceTable::markDirty(const uint32_t begin, const uint32_t end)
+{
+    const uint64_t frame = mDevice->getCurrentSubmissionIndex();
+
+    // Instances are mostly visited in slot order, so neighbouring changes can usually be merged here.
+    if(!mDirtyRanges.empty() && mDirtyRanges.back().mFrame == frame && mDirtyRanges.back().mEnd == begin)
+        mDirtyRanges.back().mEnd = end;
+    else
+        mDirtyRanges.push_back({frame, begin, end});
+}
+
+
+void InstanceTable::upload()
+{
+    const uint32_t frameIndex = mDevice->getCurrentFrameIndex();
+    const uint64_t frame = mDevice->getCurrentSubmissionIndex();
+
+    Buffer& transformsBuffer = mTransformsBuffer.get(frameIndex);
+    Buffer& prevTransformsBuffer = mPrevTransformsBuffer.get(frameIndex);
+
+    // Grow this frames copy if needed, the old contents are discarded so it gets fully refreshed.
+    const uint64_t requiredSize = std::max<uint64_t>(mSlotCount, 1) * sizeof(float3x4);
+    if(transformsBuffer->getSize() < requiredSize)
+    {
+        uint64_t newSize = transformsBuffer->getSize();
+        while(newSize < requiredSize)
+            newSize *= 2;
+
+        transformsBuffer->resize(static_cast<uint32_t>(newSize), false);
+        prevTransformsBuffer->resize(static_cast<uint32_t>(newSize), false);
+        mTransformsView.get(frameIndex) = BufferView(transformsBuffer);
+        mPrevTransformsView.get(frameIndex) = BufferView(prevTransformsBuffer);
+
+        mNeedsFullUpload[frameIndex] = true;
+    }
+
+    mUploadedBytes = 0;
+    auto uploadRange = [&](const uint32_t begin, const uint32_t end)
+    {
+        const uint32_t offset = begin * sizeof(float3x4);
+        const uint32_t size = (end - begin) * sizeof(float3x4);
+
+        transformsBuffer->setContents(&mTransforms[begin], size, offset);
+        prevTransformsBuffer->setContents(&mPrevTransforms[begin], size, offset);
+        mUploadedBytes += size;
+    };
+
+    if(mNeedsFullUpload[frameIndex])
+    {
+        if(mSlotCount > 0)
+            uploadRange(0, mSlotCount);
+
+        mNeedsFullUpload[frameIndex] = false;
+    }
+    else
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> ranges{};
+        for(const DirtyRange& range : mDirtyRanges)
+        {
+            if(range.mFrame > mSyncedFrame[frameIndex])
+                ranges.push_back({range.mBegin, range.mEnd});
+        }
+        std::sort(ranges.begin(), ranges.end());
+
+        // Upload the union of the ranges, the tables always hold the latest transforms.
+        uint32_t i = 0;
+        while(i < ranges.size())
+        {
+            const uint32_t begin = ranges[i].first;
+            uint32_t end = ranges[i].second;
+            while(++i < ranges.size() && ranges[i].first <= end)
+                end = std::max(end, ranges[i].second);
+
+            uploadRange(begin, end);
+        }
+    }
+
+    transformsBuffer->updateLastAccessed();
+    prevTransformsBuffer->updateLastAccessed();
+    mSyncedFrame[frameIndex] = frame;
+
+    // Drop changes that every copy has now seen.
+    const uint64_t oldestSyncedFrame = *std::min_element(mSyncedFrame.begin(), mSyncedFrame.end());
+    while(!mDirtyRanges.empty() && mDirtyRanges.front().mFrame <= oldestSyncedFrame)
+        mDirtyRanges.pop_front();
+}
@@ -0,0 +1,208 @@
+#include "Engine/MaterialTable.hpp"
+#include "Core/RenderDevice.hpp"
+#include "Core/BellLogging.hpp"
+#include "Core/Profiling.hpp"
+
+#include <algorithm>
+
+
+namespace
+{
+    // Slot 0 always holds the default texture, unused slots in a material entry point at it.
+    constexpr uint32_t kDefaultTextureSlot = 0;
+}
+
+
+MaterialTable::MaterialTable(RenderDevice* dev, const ImageView& defaultView) :
+    mDevice(dev),
+    mDefaultView(defaultView),
+    mEntries{},
+    mFreeMaterialIDs{},
+    mRetiredMaterialIDs{},
+    mNextTextureSlot(kDefaultTextureSlot + 1),
+    mFreeTextureSlots{},
+    mRetiredTextureSlots{},
+    mDirtyBegin(~0u),
+    mDirtyEnd(0),
+    mTableBuffer(dev, BufferUsage::DataBuffer | BufferUsage::TransferDest, sizeof(MaterialEntry) * kMaxMaterials, sizeof(MaterialEntry), "Material table"),
+    mTableBufferView(mTableBuffer),
+    mResourceSet(dev, 2)
+{
+    mEntries.reserve(kMaxMaterials);
+
+    // Fill every slot so nothing unwritten can ever be sampled.
+    mResourceSet->addBindlessSampledImageArray(ImageViewArray(kMaxTextures, mDefaultView));
+    mResourceSet->addDataBufferRO(mTableBufferView);
+    mResourceSet->finalise();
+}
+
+
+uint32_t MaterialTable::addMaterial(const uint32_t materialTypes, const std::vector<ImageView>& textures)
+{
+    BELL_ASSERT(textures.size() <= kMaxTexturesPerMaterial, "Too many textures for a single material")
+
+    recycleRetired();
+
+    uint32_t materialID = 0;
+    if(!mFreeMaterialIDs.empty())
+    {
+        materialID = mFreeMaterialIDs.back();
+        mFreeMaterialIDs.pop_back();
+    }
+    else
+    {
+        BELL_ASSERT(mEntries.size() < kMaxMaterials, "Material table is full")
+        materialID = static_cast<uint32_t>(mEntries.size());
+        mEntries.emplace_back();
+    }
+
+    MaterialEntry& entry = mEntries[materialID];
+    std::fill(std::begin(entry.mTextureSlots), std::end(entry.mTextureSlots), kDefaultTextureSlot);
+    entry.mMaterialTypes = materialTypes;
+
+    for(uint32_t i = 0; i < textures.size(); ++i)
+    {
+        const uint32_t slot = allocateTextureSlot();
+        if(slot != kDefaultTextureSlot)
+            mResourceSet->setSampledImageArrayElement(0, slot, textures[i]);
+
+        entry.mTextureSlots[i] = slot;
+    }
+
+    markDirty(materialID);
+
+    return materialID;
+}
+
+
+void MaterialTable::removeMaterial(const uint32_t materialID)
+{
+    BELL_ASSERT(materialID < mEntries.size(), "Invalid material ID")
+
+    MaterialEntry& entry = mEntries[materialID];
+    for(uint32_t& slot : entry.mTextureSlots)
+    {
+        if(slot != kDefaultTextureSlot)
+            retireTextureSlot(slot);
+
+        slot = kDefaultTextureSlot;
+    }
+    entry.mMaterialTypes = 0;
+    markDirty(materialID);
+
+    mRetiredMaterialIDs.push_back({mDevice->getCurrentSubmissionIndex(), materialID});
+}
+
+
+void MaterialTable::setTexture(const uint32_t materialID, const uint32_t textureIndex, const ImageView& view)
+{
+    BELL_ASSERT(materialID < mEntries.size(), "Invalid material ID")
+    BELL_ASSERT(textureIndex < kMaxTexturesPerMaterial, "Invalid texture index")
+
+    recycleRetired();
+
+    // Write to a fresh slot and repoint the entry, the old slot stays valid until the frames using it have finished.
+    const uint32_t slot = allocateTextureSlot();
+    if(slot == kDefaultTextureSlot) // Out of slots so keep the current texture.
+        return;
+
+    mResourceSet->setSampledImageArrayElement(0, slot, view);
+
+    uint32_t& currentSlot = mEntries[materialID].mTextureSlots[textureIndex];
+    if(currentSlot != kDefaultTextureSlot)
+        retireTextureSlot(currentSlot);
+
+    currentSlot = slot;
+    markDirty(materialID);
+}
+
+
+void MaterialTable::update()
+{
+    PROFILER_EVENT();
+
+    recycleRetired();
+
+    mResourceSet->updateArrayElements();
+
+    // Entries are small, so upload the whole dirty range in one go. In flight frames may see a mix of old and
+    // new slots for a material whilst this lands, but both stay valid until retired.
+    if(mDirtyBegin < mDirtyEnd)
+    {
+        mTableBuffer->setContents(&mEntries[mDirtyBegin], (mDirtyEnd - mDirtyBegin) * sizeof(MaterialEntry), mDirtyBegin * sizeof(MaterialEntry));
+
+        mDirtyBegin = ~0u;
+        mDirtyEnd = 0;
+    }
+
+    mResourceSet->updateLastAccessed();
+    mTableBuffer->updateLastAccessed();
+}
+
+
+void MaterialTable::clear()
+{
+    std::vector<bool> removed(mEntries.size(), false);
+    for(const uint32_t materialID : mFreeMaterialIDs)
+        removed[materialID] = true;
+    for(const auto& [submission, materialID] : mRetiredMaterialIDs)
+        removed[materialID] = true;
+
+    // Views are left in the array until their slots are reused, which keeps them alive for any frames in flight.
+    for(uint32_t i = 0; i < mEntries.size(); ++i)
+    {
+        if(!removed[i])
+            removeMaterial(i);
+    }
+}
+
+
+uint32_t MaterialTable::allocateTextureSlot()
+{
+    if(!mFreeTextureSlots.empty())
+    {
+        const uint32_t slot = mFreeTextureSlots.back();
+        mFreeTextureSlots.pop_back();
+
+        return slot;
+    }
+
+    if(mNextTextureSlot == kMaxTextures)
+    {
+        BELL_LOG_WARNING(Engine, "Material texture slots exhausted, using the default texture")
+        return kDefaultTextureSlot;
+    }
+
+    return mNextTextureSlot++;
+}
+
+
+void MaterialTable::retireTextureSlot(const uint32_t slot)
+{
+    mRetiredTextureSlots.push_back({mDevice->getCurrentSubmissionIndex(), slot});
+}
+
+
+void MaterialTable::recycleRetired()
+{
+    const uint64_t finishedSubmission = mDevice->getFinishedSubmissionIndex();
+
+    while(!mRetiredTextureSlots.empty() && mRetiredTextureSlots.front().first <= finishedSubmission)
+    {
+        mFreeTextureSlots.push_back(mRetiredTextureSlots.front().second);
+        mRetiredTextureSlots.pop_front();
+    }
+
+    while(!mRetiredMaterialIDs.empty() && mRetiredMaterialIDs.front().first <= finishedSubmission)
+    {
+        mFreeMaterialIDs.push_back(mRetiredMaterialIDs.front().second);
+        mRetiredMaterialIDs.pop_front();
+    }
+}
+
+
+void MaterialTable::markDirty(const uint32_t materialID)
+{
+    mDirtyBegin = std::min(mDirtyBegin, materialID);
+    mDirtyEnd = std::max(mDirtyEnd, materialID + 1);
+}
@@ -0,0 +1,356 @@
+#include "Engine/MeshSimplification.hpp"
+#include "Engine/GeomUtils.h"
+#include "Core/BellLogging.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+
+namespace
+{
+    // Border planes are weighted well above the surface so borders keep their shape.
+    constexpr double kBorderWeight = 10.0;
+
+    struct Quadric
+    {
+        double mA2, mAB, mAC, mAD;
+        double mB2, mBC, mBD;
+        double mC2, mCD;
+        double mD2;
+        double mWeight;
+
+        Quadric& operator+=(const Quadric& other)
+        {
+            mA2 += other.mA2; mAB += other.mAB; mAC += other.mAC; mAD += other.mAD;
+            mB2 += other.mB2; mBC += other.mBC; mBD += other.mBD;
+            mC2 += other.mC2; mCD += other.mCD;
+            mD2 += other.mD2;
+            mWeight += other.mWeight;
+
+            return *this;
+        }
+    };
+
+    void addPlane(Quadric& quadric, const float3& normal, const float distance, const double weight)
+    {
+        const double a = normal.x;
+        const double b = normal.y;
+        const double c = normal.z;
+        const double d = distance;
+
+        quadric.mA2 += a * a * weight; quadric.mAB += a * b * weight; quadric.mAC += a * c * weight; quadric.mAD += a * d * weight;
+        quadric.mB2 += b * b * weight; quadric.mBC += b * c * weight; quadric.mBD += b * d * weight;
+        quadric.mC2 += c * c * weight; quadric.mCD += c * d * weight;
+        quadric.mD2 += d * d * weight;
+        quadric.mWeight += weight;
+    }
+
+    // Weighted mean squared distance from the quadrics planes.
+    double evaluate(const Quadric& quadric, const float3& position)
+    {
+        const double x = position.x;
+        const double y = position.y;
+        const double z = position.z;
+
+        const double error = quadric.mA2 * x * x + quadric.mB2 * y * y + quadric.mC2 * z * z +
+                             2.0 * (quadric.mAB * x * y + quadric.mAC * x * z + quadric.mBC * y * z) +
+                             2.0 * (quadric.mAD * x + quadric.mBD * y + quadric.mCD * z) +
+                             quadric.mD2;
+
+        return std::max(error, 0.0) / std::max(quadric.mWeight, 1e-12);
+    }
+
+    uint64_t edgeKey(const uint32_t a, const uint32_t b)
+    {
+        return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+    }
+
+    struct PositionHash
+    {
+        size_t operator()(const float3& position) const
+        {
+            uint32_t bits[3];
+            std::memcpy(bits, &position, sizeof(bits));
+            return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        }
+    };
+
+    struct Collapse
+    {
+        double mCost;
+        uint32_t mFrom;
+        uint32_t mTo;
+    };
+}
+
+
+std::vector<uint32_t> simplifyMesh(const uint32_t* indices,
+                                   const uint32_t indexCount,
+                                   const unsigned char* vertexData,
+                                   const uint32_t vertexStride,
+                                   const uint32_t vertexCount,
+                                   const uint32_t targetIndexCount,
+                                   float& resultError)
+{
+    BELL_ASSERT((indexCount % 3) == 0, "Can only simplify triangle lists")
+
+    resultError = 0.0f;
+
+    std::vector<float3> positions(vertexCount);
+    for(uint32_t i = 0; i < vertexCount; ++i)
+        std::memcpy(&positions[i], vertexData + (uint64_t(i) * vertexStride), sizeof(float3));
+
+    // Vertices sharing a position are attribute seams, they can't be collapsed without cracking the mesh.
+    std::vector<uint32_t> canonical(vertexCount);
+    std::vector<bool> locked(vertexCount, false);
+    {
+        std::unordered_map<float3, uint32_t, PositionHash> firstVertex{};
+        firstVertex.reserve(vertexCount);
+        for(uint32_t i = 0; i < vertexCount; ++i)
+        {
+            auto [it, inserted] = firstVertex.insert({positions[i], i});
+            canonical[i] = it->second;
+            if(!inserted)
+                locked[it->second] = true; // Only the canonical vertex is flagged.
+        }
+    }
+
+    // The result keeps the original indices, topology is all in terms of the first vertex at each position.
+    std::vector<uint32_t> result(indices, indices + indexCount);
+    auto vertexAt = [&](const uint32_t i)
+    {
+        return canonical[result[i]];
+    };
+
+    // Edges only used by one triangle are open borders.
+    std::unordered_set<uint64_t> borderEdges{};
+    {
+        std::unordered_map<uint64_t, uint32_t> edgeUseCount{};
+        for(uint32_t i = 0; i < result.size(); i += 3)
+        {
+            for(uint32_t e = 0; e < 3; ++e)
+                ++edgeUseCount[edgeKey(vertexAt(i + e), vertexAt(i + ((e + 1) % 3)))];
+        }
+
+        for(const auto& [key, count] : edgeUseCount)
+        {
+            if(count == 1)
+                borderEdges.insert(key);
+        }
+    }
+
+    std::vector<bool> border(vertexCount, false);
+    for(const uint64_t key : borderEdges)
+    {
+        border[key >> 32] = true;
+        border[key & 0xFFFFFFFF] = true;
+    }
+
+    std::vector<Quadric> quadrics(vertexCount, Quadric{});
+    for(uint32_t i = 0; i < result.size(); i += 3)
+    {
+        const float3& p0 = positions[vertexAt(i)];
+        const float3& p1 = positions[vertexAt(i + 1)];
+        const float3& p2 = positions[vertexAt(i + 2)];
+
+        float3 normal = glm::cross(p1 - p0, p2 - p0);
+        const float length = glm::length(normal);
+        if(length == 0.0f)
+            continue;
+
+        normal /= length;
+        const double area = length * 0.5;
+
+        Quadric triangleQuadric{};
+        addPlane(triangleQuadric, normal, -glm::dot(normal, p0), area);
+        for(uint32_t e = 0; e < 3; ++e)
+            quadrics[vertexAt(i + e)] += triangleQuadric;
+
+        for(uint32_t e = 0; e < 3; ++e)
+        {
+            const uint32_t a = vertexAt(i + e);
+            const uint32_t b = vertexAt(i + ((e + 1) % 3));
+            if(borderEdges.find(edgeKey(a, b)) == borderEdges.end())
+                continue;
+
+            const float3 edge = positions[b] - positions[a];
+            const float3 borderNormal = glm::cross(edge, normal);
+            const float borderLength = glm::length(borderNormal);
+            if(borderLength == 0.0f)
+                continue;
+
+            Quadric borderQuadric{};
+            addPlane(borderQuadric, borderNormal / borderLength, -glm::dot(borderNormal / borderLength, positions[a]), glm::dot(edge, edge) * kBorderWeight);
+            quadrics[a] += borderQuadric;
+            quadrics[b] += borderQuadric;
+        }
+    }
+
+    auto canCollapse = [&](const uint32_t from, const uint32_t to)
+    {
+        if(locked[from] || locked[to])
+            return false;
+
+        // Border vertices can only slide along their border.
+        return !border[from] || borderEdges.find(edgeKey(from, to)) != borderEdges.end();
+    };
+
+    std::vector<Collapse> collapses{};
+    std::vector<uint32_t> collapseTarget(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency{};
+    double maxCost = 0.0;
+
+    // Collapse the cheapest independent edges in passes, until the target is hit or nothing more can collapse.
+    while(result.size() > targetIndexCount)
+    {
+        collapses.clear();
+        for(uint32_t i = 0; i < result.size(); i += 3)
+        {
+            for(uint32_t e = 0; e < 3; ++e)
+            {
+                const uint32_t a = vertexAt(i + e);
+                const uint32_t b = vertexAt(i + ((e + 1) % 3));
+
+                // Each edge is seen from both of its triangles, only consider it once.
+                if(a > b && borderEdges.find(edgeKey(a, b)) == borderEdges.end())
+                    continue;
+
+                Quadric combined = quadrics[a];
+                combined += quadrics[b];
+
+                const double costAB = canCollapse(a, b) ? evaluate(combined, positions[b]) : -1.0;
+                const double costBA = canCollapse(b, a) ? evaluate(combined, positions[a]) : -1.0;
+                if(costAB >= 0.0 && (costBA < 0.0 || costAB <= costBA))
+                    collapses.push_back({costAB, a, b});
+                else if(costBA >= 0.0)
+                    collapses.push_back({costBA, b, a});
+            }
+        }
+
+        if(collapses.empty())
+            break;
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs)
+        {
+            return lhs.mCost < rhs.mCost;
+        });
+
+        // Triangles around each vertex, for the flip test.
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for(uint32_t i = 0; i < result.size(); ++i)
+            ++adjacencyOffsets[vertexAt(i) + 1];
+
+        for(uint32_t i = 1; i <= vertexCount; ++i)
+            adjacencyOffsets[i] += adjacencyOffsets[i - 1];
+
+        adjacency.resize(result.size());
+        std::vector<uint32_t> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for(uint32_t i = 0; i < result.size(); ++i)
+            adjacency[adjacencyFill[vertexAt(i)]++] = i / 3;
+
+        for(uint32_t i = 0; i < vertexCount; ++i)
+            collapseTarget[i] = i;
+
+        std::fill(touched.begin(), touched.end(), false);
+
+        const uint32_t triangleCount = static_cast<uint32_t>(result.size() / 3);
+        const uint32_t targetTriangleCount = targetIndexCount / 3;
+        uint32_t removedTriangles = 0;
+        bool collapsed = false;
+
+        for(const Collapse& collapse : collapses)
+        {
+            if(triangleCount - removedTriangles <= targetTriangleCount)
+                break;
+
+            if(touched[collapse.mFrom] || touched[collapse.mTo])
+                continue;
+
+            // Reject collapses that would flip any of the remaining triangles.
+            bool flips = false;
+            uint32_t sharedTriangles = 0;
+            for(uint32_t a = adjacencyOffsets[collapse.mFrom]; a < adjacencyOffsets[collapse.mFrom + 1] && !flips; ++a)
+            {
+                const uint32_t triangle = adjacency[a] * 3;
+                const uint32_t t0 = vertexAt(triangle);
+                const uint32_t t1 = vertexAt(triangle + 1);
+                const uint32_t t2 = vertexAt(triangle + 2);
+                if(t0 == collapse.mTo || t1 == collapse.mTo || t2 == collapse.mTo)
+                {
+                    ++sharedTriangles;
+                    continue;
+                }
+
+                const float3 before = glm::cross(positions[t1] - positions[t0], positions[t2] - positions[t0]);
+
+                const float3 p0 = positions[t0 == collapse.mFrom ? collapse.mTo : t0];
+                const float3 p1 = positions[t1 == collapse.mFrom ? collapse.mTo : t1];
+                const float3 p2 = positions[t2 == collapse.mFrom ? collapse.mTo : t2];
+                const float3 after = glm::cross(p1 - p0, p2 - p0);
+
+                flips = glm::dot(before, after) <= 0.0f;
+            }
+
+            if(flips)
+                continue;
+
+            collapseTarget[collapse.mFrom] = collapse.mTo;
+            quadrics[collapse.mTo] += quadrics[collapse.mFrom];
+            removedTriangles += sharedTriangles;
+            maxCost = std::max(maxCost, collapse.mCost);
+            collapsed = true;
+
+            // Keep the neighbourhood fixed for the rest of the pass so the flip tests above stay valid.
+            for(uint32_t a = adjacencyOffsets[collapse.mFrom]; a < adjacencyOffsets[collapse.mFrom + 1]; ++a)
+            {
+                const uint32_t triangle = adjacency[a] * 3;
+                for(uint32_t e = 0; e < 3; ++e)
+                    touched[vertexAt(triangle + e)] = true;
+            }
+
+            // The collapsed vertices borders now belong to the vertex it collapsed on to.
+            if(border[collapse.mFrom])
+            {
+                for(uint32_t a = adjacencyOffsets[collapse.mFrom]; a < adjacencyOffsets[collapse.mFrom + 1]; ++a)
+                {
+                    const uint32_t triangle = adjacency[a] * 3;
+                    for(uint32_t e = 0; e < 3; ++e)
+                    {
+                        const uint32_t other = vertexAt(triangle + e);
+                        if(other != collapse.mTo && borderEdges.find(edgeKey(collapse.mFrom, other)) != borderEdges.end())
+                            borderEdges.insert(edgeKey(collapse.mTo, other));
+                    }
+                }
+            }
+        }
+
+        if(!collapsed)
+            break;
+
+        // Apply the collapses and drop the triangles that became degenerate.
+        uint32_t writeIndex = 0;
+        for(uint32_t i = 0; i < result.size(); i += 3)
+        {
+            // Only vertices alone at their position collapse, so their original and canonical index match.
+            const uint32_t a = collapseTarget[result[i]];
+            const uint32_t b = collapseTarget[result[i + 1]];
+            const uint32_t c = collapseTarget[result[i + 2]];
+            if(canonical[a] == canonical[b] || canonical[b] == canonical[c] || canonical[a] == canonical[c])
+                continue;
+
+            result[writeIndex++] = a;
+            result[writeIndex++] = b;
+            result[writeIndex++] = c;
+        }
+        result.resize(writeIndex);
+    }
+
+    resultError = static_cast<float>(std::sqrt(maxCost));
+
+    return result;
+}
@@ -0,0 +1,315 @@
+#include "Engine/Meshlet.hpp"
+#include "Core/BellLogging.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+
+namespace
+{
+    constexpr uint32_t kInvalidIndex = ~0u;
+
+    float3 getPosition(const unsigned char* vertexData, const uint32_t vertexStride, const uint32_t index)
+    {
+        float3 position;
+        std::memcpy(&position, vertexData + (uint64_t(index) * vertexStride), sizeof(float3));
+        return position;
+    }
+
+    Meshlet calculateBounds(const uint32_t* indices,
+                            const uint32_t indexOffset,
+                            const uint32_t indexCount,
+                            const uint32_t vertexCount,
+                            const unsigned char* vertexData,
+                            const uint32_t vertexStride)
+    {
+        Meshlet meshlet{};
+        meshlet.mIndexOffset = indexOffset;
+        meshlet.mIndexCount = indexCount;
+        meshlet.mVertexCount = vertexCount;
+
+        float3 minimum{std::numeric_limits<float>::max()};
+        float3 maximum{std::numeric_limits<float>::lowest()};
+        for(uint32_t i = 0; i < indexCount; ++i)
+        {
+            const float3 position = getPosition(vertexData, vertexStride, indices[i]);
+            minimum = glm::min(minimum, position);
+            maximum = glm::max(maximum, position);
+        }
+
+        const float3 centre = (minimum + maximum) * 0.5f;
+        float radius = 0.0f;
+        for(uint32_t i = 0; i < indexCount; ++i)
+            radius = std::max(radius, glm::length(getPosition(vertexData, vertexStride, indices[i]) - centre));
+
+        meshlet.mBoundingSphere = float4(centre, radius);
+        meshlet.mConeApex = float4(centre, 1.0f);
+        meshlet.mConeAxisCutoff = float4(0.0f, 0.0f, 1.0f, 1.0f);
+
+        // Normal cone, the same bounds meshoptimizer generates. Triangles are assumed to be counter clockwise.
+        float3 normals[kMeshletMaxTriangles];
+        float3 corners[kMeshletMaxTriangles];
+        uint32_t normalCount = 0;
+        float3 axis{0.0f};
+        for(uint32_t i = 0; i < indexCount && normalCount < kMeshletMaxTriangles; i += 3)
+        {
+            const float3 p0 = getPosition(vertexData, vertexStride, indices[i]);
+            const float3 p1 = getPosition(vertexData, vertexStride, indices[i + 1]);
+            const float3 p2 = getPosition(vertexData, vertexStride, indices[i + 2]);
+
+            const float3 normal = glm::cross(p1 - p0, p2 - p0);
+            const float area = glm::length(normal);
+            if(area == 0.0f)
+                continue;
+
+            normals[normalCount] = normal / area;
+            corners[normalCount] = p0;
+            axis += normals[normalCount];
+            ++normalCount;
+        }
+
+        const float axisLength = glm::length(axis);
+        if(normalCount == 0 || axisLength == 0.0f)
+            return meshlet;
+
+        axis /= axisLength;
+
+        float minDot = 1.0f;
+        for(uint32_t i = 0; i < normalCount; ++i)
+            minDot = std::min(minDot, glm::dot(axis, normals[i]));
+
+        // Very wide cones almost never cull anything.
+        if(minDot <= 0.1f)
+        {
+            meshlet.mConeAxisCutoff = float4(axis, 1.0f);
+            return meshlet;
+        }
+
+        // Move the apex back along the axis until it's behind every triangle.
+        float maxDistance = 0.0f;
+        for(uint32_t i = 0; i < normalCount; ++i)
+            maxDistance = std::max(maxDistance, glm::dot(centre - corners[i], normals[i]) / glm::dot(axis, normals[i]));
+
+        meshlet.mConeApex = float4(centre - (axis * maxDistance), 1.0f);
+        meshlet.mConeAxisCutoff = float4(axis, std::sqrt(1.0f - (minDot * minDot)));
+
+        return meshlet;
+    }
+}
+
+
+void buildMeshlets(std::vector<uint32_t>& indices,
+                   const uint32_t indexOffset,
+                   const uint32_t indexCount,
+                   const unsigned char* vertexData,
+                   const uint32_t vertexStride,
+                   std::vector<Meshlet>& meshlets)
+{
+    BELL_ASSERT((indexCount % 3) == 0, "Meshlets can only be built from triangle lists")
+
+    const uint32_t triangleCount = indexCount / 3;
+    if(triangleCount == 0)
+        return;
+
+    const std::vector<uint32_t> source(indices.begin() + indexOffset, indices.begin() + indexOffset + indexCount);
+    const uint32_t vertexCount = *std::max_element(source.begin(), source.end()) + 1;
+
+    // Triangles using each vertex.
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for(const uint32_t index : source)
+        ++adjacencyOffsets[index + 1];
+
+    for(uint32_t i = 1; i <= vertexCount; ++i)
+        adjacencyOffsets[i] += adjacencyOffsets[i - 1];
+
+    std::vector<uint32_t> adjacency(indexCount);
+    std::vector<uint32_t> adjacencyFill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for(uint32_t i = 0; i < indexCount; ++i)
+        adjacency[adjacencyFill[source[i]]++] = i / 3;
+
+    std::vector<float3> triangleCentres(triangleCount);
+    for(uint32_t i = 0; i < triangleCount; ++i)
+    {
+        triangleCentres[i] = (getPosition(vertexData, vertexStride, source[i * 3]) +
+                              getPosition(vertexData, vertexStride, source[i * 3 + 1]) +
+                              getPosition(vertexData, vertexStride, source[i * 3 + 2])) / 3.0f;
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32_t> vertexMeshlet(vertexCount, kInvalidIndex); // Last meshlet each vertex was added to.
+
+    std::vector<uint32_t> meshletVertices{};
+    std::vector<uint32_t> meshletTriangles{};
+    meshletVertices.reserve(kMeshletMaxVertices);
+    meshletTriangles.reserve(kMeshletMaxTriangles);
+    float3 meshletCentreSum{0.0f};
+    uint32_t meshletIndex = 0;
+
+    uint32_t writeOffset = indexOffset;
+    auto flushMeshlet = [&]()
+    {
+        if(meshletTriangles.empty())
+            return;
+
+        const uint32_t firstIndex = writeOffset;
+        for(const uint32_t triangle : meshletTriangles)
+        {
+            indices[writeOffset++] = source[triangle * 3];
+            indices[writeOffset++] = source[triangle * 3 + 1];
+            indices[writeOffset++] = source[triangle * 3 + 2];
+        }
+
+        meshlets.push_back(calculateBounds(indices.data() + firstIndex, firstIndex, writeOffset - firstIndex,
+                                           static_cast<uint32_t>(meshletVertices.size()), vertexData, vertexStride));
+
+        meshletVertices.clear();
+        meshletTriangles.clear();
+        meshletCentreSum = float3{0.0f};
+        ++meshletIndex;
+    };
+
+    auto newVertexCount = [&](const uint32_t triangle)
+    {
+        uint32_t count = 0;
+        for(uint32_t i = 0; i < 3; ++i)
+            count += vertexMeshlet[source[triangle * 3 + i]] != meshletIndex ? 1 : 0;
+
+        return count;
+    };
+
+    // Greedily grow each meshlet with the connected triangle that adds the fewest vertices, then the closest one.
+    uint32_t emittedCount = 0;
+    uint32_t nextSeed = 0;
+    while(emittedCount < triangleCount)
+    {
+        uint32_t bestTriangle = kInvalidIndex;
+        uint32_t bestNewVertices = 4;
+        float bestDistance = std::numeric_limits<float>::max();
+
+        const float3 meshletCentre = meshletCentreSum / std::max(1.0f, float(meshletTriangles.size()));
+        for(const uint32_t vertex : meshletVertices)
+        {
+            for(uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; ++i)
+            {
+                const uint32_t triangle = adjacency[i];
+                if(emitted[triangle])
+                    continue;
+
+                const uint32_t newVertices = newVertexCount(triangle);
+                if(meshletVertices.size() + newVertices > kMeshletMaxVertices)
+                    continue;
+
+                const float3 offset = triangleCentres[triangle] - meshletCentre;
+                const float distance = glm::dot(offset, offset);
+                if(newVertices < bestNewVertices || (newVertices == bestNewVertices && distance < bestDistance))
+                {
+                    bestTriangle = triangle;
+                    bestNewVertices = newVertices;
+                    bestDistance = distance;
+                }
+            }
+        }
+
+        if(bestTriangle == kInvalidIndex)
+        {
+            // Nothing connected fits, so start a new meshlet from the next unused triangle.
+            if(!meshletTriangles.empty())
+            {
+                flushMeshlet();
+                continue;
+            }
+
+            while(emitted[nextSeed])
+                ++nextSeed;
+
+            bestTriangle = nextSeed;
+        }
+
+        emitted[bestTriangle] = true;
+        ++emittedCount;
+
+        meshletTriangles.push_back(bestTriangle);
+        meshletCentreSum += triangleCentres[bestTriangle];
+        for(uint32_t i = 0; i < 3; ++i)
+        {
+            const uint32_t vertex = source[bestTriangle * 3 + i];
+            if(vertexMeshlet[vertex] != meshletIndex)
+            {
+                vertexMeshlet[vertex] = meshletIndex;
+                meshletVertices.push_back(vertex);
+            }
+        }
+
+        if(meshletTriangles.size() == kMeshletMaxTriangles)
+            flushMeshlet();
+    }
+
+    flushMeshlet();
+}
+
+
+MeshletCullResult cullMeshlet(const Meshlet& meshlet, const float4x4& transform, const MeshletCullingView& view)
+{
+    const float3 centre = float3(transform * float4(float3(meshlet.mBoundingSphere), 1.0f));
+    const float scale = std::max({glm::length(float3(transform[0])), glm::length(float3(transform[1])), glm::length(float3(transform[2]))});
+    const float radius = meshlet.mBoundingSphere.w * scale;
+
+    // Project the spheres bounding box, as projectAABB in OcclusionCulling.hlsl does.
+    const float3 minimum = centre - float3(radius);
+    const float3 maximum = centre + float3(radius);
+
+    float4 clipSpaceMin{10.0f};
+    float4 clipSpaceMax{-10.0f};
+    bool crossesCameraPlane = false;
+    uint32_t outsideAll = 0x3F;
+    for(uint32_t i = 0; i < 8; ++i)
+    {
+        const float4 corner{(i & 1) ? maximum.x : minimum.x, (i & 2) ? maximum.y : minimum.y, (i & 4) ? maximum.z : minimum.z, 1.0f};
+        const float4 clip = view.mViewProj * corner;
+
+        uint32_t outside = 0;
+        outside |= clip.x < -clip.w ? 1 : 0;
+        outside |= clip.x > clip.w ? 2 : 0;
+        outside |= clip.y < -clip.w ? 4 : 0;
+        outside |= clip.y > clip.w ? 8 : 0;
+        outside |= clip.z < 0.0f ? 16 : 0;
+        outside |= clip.z > clip.w ? 32 : 0;
+        outsideAll &= outside;
+
+        if(clip.w <= 0.0f)
+            crossesCameraPlane = true;
+
+        const float4 trans = clip / clip.w;
+        clipSpaceMin = glm::min(clipSpaceMin, trans);
+        clipSpaceMax = glm::max(clipSpaceMax, trans);
+    }
+
+    if(outsideAll != 0)
+        return MeshletCullResult::Frustum;
+
+    if(meshlet.mConeAxisCutoff.w < 1.0f)
+    {
+        const float3 apex = float3(transform * float4(float3(meshlet.mConeApex), 1.0f));
+        const float3 axis = glm::normalize(float3(transform * float4(float3(meshlet.mConeAxisCutoff), 0.0f)));
+        if(glm::dot(glm::normalize(apex - view.mCameraPosition), axis) >= meshlet.mConeAxisCutoff.w)
+            return MeshletCullResult::Backface;
+    }
+
+    if(!view.mHierarchicalDepth || crossesCameraPlane)
+        return MeshletCullResult::Visible;
+
+    const float4 uv = float4(float2(clipSpaceMin) * 0.5f + 0.5f, float2(clipSpaceMax) * 0.5f + 0.5f);
+    const float2 size = (float2(clipSpaceMax) - float2(clipSpaceMin)) * view.mFrameBufferSize;
+    const float lod = std::ceil(std::log2(std::max(size.x, size.y)));
+
+    const float maxDepth = std::max({view.mHierarchicalDepth(float2(uv.x, uv.y), lod),
+                                     view.mHierarchicalDepth(float2(uv.z, uv.y), lod),
+                                     view.mHierarchicalDepth(float2(uv.x, uv.w), lod),
+                                     view.mHierarchicalDepth(float2(uv.z, uv.w), lod)});
+
+    const float linearDepth = view.mNearPlane / (clipSpaceMax.z * (view.mFarPlane - view.mNearPlane));
+
+    return linearDepth > maxDepth ? MeshletCullResult::Occluded : MeshletCullResult::Visible;
+}
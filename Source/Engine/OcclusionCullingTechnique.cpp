@@ -5,16 +5,20 @@
 #include "Core/Executor.hpp"
 #include "Core/BarrierManager.hpp"
 
+#include <algorithm>
+
 constexpr const char kOcclusionIndexBuffer[] = "OcclusionIndexBuffer";
 constexpr const char kOcclusionSampler[] = "OcclusionSampler";
 
+constexpr uint32_t kInitialOcclusionCapacity = 512;
+
 
 OcclusionCullingTechnique::OcclusionCullingTechnique(RenderEngine* eng, RenderGraph& graph) :
     Technique("Occlusion culling", eng->getDevice()),
     mOcclusionCullingShader(eng->getShader("./Shaders/OcclusionCulling.comp")),
-    mBoundsIndexBuffer(getDevice(), BufferUsage::TransferDest | BufferUsage::DataBuffer, sizeof(uint32_t) * 500, sizeof(uint32_t) * 500, "Occlusion index buffer"),
+    mBoundsIndexBuffer(getDevice(), BufferUsage::TransferDest | BufferUsage::DataBuffer, sizeof(uint32_t) * kInitialOcclusionCapacity, sizeof(uint32_t), "Occlusion index buffer"),
     mBoundsIndexBufferView(mBoundsIndexBuffer),
-    mPredicationBuffer(getDevice(), BufferUsage::CommandPredication| BufferUsage::DataBuffer, sizeof(uint32_t) * 500, sizeof(uint32_t) * 500, "Occlusion index buffer"),
+    mPredicationBuffer(getDevice(), BufferUsage::CommandPredication| BufferUsage::DataBuffer, sizeof(uint32_t) * kInitialOcclusionCapacity, sizeof(uint32_t), "Occlusion predication buffer"),
     mPredicationBufferView(mPredicationBuffer),
     mOcclusionSampler(SamplerType::Point)
 {
@@ -72,13 +76,48 @@ OcclusionCullingTechnique::OcclusionCullingTechnique(RenderEngine* eng, RenderGr
 }
 
 
+void OcclusionCullingTechnique::render(RenderGraph&, RenderEngine* eng)
+{
+    const Scene* scene = eng->getScene();
+    if(!scene)
+        return;
+
+    // Size for every instance in the scene, the main view can't see more than that.
+    const uint64_t requiredSize = std::max<uint64_t>(scene->getStaticMeshInstances().size() + scene->getDynamicMeshInstances().size(), 1) * sizeof(uint32_t);
+
+    Buffer& boundsIndexBuffer = *mBoundsIndexBuffer;
+    if(boundsIndexBuffer->getSize() < requiredSize)
+    {
+        uint64_t newSize = boundsIndexBuffer->getSize();
+        while(newSize < requiredSize)
+            newSize *= 2;
+
+        boundsIndexBuffer->resize(static_cast<uint32_t>(newSize), false);
+        *mBoundsIndexBufferView = BufferView(boundsIndexBuffer);
+    }
+
+    // Written on the GPU every frame, so the old contents don't need keeping.
+    if(mPredicationBuffer->getSize() < requiredSize)
+    {
+        uint64_t newSize = mPredicationBuffer->getSize();
+        while(newSize < requiredSize)
+            newSize *= 2;
+
+        mPredicationBuffer->resize(static_cast<uint32_t>(newSize), false);
+        mPredicationBufferView = BufferView(mPredicationBuffer);
+    }
+
+    boundsIndexBuffer->updateLastAccessed();
+    mPredicationBuffer->updateLastAccessed();
+}
+
+
 void OcclusionCullingTechnique::bindResources(RenderGraph& graph)
 {
     graph.bindBuffer(kOcclusionIndexBuffer, *mBoundsIndexBufferView);
+    // Rebound every frame as the buffer grows with the scene.
+    graph.bindBuffer(kOcclusionPredicationBuffer, mPredicationBufferView);
 
-    if(!graph.isResourceSlotBound(kOcclusionPredicationBuffer))
-    {
-        graph.bindBuffer(kOcclusionPredicationBuffer, mPredicationBufferView);
+    if(!graph.isResourceSlotBound(kOcclusionSampler))
         graph.bindSampler(kOcclusionSampler, mOcclusionSampler);
-    }
 }
@@ -43,6 +43,8 @@ PreDepthTechnique::PreDepthTechnique(RenderEngine* eng, RenderGraph& graph) :
 
                 const BufferView& pred = eng->getRenderGraph().getBuffer(kOcclusionPredicationBuffer);
 
+                const std::vector<uint32_t>& lods = eng->getRenderView(graph.getTask(taskIndex).getInputRenderQueueIndex()).getInstanceLODs();
+
                 for (uint32_t i = 0; i < meshes.size(); ++i)
                 {
                     const auto& mesh = meshes[i];
@@ -52,7 +54,7 @@ PreDepthTechnique::PreDepthTechnique(RenderEngine* eng, RenderGraph& graph) :
 
                     exec->startCommandPredication(pred, i);
 
-                    mesh->draw(exec, &stateCache);
+                    mesh->draw(exec, &stateCache, lods[i]);
 
                     exec->endCommandPredication();
                 }
@@ -70,14 +72,7 @@ PreDepthTechnique::PreDepthTechnique(RenderEngine* eng, RenderGraph& graph) :
 
                 UberShaderSkinnedStateCache stateCache(exec, mPipelines);
 
-                for (const auto& mesh : meshes)
-                {
-                    // Don't render transparent geometry.
-                    if (!(mesh->getInstanceFlags() & InstanceFlags::Draw))
-                        continue;
-
-                    mesh->draw(exec, &stateCache);
-                }
+                eng->getRenderView(graph.getTask(taskIndex).getInputRenderQueueIndex()).recordSortedDraws(exec, &stateCache);
             }
         );
     }
@@ -12,7 +12,9 @@
 
 
 CPURayTracingScene::CPURayTracingScene(RenderEngine* eng, const Scene* scene) :
-    mPrimitiveMaterialID{}
+    mPrimitiveMaterialID{},
+    mEngine{eng},
+    mTerrainMesher{}
 {
     updateCPUAccelerationStructure(scene);
 
@@ -30,6 +32,9 @@ void CPURayTracingScene::renderSceneToMemory(const Camera& camera, const uint32_
     const float farPlane = camera.getFarPlane();
     const float aspect = camera.getAspect();
 
+    // The image plane is one unit away and one unit high.
+    const RayCone primaryCone{0.0f, 1.0f / float(y)};
+
     auto trace_ray = [&](const uint32_t pix, const uint32_t piy) -> float4
     {
         float3 dir = {((float(pix) / float(x)) - 0.5f) * aspect, (float(piy) / float(y)) - 0.5f, 1.0f};
@@ -49,14 +54,15 @@ void CPURayTracingScene::renderSceneToMemory(const Camera& camera, const uint32_
         //ray.type = nanort::RAY_TYPE_PRIMARY;
 
         InterpolatedVertex frag;
-        const bool hit = traceRay(ray, &frag);
+        const bool hit = traceRay(ray, &frag, primaryCone);
         if(hit)
         {
             return shadePoint(frag, float4(origin, 1.0f), 10, 5);
         }
         else
         {
-            return mScene->getCPUSkybox()->sampleCube4(dir);
+            const std::unique_ptr<CPUImage>& skybox = mScene->getCPUSkybox();
+            return skybox->sampleCube4(dir, skybox->calculateCubeLOD(primaryCone.mSpreadAngle));
         }
     };
 
@@ -133,11 +139,17 @@ CPURayTracingScene::InterpolatedVertex CPURayTracingScene::interpolateFragment(c
     frag.mVertexColour = ((1.0f - v - u) * firstColour) + (u * secondColour) + (v * thirdColour);
     frag.mPrimID = primID;
 
+    const float worldArea = glm::length(glm::cross(secondPosition - firstPosition, thirdPosition - firstPosition));
+    const float2 uvEdge1 = seconduv - firstuv;
+    const float2 uvEdge2 = thirduv - firstuv;
+    const float uvArea = std::abs((uvEdge1.x * uvEdge2.y) - (uvEdge1.y * uvEdge2.x));
+    frag.mTriangleLOD = worldArea > 0.0f && uvArea > 0.0f ? 0.5f * std::log2(uvArea / worldArea) : 0.0f;
+
     return frag;
 }
 
 
-bool CPURayTracingScene::traceRay(const nanort::Ray<float>& ray, InterpolatedVertex *result) const
+bool CPURayTracingScene::traceRay(const nanort::Ray<float>& ray, InterpolatedVertex *result, const RayCone& cone) const
 {
     nanort::TriangleIntersector triangle_intersecter(reinterpret_cast<const float*>(mPositions.data()), mIndexBuffer.data(), sizeof(float3));
     nanort::TriangleIntersection intersection;
@@ -146,6 +158,9 @@ bool CPURayTracingScene::traceRay(const nanort::Ray<float>& ray, InterpolatedVer
     if(hit) // check for alpha tested geometry.
     {
         *result= interpolateFragment(intersection.prim_id, intersection.u, intersection.v);
+        result->mConeWidth = cone.mWidth + (cone.mSpreadAngle * intersection.t);
+        result->mConeSpread = cone.mSpreadAngle;
+        result->mConeCosine = glm::dot(result->mNormal, float3(ray.dir[0], ray.dir[1], ray.dir[2]));
 
         const std::vector<CPUImage>& materials = mScene->getCPUImageMaterials();
         BELL_ASSERT(result->mPrimID < mPrimitiveMaterialID.size(), "index out of bounds")
@@ -155,7 +170,7 @@ bool CPURayTracingScene::traceRay(const nanort::Ray<float>& ray, InterpolatedVer
         {
 
             const CPUImage& diffuseTexture = materials[matInfo.materialIndex];
-            const float4 colour = diffuseTexture.sample4(result->mUV);
+            const float4 colour = diffuseTexture.sample4(result->mUV, diffuseTexture.calculateLOD(result->mTriangleLOD, result->mConeWidth, result->mConeCosine));
 
             if(colour.a == 0.0f) // trace another ray.
             {
@@ -169,7 +184,7 @@ bool CPURayTracingScene::traceRay(const nanort::Ray<float>& ray, InterpolatedVer
                 newRay.min_t = 0.01f;
                 newRay.max_t = 2000.0f;
 
-                hit = traceRay(newRay, result);
+                hit = traceRay(newRay, result, RayCone{result->mConeWidth, cone.mSpreadAngle});
             }
         }
     }
@@ -241,6 +256,11 @@ float4 CPURayTracingScene::traceDiffuseRays(const InterpolatedVertex& frag, cons
 
     DiffuseSampler sampler(sampleCount * depth);
 
+    // Each sample stands in for an equal share of the hemisphere, widen the cone to roughly cover it.
+    const RayCone cone{frag.mConeWidth, frag.mConeSpread + std::sqrt(2.0f / float(sampleCount))};
+    const std::unique_ptr<CPUImage>& skybox = mScene->getCPUSkybox();
+    const float skyboxLOD = skybox->calculateCubeLOD(cone.mSpreadAngle);
+
     float4 result = float4{0.0f, 0.0f, 0.0f, 0.0f};
     float weight = 0.0f;
     for(uint32_t i = 0; i < sampleCount; ++i)
@@ -266,14 +286,14 @@ float4 CPURayTracingScene::traceDiffuseRays(const InterpolatedVertex& frag, cons
         newRay.max_t = 2000.0f;
 
         InterpolatedVertex intersection;
-        const bool hit = traceRay(newRay, &intersection);
+        const bool hit = traceRay(newRay, &intersection, cone);
         if(hit)
         {
             result += sample.P * diffuseFactor * shadePoint(intersection, frag.mPosition, sampleCount, depth - 1);
         }
         else
         {
-            result += sample.P * diffuseFactor * mScene->getCPUSkybox()->sampleCube4(sample.L); // miss so sample skybox.
+            result += sample.P * diffuseFactor * skybox->sampleCube4(sample.L, skyboxLOD); // miss so sample skybox.
         }
     }
 
@@ -295,6 +315,12 @@ float4 CPURayTracingScene::traceSpecularRays(const InterpolatedVertex& frag, con
 
     const float3 V = glm::normalize(float3(origin - frag.mPosition));
 
+    // Same as the diffuse cone but narrowed by the width of the GGX lobe.
+    const float alpha = mat.specularRoughness.w * mat.specularRoughness.w;
+    const RayCone cone{frag.mConeWidth, frag.mConeSpread + (alpha * std::sqrt(2.0f / float(sampleCount)))};
+    const std::unique_ptr<CPUImage>& skybox = mScene->getCPUSkybox();
+    const float skyboxLOD = skybox->calculateCubeLOD(cone.mSpreadAngle);
+
     float4 result = float4{0.0f, 0.0f, 0.0f, 0.0f};
     float weight = 0.0f;
     for(uint32_t i = 0; i < sampleCount; ++i)
@@ -317,14 +343,14 @@ float4 CPURayTracingScene::traceSpecularRays(const InterpolatedVertex& frag, con
         BELL_ASSERT(specularFactor >= 0.0f, "")
 
         InterpolatedVertex intersection;
-        const bool hit = traceRay(newRay, &intersection);
+        const bool hit = traceRay(newRay, &intersection, cone);
         if(hit)
         {
             result += specularFactor * sample.P * shadePoint(intersection, frag.mPosition, sampleCount, depth - 1);
         }
         else
         {
-            result += specularFactor * sample.P * mScene->getCPUSkybox()->sampleCube4(sample.L); // miss so sample skybox.
+            result += specularFactor * sample.P * skybox->sampleCube4(sample.L, skyboxLOD); // miss so sample skybox.
         }
     }
 
@@ -350,11 +376,15 @@ CPURayTracingScene::Material CPURayTracingScene::calculateMaterial(const Interpo
 
     uint32_t nextMaterialSlot = 0;
     const auto& materials = mScene->getCPUImageMaterials();
+    auto lod = [&frag](const CPUImage& image)
+    {
+        return image.calculateLOD(frag.mTriangleLOD, frag.mConeWidth, frag.mConeCosine);
+    };
 
     if(info.materialFlags & MaterialType::Diffuse)
     {
         BELL_ASSERT(info.materialIndex < materials.size(), "material index out of bounds")
-        mat.diffuse = materials[info.materialIndex].sample4(frag.mUV);
+        mat.diffuse = materials[info.materialIndex].sample4(frag.mUV, lod(materials[info.materialIndex]));
         ++nextMaterialSlot;
     }
     else if(info.materialFlags & MaterialType::Albedo)
@@ -368,13 +398,13 @@ CPURayTracingScene::Material CPURayTracingScene::calculateMaterial(const Interpo
     if(info.materialFlags & MaterialType::Roughness)
     {
         BELL_ASSERT((info.materialIndex + nextMaterialSlot) < materials.size(), "material index out of bounds")
-        mat.specularRoughness.w = materials[info.materialIndex + nextMaterialSlot].sample(frag.mUV);
+        mat.specularRoughness.w = materials[info.materialIndex + nextMaterialSlot].sample(frag.mUV, lod(materials[info.materialIndex + nextMaterialSlot]));
         ++nextMaterialSlot;
     }
     else if(info.materialFlags & MaterialType::Gloss)
     {
         BELL_ASSERT((info.materialIndex + nextMaterialSlot) < materials.size(), "material index out of bounds")
-        mat.specularRoughness.w = 1.0f - materials[info.materialIndex + nextMaterialSlot].sample(frag.mUV);
+        mat.specularRoughness.w = 1.0f - materials[info.materialIndex + nextMaterialSlot].sample(frag.mUV, lod(materials[info.materialIndex + nextMaterialSlot]));
         ++nextMaterialSlot;
     }
 
@@ -382,7 +412,7 @@ CPURayTracingScene::Material CPURayTracingScene::calculateMaterial(const Interpo
     if(info.materialFlags & MaterialType::Specular)
     {
         BELL_ASSERT((info.materialIndex + nextMaterialSlot) < materials.size(), "material index out of bounds")
-        const float3 spec = materials[info.materialIndex + nextMaterialSlot].sample4(frag.mUV);
+        const float3 spec = materials[info.materialIndex + nextMaterialSlot].sample4(frag.mUV, lod(materials[info.materialIndex + nextMaterialSlot]));
         mat.specularRoughness.x = spec.x;
         mat.specularRoughness.y = spec.y;
         mat.specularRoughness.z = spec.z;
@@ -391,20 +421,20 @@ CPURayTracingScene::Material CPURayTracingScene::calculateMaterial(const Interpo
     else if(info.materialFlags & MaterialType::CombinedSpecularGloss)
     {
         BELL_ASSERT((info.materialIndex + nextMaterialSlot) < materials.size(), "material index out of bounds")
-        mat.specularRoughness = materials[info.materialIndex + nextMaterialSlot].sample4(frag.mUV);
+        mat.specularRoughness = materials[info.materialIndex + nextMaterialSlot].sample4(frag.mUV, lod(materials[info.materialIndex + nextMaterialSlot]));
         mat.specularRoughness.w = 1.0f - mat.specularRoughness.w;
         ++nextMaterialSlot;
     }
     else if(info.materialFlags & MaterialType::Metalness)
     {
         BELL_ASSERT((info.materialIndex + nextMaterialSlot) < materials.size(), "material index out of bounds")
-        metalness = materials[info.materialIndex + nextMaterialSlot].sample(frag.mUV);
+        metalness = materials[info.materialIndex + nextMaterialSlot].sample(frag.mUV, lod(materials[info.materialIndex + nextMaterialSlot]));
         ++nextMaterialSlot;
     }
     else if(info.materialFlags & MaterialType::CombinedMetalnessRoughness)
     {
         BELL_ASSERT((info.materialIndex + nextMaterialSlot) < materials.size(), "material index out of bounds")
-        const float4 metalnessRoughness = materials[info.materialIndex + nextMaterialSlot].sample4(frag.mUV);
+        const float4 metalnessRoughness = materials[info.materialIndex + nextMaterialSlot].sample4(frag.mUV, lod(materials[info.materialIndex + nextMaterialSlot]));
         metalness = metalnessRoughness.z;
         mat.specularRoughness.w = metalnessRoughness.y;
         ++nextMaterialSlot;
@@ -413,7 +443,7 @@ CPURayTracingScene::Material CPURayTracingScene::calculateMaterial(const Interpo
     if(info.materialFlags & MaterialType::Albedo)
     {
         BELL_ASSERT(info.materialIndex < materials.size(), "material index out of bounds")
-        const float4 albedo = materials[info.materialIndex].sample4(frag.mUV);
+        const float4 albedo = materials[info.materialIndex].sample4(frag.mUV, lod(materials[info.materialIndex]));
         mat.diffuse = albedo * (1.0f - 0.04f) * (1.0f - metalness);
         mat.diffuse.w = albedo.w;// Preserve the alpha chanle.
 
@@ -426,7 +456,7 @@ CPURayTracingScene::Material CPURayTracingScene::calculateMaterial(const Interpo
     if(info.materialFlags & MaterialType::Emisive)
     {
         BELL_ASSERT((info.materialIndex + nextMaterialSlot) < materials.size(), "material index out of bounds")
-        const float3 emissive = materials[info.materialIndex + nextMaterialSlot].sample4(frag.mUV);
+        const float3 emissive = materials[info.materialIndex + nextMaterialSlot].sample4(frag.mUV, lod(materials[info.materialIndex + nextMaterialSlot]));
         mat.emissiveOcclusion.x = emissive.x;
         mat.emissiveOcclusion.y = emissive.y;
         mat.emissiveOcclusion.z = emissive.z;
@@ -436,7 +466,7 @@ CPURayTracingScene::Material CPURayTracingScene::calculateMaterial(const Interpo
     if(info.materialFlags & MaterialType::AmbientOcclusion)
     {
         BELL_ASSERT((info.materialIndex + nextMaterialSlot) < materials.size(), "material index out of bounds")
-        mat.emissiveOcclusion.w = materials[info.materialIndex + nextMaterialSlot].sample(frag.mUV);
+        mat.emissiveOcclusion.w = materials[info.materialIndex + nextMaterialSlot].sample(frag.mUV, lod(materials[info.materialIndex + nextMaterialSlot]));
     }
 
     return mat;
@@ -489,6 +519,14 @@ float4 CPURayTracingScene::shadePoint(const InterpolatedVertex& frag, const floa
 void CPURayTracingScene::updateCPUAccelerationStructure(const Scene* scene)
 {
     mScene = scene;
+
+    mPositions.clear();
+    mUVs.clear();
+    mNormals.clear();
+    mVertexColours.clear();
+    mIndexBuffer.clear();
+    mPrimitiveMaterialID.clear();
+
     uint64_t vertexOffset = 0;
     InstanceID instanceID = 0;
     for (const auto& [id, entry] : scene->getInstanceMap())
@@ -498,16 +536,19 @@ void CPURayTracingScene::updateCPUAccelerationStructure(const Scene* scene)
         const uint32_t vertexStride = mesh->getVertexStride();
 
         // add Index data.
-        const auto& indexBuffer = mesh->getIndexData();
-        std::transform(indexBuffer.begin(), indexBuffer.end(), std::back_inserter(mIndexBuffer), [vertexOffset](const uint32_t index)
+        // Only trace against the full detail mesh.
+        const auto& indexData = mesh->getIndexData();
+        const uint32_t indexCount = mesh->getBaseIndexCount();
+        std::transform(indexData.begin(), indexData.begin() + indexCount, std::back_inserter(mIndexBuffer), [vertexOffset](const uint32_t index)
         {
             return vertexOffset + index;
         });
 
         // add material mappings
-        for (uint32_t i = 0; i < indexBuffer.size() / 3; ++i)
+        const uint32_t materialOffset = scene->getCPUImageOffset(instance->getMaterialIndex(0));
+        for (uint32_t i = 0; i < indexCount / 3; ++i)
         {
-            mPrimitiveMaterialID.push_back({ instanceID, instance->getMaterialIndex(0), instance->getMaterialFlags(0) });
+            mPrimitiveMaterialID.push_back({ instanceID, materialOffset, instance->getMaterialFlags(0) });
         }
 
         // Transform and add vertex data.
@@ -538,6 +579,28 @@ void CPURayTracingScene::updateCPUAccelerationStructure(const Scene* scene)
         ++instanceID;
     }
 
+    // Terrain triangles go after every instance, untextured and planar mapped in xz.
+    const std::unique_ptr<VoxelTerrain>& terrain = scene->getVoxelTerrain();
+    if(terrain)
+    {
+        mTerrainMesher.update(*terrain, mEngine->getThreadPool());
+
+        std::vector<float3> terrainPositions{};
+        std::vector<float3> terrainNormals{};
+        mTerrainMesher.getTriangles(terrainPositions, terrainNormals);
+
+        for(uint32_t i = 0; i < terrainPositions.size(); ++i)
+        {
+            mIndexBuffer.push_back(vertexOffset + i);
+            mPositions.push_back(terrainPositions[i]);
+            mUVs.emplace_back(terrainPositions[i].x, terrainPositions[i].z);
+            mNormals.emplace_back(terrainNormals[i], 1.0f);
+            mVertexColours.emplace_back(1.0f, 1.0f, 1.0f, 1.0f);
+        }
+
+        mPrimitiveMaterialID.insert(mPrimitiveMaterialID.end(), terrainPositions.size() / 3, MaterialInfo{kInvalidInstanceID, 0, 0});
+    }
+
     mMeshes = std::make_unique<nanort::TriangleMesh<float>>(reinterpret_cast<float*>(mPositions.data()), mIndexBuffer.data(), sizeof(float3));
     mPred = std::make_unique<nanort::TriangleSAHPred<float>>(reinterpret_cast<float*>(mPositions.data()), mIndexBuffer.data(), sizeof(float3));
 
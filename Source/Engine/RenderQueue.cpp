@@ -1,10 +1,85 @@
 #include "Engine/RenderQueue.hpp"
 #include "Engine/Camera.hpp"
 #include "Engine/Engine.hpp"
+#include "Engine/UberShaderStateCache.hpp"
+#include "Core/ContainerUtils.hpp"
+#include "Core/Executor.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 
-void RenderView::updateView(const Camera& cam)
+
+namespace
+{
+    constexpr uint32_t kShadeFlagBits = 24;
+    constexpr uint32_t kMaterialBits = 22;
+    constexpr uint32_t kDepthBits = 16;
+
+    DrawLayer getDrawLayer(const uint32_t materialFlags)
+    {
+        if(materialFlags & MaterialType::Transparent)
+            return DrawLayer::Transparent;
+        else if(materialFlags & MaterialType::AlphaTested)
+            return DrawLayer::AlphaTested;
+
+        return DrawLayer::Opaque;
+    }
+}
+
+
+uint64_t makeDrawKey(const DrawLayer layer, const uint64_t shadeFlags, const uint32_t materialIndex, const float normalisedDepth)
+{
+    BELL_ASSERT(shadeFlags < (1ull << kShadeFlagBits), "Shade flags don't fit in the draw key")
+
+    const uint64_t depthMax = (1ull << kDepthBits) - 1;
+    uint64_t depth = static_cast<uint64_t>(std::clamp(normalisedDepth, 0.0f, 1.0f) * float(depthMax));
+    const uint64_t material = materialIndex & ((1ull << kMaterialBits) - 1);
+    const uint64_t key = uint64_t(layer) << (kShadeFlagBits + kMaterialBits + kDepthBits);
+
+    // Blending needs transparent draws in back to front order, so depth takes priority over state for them.
+    if(layer == DrawLayer::Transparent)
+    {
+        depth = depthMax - depth;
+        return key | (depth << (kShadeFlagBits + kMaterialBits)) | (shadeFlags << kMaterialBits) | material;
+    }
+
+    return key | (shadeFlags << (kMaterialBits + kDepthBits)) | (material << kDepthBits) | depth;
+}
+
+
+uint32_t selectInstanceLOD(const MeshInstance& instance, const Camera& camera, const float viewportHeight, const float lodBias)
 {
+    const StaticMesh* mesh = instance.getMesh();
+    if(mesh->getLODCount() <= 1 || lodBias <= 0.0f)
+        return 0;
+
+    const float4x4 transform = instance.getTransMatrix();
+    const float scale = std::max({glm::length(float3(transform[0])), glm::length(float3(transform[1])), glm::length(float3(transform[2]))});
+
+    // Pixels covered by one world space unit at the closest point of the instance.
+    float pixelsPerUnit = 0.0f;
+    if(camera.getMode() == CameraMode::Orthographic)
+    {
+        pixelsPerUnit = viewportHeight / camera.getOrthographicSize().y;
+    }
+    else
+    {
+        const AABB bounds = mesh->getAABB() * transform;
+        const float radius = glm::length(float3(bounds.getMax() - bounds.getMin())) * 0.5f;
+        const float distance = std::max(glm::length(float3(bounds.getCentralPoint()) - camera.getPosition()) - radius, camera.getNearPlane());
+        pixelsPerUnit = viewportHeight / (2.0f * std::tan(glm::radians(camera.getFOV()) * 0.5f) * distance);
+    }
+
+    return mesh->getLODForError(lodBias / (pixelsPerUnit * scale));
+}
+
+
+void RenderView::updateView(const Camera& cam, const float viewportHeight)
+{
+    if(mFrozen)
+        return;
+
     const Scene* scene = mEng->getScene();
 
     if(scene)
@@ -13,17 +88,87 @@ void RenderView::updateView(const Camera& cam)
         mInstances = scene->getVisibleMeshes(frustum);
 
         PROFILER_EVENT("sort meshes");
-        std::sort(mInstances.begin(), mInstances.end(), [camera = cam](const MeshInstance* lhs, const MeshInstance* rhs)
+
+        // Distances are positive, so their bit patterns sort in the same order as their values.
+        mSortEntries.resize(mInstances.size());
+        for(uint32_t i = 0; i < mInstances.size(); ++i)
+        {
+            const float3 central = (mInstances[i]->getMesh()->getAABB() * mInstances[i]->getTransMatrix()).getCentralPoint();
+            const float distance = glm::length(central - cam.getPosition());
+
+            uint32_t distanceBits;
+            memcpy(&distanceBits, &distance, sizeof(float));
+            mSortEntries[i] = {distanceBits, mInstances[i]};
+        }
+        radixSort(mSortEntries, mSortScratch, [](const SortEntry& entry) { return entry.mKey; });
+
+        mInstanceDepths.resize(mInstances.size());
+        for(uint32_t i = 0; i < mInstances.size(); ++i)
         {
-            const float3 centralLeft = (lhs->getMesh()->getAABB() *  lhs->getTransMatrix()).getCentralPoint();
-            const float leftDistance = glm::length(centralLeft - camera.getPosition());
+            mInstances[i] = mSortEntries[i].mInstance;
 
-            const float3 centralright = (rhs->getMesh()->getAABB() * rhs->getTransMatrix()).getCentralPoint();
-            const float rightDistance = glm::length(centralright - camera.getPosition());
-            return leftDistance < rightDistance;
-        });
+            float distance;
+            const uint32_t distanceBits = static_cast<uint32_t>(mSortEntries[i].mKey);
+            memcpy(&distance, &distanceBits, sizeof(float));
+            mInstanceDepths[i] = distance / cam.getFarPlane();
+        }
 
         mConstInstances.resize(mInstances.size());
         memcpy(mConstInstances.data(), mInstances.data(), sizeof(MeshInstance*) * mInstances.size());
+
+        mInstanceLODs.resize(mInstances.size());
+        for(uint32_t i = 0; i < mInstances.size(); ++i)
+            mInstanceLODs[i] = selectInstanceLOD(*mInstances[i], cam, viewportHeight, mLODBias);
+
+        mDraws.clear();
+        for(uint32_t i = 0; i < mInstances.size(); ++i)
+        {
+            const MeshInstance* instance = mInstances[i];
+            if(!(instance->getInstanceFlags() & InstanceFlags::Draw))
+                continue;
+
+            for(uint32_t subMesh_i = 0; subMesh_i < instance->getSubMeshCount(); ++subMesh_i)
+            {
+                const uint64_t key = makeDrawKey(getDrawLayer(instance->getMaterialFlags(subMesh_i)),
+                                                 instance->getShadeFlags(subMesh_i),
+                                                 instance->getMaterialIndex(subMesh_i),
+                                                 mInstanceDepths[i]);
+                mDraws.push_back({key, i, subMesh_i});
+            }
+        }
+        radixSort(mDraws, mDrawScratch, [](const ViewDraw& draw) { return draw.mKey; });
+    }
+}
+
+void RenderView::freeze(const std::vector<MeshInstance*>& instances, const std::vector<uint32_t>& lods, const std::vector<ViewDraw>& draws)
+{
+    BELL_ASSERT(instances.size() == lods.size(), "Need a LOD for every instance")
+
+    mInstances = instances;
+    mConstInstances.assign(instances.begin(), instances.end());
+    mInstanceLODs = lods;
+    mDraws = draws;
+    mFrozen = true;
+}
+
+
+void RenderView::recordSortedDraws(Executor* exec, UberShaderStateCache* cache) const
+{
+    const StaticMesh* boundMesh = nullptr;
+
+    for(const ViewDraw& draw : mDraws)
+    {
+        const MeshInstance* instance = mConstInstances[draw.mInstance];
+        const StaticMesh* mesh = instance->getMesh();
+
+        if(mesh != boundMesh)
+        {
+            exec->bindVertexBuffer(*(mesh->getVertexBufferView()), 0);
+            exec->bindIndexBuffer(*(mesh->getIndexBufferView()), 0);
+            boundMesh = mesh;
+        }
+
+        cache->update(instance->getShadeFlags(draw.mSubMesh));
+        instance->drawSubMesh(exec, draw.mSubMesh, mInstanceLODs[draw.mInstance]);
     }
-}
\ No newline at end of file
+}
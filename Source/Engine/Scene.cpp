@@ -1,6 +1,9 @@
 #include "Engine/Scene.h"
 #include "Engine/Engine.hpp"
+#include "Engine/CookedMesh.hpp"
 #include "Engine/TextureUtil.hpp"
+#include "Engine/TextureCompression.hpp"
+#include "Engine/TextureStreamer.hpp"
 #include "Engine/UberShaderStateCache.hpp"
 #include "Core/BellLogging.hpp"
 #include "Core/Profiling.hpp"
@@ -14,6 +17,7 @@
 #include "glm/gtx/quaternion.hpp"
 
 #include <algorithm>
+#include <filesystem>
 #include <fstream>
 #include <iterator>
 #include <limits>
@@ -45,6 +49,7 @@ MeshInstance::MeshInstance(Scene* scene,
         mID{id},
         mMaterials{},
         mInstanceFlags{InstanceFlags::Draw},
+        mBaseTransformsIndex(kInvalidTransformsIndex),
         mGlobalBoneBufferOffset(0),
         mIsSkinned(false),
         mAnimationActive(false)
@@ -76,6 +81,7 @@ MeshInstance::MeshInstance(Scene* scene,
         mID{id},
         mMaterials{},
         mInstanceFlags{InstanceFlags::Draw},
+        mBaseTransformsIndex(kInvalidTransformsIndex),
         mGlobalBoneBufferOffset(0),
         mIsSkinned(false),
         mAnimationActive(false)
@@ -113,47 +119,55 @@ const BottomLevelAccelerationStructure* MeshInstance::getAccelerationStructure()
     return mScene->getAccelerationStructure(mMesh);
 }
 
-std::vector<float4x4> MeshInstance::tickAnimation(const double time)
+void MeshInstance::tickAnimation(const double time, float4x4* boneMatracies)
 {
     const SkeletalAnimation* activeAnim = getActiveAnimation();
     if(!activeAnim || !mAnimationActive)
-        return std::vector<float4x4>(getMesh()->getSkeleton().size(), float4x4(1.0f));
+    {
+        std::fill_n(boneMatracies, getMesh()->getSkeleton().size(), float4x4(1.0f));
+        return;
+    }
 
     mTick += time * activeAnim->getTicksPerSec();
 
     if(mTick >= activeAnim->getTotalTicks() && !mLoop)
     {
         mAnimationActive = false;
-        return std::vector<float4x4>(getMesh()->getSkeleton().size(), float4x4(1.0f));
+        std::fill_n(boneMatracies, getMesh()->getSkeleton().size(), float4x4(1.0f));
+        return;
     }
 
     if(mLoop)
         mTick = fmod(mTick, activeAnim->getTotalTicks());
 
-    return activeAnim->calculateBoneMatracies(*getMesh(), mTick);
+    activeAnim->calculateBoneMatracies(*getMesh(), mTick, boneMatracies);
 }
 
-void MeshInstance::draw(Executor* exec, UberShaderStateCache* cache) const
+void MeshInstance::draw(Executor* exec, UberShaderStateCache* cache, const uint32_t lod) const
 {
     const StaticMesh* mesh = getMesh();
-    const uint32_t vertesStride = mesh->getVertexStride();
-    const std::vector<SubMesh>& subMeshes = mesh->getSubMeshes();
 
     exec->bindVertexBuffer(*(mesh->getVertexBufferView()), 0);
     exec->bindIndexBuffer(*(mesh->getIndexBufferView()), 0);
 
-    for(uint32_t subMesh_i = 0; subMesh_i < subMeshes.size(); ++subMesh_i)
+    for(uint32_t subMesh_i = 0; subMesh_i < mesh->getSubMeshes().size(); ++subMesh_i)
     {
-        const SubMesh& subMesh = subMeshes[subMesh_i];
-        MeshEntry shaderEntry = getMeshShaderEntry(subMesh_i);
-        const uint64_t shadeFlags = getShadeFlags(subMesh_i);
-        cache->update(shadeFlags);
-
-        exec->insertPushConstant(&shaderEntry, sizeof(MeshEntry));
-        exec->indexedDraw(subMesh.mVertexOffset, subMesh.mIndexOffset, subMesh.mIndexCount);
+        cache->update(getShadeFlags(subMesh_i));
+        drawSubMesh(exec, subMesh_i, lod);
     }
 }
 
+void MeshInstance::drawSubMesh(Executor* exec, const uint32_t subMesh_i, const uint32_t lod) const
+{
+    const StaticMesh* mesh = getMesh();
+    const SubMesh& subMesh = mesh->getSubMeshes()[subMesh_i];
+    const SubMeshLOD& subMeshLOD = mesh->getSubMeshLOD(lod, subMesh_i);
+
+    MeshEntry shaderEntry = getMeshShaderEntry(subMesh_i);
+    exec->insertPushConstant(&shaderEntry, sizeof(MeshEntry));
+    exec->indexedDraw(subMesh.mVertexOffset, subMeshLOD.mIndexOffset, subMeshLOD.mIndexCount);
+}
+
 uint64_t MeshInstance::getShadeFlags(const uint32_t subMesh_i) const
 {
     BELL_ASSERT(subMesh_i < mMaterials.size(), "submesh out of index")
@@ -182,7 +196,8 @@ Scene::Scene(const std::filesystem::path& path) :
     mSceneAABB(float4(std::numeric_limits<float>::max()), float4(std::numeric_limits<float>::min())),
     mSceneCamera(nullptr),
 	mMaterials{},
-	mMaterialImageViews{},
+    mCPUMaterials{},
+    mCPUMaterialOffsets{},
     mLights{},
     mFreeLightIndicies{},
     mShadowLightCamera(nullptr),
@@ -253,6 +268,19 @@ std::vector<InstanceID> Scene::loadFromFile(const int vertAttributes, RenderEngi
     mSceneMeshes.reserve(scene->mNumMeshes);
     mSceneAccelerationStructures.reserve(scene->mNumMeshes);
 
+    // Build the vertex data for every mesh on the thread pool whilst the materials are loading.
+    ThreadPool& threadPool = eng->getThreadPool();
+    std::vector<std::future<StaticMesh>> meshFutures{};
+    meshFutures.reserve(scene->mNumMeshes);
+    for(uint32_t i = 0; i < scene->mNumMeshes; ++i)
+    {
+        meshFutures.push_back(threadPool.addTask([scene, vertAttributes](const aiMesh* mesh)
+        {
+            PROFILER_EVENT("Build mesh");
+            return StaticMesh{scene, mesh, vertAttributes};
+        }, scene->mMeshes[i]));
+    }
+
     MaterialMappings meshMaterials;
     fs::path materialFile{mPath};
     materialFile += ".mat";
@@ -273,9 +301,17 @@ std::vector<InstanceID> Scene::loadFromFile(const int vertAttributes, RenderEngi
               kInvalidInstanceID,
               vertAttributes,
               meshMaterials,
+              meshFutures,
               meshToSceneIDMapping,
               instanceIDs);
 
+    // The importer owns the scene so make sure any meshes not referenced by a node have finished with it.
+    for(auto& meshFuture : meshFutures)
+    {
+        if(meshFuture.valid())
+            meshFuture.wait();
+    }
+
     addLights(scene);
 
     return instanceIDs;
@@ -289,6 +325,7 @@ void Scene::parseNode(RenderEngine* eng,
                       const InstanceID parentID,
                       const int vertAttributes,
                       const MaterialMappings& materialIndexMappings,
+                      std::vector<std::future<StaticMesh>>& meshFutures,
                       std::unordered_map<const aiMesh*, SceneID>& meshMappings,
                       std::vector<InstanceID>& instanceIds)
 {
@@ -316,7 +353,8 @@ void Scene::parseNode(RenderEngine* eng,
         SceneID meshID = 0;
         if(meshMappings.find(currentMesh) == meshMappings.end())
         {
-            StaticMesh mesh{scene, currentMesh, vertAttributes};
+            // Wait for the mesh to finish building on the thread pool.
+            StaticMesh mesh = meshFutures[node->mMeshes[i]].get();
 
             meshID = addMesh(eng, mesh, MeshType::Static);
 
@@ -347,6 +385,7 @@ void Scene::parseNode(RenderEngine* eng,
                   currentInstanceID,
                   vertAttributes,
                   materialIndexMappings,
+                  meshFutures,
                   meshMappings,
                   instanceIds);
     }
@@ -426,6 +465,7 @@ Scene::MaterialMappings Scene::loadMaterialsInternal(RenderEngine* eng)
         materialMappings.insert({aiString(token), materialIndex});
 	}
 
+    std::vector<MaterialPaths> materials{};
     MaterialPaths mat{"", "", "", "", "", "", "", "", 0, 0};
     std::string albedoOrDiffuseFile;
     std::string normalsFile;
@@ -438,11 +478,9 @@ Scene::MaterialMappings Scene::loadMaterialsInternal(RenderEngine* eng)
 	{
 		if(token == "Material")
 		{
-            mat.mMaterialOffset = mMaterialImageViews.size();
-
             // add the previously read material if it exists.
             if(mat.mMaterialTypes)
-                addMaterial(mat, eng);
+                materials.push_back(mat);
 
             mat.mNormalsPath = "";
             mat.mAlbedoorDiffusePath = "";
@@ -522,10 +560,9 @@ Scene::MaterialMappings Scene::loadMaterialsInternal(RenderEngine* eng)
 	}
     // Add the last material
     if(mat.mMaterialTypes)
-    {
-        mat.mMaterialOffset = mMaterialImageViews.size();
-        addMaterial(mat, eng);
-    }
+        materials.push_back(mat);
+
+    addMaterials(materials, eng);
 
     return materialMappings;
 }
@@ -549,6 +586,8 @@ void Scene::loadMaterialsExternal(RenderEngine* eng, const aiScene* scene)
         return mappedPath;
     };
 
+    std::vector<MaterialPaths> materials{};
+    materials.reserve(scene->mNumMaterials);
     for(uint32_t i = 0; i < scene->mNumMaterials; ++i)
     {
         const aiMaterial* material = scene->mMaterials[i];
@@ -693,10 +732,10 @@ void Scene::loadMaterialsExternal(RenderEngine* eng, const aiScene* scene)
         if(opacity < 1.0f)
             newMaterial.mMaterialTypes |= static_cast<uint32_t>(MaterialType::Transparent);
 
-        newMaterial.mMaterialOffset = mMaterialImageViews.size();
-
-        addMaterial(newMaterial, eng);
+        materials.push_back(newMaterial);
     }
+
+    addMaterials(materials, eng);
 }
 
 
@@ -714,6 +753,33 @@ SceneID Scene::addMesh(RenderEngine* eng, const StaticMesh& mesh, MeshType meshT
 
 SceneID Scene::loadFile(const std::string &path, MeshType meshType, RenderEngine* eng, const bool loadMaterials)
 {
+    // Cooked meshes skip assimp entirely, materials can only come from a .mat file.
+    if(CookedMesh::isCookedMesh(path))
+    {
+        StaticMesh newMesh(path, VertexAttributes::Position4 | VertexAttributes::Normals | VertexAttributes::TextureCoordinates |
+                           VertexAttributes::Tangents | VertexAttributes::Albedo);
+        newMesh.initializeDeviceBuffers(eng);
+        const InstanceID id = addMesh(eng, newMesh, meshType);
+
+        mPath = fs::path(path);
+
+        if(loadMaterials)
+        {
+            fs::path materialFile{mPath};
+            materialFile += ".mat";
+            if (fs::exists(materialFile))
+            {
+                loadMaterialsInternal(eng);
+            }
+            else
+            {
+                BELL_LOG_ARGS("No material file found for cooked mesh %s", path.c_str())
+            }
+        }
+
+        return id;
+    }
+
     Assimp::Importer importer;
 
     const aiScene* scene = importer.ReadFile(path.c_str(),
@@ -829,6 +895,7 @@ void Scene::removeInstance(const InstanceID id)
         case InstanceType::DynamicMesh:
         {
             mFreeDynamicMeshIndicies.push_back(entry.mIndex);
+            releaseTransformSlots(mDynamicMeshInstances[entry.mIndex]);
             mDynamicMeshInstances[entry.mIndex].setInstanceFlags(0);
             break;
         }
@@ -836,6 +903,7 @@ void Scene::removeInstance(const InstanceID id)
         case InstanceType::StaticMesh:
         {
             mFreeStaticMeshIndicies.push_back(entry.mIndex);
+            releaseTransformSlots(mStaticMeshInstances[entry.mIndex]);
             mStaticMeshInstances[entry.mIndex].setInstanceFlags(0);
             break;
         }
@@ -855,6 +923,27 @@ void Scene::removeInstance(const InstanceID id)
 }
 
 
+void Scene::resetTransformSlots()
+{
+    for(MeshInstance& instance : mStaticMeshInstances)
+        instance.setBaseTransformsIndex(MeshInstance::kInvalidTransformsIndex);
+    for(MeshInstance& instance : mDynamicMeshInstances)
+        instance.setBaseTransformsIndex(MeshInstance::kInvalidTransformsIndex);
+
+    mReleasedTransformSlots.clear();
+}
+
+
+void Scene::releaseTransformSlots(MeshInstance& instance)
+{
+    if(instance.getBaseTransformsIndex() != MeshInstance::kInvalidTransformsIndex)
+    {
+        mReleasedTransformSlots.push_back(instance.getBaseTransformsIndex());
+        instance.setBaseTransformsIndex(MeshInstance::kInvalidTransformsIndex);
+    }
+}
+
+
 void Scene::computeBounds(const AccelerationStructure type)
 {
     PROFILER_EVENT();
@@ -1112,171 +1201,241 @@ void Scene::setShadowingLight(Camera* cam)
 }
 
 
-void Scene::addMaterial(const Scene::Material& mat)
+std::vector<Image*> Scene::getMaterialViewImages(const Scene::Material& mat)
 {
-    mMaterials.push_back(mat);
+    std::vector<Image*> images{};
 
     if(mat.mMaterialTypes & static_cast<uint32_t>(MaterialType::HeightMap))
-    {
-        mMaterialImageViews.emplace_back(*mat.mHeightMap, ImageViewType::Colour);
-    }
+        images.push_back(mat.mHeightMap);
 
     if(mat.mMaterialTypes & static_cast<uint32_t>(MaterialType::Albedo) ||
             mat.mMaterialTypes & static_cast<uint32_t>(MaterialType::Diffuse))
-    {
-        mMaterialImageViews.emplace_back(*mat.mAlbedoorDiffuse, ImageViewType::Colour);
-    }
+        images.push_back(mat.mAlbedoorDiffuse);
 
     if(mat.mMaterialTypes & static_cast<uint32_t>(MaterialType::Normals))
-    {
-        mMaterialImageViews.emplace_back(*mat.mNormals, ImageViewType::Colour);
-    }
+        images.push_back(mat.mNormals);
 
     if(mat.mMaterialTypes & static_cast<uint32_t>(MaterialType::CombinedMetalnessRoughness))
-    {
-         mMaterialImageViews.emplace_back(*mat.mRoughnessOrGloss, ImageViewType::Colour);
-    }
+        images.push_back(mat.mRoughnessOrGloss);
 
     if(mat.mMaterialTypes & static_cast<uint32_t>(MaterialType::Roughness) ||
             mat.mMaterialTypes & static_cast<uint32_t>(MaterialType::Gloss))
-    {
-        mMaterialImageViews.emplace_back(*mat.mRoughnessOrGloss, ImageViewType::Colour);
-    }
+        images.push_back(mat.mRoughnessOrGloss);
 
     if((mat.mMaterialTypes & static_cast<uint32_t>(MaterialType::Metalness)) ||
             (mat.mMaterialTypes & static_cast<uint32_t>(MaterialType::Specular)) ||
             (mat.mMaterialTypes & static_cast<uint32_t>(MaterialType::CombinedSpecularGloss)))
-    {
-        mMaterialImageViews.emplace_back(*mat.mMetalnessOrSpecular, ImageViewType::Colour);
-    }
+        images.push_back(mat.mMetalnessOrSpecular);
 
     if(mat.mMaterialTypes & static_cast<uint32_t>(MaterialType::AmbientOcclusion))
-    {
-        mMaterialImageViews.emplace_back(*mat.mAmbientOcclusion, ImageViewType::Colour);
-    }
+        images.push_back(mat.mAmbientOcclusion);
 
     if(mat.mMaterialTypes & static_cast<uint32_t>(MaterialType::Emisive))
-    {
-        mMaterialImageViews.emplace_back(*mat.mEmissive, ImageViewType::Colour);
-    }
+        images.push_back(mat.mEmissive);
+
+    return images;
 }
 
 
-void Scene::addMaterial(const MaterialPaths& mat, RenderEngine* eng)
+void Scene::addMaterial(const Scene::Material& mat, RenderEngine* eng)
 {
-    const uint32_t materialFlags = mat.mMaterialTypes;
-    Scene::Material newMaterial{};
-    newMaterial.mMaterialTypes = materialFlags;
-    newMaterial.mMaterialOffset = mat.mMaterialOffset;
+    // Views cover the whole mip chain that's currently resident.
+    std::vector<ImageView> views{};
+    for(Image* image : getMaterialViewImages(mat))
+        views.emplace_back(*image, ImageViewType::Colour, 0, 1, 0, (*image)->numberOfMips());
 
-    auto calculateMips = [](const TextureUtil::TextureInfo& info) -> uint32_t
+    mMaterials.push_back(mat);
+    mMaterials.back().mMaterialOffset = eng->getMaterialTable().addMaterial(mat.mMaterialTypes, views);
+}
+
+
+namespace
+{
+    uint32_t calculateMips(const int width, const int height)
     {
-        const int minSize = std::min(info.width, info.height);
+        const int minSize = std::min(width, height);
         const uint32_t logSize = std::log2(minSize);
 
         return std::clamp(logSize, 1u, 8u);
-    };
+    }
 
-    if(materialFlags & static_cast<uint32_t>(MaterialType::HeightMap))
+    // mInfo always holds the top mip uncompressed as that's what the CPU ray tracer samples, only the base
+    // mips are kept for the GPU, the rest get streamed in when needed.
+    struct DecodedTexture
     {
-        TextureUtil::TextureInfo heightMapInfo = TextureUtil::load32BitTexture(mat.mHeightMapPath.c_str(), STBI_grey);
-        Image* heightTexture = new Image(eng->getDevice(), Format::R8UNorm, ImageUsage::Sampled | ImageUsage::TransferDest | ImageUsage::TransferSrc,
-                             static_cast<uint32_t>(heightMapInfo.width), static_cast<uint32_t>(heightMapInfo.height), 1, calculateMips(heightMapInfo), 1, 1, mat.mHeightMapPath);
-        (*heightTexture)->setContents(heightMapInfo.mData.data(), static_cast<uint32_t>(heightMapInfo.width), static_cast<uint32_t>(heightMapInfo.height), 1);
-        (*heightTexture)->generateMips();
-        newMaterial.mHeightMap = heightTexture;
-
-        mCPUMaterials.emplace_back(std::move(heightMapInfo.mData), (*heightTexture)->getExtent(0, 0), Format::R8UNorm);
-    }
+        TextureUtil::TextureInfo mInfo;
+        TextureStreamer::TextureDesc mDesc;
+        TextureStreamer::StreamedMips mBaseMips;
+    };
 
-    if(materialFlags & static_cast<uint32_t>(MaterialType::Albedo) || materialFlags & static_cast<uint32_t>(MaterialType::Diffuse))
+    DecodedTexture decodeTexture(const std::string& path, const int channels, const Format format)
     {
-        TextureUtil::TextureInfo diffuseInfo = TextureUtil::load32BitTexture(mat.mAlbedoorDiffusePath.c_str(), STBI_rgb_alpha);
-        Image *diffuseTexture = new Image(eng->getDevice(), Format::RGBA8UNorm, ImageUsage::Sampled | ImageUsage::TransferDest | ImageUsage::TransferSrc,
-                             static_cast<uint32_t>(diffuseInfo.width), static_cast<uint32_t>(diffuseInfo.height), 1, calculateMips(diffuseInfo), 1, 1, mat.mAlbedoorDiffusePath);
-        (*diffuseTexture)->setContents(diffuseInfo.mData.data(), static_cast<uint32_t>(diffuseInfo.width), static_cast<uint32_t>(diffuseInfo.height), 1);
-        (*diffuseTexture)->generateMips();
+        DecodedTexture texture{};
+
+        // Prefer the output of the texture cooker if it's been run.
+        const std::string cookedPath = TextureCompression::getCookedTexturePath(path);
+        TextureCompression::CompressedTexture compressed{};
+        if(std::filesystem::exists(cookedPath) && TextureCompression::loadDDS(cookedPath, compressed))
+        {
+            texture.mInfo.mData = TextureCompression::decompressImage(compressed.mMips[0].data(), compressed.mWidth, compressed.mHeight, compressed.mFormat);
+            texture.mInfo.width = static_cast<int>(compressed.mWidth);
+            texture.mInfo.height = static_cast<int>(compressed.mHeight);
 
-        newMaterial.mAlbedoorDiffuse = diffuseTexture;
+            const uint32_t mipCount = static_cast<uint32_t>(compressed.mMips.size());
+            texture.mDesc = {path, cookedPath, true, compressed.mFormat, channels, compressed.mWidth, compressed.mHeight, mipCount};
+            texture.mBaseMips = TextureStreamer::extractMips(compressed, TextureStreamer::getBaseMip(compressed.mWidth, compressed.mHeight, mipCount));
+        }
+        else
+        {
+            texture.mInfo = TextureUtil::load32BitTexture(path.c_str(), channels);
+
+            const uint32_t width = static_cast<uint32_t>(texture.mInfo.width);
+            const uint32_t height = static_cast<uint32_t>(texture.mInfo.height);
+            const uint32_t mipCount = calculateMips(texture.mInfo.width, texture.mInfo.height);
+            texture.mDesc = {path, path, false, format, channels, width, height, mipCount};
+            texture.mBaseMips = TextureStreamer::extractMips(texture.mInfo, channels, TextureStreamer::getBaseMip(width, height, mipCount));
+        }
 
-        mCPUMaterials.emplace_back(std::move(diffuseInfo.mData), (*diffuseTexture)->getExtent(0, 0), Format::RGBA8UNorm);
+        return texture;
     }
+}
+
+
+struct Scene::DecodedMaterial
+{
+    MaterialPaths mPaths;
+
+    DecodedTexture mHeightMap;
+    DecodedTexture mAlbedoOrDiffuse;
+    DecodedTexture mNormals;
+    DecodedTexture mRoughnessOrGloss;
+    DecodedTexture mMetalnessOrSpecular;
+    DecodedTexture mCombinedMetalnessRoughness;
+    DecodedTexture mEmissive;
+    DecodedTexture mAmbientOcclusion;
+};
+
+
+// Only touches the file system, so safe to call from any thread.
+Scene::DecodedMaterial Scene::decodeMaterial(const MaterialPaths& mat)
+{
+    PROFILER_EVENT();
+
+    const uint32_t materialFlags = mat.mMaterialTypes;
+    DecodedMaterial decoded{};
+    decoded.mPaths = mat;
+
+    if(materialFlags & static_cast<uint32_t>(MaterialType::HeightMap))
+        decoded.mHeightMap = decodeTexture(mat.mHeightMapPath, STBI_grey, Format::R8UNorm);
+
+    if(materialFlags & static_cast<uint32_t>(MaterialType::Albedo) || materialFlags & static_cast<uint32_t>(MaterialType::Diffuse))
+        decoded.mAlbedoOrDiffuse = decodeTexture(mat.mAlbedoorDiffusePath, STBI_rgb_alpha, Format::RGBA8UNorm);
 
     if(materialFlags & static_cast<uint32_t>(MaterialType::Normals))
-    {
-        TextureUtil::TextureInfo normalsInfo = TextureUtil::load32BitTexture(mat.mNormalsPath.c_str(), STBI_rgb_alpha);
-        Image* normalsTexture = new Image(eng->getDevice(), Format::RGBA8UNorm, ImageUsage::Sampled | ImageUsage::TransferDest | ImageUsage::TransferSrc,
-                             static_cast<uint32_t>(normalsInfo.width), static_cast<uint32_t>(normalsInfo.height), 1, calculateMips(normalsInfo), 1, 1, mat.mNormalsPath);
-        (*normalsTexture)->setContents(normalsInfo.mData.data(), static_cast<uint32_t>(normalsInfo.width), static_cast<uint32_t>(normalsInfo.height), 1);
-        (*normalsTexture)->generateMips();
-        newMaterial.mNormals = normalsTexture;
-
-        mCPUMaterials.emplace_back(std::move(normalsInfo.mData), (*normalsTexture)->getExtent(0, 0), Format::RGBA8UNorm);
-    }
+        decoded.mNormals = decodeTexture(mat.mNormalsPath, STBI_rgb_alpha, Format::RGBA8UNorm);
 
     if(materialFlags & static_cast<uint32_t>(MaterialType::Roughness) || materialFlags & static_cast<uint32_t>(MaterialType::Gloss))
-    {
-        TextureUtil::TextureInfo roughnessInfo = TextureUtil::load32BitTexture(mat.mRoughnessOrGlossPath.c_str(), STBI_grey);
-        Image* roughnessTexture = new Image(eng->getDevice(), Format::R8UNorm, ImageUsage::Sampled | ImageUsage::TransferDest | ImageUsage::TransferSrc,
-                             static_cast<uint32_t>(roughnessInfo.width), static_cast<uint32_t>(roughnessInfo.height), 1, calculateMips(roughnessInfo), 1, 1, mat.mRoughnessOrGlossPath);
-        (*roughnessTexture)->setContents(roughnessInfo.mData.data(), static_cast<uint32_t>(roughnessInfo.width), static_cast<uint32_t>(roughnessInfo.height), 1);
-        (*roughnessTexture)->generateMips();
-        newMaterial.mRoughnessOrGloss = roughnessTexture;
-
-        mCPUMaterials.emplace_back(std::move(roughnessInfo.mData), (*roughnessTexture)->getExtent(0, 0), Format::R8UNorm);
-    }
+        decoded.mRoughnessOrGloss = decodeTexture(mat.mRoughnessOrGlossPath, STBI_grey, Format::R8UNorm);
 
-    if(materialFlags & static_cast<uint32_t>(MaterialType::Metalness) || materialFlags & static_cast<uint32_t>(MaterialType::Specular) || mat.mMaterialTypes & static_cast<uint32_t>(MaterialType::CombinedSpecularGloss))
-    {
-        TextureUtil::TextureInfo metalnessInfo = TextureUtil::load32BitTexture(mat.mMetalnessOrSpecularPath.c_str(), materialFlags & static_cast<uint32_t>(MaterialType::Metalness) ? STBI_grey : STBI_rgb_alpha);
-        Image* metalnessTexture = new Image(eng->getDevice(), materialFlags & static_cast<uint32_t>(MaterialType::Metalness) ? Format::R8UNorm : Format::RGBA8UNorm, ImageUsage::Sampled | ImageUsage::TransferDest | ImageUsage::TransferSrc,
-                             static_cast<uint32_t>(metalnessInfo.width), static_cast<uint32_t>(metalnessInfo.height), 1, calculateMips(metalnessInfo), 1, 1, mat.mMetalnessOrSpecularPath);
-        (*metalnessTexture)->setContents(metalnessInfo.mData.data(), static_cast<uint32_t>(metalnessInfo.width), static_cast<uint32_t>(metalnessInfo.height), 1);
-        (*metalnessTexture)->generateMips();
-        newMaterial.mMetalnessOrSpecular = metalnessTexture;
-
-        mCPUMaterials.emplace_back(std::move(metalnessInfo.mData), (*metalnessTexture)->getExtent(0, 0), materialFlags & static_cast<uint32_t>(MaterialType::Metalness) ? Format::R8UNorm : Format::RGBA8UNorm);
-    }
+    if(materialFlags & static_cast<uint32_t>(MaterialType::Metalness) || materialFlags & static_cast<uint32_t>(MaterialType::Specular) || materialFlags & static_cast<uint32_t>(MaterialType::CombinedSpecularGloss))
+        decoded.mMetalnessOrSpecular = decodeTexture(mat.mMetalnessOrSpecularPath, materialFlags & static_cast<uint32_t>(MaterialType::Metalness) ? STBI_grey : STBI_rgb_alpha,
+                                                       materialFlags & static_cast<uint32_t>(MaterialType::Metalness) ? Format::R8UNorm : Format::RGBA8UNorm);
 
     if(materialFlags & static_cast<uint32_t>(MaterialType::CombinedMetalnessRoughness))
+        decoded.mCombinedMetalnessRoughness = decodeTexture(mat.mRoughnessOrGlossPath, STBI_rgb_alpha, Format::RGBA8UNorm);
+
+    if(materialFlags & static_cast<uint32_t>(MaterialType::Emisive))
+        decoded.mEmissive = decodeTexture(mat.mEmissivePath, STBI_rgb_alpha, Format::RGBA8UNorm);
+
+    if(materialFlags & static_cast<uint32_t>(MaterialType::AmbientOcclusion))
+        decoded.mAmbientOcclusion = decodeTexture(mat.mAmbientOcclusionPath, STBI_grey, Format::R8UNorm);
+
+    return decoded;
+}
+
+
+void Scene::addMaterial(const MaterialPaths& mat, RenderEngine* eng)
+{
+    addMaterial(decodeMaterial(mat), eng);
+}
+
+
+void Scene::addMaterials(const std::vector<MaterialPaths>& materials, RenderEngine* eng)
+{
+    PROFILER_EVENT();
+
+    ThreadPool& threadPool = eng->getThreadPool();
+
+    std::vector<std::future<DecodedMaterial>> decodedMaterials{};
+    decodedMaterials.reserve(materials.size());
+    for(const MaterialPaths& mat : materials)
+        decodedMaterials.push_back(threadPool.addTask(&Scene::decodeMaterial, mat));
+
+    // Meshes refer to materials by their position so add them in order, each one is usable as soon as it's added
+    // whilst the remaining textures carry on decoding on the pool.
+    for(auto& decoded : decodedMaterials)
+        addMaterial(decoded.get(), eng);
+}
+
+
+void Scene::addMaterial(DecodedMaterial&& decoded, RenderEngine* eng)
+{
+    const MaterialPaths& mat = decoded.mPaths;
+    const uint32_t materialFlags = mat.mMaterialTypes;
+    Scene::Material newMaterial{};
+    newMaterial.mMaterialTypes = materialFlags;
+
+    TextureStreamer& streamer = eng->getTextureStreamer();
+    const uint32_t cpuImageOffset = static_cast<uint32_t>(mCPUMaterials.size());
+
+    // Uploads are recorded in to the prefix command buffer so all the textures loaded before the next frame
+    // are submitted together. Only the base mips are uploaded here.
+    auto uploadTexture = [&](DecodedTexture& decodedTexture) -> Image*
     {
-        TextureUtil::TextureInfo metalnessRoughnessInfo = TextureUtil::load32BitTexture(mat.mRoughnessOrGlossPath.c_str(), STBI_rgb_alpha);
-        Image* metalnessRoughnessTexture = new Image(eng->getDevice(), Format::RGBA8UNorm, ImageUsage::Sampled | ImageUsage::TransferDest | ImageUsage::TransferSrc,
-                             static_cast<uint32_t>(metalnessRoughnessInfo.width), static_cast<uint32_t>(metalnessRoughnessInfo.height), 1, calculateMips(metalnessRoughnessInfo), 1, 1, mat.mRoughnessOrGlossPath);
-        (*metalnessRoughnessTexture)->setContents(metalnessRoughnessInfo.mData.data(), static_cast<uint32_t>(metalnessRoughnessInfo.width), static_cast<uint32_t>(metalnessRoughnessInfo.height), 1);
-        (*metalnessRoughnessTexture)->generateMips();
-        newMaterial.mRoughnessOrGloss = metalnessRoughnessTexture;
+        const TextureStreamer::TextureDesc& desc = decodedTexture.mDesc;
+        Image* texture = streamer.addTexture(desc, std::move(decodedTexture.mBaseMips));
 
-        mCPUMaterials.emplace_back(std::move(metalnessRoughnessInfo.mData), (*metalnessRoughnessTexture)->getExtent(0, 0), Format::RGBA8UNorm);
+        const Format cpuFormat = desc.mCompressed ? (desc.mFormat == Format::BC4UNorm ? Format::R8UNorm : Format::RGBA8UNorm) : desc.mFormat;
+        mCPUMaterials.emplace_back(std::move(decodedTexture.mInfo.mData), ImageExtent{desc.mWidth, desc.mHeight, 1}, cpuFormat);
 
-    }
+        return texture;
+    };
+
+    if(materialFlags & static_cast<uint32_t>(MaterialType::HeightMap))
+        newMaterial.mHeightMap = uploadTexture(decoded.mHeightMap);
+
+    if(materialFlags & static_cast<uint32_t>(MaterialType::Albedo) || materialFlags & static_cast<uint32_t>(MaterialType::Diffuse))
+        newMaterial.mAlbedoorDiffuse = uploadTexture(decoded.mAlbedoOrDiffuse);
+
+    if(materialFlags & static_cast<uint32_t>(MaterialType::Normals))
+        newMaterial.mNormals = uploadTexture(decoded.mNormals);
+
+    if(materialFlags & static_cast<uint32_t>(MaterialType::Roughness) || materialFlags & static_cast<uint32_t>(MaterialType::Gloss))
+        newMaterial.mRoughnessOrGloss = uploadTexture(decoded.mRoughnessOrGloss);
+
+    if(materialFlags & static_cast<uint32_t>(MaterialType::Metalness) || materialFlags & static_cast<uint32_t>(MaterialType::Specular) || materialFlags & static_cast<uint32_t>(MaterialType::CombinedSpecularGloss))
+        newMaterial.mMetalnessOrSpecular = uploadTexture(decoded.mMetalnessOrSpecular);
+
+    if(materialFlags & static_cast<uint32_t>(MaterialType::CombinedMetalnessRoughness))
+        newMaterial.mRoughnessOrGloss = uploadTexture(decoded.mCombinedMetalnessRoughness);
 
     if(materialFlags & static_cast<uint32_t>(MaterialType::Emisive))
-    {
-        TextureUtil::TextureInfo emissiveInfo = TextureUtil::load32BitTexture(mat.mEmissivePath.c_str(), STBI_rgb_alpha);
-        Image* emissiveTexture = new Image(eng->getDevice(), Format::RGBA8UNorm, ImageUsage::Sampled | ImageUsage::TransferDest | ImageUsage::TransferSrc,
-                             static_cast<uint32_t>(emissiveInfo.width), static_cast<uint32_t>(emissiveInfo.height), 1, calculateMips(emissiveInfo), 1, 1, mat.mEmissivePath);
-        (*emissiveTexture)->setContents(emissiveInfo.mData.data(), static_cast<uint32_t>(emissiveInfo.width), static_cast<uint32_t>(emissiveInfo.height), 1);
-        (*emissiveTexture)->generateMips();
-        newMaterial.mEmissive = emissiveTexture;
-
-        mCPUMaterials.emplace_back(std::move(emissiveInfo.mData), (*emissiveTexture)->getExtent(0, 0), Format::RGBA8UNorm);
-    }
+        newMaterial.mEmissive = uploadTexture(decoded.mEmissive);
 
     if(materialFlags & static_cast<uint32_t>(MaterialType::AmbientOcclusion))
-    {
-        TextureUtil::TextureInfo occlusionInfo = TextureUtil::load32BitTexture(mat.mAmbientOcclusionPath.c_str(), STBI_grey);
-        Image* occlusionTexture = new Image(eng->getDevice(), Format::R8UNorm, ImageUsage::Sampled | ImageUsage::TransferDest | ImageUsage::TransferSrc,
-                             static_cast<uint32_t>(occlusionInfo.width), static_cast<uint32_t>(occlusionInfo.height), 1, calculateMips(occlusionInfo), 1, 1, mat.mAmbientOcclusionPath);
-        (*occlusionTexture)->setContents(occlusionInfo.mData.data(), static_cast<uint32_t>(occlusionInfo.width), static_cast<uint32_t>(occlusionInfo.height), 1);
-        (*occlusionTexture)->generateMips();
-        newMaterial.mAmbientOcclusion = occlusionTexture;
-
-        mCPUMaterials.emplace_back(std::move(occlusionInfo.mData), (*occlusionTexture)->getExtent(0, 0), Format::R8UNorm);
-    }
+        newMaterial.mAmbientOcclusion = uploadTexture(decoded.mAmbientOcclusion);
 
     newMaterial.mName = mat.mName;
-    addMaterial(newMaterial);
+    addMaterial(newMaterial, eng);
+
+    const uint32_t materialID = mMaterials.back().mMaterialOffset;
+    if(materialID >= mCPUMaterialOffsets.size())
+        mCPUMaterialOffsets.resize(materialID + 1, 0);
+    mCPUMaterialOffsets[materialID] = cpuImageOffset;
+
+    const std::vector<Image*> images = getMaterialViewImages(newMaterial);
+    for(uint32_t i = 0; i < images.size(); ++i)
+        streamer.setMaterialSlot(images[i], materialID, i);
 }
 
 
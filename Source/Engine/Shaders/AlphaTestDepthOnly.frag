@@ -8,6 +8,9 @@ SamplerState linearSampler;
 [[vk::binding(0, 1)]]
 Texture2D materials[];
 
+[[vk::binding(1, 1)]]
+StructuredBuffer<MaterialTableEntry> materialTable;
+
 [[vk::push_constant]]
 ConstantBuffer<MeshInstanceInfo> model;
 
@@ -16,7 +19,7 @@ void main(DepthOnlyOutput vertInput)
 	if(model.materialFlags & kMaterial_AlphaTested)
 	{
 		// Just perform an alpha test.
-		const float alpha = materials[vertInput.materialIndex].Sample(linearSampler, vertInput.uv).w;
+		const float alpha = materials[materialTable[vertInput.materialIndex].textureSlots[0]].Sample(linearSampler, vertInput.uv).w;
 		if(alpha == 0.0f)
 			discard;
 	}
@@ -12,18 +12,32 @@ StructuredBuffer<float4x4> skinningBones;
 [[vk::binding(3)]]
 StructuredBuffer<float4x3> instanceTransforms;
 
+#if SHADE_FLAGS & ShadeFlag_IndirectDraw
+[[vk::binding(4)]]
+StructuredBuffer<MeshInstanceInfo> drawEntries;
+#else
 [[vk::push_constant]]
 ConstantBuffer<MeshInstanceInfo> model;
-
+#endif
 
 #if SHADE_FLAGS & ShadeFlag_Skinning
-DepthOnlyOutput main(SkinnedVertex vertInput)
+#define VERTEX_INPUT SkinnedVertex
+#else
+#define VERTEX_INPUT Vertex
+#endif
+
+#if SHADE_FLAGS & ShadeFlag_IndirectDraw
+DepthOnlyOutput main(VERTEX_INPUT vertInput, uint startInstance : SV_StartInstanceLocation)
 #else
-DepthOnlyOutput main(Vertex vertInput)
+DepthOnlyOutput main(VERTEX_INPUT vertInput)
 #endif
 {
 	DepthOnlyOutput output;
 
+#if SHADE_FLAGS & ShadeFlag_IndirectDraw
+	const MeshInstanceInfo model = drawEntries[startInstance];
+#endif
+
 	float4x3 meshMatrix = instanceTransforms[model.transformsIndex];
 
 #if SHADE_FLAGS & ShadeFlag_Skinning
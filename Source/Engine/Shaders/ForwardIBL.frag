@@ -45,6 +45,9 @@ Texture2D<float4> reflectionMap;
 [[vk::binding(0, 1)]]
 Texture2D materials[];
 
+[[vk::binding(1, 1)]]
+StructuredBuffer<MaterialTableEntry> materialTable;
+
 
 #include "Materials.hlsl"
 
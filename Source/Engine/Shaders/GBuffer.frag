@@ -24,6 +24,9 @@ SamplerState linearSampler;
 [[vk::binding(0, 1)]]
 Texture2D materials[];
 
+[[vk::binding(1, 1)]]
+StructuredBuffer<MaterialTableEntry> materialTable;
+
 
 #include "Materials.hlsl"
 
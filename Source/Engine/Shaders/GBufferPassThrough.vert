@@ -3,8 +3,13 @@
 #include "Skinning.hlsl"
 
 
+#if SHADE_FLAGS & ShadeFlag_IndirectDraw
+[[vk::binding(5)]]
+StructuredBuffer<MeshInstanceInfo> drawEntries;
+#else
 [[vk::push_constant]]
 ConstantBuffer<MeshInstanceInfo> model;
+#endif
 
 
 [[vk::binding(0)]]
@@ -20,13 +25,23 @@ StructuredBuffer<float4x3> instanceTransforms;
 StructuredBuffer<float4x3> prevInstanceTransforms;
 
 #if SHADE_FLAGS & ShadeFlag_Skinning
-GBufferVertOutput main(SkinnedVertex vertInput)
+#define VERTEX_INPUT SkinnedVertex
 #else
-GBufferVertOutput main(Vertex vertInput)
+#define VERTEX_INPUT Vertex
+#endif
+
+#if SHADE_FLAGS & ShadeFlag_IndirectDraw
+GBufferVertOutput main(VERTEX_INPUT vertInput, uint startInstance : SV_StartInstanceLocation)
+#else
+GBufferVertOutput main(VERTEX_INPUT vertInput)
 #endif
 {
 	GBufferVertOutput output;
 
+#if SHADE_FLAGS & ShadeFlag_IndirectDraw
+	const MeshInstanceInfo model = drawEntries[startInstance];
+#endif
+
 	float4x3 meshMatrix = instanceTransforms[model.transformsIndex];
 	float4x3 prevMeshMatrix = prevInstanceTransforms[model.transformsIndex];
 
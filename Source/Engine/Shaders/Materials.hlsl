@@ -1,5 +1,7 @@
 #define DIELECTRIC_SPECULAR 0.04
 
+#define MATERIAL_TEXTURE(index, slot) materials[materialTable[index].textureSlots[slot]]
+
 
 float3 fresnelSchlickRoughness(const float cosTheta, const float3 F0, const float roughness)
 {
@@ -55,7 +57,7 @@ MaterialInfo calculateMaterialInfo(	const float4 vertexNormal,
 #if SHADE_FLAGS & kMaterial_HeightMap
 	{
 		const float3 tangentView = mul(-view, transpose(tbv));
-		Texture2D<float> heightMap = materials[materialIndex];
+		Texture2D<float> heightMap = MATERIAL_TEXTURE(materialIndex, 0);
 
 		uv = parallaxUV(uv, tangentView, heightMap);
 
@@ -65,7 +67,7 @@ MaterialInfo calculateMaterialInfo(	const float4 vertexNormal,
 
 #if SHADE_FLAGS & kMaterial_Diffuse
 	{
-		mat.diffuse = materials[materialIndex + nextMaterialSlot].Sample(linearSampler, uv);
+		mat.diffuse = MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).Sample(linearSampler, uv);
 		++nextMaterialSlot;
 	}
 #endif
@@ -76,11 +78,11 @@ MaterialInfo calculateMaterialInfo(	const float4 vertexNormal,
 
 #if SHADE_FLAGS & kMaterial_Normals
 	{
-		float3 normal = materials[materialIndex + nextMaterialSlot].Sample(linearSampler, uv).xyz;
+		// Only XY are stored (BC5 for cooked textures), reconstruct Z.
+		const float2 normalXY = remapNormals(MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).Sample(linearSampler, uv).xy);
 		++nextMaterialSlot;
 
-	    // remap normal
-	    normal = remapNormals(normal);
+	    float3 normal = float3(normalXY, reconstructNormalAxis(normalXY));
 	    normal = normalize(normal);
 
 		{
@@ -96,7 +98,7 @@ MaterialInfo calculateMaterialInfo(	const float4 vertexNormal,
 	float metalness = 0.0f;
 #if SHADE_FLAGS & kMaterial_CombinedMetalnessRoughness
 	{
-		const float2 metalnessRoughness = materials[materialIndex + nextMaterialSlot].Sample(linearSampler, uv).zy;
+		const float2 metalnessRoughness = MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).Sample(linearSampler, uv).zy;
 		metalness = metalnessRoughness.x;
 		mat.specularRoughness.w = metalnessRoughness.y;
 		++nextMaterialSlot;
@@ -105,28 +107,28 @@ MaterialInfo calculateMaterialInfo(	const float4 vertexNormal,
 	{
 #if 	SHADE_FLAGS & kMaterial_Roughness
 		{
-			mat.specularRoughness.w = materials[materialIndex + nextMaterialSlot].Sample(linearSampler, uv).x;
+			mat.specularRoughness.w = MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).Sample(linearSampler, uv).x;
 			++nextMaterialSlot;
 		}
 #endif
 
 #if SHADE_FLAGS & kMaterial_Gloss
 		{
-			mat.specularRoughness.w = 1.0f - materials[materialIndex + nextMaterialSlot].Sample(linearSampler, uv).x;
+			mat.specularRoughness.w = 1.0f - MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).Sample(linearSampler, uv).x;
 			++nextMaterialSlot;
 		}
 #endif
 
 #if SHADE_FLAGS & kMaterial_Specular
 		{
-			mat.specularRoughness.xyz= materials[materialIndex + nextMaterialSlot].Sample(linearSampler, uv).xyz;
+			mat.specularRoughness.xyz= MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).Sample(linearSampler, uv).xyz;
 			++nextMaterialSlot;
 		}
 #endif
 		
 #if SHADE_FLAGS & kMaterial_CombinedSpecularGloss
 		{
-			mat.specularRoughness = materials[materialIndex + nextMaterialSlot].Sample(linearSampler, uv);
+			mat.specularRoughness = MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).Sample(linearSampler, uv);
 			mat.specularRoughness.w = 1.0f - mat.specularRoughness.w;
 			++nextMaterialSlot;
 		}
@@ -134,7 +136,7 @@ MaterialInfo calculateMaterialInfo(	const float4 vertexNormal,
 
 #if SHADE_FLAGS & kMaterial_Metalness
 		{
-			metalness = materials[materialIndex + nextMaterialSlot].Sample(linearSampler, uv).x;
+			metalness = MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).Sample(linearSampler, uv).x;
 			++nextMaterialSlot;
 		}
 #endif
@@ -143,7 +145,7 @@ MaterialInfo calculateMaterialInfo(	const float4 vertexNormal,
 
 #if SHADE_FLAGS & kMaterial_Albedo
 	{
-		const float4 albedo = materials[materialIndex].Sample(linearSampler, uv);
+		const float4 albedo = MATERIAL_TEXTURE(materialIndex, 0).Sample(linearSampler, uv);
 		mat.diffuse = albedo * (1.0 - DIELECTRIC_SPECULAR) * (1.0 - metalness);
 		mat.diffuse.w = albedo.w;// Preserve the alpha chanle.
 
@@ -155,14 +157,14 @@ MaterialInfo calculateMaterialInfo(	const float4 vertexNormal,
 
 #if SHADE_FLAGS & kMaterial_AmbientOcclusion
 	{
-		mat.emissiveOcclusion.w = materials[materialIndex + nextMaterialSlot].Sample(linearSampler, uv).x;
+		mat.emissiveOcclusion.w = MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).Sample(linearSampler, uv).x;
 		++nextMaterialSlot;
 	}
 #endif
 
 #if SHADE_FLAGS & kMaterial_Emissive
 	{
-		mat.emissiveOcclusion.xyz = materials[materialIndex + nextMaterialSlot].Sample(linearSampler, uv).xyz;
+		mat.emissiveOcclusion.xyz = MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).Sample(linearSampler, uv).xyz;
 	}
 #endif
 
@@ -188,7 +190,7 @@ MaterialInfo calculateMaterialInfoRayTracing(	const float4 vertexColour,
 
 	if(materialTypes & kMaterial_Diffuse)
 	{
-		mat.diffuse = materials[materialIndex].SampleLevel(linearSampler, uv, LOD);
+		mat.diffuse = MATERIAL_TEXTURE(materialIndex, 0).SampleLevel(linearSampler, uv, LOD);
 		++nextMaterialSlot;
 	}
 
@@ -203,7 +205,7 @@ MaterialInfo calculateMaterialInfoRayTracing(	const float4 vertexColour,
 	float metalness = 0.0f;
 	if(materialTypes & kMaterial_CombinedMetalnessRoughness)
 	{
-		const float2 metalnessRoughness = materials[materialIndex + nextMaterialSlot].SampleLevel(linearSampler, uv, LOD).zy;
+		const float2 metalnessRoughness = MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).SampleLevel(linearSampler, uv, LOD).zy;
 		metalness = metalnessRoughness.x;
 		mat.specularRoughness.w = metalnessRoughness.y;
 		++nextMaterialSlot;
@@ -212,39 +214,39 @@ MaterialInfo calculateMaterialInfoRayTracing(	const float4 vertexColour,
 	{
 		if(materialTypes & kMaterial_Roughness)
 		{
-			mat.specularRoughness.w = materials[materialIndex + nextMaterialSlot].SampleLevel(linearSampler, uv, LOD).x;
+			mat.specularRoughness.w = MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).SampleLevel(linearSampler, uv, LOD).x;
 			++nextMaterialSlot;
 		}
 
 		if(materialTypes & kMaterial_Gloss)
 		{
-			mat.specularRoughness.w = 1.0f - materials[materialIndex + nextMaterialSlot].SampleLevel(linearSampler, uv, LOD).x;
+			mat.specularRoughness.w = 1.0f - MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).SampleLevel(linearSampler, uv, LOD).x;
 			++nextMaterialSlot;
 		}
 
 		if(materialTypes & kMaterial_Specular)
 		{
-			mat.specularRoughness.xyz= materials[materialIndex + nextMaterialSlot].SampleLevel(linearSampler, uv, LOD).xyz;
+			mat.specularRoughness.xyz= MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).SampleLevel(linearSampler, uv, LOD).xyz;
 			++nextMaterialSlot;
 		}
 		
 		if(materialTypes & kMaterial_CombinedSpecularGloss)
 		{
-			mat.specularRoughness = materials[materialIndex + nextMaterialSlot].SampleLevel(linearSampler, uv, LOD);
+			mat.specularRoughness = MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).SampleLevel(linearSampler, uv, LOD);
 			mat.specularRoughness.w = 1.0f - mat.specularRoughness.w;
 			++nextMaterialSlot;
 		}
 
 		if(materialTypes & kMaterial_Metalness)
 		{
-			metalness = materials[materialIndex + nextMaterialSlot].SampleLevel(linearSampler, uv, LOD).x;
+			metalness = MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).SampleLevel(linearSampler, uv, LOD).x;
 			++nextMaterialSlot;
 		}
 	}
 
 	if(materialTypes & kMaterial_Albedo)
 	{
-		const float4 albedo = materials[materialIndex].SampleLevel(linearSampler, uv, LOD);
+		const float4 albedo = MATERIAL_TEXTURE(materialIndex, 0).SampleLevel(linearSampler, uv, LOD);
 		mat.diffuse = albedo * (1.0 - DIELECTRIC_SPECULAR) * (1.0 - metalness);
 		mat.diffuse.w = albedo.w;// Preserve the alpha chanle.
 
@@ -255,13 +257,13 @@ MaterialInfo calculateMaterialInfoRayTracing(	const float4 vertexColour,
 
 	if(materialTypes & kMaterial_AmbientOcclusion)
 	{
-		mat.emissiveOcclusion.w = materials[materialIndex + nextMaterialSlot].SampleLevel(linearSampler, uv, LOD).x;
+		mat.emissiveOcclusion.w = MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).SampleLevel(linearSampler, uv, LOD).x;
 		++nextMaterialSlot;
 	}
 
 	if(materialTypes & kMaterial_Emissive)
 	{
-		mat.emissiveOcclusion.xyz = materials[materialIndex + nextMaterialSlot].SampleLevel(linearSampler, uv, LOD).xyz;
+		mat.emissiveOcclusion.xyz = MATERIAL_TEXTURE(materialIndex, nextMaterialSlot).SampleLevel(linearSampler, uv, LOD).xyz;
 	}
 
 
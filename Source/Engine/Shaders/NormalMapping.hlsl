@@ -44,7 +44,7 @@ float2 remapNormals(const float2 N)
 
 float reconstructNormalAxis(const float2 N)
 {
-	return sqrt(1.0f - dot(N.xy, N.xy));
+	return sqrt(saturate(1.0f - dot(N.xy, N.xy)));
 }
 
 float2 OctWrap( float2 v )
@@ -0,0 +1,86 @@
+
+struct AABB
+{
+	float4 minimum;
+	float4 maximum;
+};
+
+struct ProjectedAABB
+{
+	// Normalised device coordinates, only meaningful if the box is entirely in front of the camera.
+	float4 clipSpaceMin;
+	float4 clipSpaceMax;
+	bool inFrustum;
+	bool crossesCameraPlane;
+};
+
+ProjectedAABB projectAABB(const AABB bounds, const float4x4 viewProj)
+{
+	float4 verticies[8] = 
+	{
+		bounds.minimum,
+		float4(bounds.minimum.x, bounds.minimum.y, bounds.maximum.z, 1.0f),
+		float4(bounds.maximum.x, bounds.minimum.y, bounds.maximum.z, 1.0f),
+		float4(bounds.maximum.x, bounds.minimum.y, bounds.minimum.z, 1.0f),
+		float4(bounds.minimum.x, bounds.maximum.y, bounds.minimum.z, 1.0f),
+		float4(bounds.minimum.x, bounds.maximum.y, bounds.maximum.z, 1.0f),
+		bounds.maximum,
+		float4(bounds.maximum.x, bounds.maximum.y, bounds.minimum.z, 1.0f),
+	};
+
+	ProjectedAABB result;
+	result.clipSpaceMin = float4(10.0f, 10.0f, 10.0f, 10.0f);
+	result.clipSpaceMax = float4(-10.0f, -10.0f, -10.0f, -10.0f);
+	result.crossesCameraPlane = false;
+
+	// The box is outside the frustum if every corner is outside the same plane.
+	uint outsideAll = 0x3F;
+	for(uint i = 0; i < 8; ++i)
+	{
+		const float4 clip = mul(viewProj, verticies[i]);
+
+		uint outside = 0;
+		outside |= clip.x < -clip.w ? 1 : 0;
+		outside |= clip.x > clip.w ? 2 : 0;
+		outside |= clip.y < -clip.w ? 4 : 0;
+		outside |= clip.y > clip.w ? 8 : 0;
+		outside |= clip.z < 0.0f ? 16 : 0; // Reverse depth, so this is past the far plane.
+		outside |= clip.z > clip.w ? 32 : 0;
+		outsideAll &= outside;
+
+		if(clip.w <= 0.0f)
+			result.crossesCameraPlane = true;
+
+		const float4 trans = clip / clip.w;
+		result.clipSpaceMin = min(result.clipSpaceMin, trans);
+		result.clipSpaceMax = max(result.clipSpaceMax, trans);
+	}
+
+	result.inFrustum = outsideAll == 0;
+
+	return result;
+}
+
+// Tests the projected box against the hierarchical linear depth.
+bool isOccluded(const ProjectedAABB projected, Texture2D<float2> hierarchicalDepth, SamplerState samp, const CameraBuffer camera)
+{
+	// The projection isn't valid for boxes behind the camera.
+	if(projected.crossesCameraPlane)
+		return false;
+
+	// Use the min and max points as screen space UVs.
+	const float4 AABBuv = float4(projected.clipSpaceMin.xy * 0.5f + 0.5f, projected.clipSpaceMax.xy * 0.5f + 0.5f);
+
+	// Calculate a lod that would cover the AABB with 4 samples.
+	const float2 size = (projected.clipSpaceMax.xy - projected.clipSpaceMin.xy) * camera.frameBufferSize;
+	const float depthLOD = ceil(log2(max(size.x, size.y)));
+
+	const float4 depthTaps = float4(hierarchicalDepth.SampleLevel(samp, AABBuv.xy, depthLOD).y,
+									hierarchicalDepth.SampleLevel(samp, AABBuv.zy, depthLOD).y,
+									hierarchicalDepth.SampleLevel(samp, AABBuv.xw, depthLOD).y,
+									hierarchicalDepth.SampleLevel(samp, AABBuv.zw, depthLOD).y);
+
+	const float maxDepth = max(max(depthTaps.x, depthTaps.y), max(depthTaps.z, depthTaps.w));
+
+	return lineariseReverseDepth(projected.clipSpaceMax.z, camera.nearPlane, camera.farPlane) > maxDepth;
+}
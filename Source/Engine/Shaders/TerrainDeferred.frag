@@ -22,6 +22,9 @@ SamplerState linearSampler;
 [[vk::binding(0, 1)]]
 Texture2D materials[];
 
+[[vk::binding(1, 1)]]
+StructuredBuffer<MaterialTableEntry> materialTable;
+
 [[vk::push_constant]]
 ConstantBuffer<TerrainTextureing> constants;
 
@@ -68,13 +68,15 @@ struct VoxelDimmensions
 };
 
 
-struct TerrainVolume
+struct TerrainChunk
 {
     float3 minimum;
     float  voxelSize;
-    uint3  offset;
-    uint   lod;
-    float4 frustumPlanes[6];
+    uint   brickOffset;
+    uint   cellCount;
+    uint   vertexOffset;
+    uint   vertexCapacity;
+    uint   counterIndex;
 };
 
 struct TerrainTextureing
@@ -84,6 +86,16 @@ struct TerrainTextureing
     uint materialIndexY;
 };
 
+// Indexed by material ID, holds the slot in the bindless materials array of each of the materials textures.
+struct MaterialTableEntry
+{
+    uint textureSlots[8];
+    uint materialTypes;
+    uint padding0;
+    uint padding1;
+    uint padding2;
+};
+
 struct ColourCorrection
 {
     float gamma;
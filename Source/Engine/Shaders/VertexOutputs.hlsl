@@ -110,6 +110,9 @@ struct TerrainVertexOutput
 	float3 normal : NORMAL;
 };
 
+// Set for draws generated by the indirect draw culling pass.
+#define ShadeFlag_IndirectDraw (1 << 23)
+
 struct MeshInstanceInfo
 {
 	uint transformsIndex;
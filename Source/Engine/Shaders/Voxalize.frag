@@ -51,6 +51,9 @@ Texture2D<float> shadowMap;
 [[vk::binding(0, 1)]]
 Texture2D materials[];
 
+[[vk::binding(1, 1)]]
+StructuredBuffer<MaterialTableEntry> materialTable;
+
 
 #if defined(Light_froxelation)
 [[vk::binding(0, 2)]]
@@ -108,7 +108,8 @@ void ShadowMappingTechnique::render(RenderGraph& graph, RenderEngine* eng)
 
     // update renderView that feeds these tasks.
     RenderView& renderView = eng->getRenderView(kRenderView_Shadow);
-    renderView.updateView(eng->getScene()->getShadowLightCamera());
+    renderView.setLODBias(kShadowLODBias);
+    renderView.updateView(eng->getScene()->getShadowLightCamera(), eng->getShadowMapResolution().y);
 
     shadowTask.setRecordCommandsCallback(
         [this](const RenderGraph& graph, const uint32_t taskIndex, Executor* exec, RenderEngine* eng, const std::vector<const MeshInstance*>&)
@@ -132,13 +133,16 @@ void ShadowMappingTechnique::render(RenderGraph& graph, RenderEngine* eng)
 
             UberShaderSkinnedStateCache stateCache(exec, mShadowMappingPipelines);
 
+            const Camera& lightCamera = eng->getScene()->getShadowLightCamera();
+            const float viewportHeight = eng->getShadowMapResolution().y;
+
             for (const auto& mesh : meshes)
             {
                 // Don't render transparent geometry.
                 if (!(mesh->getInstanceFlags() & InstanceFlags::Draw))
                     continue;
 
-                mesh->draw(exec, &stateCache);
+                mesh->draw(exec, &stateCache, selectInstanceLOD(*mesh, lightCamera, viewportHeight, kShadowLODBias));
             }
         }
     );
@@ -1,5 +1,7 @@
 #include "Engine/StaticMesh.h"
 #include "Engine/Engine.hpp"
+#include "Engine/CookedMesh.hpp"
+#include "Engine/MeshSimplification.hpp"
 #include "Core/BellLogging.hpp"
 #include "Core/ConversionUtils.hpp"
 #include "Core/Buffer.hpp"
@@ -9,6 +11,8 @@
 
 #include "glm/gtx/handed_coordinate_space.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <limits>
 
 
@@ -39,6 +43,13 @@ StaticMesh::StaticMesh(const std::string& path, const int vertAttributes, const
     mVertexAttributes(vertAttributes),
     mVertexStride(0)
 {
+    if(CookedMesh::isCookedMesh(path))
+    {
+        loadCookedMesh(path);
+        BELL_ASSERT(mVertexAttributes == vertAttributes, "Cooked mesh vertex attributes don't match those requested")
+        return;
+    }
+
 	Assimp::Importer importer;
 
     const aiScene* scene = importer.ReadFile(path.c_str(),
@@ -54,6 +65,7 @@ StaticMesh::StaticMesh(const std::string& path, const int vertAttributes, const
               aiMatrix4x4(),
               mVertexAttributes);
 
+    generateLODs();
     loadAnimations(scene);
 }
 
@@ -71,6 +83,7 @@ StaticMesh::StaticMesh(const aiScene *scene, const aiMesh* mesh, const int verte
 {
     configure(scene, mesh, float4x4(1.0f), vertexAttributes);
 
+    generateLODs();
     loadAnimations(scene);
 }
 
@@ -90,6 +103,7 @@ StaticMesh::StaticMesh(const aiScene* scene, const int vertexAttributes) :
               aiMatrix4x4(),
               vertexAttributes);
 
+    generateLODs();
     loadAnimations(scene);
 }
 
@@ -123,6 +137,171 @@ void StaticMesh::initializeDeviceBuffers(RenderEngine* eng)
 }
 
 
+bool StaticMesh::writeCookedMesh(const std::string& filePath) const
+{
+    CookedMesh::Writer writer{};
+
+    CookedMesh::Header header{};
+    header.mMagic = CookedMesh::kMagic;
+    header.mVersion = CookedMesh::kVersion;
+    header.mVertexAttributes = mVertexAttributes;
+    header.mVertexStride = mVertexStride;
+    header.mVertexCount = mVertexCount;
+    header.mIndexCount = mIndexData.size();
+    header.mSubMeshCount = mSubMeshes.size();
+    header.mBoneCount = mSkeleton.size();
+    header.mMeshletCount = mMeshlets.size();
+    header.mLODCount = mLODErrors.size();
+    header.mAABBMin = mAABB.getMin();
+    header.mAABBMax = mAABB.getMax();
+    writer.write(header);
+
+    const std::vector<unsigned char>& vertexData = mVertexData.getVertexBuffer();
+    writer.allignTo(CookedMesh::kSectionAllignment);
+    header.mVertexDataOffset = writer.getOffset();
+    writer.writeBytes(vertexData.data(), vertexData.size());
+
+    writer.allignTo(CookedMesh::kSectionAllignment);
+    header.mIndexDataOffset = writer.getOffset();
+    writer.writeBytes(mIndexData.data(), mIndexData.size() * sizeof(uint32_t));
+
+    writer.allignTo(CookedMesh::kSectionAllignment);
+    header.mSubMeshOffset = writer.getOffset();
+    writer.writeBytes(mSubMeshes.data(), mSubMeshes.size() * sizeof(SubMesh));
+
+    writer.allignTo(CookedMesh::kSectionAllignment);
+    header.mMeshletOffset = writer.getOffset();
+    writer.writeBytes(mMeshlets.data(), mMeshlets.size() * sizeof(Meshlet));
+
+    writer.allignTo(CookedMesh::kSectionAllignment);
+    header.mLODOffset = writer.getOffset();
+    writer.writeBytes(mLODErrors.data(), mLODErrors.size() * sizeof(float));
+    writer.writeBytes(mLODSubMeshes.data(), mLODSubMeshes.size() * sizeof(SubMeshLOD));
+
+    writer.allignTo(CookedMesh::kSectionAllignment);
+    header.mAnimationDataOffset = writer.getOffset();
+    for(const Bone& bone : mSkeleton)
+    {
+        writer.writeString(bone.mName);
+        writer.write(bone.mParentIndex);
+        writer.write(bone.mInverseBindPose);
+        writer.write(bone.mLocalMatrix);
+        writer.write(bone.mOBB);
+    }
+
+    writer.write<uint64_t>(mSkeletalAnimations.size());
+    for(const auto& [name, animation] : mSkeletalAnimations)
+        animation.serialise(writer);
+
+    writer.write<uint64_t>(mBlendMeshes.size());
+    for(const MeshBlend& blend : mBlendMeshes)
+        blend.serialise(writer);
+
+    writer.write<uint64_t>(mBlendAnimations.size());
+    for(const auto& [name, animation] : mBlendAnimations)
+        animation.serialise(writer);
+
+    header.mAnimationDataSize = writer.getOffset() - header.mAnimationDataOffset;
+    writer.writeAt(0, header);
+
+    return writer.writeToFile(filePath);
+}
+
+
+void StaticMesh::loadCookedMesh(const std::string& filePath)
+{
+    static_assert(std::is_trivially_copyable_v<SubMesh>, "SubMesh must be trivially copyable to be cooked");
+
+    CookedMesh::MappedFile file{filePath};
+    if(!file.isValid() || file.getSize() < sizeof(CookedMesh::Header))
+    {
+        BELL_LOG_ERROR(Assets, "Failed to map cooked mesh %s", filePath.c_str())
+        return;
+    }
+
+    CookedMesh::Header header{};
+    std::memcpy(&header, file.getData(), sizeof(CookedMesh::Header));
+    if(header.mMagic != CookedMesh::kMagic || header.mVersion != CookedMesh::kVersion)
+    {
+        BELL_LOG_ERROR(Assets, "%s is not a compatible cooked mesh", filePath.c_str())
+        return;
+    }
+
+    const uint64_t vertexDataSize = header.mVertexCount * header.mVertexStride;
+    const uint64_t indexDataSize = header.mIndexCount * sizeof(uint32_t);
+    const uint64_t subMeshDataSize = header.mSubMeshCount * sizeof(SubMesh);
+    const uint64_t meshletDataSize = header.mMeshletCount * sizeof(Meshlet);
+    const uint64_t lodDataSize = header.mLODCount * (sizeof(float) + (header.mSubMeshCount * sizeof(SubMeshLOD)));
+    if(header.mVertexDataOffset + vertexDataSize > file.getSize() ||
+       header.mIndexDataOffset + indexDataSize > file.getSize() ||
+       header.mSubMeshOffset + subMeshDataSize > file.getSize() ||
+       header.mMeshletOffset + meshletDataSize > file.getSize() ||
+       header.mLODOffset + lodDataSize > file.getSize() ||
+       header.mAnimationDataOffset + header.mAnimationDataSize > file.getSize())
+    {
+        BELL_LOG_ERROR(Assets, "Cooked mesh %s is truncated", filePath.c_str())
+        return;
+    }
+
+    mVertexAttributes = header.mVertexAttributes;
+    mVertexStride = header.mVertexStride;
+    mVertexCount = header.mVertexCount;
+    mAABB = AABB{header.mAABBMin, header.mAABBMax};
+
+    // Vertex and index data are already in their final layout, so a bulk copy is all that's needed.
+    mVertexData.setData(file.getData() + header.mVertexDataOffset, vertexDataSize);
+
+    const uint32_t* indexData = reinterpret_cast<const uint32_t*>(file.getData() + header.mIndexDataOffset);
+    mIndexData.assign(indexData, indexData + header.mIndexCount);
+
+    mSubMeshes.resize(header.mSubMeshCount);
+    std::memcpy(mSubMeshes.data(), file.getData() + header.mSubMeshOffset, subMeshDataSize);
+
+    mMeshlets.resize(header.mMeshletCount);
+    std::memcpy(mMeshlets.data(), file.getData() + header.mMeshletOffset, meshletDataSize);
+
+    mLODErrors.resize(header.mLODCount);
+    mLODSubMeshes.resize(header.mLODCount * header.mSubMeshCount);
+    std::memcpy(mLODErrors.data(), file.getData() + header.mLODOffset, mLODErrors.size() * sizeof(float));
+    std::memcpy(mLODSubMeshes.data(), file.getData() + header.mLODOffset + (mLODErrors.size() * sizeof(float)), mLODSubMeshes.size() * sizeof(SubMeshLOD));
+
+    CookedMesh::Reader reader{file.getData() + header.mAnimationDataOffset, header.mAnimationDataSize};
+    mSkeleton.reserve(header.mBoneCount);
+    for(uint32_t i = 0; i < header.mBoneCount && reader.isValid(); ++i)
+    {
+        Bone bone{};
+        bone.mName = reader.readString();
+        bone.mParentIndex = reader.read<uint16_t>();
+        bone.mInverseBindPose = reader.read<float4x4>();
+        bone.mLocalMatrix = reader.read<float4x4>();
+        bone.mOBB = reader.read<OBB>();
+
+        mBoneIndexMap[bone.mName] = mSkeleton.size();
+        mSkeleton.push_back(std::move(bone));
+    }
+
+    const uint64_t skeletalAnimationCount = reader.read<uint64_t>();
+    for(uint64_t i = 0; i < skeletalAnimationCount && reader.isValid(); ++i)
+    {
+        SkeletalAnimation animation{reader};
+        mSkeletalAnimations.insert({animation.getName(), std::move(animation)});
+    }
+
+    const uint64_t blendMeshCount = reader.read<uint64_t>();
+    for(uint64_t i = 0; i < blendMeshCount && reader.isValid(); ++i)
+        mBlendMeshes.emplace_back(reader);
+
+    const uint64_t blendAnimationCount = reader.read<uint64_t>();
+    for(uint64_t i = 0; i < blendAnimationCount && reader.isValid(); ++i)
+    {
+        BlendMeshAnimation animation{reader};
+        mBlendAnimations.insert({animation.getName(), std::move(animation)});
+    }
+
+    BELL_ASSERT(reader.isValid(), "Corrupt animation data in cooked mesh")
+}
+
+
 void StaticMesh::configure(const aiScene* scene, const aiMesh* mesh, const float4x4 transform, const int vertAttributes)
 {
     const unsigned int primitiveType = mesh->mPrimitiveTypes;
@@ -295,6 +474,15 @@ void StaticMesh::configure(const aiScene* scene, const aiMesh* mesh, const float
     mBoneWeights.clear();
     mBonesPerVertex.clear();
 
+    // Positions are always the first attribute.
+    if(positionNeeded && primitiveType == aiPrimitiveType::aiPrimitiveType_TRIANGLE)
+    {
+        newSubMesh.mMeshletOffset = mMeshlets.size();
+        buildMeshlets(mIndexData, newSubMesh.mIndexOffset, newSubMesh.mIndexCount,
+                      mVertexData.getVertexBuffer().data() + (newSubMesh.mVertexOffset * mVertexStride), mVertexStride, mMeshlets);
+        newSubMesh.mMeshletCount = mMeshlets.size() - newSubMesh.mMeshletOffset;
+    }
+
     AABB submeshAABB{topLeft, bottumRight};
     submeshAABB = submeshAABB * transform;
     mAABB = AABB{componentWiseMin(submeshAABB.getMin(), mAABB.getMin()), componentWiseMax(submeshAABB.getMax(), mAABB.getMax())};
@@ -303,6 +491,93 @@ void StaticMesh::configure(const aiScene* scene, const aiMesh* mesh, const float
 }
 
 
+void StaticMesh::generateLODs()
+{
+    mLODErrors = {0.0f};
+    mLODSubMeshes.clear();
+    for(const SubMesh& subMesh : mSubMeshes)
+        mLODSubMeshes.push_back({subMesh.mIndexOffset, subMesh.mIndexCount});
+
+    if(!(mVertexAttributes & (VertexAttributes::Position3 | VertexAttributes::Position4)))
+        return;
+
+    // Submeshes this small aren't worth simplifying any further.
+    constexpr uint32_t kMinLODIndexCount = 64 * 3;
+
+    const uint32_t subMeshCount = mSubMeshes.size();
+    for(uint32_t lod = 1; lod < kMaxMeshLODs; ++lod)
+    {
+        bool reduced = false;
+        float lodError = mLODErrors.back();
+
+        for(uint32_t subMesh_i = 0; subMesh_i < subMeshCount; ++subMesh_i)
+        {
+            const SubMesh& subMesh = mSubMeshes[subMesh_i];
+            const SubMeshLOD previous = mLODSubMeshes[((lod - 1) * subMeshCount) + subMesh_i];
+            if(previous.mIndexCount < kMinLODIndexCount)
+            {
+                mLODSubMeshes.push_back(previous);
+                continue;
+            }
+
+            // Each level aims for half the triangles of the one before.
+            const uint32_t targetIndexCount = (previous.mIndexCount / 6) * 3;
+
+            float error = 0.0f;
+            std::vector<uint32_t> simplified = simplifyMesh(mIndexData.data() + previous.mIndexOffset, previous.mIndexCount,
+                                                            mVertexData.getVertexBuffer().data() + (subMesh.mVertexOffset * mVertexStride),
+                                                            mVertexStride, subMesh.mVertexCount, targetIndexCount, error);
+
+            // Stop once there's too little left to collapse to be worth another copy of the indices.
+            if(simplified.size() * 10 > previous.mIndexCount * 9)
+            {
+                mLODSubMeshes.push_back(previous);
+                continue;
+            }
+
+            // Errors add up through the chain, as each level is simplified from the last.
+            const float transformScale = std::max({glm::length(float3(subMesh.mTransform[0])), glm::length(float3(subMesh.mTransform[1])), glm::length(float3(subMesh.mTransform[2]))});
+            lodError = std::max(lodError, mLODErrors.back() + (error * transformScale));
+
+            mLODSubMeshes.push_back({static_cast<uint32_t>(mIndexData.size()), static_cast<uint32_t>(simplified.size())});
+            mIndexData.insert(mIndexData.end(), simplified.begin(), simplified.end());
+            reduced = true;
+        }
+
+        if(!reduced)
+        {
+            mLODSubMeshes.resize(lod * subMeshCount);
+            break;
+        }
+
+        mLODErrors.push_back(lodError);
+    }
+}
+
+
+uint32_t StaticMesh::getBaseIndexCount() const
+{
+    if(mLODErrors.size() <= 1)
+        return static_cast<uint32_t>(mIndexData.size());
+
+    uint32_t indexCount = 0;
+    for(const SubMesh& subMesh : mSubMeshes)
+        indexCount = std::max(indexCount, subMesh.mIndexOffset + subMesh.mIndexCount);
+
+    return indexCount;
+}
+
+
+uint32_t StaticMesh::getLODForError(const float maxError) const
+{
+    uint32_t lod = 0;
+    while((lod + 1) < mLODErrors.size() && mLODErrors[lod + 1] <= maxError)
+        ++lod;
+
+    return lod;
+}
+
+
 uint16_t StaticMesh::findBoneParent(const aiNode* bone, float4x4& localTransform)
 {
     const aiNode* currentNode = bone;
@@ -468,7 +743,7 @@ void StaticMesh::loadAnimations(const aiScene* scene)
             mBlendAnimations.insert({ std::string(animation->mName.C_Str()), BlendMeshAnimation(animation, scene) });
         if (animation->mNumChannels == 0 && animation->mNumMorphMeshChannels == 0)
         {
-            BELL_LOG_ARGS("Unsupported animation %s not loaded", animation->mName.C_Str())
+            BELL_LOG_WARNING(Assets, "Unsupported animation %s not loaded", animation->mName.C_Str())
         }
     }
 }
@@ -0,0 +1,254 @@
+#include "Engine/TerrainMesher.hpp"
+#include "Engine/VoxelTerrain.hpp"
+#include "Engine/ThreadPool.hpp"
+
+#include "MarchingCubesTables.hpp"
+
+#include "Core/Profiling.hpp"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TERRAIN_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define TERRAIN_USE_SSE2 0
+#endif
+
+
+namespace
+{
+    constexpr uint32_t kCellCount = VoxelTerrain::kChunkSize;
+    constexpr uint32_t kBrickSize = kCellCount + 3;
+    static_assert(kCellCount == 16, "Rows of cells are classified 16 at a time");
+
+    // Bit i is set when row[i] is outside the terrain, for 16 voxels.
+    uint32_t outsideMask(const int8_t* row)
+    {
+#if TERRAIN_USE_SSE2
+        const __m128i voxels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row));
+        return ~uint32_t(_mm_movemask_epi8(voxels)) & 0xFFFFu;
+#else
+        uint32_t mask = 0;
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            if(row[i] >= 0)
+                mask |= 1u << i;
+        }
+
+        return mask;
+#endif
+    }
+
+    // Voxels are uploaded as R8Norm, so match how the shader sees them.
+    float brickValue(const int8_t* brick, const uint3& voxel)
+    {
+        return std::max(float(brick[voxel.x + (voxel.z * kBrickSize) + (voxel.y * kBrickSize * kBrickSize)]) / 127.0f, -1.0f);
+    }
+
+    void interpolateVertex(const float3& p1, const float3& p2, const float3& n1, const float3& n2, const float value1, const float value2,
+                           float3& position, float3& normal)
+    {
+        // Same order as VertexInterp in the shader.
+        if(std::abs(value1) < 0.00001f)
+        {
+            position = p1;
+            normal = n1;
+            return;
+        }
+        if(std::abs(value2) < 0.00001f)
+        {
+            position = p2;
+            normal = n2;
+            return;
+        }
+        if(std::abs(value1 - value2) < 0.00001f)
+        {
+            position = p1;
+            normal = n1;
+            return;
+        }
+
+        const float mu = -value1 / (value2 - value1);
+        position = p1 + (mu * (p2 - p1));
+        normal = n1 + (mu * (n2 - n1));
+    }
+}
+
+
+TerrainMesher::TerrainMesher() :
+    mTerrain{nullptr},
+    mChunkMeshes{}
+{
+}
+
+
+uint32_t TerrainMesher::update(const VoxelTerrain& terrain, ThreadPool& threadPool)
+{
+    PROFILER_EVENT("Terrain CPU meshing");
+
+    const uint3 chunkCount = terrain.getChunkCount();
+    const uint32_t totalChunks = chunkCount.x * chunkCount.y * chunkCount.z;
+    if(mTerrain != &terrain || mChunkMeshes.size() != totalChunks)
+    {
+        // Chunks still at revision zero haven't been initialised, so have no surface.
+        mTerrain = &terrain;
+        mChunkMeshes.clear();
+        mChunkMeshes.resize(totalChunks, ChunkMesh{{}, {}, 0});
+    }
+
+    std::vector<uint32_t> staleChunks{};
+    for(uint32_t chunk = 0; chunk < totalChunks; ++chunk)
+    {
+        if(mChunkMeshes[chunk].mRevision != terrain.getChunkRevision(chunk))
+            staleChunks.push_back(chunk);
+    }
+
+    if(staleChunks.empty())
+        return 0;
+
+    // Each chunk only writes its own mesh, so they can be built in any order.
+    auto meshChunks = [&](const uint32_t start, const uint32_t stepSize)
+    {
+        std::vector<int8_t> brick(kBrickSize * kBrickSize * kBrickSize);
+        for(uint32_t i = start; i < staleChunks.size(); i += stepSize)
+        {
+            const uint32_t chunk = staleChunks[i];
+            meshChunk(terrain, chunk, brick.data(), mChunkMeshes[chunk]);
+            mChunkMeshes[chunk].mRevision = terrain.getChunkRevision(chunk);
+        }
+    };
+
+    const uint32_t workerCount = std::clamp(uint32_t(threadPool.getWorkerCount()), 1u, uint32_t(staleChunks.size()));
+    std::vector<std::future<void>> handles{};
+    for(uint32_t i = 1; i < workerCount; ++i)
+    {
+        handles.push_back(threadPool.addTask(meshChunks, i, workerCount));
+    }
+
+    meshChunks(0, workerCount);
+
+    for(auto& handle : handles)
+        handle.wait();
+
+    return staleChunks.size();
+}
+
+
+uint32_t TerrainMesher::getVertexCount() const
+{
+    uint32_t count = 0;
+    for(const ChunkMesh& mesh : mChunkMeshes)
+        count += mesh.mPositions.size();
+
+    return count;
+}
+
+
+void TerrainMesher::getTriangles(std::vector<float3>& positions, std::vector<float3>& normals) const
+{
+    const uint32_t vertexCount = getVertexCount();
+    positions.reserve(positions.size() + vertexCount);
+    normals.reserve(normals.size() + vertexCount);
+
+    for(const ChunkMesh& mesh : mChunkMeshes)
+    {
+        positions.insert(positions.end(), mesh.mPositions.begin(), mesh.mPositions.end());
+        normals.insert(normals.end(), mesh.mNormals.begin(), mesh.mNormals.end());
+    }
+}
+
+
+void TerrainMesher::meshChunk(const VoxelTerrain& terrain, const uint32_t chunk, int8_t* brick, ChunkMesh& mesh) const
+{
+    using namespace MarchingCubes;
+
+    mesh.mPositions.clear();
+    mesh.mNormals.clear();
+
+    if(!terrain.getChunkBrick(chunk, 0, brick))
+    {
+        mesh.mPositions = std::vector<float3>{};
+        mesh.mNormals = std::vector<float3>{};
+        return;
+    }
+
+    const float3 minimum = terrain.getChunkBounds(chunk).getMin();
+    const float voxelSize = terrain.getVoxelSize();
+
+    for(uint32_t y = 0; y < kCellCount; ++y)
+    {
+        for(uint32_t z = 0; z < kCellCount; ++z)
+        {
+            // Classify the whole row of cells at once, bit x of each mask is that corner of cell x.
+            uint32_t cornerMasks[8];
+            uint32_t anyOutside = 0;
+            uint32_t allOutside = 0xFFFFu;
+            for(uint32_t corner = 0; corner < 8; ++corner)
+            {
+                // Offset by one to skip the bricks border.
+                const uint32_t voxelY = y + kCubeCorners[corner][1] + 1;
+                const uint32_t voxelZ = z + kCubeCorners[corner][2] + 1;
+                const int8_t* row = brick + (voxelZ * kBrickSize) + (voxelY * kBrickSize * kBrickSize);
+
+                cornerMasks[corner] = outsideMask(row + kCubeCorners[corner][0] + 1);
+                anyOutside |= cornerMasks[corner];
+                allOutside &= cornerMasks[corner];
+            }
+
+            // Only cells with corners either side of the surface produce triangles.
+            const uint32_t activeCells = anyOutside & ~allOutside;
+            if(activeCells == 0)
+                continue;
+
+            for(uint32_t x = 0; x < kCellCount; ++x)
+            {
+                if((activeCells & (1u << x)) == 0)
+                    continue;
+
+                uint32_t cubeIndex = 0;
+                float values[8];
+                float3 positions[8];
+                float3 normals[8];
+                for(uint32_t corner = 0; corner < 8; ++corner)
+                {
+                    cubeIndex |= ((cornerMasks[corner] >> x) & 1u) << corner;
+
+                    const uint3 cell = uint3{x, y, z} + uint3{kCubeCorners[corner][0], kCubeCorners[corner][1], kCubeCorners[corner][2]};
+                    const uint3 voxel = cell + 1u;
+                    positions[corner] = minimum + (float3(cell) * voxelSize);
+                    values[corner] = brickValue(brick, voxel);
+
+                    const float3 gradient{brickValue(brick, voxel + uint3{1, 0, 0}) - brickValue(brick, voxel - uint3{1, 0, 0}),
+                                          brickValue(brick, voxel + uint3{0, 1, 0}) - brickValue(brick, voxel - uint3{0, 1, 0}),
+                                          brickValue(brick, voxel + uint3{0, 0, 1}) - brickValue(brick, voxel - uint3{0, 0, 1})};
+                    const float length = glm::length(gradient);
+                    normals[corner] = length > 0.0f ? gradient / length : float3(0.0f, 1.0f, 0.0f);
+                }
+
+                const uint32_t edges = kEdgeTable[cubeIndex];
+                float3 edgePositions[12];
+                float3 edgeNormals[12];
+                for(uint32_t edge = 0; edge < 12; ++edge)
+                {
+                    if((edges & (1u << edge)) == 0)
+                        continue;
+
+                    const uint32_t first = kEdgeCorners[edge][0];
+                    const uint32_t second = kEdgeCorners[edge][1];
+                    interpolateVertex(positions[first], positions[second], normals[first], normals[second], values[first], values[second],
+                                      edgePositions[edge], edgeNormals[edge]);
+                }
+
+                for(uint32_t i = 0; kTriTable[cubeIndex][i] != -1; ++i)
+                {
+                    const uint32_t edge = kTriTable[cubeIndex][i];
+                    mesh.mPositions.push_back(edgePositions[edge]);
+
+                    const float length = glm::length(edgeNormals[edge]);
+                    mesh.mNormals.push_back(length > 0.0f ? edgeNormals[edge] / length : float3(0.0f, 1.0f, 0.0f));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,973 @@
+#include "Engine/TextureCompression.hpp"
+#include "Engine/TextureUtil.hpp"
+
+#include "Core/BellLogging.hpp"
+#include "Core/Profiling.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BCN_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define BCN_USE_SSE2 0
+#endif
+
+
+namespace
+{
+    constexpr uint32_t kBlockPixels = 16;
+
+    // BC7 4 bit index interpolation weights.
+    constexpr uint32_t kBC7Weights4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    // Fetch a 4x4 block of RGBA8 texels, edge texels are replicated for partial blocks.
+    void fetchBlock(const unsigned char* pixels, const uint32_t width, const uint32_t height, const uint32_t channels,
+                    const uint32_t blockX, const uint32_t blockY, uint8_t* block)
+    {
+        for(uint32_t y = 0; y < 4; ++y)
+        {
+            const uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+            for(uint32_t x = 0; x < 4; ++x)
+            {
+                const uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+                const unsigned char* source = pixels + (sourceY * width + sourceX) * channels;
+                uint8_t* dst = block + (y * 4 + x) * 4;
+
+                for(uint32_t c = 0; c < 4; ++c)
+                    dst[c] = c < channels ? source[c] : (c == 3 ? 255 : 0);
+            }
+        }
+    }
+
+
+    void blockMinMax(const uint8_t* block, uint8_t* minColour, uint8_t* maxColour)
+    {
+#if BCN_USE_SSE2
+        const __m128i p0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+        const __m128i p1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16));
+        const __m128i p2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 32));
+        const __m128i p3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 48));
+
+        __m128i minimum = _mm_min_epu8(_mm_min_epu8(p0, p1), _mm_min_epu8(p2, p3));
+        __m128i maximum = _mm_max_epu8(_mm_max_epu8(p0, p1), _mm_max_epu8(p2, p3));
+        minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 8));
+        minimum = _mm_min_epu8(minimum, _mm_srli_si128(minimum, 4));
+        maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 8));
+        maximum = _mm_max_epu8(maximum, _mm_srli_si128(maximum, 4));
+
+        const int32_t packedMin = _mm_cvtsi128_si32(minimum);
+        const int32_t packedMax = _mm_cvtsi128_si32(maximum);
+        std::memcpy(minColour, &packedMin, 4);
+        std::memcpy(maxColour, &packedMax, 4);
+#else
+        for(uint32_t c = 0; c < 4; ++c)
+        {
+            minColour[c] = 255;
+            maxColour[c] = 0;
+        }
+
+        for(uint32_t i = 0; i < kBlockPixels; ++i)
+        {
+            for(uint32_t c = 0; c < 4; ++c)
+            {
+                minColour[c] = std::min(minColour[c], block[i * 4 + c]);
+                maxColour[c] = std::max(maxColour[c], block[i * 4 + c]);
+            }
+        }
+#endif
+    }
+
+
+    // dot(texel, axis) for all 16 texels in the block.
+    void projectBlock(const uint8_t* block, const int16_t* axis, int32_t* dots)
+    {
+#if BCN_USE_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i axisVec = _mm_set_epi16(axis[3], axis[2], axis[1], axis[0], axis[3], axis[2], axis[1], axis[0]);
+
+        for(uint32_t i = 0; i < 4; ++i)
+        {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+            const __m128i low = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), axisVec);
+            const __m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), axisVec);
+
+            // madd leaves rg and ba partial sums in adjacent lanes, add the pairs together.
+            const __m128i lowSum = _mm_shuffle_epi32(_mm_add_epi32(low, _mm_srli_epi64(low, 32)), _MM_SHUFFLE(3, 3, 2, 0));
+            const __m128i highSum = _mm_shuffle_epi32(_mm_add_epi32(high, _mm_srli_epi64(high, 32)), _MM_SHUFFLE(3, 3, 2, 0));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dots + i * 4), _mm_unpacklo_epi64(lowSum, highSum));
+        }
+#else
+        for(uint32_t i = 0; i < kBlockPixels; ++i)
+        {
+            dots[i] = block[i * 4] * axis[0] + block[i * 4 + 1] * axis[1] + block[i * 4 + 2] * axis[2] + block[i * 4 + 3] * axis[3];
+        }
+#endif
+    }
+
+
+    // Find the texels at either end of the principal axis of the block (power iteration on the covariance matrix).
+    void findEndpoints(const uint8_t* block, const uint32_t channels, uint8_t* startColour, uint8_t* endColour)
+    {
+        float mean[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for(uint32_t i = 0; i < kBlockPixels; ++i)
+        {
+            for(uint32_t c = 0; c < channels; ++c)
+                mean[c] += block[i * 4 + c];
+        }
+        for(uint32_t c = 0; c < channels; ++c)
+            mean[c] /= float(kBlockPixels);
+
+        float covariance[4][4] = {};
+        for(uint32_t i = 0; i < kBlockPixels; ++i)
+        {
+            for(uint32_t c1 = 0; c1 < channels; ++c1)
+            {
+                for(uint32_t c2 = c1; c2 < channels; ++c2)
+                    covariance[c1][c2] += (block[i * 4 + c1] - mean[c1]) * (block[i * 4 + c2] - mean[c2]);
+            }
+        }
+        for(uint32_t c1 = 0; c1 < channels; ++c1)
+        {
+            for(uint32_t c2 = 0; c2 < c1; ++c2)
+                covariance[c1][c2] = covariance[c2][c1];
+        }
+
+        // Start from the bounding box diagonal.
+        uint8_t minColour[4];
+        uint8_t maxColour[4];
+        blockMinMax(block, minColour, maxColour);
+        float axis[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for(uint32_t c = 0; c < channels; ++c)
+            axis[c] = float(maxColour[c] - minColour[c]);
+
+        for(uint32_t iteration = 0; iteration < 8; ++iteration)
+        {
+            float newAxis[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            for(uint32_t c1 = 0; c1 < channels; ++c1)
+            {
+                for(uint32_t c2 = 0; c2 < channels; ++c2)
+                    newAxis[c1] += covariance[c1][c2] * axis[c2];
+            }
+
+            float length = 0.0f;
+            for(uint32_t c = 0; c < channels; ++c)
+                length = std::max(length, std::abs(newAxis[c]));
+
+            if(length < 1e-6f)
+                break;
+
+            for(uint32_t c = 0; c < channels; ++c)
+                axis[c] = newAxis[c] / length;
+        }
+
+        int16_t intAxis[4] = {0, 0, 0, 0};
+        float maxComponent = 0.0f;
+        for(uint32_t c = 0; c < channels; ++c)
+            maxComponent = std::max(maxComponent, std::abs(axis[c]));
+        if(maxComponent > 0.0f)
+        {
+            for(uint32_t c = 0; c < channels; ++c)
+                intAxis[c] = static_cast<int16_t>(axis[c] / maxComponent * 127.0f);
+        }
+
+        int32_t dots[kBlockPixels];
+        projectBlock(block, intAxis, dots);
+
+        uint32_t minIndex = 0;
+        uint32_t maxIndex = 0;
+        for(uint32_t i = 1; i < kBlockPixels; ++i)
+        {
+            if(dots[i] < dots[minIndex])
+                minIndex = i;
+            if(dots[i] > dots[maxIndex])
+                maxIndex = i;
+        }
+
+        std::memcpy(startColour, block + minIndex * 4, 4);
+        std::memcpy(endColour, block + maxIndex * 4, 4);
+    }
+
+
+    // Pull the endpoints slightly towards each other, the extremes are rarely the best fit.
+    void insetEndpoints(uint8_t* start, uint8_t* end, const uint32_t channels, const int32_t insetShift)
+    {
+        for(uint32_t c = 0; c < channels; ++c)
+        {
+            const int32_t inset = (int32_t(end[c]) - int32_t(start[c])) / (1 << insetShift);
+            start[c] = static_cast<uint8_t>(std::clamp(int32_t(start[c]) + inset, 0, 255));
+            end[c] = static_cast<uint8_t>(std::clamp(int32_t(end[c]) - inset, 0, 255));
+        }
+    }
+
+
+    uint16_t packRGB565(const uint8_t* colour)
+    {
+        const uint32_t r = (colour[0] * 31u + 127u) / 255u;
+        const uint32_t g = (colour[1] * 63u + 127u) / 255u;
+        const uint32_t b = (colour[2] * 31u + 127u) / 255u;
+
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+
+    void unpackRGB565(const uint16_t packed, uint8_t* colour)
+    {
+        const uint32_t r = packed >> 11;
+        const uint32_t g = (packed >> 5) & 0x3F;
+        const uint32_t b = packed & 0x1F;
+
+        colour[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+        colour[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+        colour[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+        colour[3] = 255;
+    }
+
+
+    // Always emits 4 colour blocks so the output is also valid as the colour part of BC3.
+    void encodeBC1Block(const uint8_t* block, uint8_t* output)
+    {
+        uint8_t start[4];
+        uint8_t end[4];
+        findEndpoints(block, 3, start, end);
+        insetEndpoints(start, end, 3, 4);
+
+        uint16_t colour0 = packRGB565(end);
+        uint16_t colour1 = packRGB565(start);
+        if(colour0 < colour1)
+            std::swap(colour0, colour1);
+
+        uint32_t indices = 0;
+        if(colour0 != colour1)
+        {
+            uint8_t endpoint0[4];
+            uint8_t endpoint1[4];
+            unpackRGB565(colour0, endpoint0);
+            unpackRGB565(colour1, endpoint1);
+
+            // The palette is colinear so the closest entry can be found by projecting on to the endpoint axis.
+            const int16_t axis[4] = {int16_t(endpoint0[0] - endpoint1[0]), int16_t(endpoint0[1] - endpoint1[1]), int16_t(endpoint0[2] - endpoint1[2]), 0};
+            int32_t dots[kBlockPixels];
+            projectBlock(block, axis, dots);
+
+            const int32_t dot0 = endpoint0[0] * axis[0] + endpoint0[1] * axis[1] + endpoint0[2] * axis[2];
+            const int32_t dot1 = endpoint1[0] * axis[0] + endpoint1[1] * axis[1] + endpoint1[2] * axis[2];
+            const int32_t range = dot0 - dot1;
+
+            // position along the axis from colour1 (0) to colour0 (3) -> palette index.
+            constexpr uint32_t kPositionToIndex[4] = {1, 3, 2, 0};
+            for(uint32_t i = 0; i < kBlockPixels; ++i)
+            {
+                const int32_t position = std::clamp((((dots[i] - dot1) * 6) + range) / (range * 2), 0, 3);
+                indices |= kPositionToIndex[position] << (i * 2);
+            }
+        }
+
+        std::memcpy(output, &colour0, 2);
+        std::memcpy(output + 2, &colour1, 2);
+        std::memcpy(output + 4, &indices, 4);
+    }
+
+
+    void decodeBC1Block(const uint8_t* input, uint8_t* output, const bool forceFourColour)
+    {
+        uint16_t colour0;
+        uint16_t colour1;
+        uint32_t indices;
+        std::memcpy(&colour0, input, 2);
+        std::memcpy(&colour1, input + 2, 2);
+        std::memcpy(&indices, input + 4, 4);
+
+        uint8_t palette[4][4];
+        unpackRGB565(colour0, palette[0]);
+        unpackRGB565(colour1, palette[1]);
+        for(uint32_t c = 0; c < 3; ++c)
+        {
+            if(colour0 > colour1 || forceFourColour)
+            {
+                palette[2][c] = static_cast<uint8_t>((2 * palette[0][c] + palette[1][c]) / 3);
+                palette[3][c] = static_cast<uint8_t>((palette[0][c] + 2 * palette[1][c]) / 3);
+            }
+            else
+            {
+                palette[2][c] = static_cast<uint8_t>((palette[0][c] + palette[1][c]) / 2);
+                palette[3][c] = 0;
+            }
+        }
+        palette[2][3] = 255;
+        palette[3][3] = (colour0 > colour1 || forceFourColour) ? 255 : 0;
+
+        for(uint32_t i = 0; i < kBlockPixels; ++i)
+            std::memcpy(output + i * 4, palette[(indices >> (i * 2)) & 0x3], 4);
+    }
+
+
+    // Single channel block, reads channel "channel" of the RGBA block.
+    void encodeBC4Block(const uint8_t* block, const uint32_t channel, const uint8_t minValue, const uint8_t maxValue, uint8_t* output)
+    {
+        output[0] = maxValue;
+        output[1] = minValue;
+
+        uint64_t bits = 0;
+        if(maxValue != minValue)
+        {
+            const int32_t range = maxValue - minValue;
+            // position along the ramp from min (0) to max (7) -> palette index.
+            constexpr uint64_t kPositionToIndex[8] = {1, 7, 6, 5, 4, 3, 2, 0};
+            for(uint32_t i = 0; i < kBlockPixels; ++i)
+            {
+                const int32_t position = ((block[i * 4 + channel] - minValue) * 14 + range) / (range * 2);
+                bits |= kPositionToIndex[position] << (i * 3);
+            }
+        }
+
+        for(uint32_t i = 0; i < 6; ++i)
+            output[2 + i] = static_cast<uint8_t>(bits >> (i * 8));
+    }
+
+
+    void decodeBC4Block(const uint8_t* input, uint8_t* output, const uint32_t stride)
+    {
+        const uint32_t value0 = input[0];
+        const uint32_t value1 = input[1];
+
+        uint8_t palette[8];
+        palette[0] = static_cast<uint8_t>(value0);
+        palette[1] = static_cast<uint8_t>(value1);
+        if(value0 > value1)
+        {
+            for(uint32_t i = 2; i < 8; ++i)
+                palette[i] = static_cast<uint8_t>(((8 - i) * value0 + (i - 1) * value1) / 7);
+        }
+        else
+        {
+            for(uint32_t i = 2; i < 6; ++i)
+                palette[i] = static_cast<uint8_t>(((6 - i) * value0 + (i - 1) * value1) / 5);
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        uint64_t bits = 0;
+        for(uint32_t i = 0; i < 6; ++i)
+            bits |= uint64_t(input[2 + i]) << (i * 8);
+
+        for(uint32_t i = 0; i < kBlockPixels; ++i)
+            output[i * stride] = palette[(bits >> (i * 3)) & 0x7];
+    }
+
+
+    class BitWriter
+    {
+    public:
+        BitWriter() :
+            mBits{0, 0},
+            mOffset{0} {}
+
+        void write(const uint64_t value, const uint32_t count)
+        {
+            for(uint32_t i = 0; i < count; ++i, ++mOffset)
+                mBits[mOffset / 64] |= ((value >> i) & 1) << (mOffset % 64);
+        }
+
+        void store(uint8_t* output) const
+        {
+            std::memcpy(output, mBits, 16);
+        }
+
+    private:
+        uint64_t mBits[2];
+        uint32_t mOffset;
+    };
+
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t* input) :
+            mOffset{0}
+        {
+            std::memcpy(mBits, input, 16);
+        }
+
+        uint32_t read(const uint32_t count)
+        {
+            uint32_t value = 0;
+            for(uint32_t i = 0; i < count; ++i, ++mOffset)
+                value |= uint32_t((mBits[mOffset / 64] >> (mOffset % 64)) & 1) << i;
+
+            return value;
+        }
+
+    private:
+        uint64_t mBits[2];
+        uint32_t mOffset;
+    };
+
+
+    // Quantise an endpoint to 7 bits per channel plus a shared p bit, picking whichever p bit fits best.
+    void quantiseBC7Endpoint(const uint8_t* colour, uint8_t* quantised, uint32_t& pBit)
+    {
+        uint32_t bestError = ~0u;
+        for(uint32_t p = 0; p < 2; ++p)
+        {
+            uint8_t candidate[4];
+            uint32_t error = 0;
+            for(uint32_t c = 0; c < 4; ++c)
+            {
+                candidate[c] = static_cast<uint8_t>(std::clamp((int32_t(colour[c]) - int32_t(p) + 1) / 2, 0, 127));
+                const int32_t diff = int32_t((candidate[c] << 1) | p) - int32_t(colour[c]);
+                error += diff * diff;
+            }
+
+            if(error < bestError)
+            {
+                bestError = error;
+                pBit = p;
+                std::memcpy(quantised, candidate, 4);
+            }
+        }
+    }
+
+
+    // Mode 6: single subset, 7.7.7.7 endpoints with per endpoint p bits and 4 bit indices.
+    void encodeBC7Block(const uint8_t* block, uint8_t* output)
+    {
+        uint8_t start[4];
+        uint8_t end[4];
+        findEndpoints(block, 4, start, end);
+        insetEndpoints(start, end, 4, 5);
+
+        uint8_t quantised[2][4];
+        uint32_t pBits[2];
+        quantiseBC7Endpoint(start, quantised[0], pBits[0]);
+        quantiseBC7Endpoint(end, quantised[1], pBits[1]);
+
+        int32_t endpoints[2][4];
+        for(uint32_t e = 0; e < 2; ++e)
+        {
+            for(uint32_t c = 0; c < 4; ++c)
+                endpoints[e][c] = (quantised[e][c] << 1) | pBits[e];
+        }
+
+        int32_t palette[16][4];
+        for(uint32_t i = 0; i < 16; ++i)
+        {
+            for(uint32_t c = 0; c < 4; ++c)
+                palette[i][c] = ((64 - kBC7Weights4[i]) * endpoints[0][c] + kBC7Weights4[i] * endpoints[1][c] + 32) >> 6;
+        }
+
+        uint32_t indices[kBlockPixels];
+        for(uint32_t i = 0; i < kBlockPixels; ++i)
+        {
+            uint32_t bestError = ~0u;
+            for(uint32_t p = 0; p < 16; ++p)
+            {
+                uint32_t error = 0;
+                for(uint32_t c = 0; c < 4; ++c)
+                {
+                    const int32_t diff = palette[p][c] - block[i * 4 + c];
+                    error += diff * diff;
+                }
+
+                if(error < bestError)
+                {
+                    bestError = error;
+                    indices[i] = p;
+                }
+            }
+        }
+
+        // The MSB of the anchor index is implicitly 0, swap the endpoints if needed.
+        if(indices[0] & 0x8)
+        {
+            std::swap(quantised[0], quantised[1]);
+            std::swap(pBits[0], pBits[1]);
+            for(uint32_t i = 0; i < kBlockPixels; ++i)
+                indices[i] = 15 - indices[i];
+        }
+
+        BitWriter writer{};
+        writer.write(1 << 6, 7);
+        for(uint32_t c = 0; c < 4; ++c)
+        {
+            writer.write(quantised[0][c], 7);
+            writer.write(quantised[1][c], 7);
+        }
+        writer.write(pBits[0], 1);
+        writer.write(pBits[1], 1);
+        writer.write(indices[0], 3);
+        for(uint32_t i = 1; i < kBlockPixels; ++i)
+            writer.write(indices[i], 4);
+
+        writer.store(output);
+    }
+
+
+    // Only mode 6 is supported as that's all the encoder produces, other modes decode to magenta.
+    void decodeBC7Block(const uint8_t* input, uint8_t* output)
+    {
+        if((input[0] & 0x7F) != 0x40)
+        {
+            for(uint32_t i = 0; i < kBlockPixels; ++i)
+            {
+                output[i * 4] = 255;
+                output[i * 4 + 1] = 0;
+                output[i * 4 + 2] = 255;
+                output[i * 4 + 3] = 255;
+            }
+            return;
+        }
+
+        BitReader reader{input};
+        reader.read(7);
+
+        uint32_t endpoints[2][4];
+        for(uint32_t c = 0; c < 4; ++c)
+        {
+            endpoints[0][c] = reader.read(7);
+            endpoints[1][c] = reader.read(7);
+        }
+        const uint32_t pBit0 = reader.read(1);
+        const uint32_t pBit1 = reader.read(1);
+        for(uint32_t c = 0; c < 4; ++c)
+        {
+            endpoints[0][c] = (endpoints[0][c] << 1) | pBit0;
+            endpoints[1][c] = (endpoints[1][c] << 1) | pBit1;
+        }
+
+        for(uint32_t i = 0; i < kBlockPixels; ++i)
+        {
+            const uint32_t index = reader.read(i == 0 ? 3 : 4);
+            for(uint32_t c = 0; c < 4; ++c)
+                output[i * 4 + c] = static_cast<uint8_t>(((64 - kBC7Weights4[index]) * endpoints[0][c] + kBC7Weights4[index] * endpoints[1][c] + 32) >> 6);
+        }
+    }
+
+
+    uint32_t getBlockBytes(const Format format)
+    {
+        return (format == Format::BC1UNorm || format == Format::BC4UNorm) ? 8 : 16;
+    }
+
+
+    void renormalise(std::vector<unsigned char>& pixels, const uint32_t channels)
+    {
+        for(size_t i = 0; i < pixels.size(); i += channels)
+        {
+            float normal[3];
+            for(uint32_t c = 0; c < 3; ++c)
+                normal[c] = (pixels[i + c] / 255.0f) * 2.0f - 1.0f;
+
+            const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            if(length < 1e-5f)
+                continue;
+
+            for(uint32_t c = 0; c < 3; ++c)
+                pixels[i + c] = static_cast<unsigned char>(std::clamp(((normal[c] / length) * 0.5f + 0.5f) * 255.0f + 0.5f, 0.0f, 255.0f));
+        }
+    }
+
+
+    // DDS container, always written with the DX10 extension header.
+    constexpr uint32_t kDDSMagic = 0x20534444; // "DDS "
+    constexpr uint32_t kDX10FourCC = 0x30315844; // "DX10"
+    constexpr uint32_t kDXT1FourCC = 0x31545844;
+    constexpr uint32_t kDXT5FourCC = 0x35545844;
+    constexpr uint32_t kATI1FourCC = 0x31495441;
+    constexpr uint32_t kATI2FourCC = 0x32495441;
+
+    constexpr uint32_t kDXGIFormatBC1UNorm = 71;
+    constexpr uint32_t kDXGIFormatBC3UNorm = 77;
+    constexpr uint32_t kDXGIFormatBC4UNorm = 80;
+    constexpr uint32_t kDXGIFormatBC5UNorm = 83;
+    constexpr uint32_t kDXGIFormatBC7UNorm = 98;
+
+    struct DDSPixelFormat
+    {
+        uint32_t mSize;
+        uint32_t mFlags;
+        uint32_t mFourCC;
+        uint32_t mRGBBitCount;
+        uint32_t mRBitMask;
+        uint32_t mGBitMask;
+        uint32_t mBBitMask;
+        uint32_t mABitMask;
+    };
+
+    struct DDSHeader
+    {
+        uint32_t mSize;
+        uint32_t mFlags;
+        uint32_t mHeight;
+        uint32_t mWidth;
+        uint32_t mPitchOrLinearSize;
+        uint32_t mDepth;
+        uint32_t mMipMapCount;
+        uint32_t mReserved1[11];
+        DDSPixelFormat mPixelFormat;
+        uint32_t mCaps;
+        uint32_t mCaps2;
+        uint32_t mCaps3;
+        uint32_t mCaps4;
+        uint32_t mReserved2;
+    };
+    static_assert(sizeof(DDSHeader) == 124, "Incorrect DDS header size");
+
+    struct DDSHeaderDX10
+    {
+        uint32_t mDXGIFormat;
+        uint32_t mResourceDimension;
+        uint32_t mMiscFlag;
+        uint32_t mArraySize;
+        uint32_t mMiscFlags2;
+    };
+
+    uint32_t getDXGIFormat(const Format format)
+    {
+        switch(format)
+        {
+            case Format::BC1UNorm:
+                return kDXGIFormatBC1UNorm;
+
+            case Format::BC3UNorm:
+                return kDXGIFormatBC3UNorm;
+
+            case Format::BC4UNorm:
+                return kDXGIFormatBC4UNorm;
+
+            case Format::BC5UNorm:
+                return kDXGIFormatBC5UNorm;
+
+            case Format::BC7UNorm:
+                return kDXGIFormatBC7UNorm;
+
+            default:
+                BELL_TRAP;
+                return 0;
+        }
+    }
+
+    bool getFormatFromDXGI(const uint32_t dxgiFormat, Format& format)
+    {
+        switch(dxgiFormat)
+        {
+            case kDXGIFormatBC1UNorm:
+                format = Format::BC1UNorm;
+                return true;
+
+            case kDXGIFormatBC3UNorm:
+                format = Format::BC3UNorm;
+                return true;
+
+            case kDXGIFormatBC4UNorm:
+                format = Format::BC4UNorm;
+                return true;
+
+            case kDXGIFormatBC5UNorm:
+                format = Format::BC5UNorm;
+                return true;
+
+            case kDXGIFormatBC7UNorm:
+                format = Format::BC7UNorm;
+                return true;
+
+            default:
+                return false;
+        }
+    }
+}
+
+
+namespace TextureCompression
+{
+
+std::vector<unsigned char> compressImage(const unsigned char* pixels, const uint32_t width, const uint32_t height, const uint32_t channels, const Format format)
+{
+    PROFILER_EVENT();
+
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    const uint32_t blockBytes = getBlockBytes(format);
+
+    std::vector<unsigned char> compressed(blocksX * blocksY * blockBytes);
+    uint8_t block[kBlockPixels * 4];
+    for(uint32_t blockY = 0; blockY < blocksY; ++blockY)
+    {
+        for(uint32_t blockX = 0; blockX < blocksX; ++blockX)
+        {
+            fetchBlock(pixels, width, height, channels, blockX, blockY, block);
+            uint8_t* output = compressed.data() + (blockY * blocksX + blockX) * blockBytes;
+
+            switch(format)
+            {
+                case Format::BC1UNorm:
+                    encodeBC1Block(block, output);
+                    break;
+
+                case Format::BC3UNorm:
+                {
+                    uint8_t minColour[4];
+                    uint8_t maxColour[4];
+                    blockMinMax(block, minColour, maxColour);
+                    encodeBC4Block(block, 3, minColour[3], maxColour[3], output);
+                    encodeBC1Block(block, output + 8);
+                    break;
+                }
+
+                case Format::BC4UNorm:
+                case Format::BC5UNorm:
+                {
+                    uint8_t minColour[4];
+                    uint8_t maxColour[4];
+                    blockMinMax(block, minColour, maxColour);
+                    encodeBC4Block(block, 0, minColour[0], maxColour[0], output);
+                    if(format == Format::BC5UNorm)
+                        encodeBC4Block(block, 1, minColour[1], maxColour[1], output + 8);
+                    break;
+                }
+
+                case Format::BC7UNorm:
+                    encodeBC7Block(block, output);
+                    break;
+
+                default:
+                    BELL_ASSERT(false, "Unsupported compression format")
+                    return {};
+            }
+        }
+    }
+
+    return compressed;
+}
+
+
+std::vector<unsigned char> decompressImage(const unsigned char* blocks, const uint32_t width, const uint32_t height, const Format format)
+{
+    PROFILER_EVENT();
+
+    const uint32_t blocksX = (width + 3) / 4;
+    const uint32_t blocksY = (height + 3) / 4;
+    const uint32_t blockBytes = getBlockBytes(format);
+    const uint32_t outputChannels = format == Format::BC4UNorm ? 1 : 4;
+
+    std::vector<unsigned char> pixels(width * height * outputChannels);
+    uint8_t decoded[kBlockPixels * 4];
+    for(uint32_t blockY = 0; blockY < blocksY; ++blockY)
+    {
+        for(uint32_t blockX = 0; blockX < blocksX; ++blockX)
+        {
+            const uint8_t* input = blocks + (blockY * blocksX + blockX) * blockBytes;
+
+            switch(format)
+            {
+                case Format::BC1UNorm:
+                    decodeBC1Block(input, decoded, false);
+                    break;
+
+                case Format::BC3UNorm:
+                    decodeBC1Block(input + 8, decoded, true);
+                    decodeBC4Block(input, decoded + 3, 4);
+                    break;
+
+                case Format::BC4UNorm:
+                    decodeBC4Block(input, decoded, 4);
+                    break;
+
+                case Format::BC5UNorm:
+                    decodeBC4Block(input, decoded, 4);
+                    decodeBC4Block(input + 8, decoded + 1, 4);
+                    for(uint32_t i = 0; i < kBlockPixels; ++i)
+                    {
+                        const float x = (decoded[i * 4] / 255.0f) * 2.0f - 1.0f;
+                        const float y = (decoded[i * 4 + 1] / 255.0f) * 2.0f - 1.0f;
+                        const float z = std::sqrt(std::max(0.0f, 1.0f - x * x - y * y));
+                        decoded[i * 4 + 2] = static_cast<uint8_t>((z * 0.5f + 0.5f) * 255.0f + 0.5f);
+                        decoded[i * 4 + 3] = 255;
+                    }
+                    break;
+
+                case Format::BC7UNorm:
+                    decodeBC7Block(input, decoded);
+                    break;
+
+                default:
+                    BELL_ASSERT(false, "Unsupported compression format")
+                    return {};
+            }
+
+            for(uint32_t y = 0; y < 4 && (blockY * 4 + y) < height; ++y)
+            {
+                for(uint32_t x = 0; x < 4 && (blockX * 4 + x) < width; ++x)
+                {
+                    unsigned char* dst = pixels.data() + ((blockY * 4 + y) * width + blockX * 4 + x) * outputChannels;
+                    std::memcpy(dst, decoded + (y * 4 + x) * 4, outputChannels);
+                }
+            }
+        }
+    }
+
+    return pixels;
+}
+
+
+CompressedTexture compressTexture(std::vector<unsigned char> pixels, const uint32_t width, const uint32_t height, const uint32_t channels,
+                                  const Format format, const bool normalMap)
+{
+    CompressedTexture texture{format, width, height, {}};
+
+    uint32_t mipWidth = width;
+    uint32_t mipHeight = height;
+    while(true)
+    {
+        texture.mMips.push_back(compressImage(pixels.data(), mipWidth, mipHeight, channels, format));
+
+        if(mipWidth == 1 && mipHeight == 1)
+            break;
+
+        pixels = TextureUtil::generateMip2D(pixels, mipWidth, mipHeight, channels);
+        mipWidth = std::max(1u, mipWidth / 2);
+        mipHeight = std::max(1u, mipHeight / 2);
+
+        if(normalMap)
+            renormalise(pixels, channels);
+    }
+
+    return texture;
+}
+
+
+bool writeDDS(const std::string& path, const CompressedTexture& texture)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file.is_open())
+    {
+        BELL_LOG_ARGS("Unable to open %s for writing", path.c_str())
+        return false;
+    }
+
+    DDSHeader header{};
+    header.mSize = sizeof(DDSHeader);
+    header.mFlags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // caps | height | width | pixel format | mip count | linear size
+    header.mHeight = texture.mHeight;
+    header.mWidth = texture.mWidth;
+    header.mPitchOrLinearSize = texture.mMips.empty() ? 0 : static_cast<uint32_t>(texture.mMips[0].size());
+    header.mDepth = 1;
+    header.mMipMapCount = static_cast<uint32_t>(texture.mMips.size());
+    header.mPixelFormat.mSize = sizeof(DDSPixelFormat);
+    header.mPixelFormat.mFlags = 0x4; // four cc
+    header.mPixelFormat.mFourCC = kDX10FourCC;
+    header.mCaps = 0x1000 | 0x400000 | 0x8; // texture | mipmap | complex
+
+    DDSHeaderDX10 dx10Header{};
+    dx10Header.mDXGIFormat = getDXGIFormat(texture.mFormat);
+    dx10Header.mResourceDimension = 3; // Texture2D
+    dx10Header.mArraySize = 1;
+
+    file.write(reinterpret_cast<const char*>(&kDDSMagic), sizeof(uint32_t));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(DDSHeader));
+    file.write(reinterpret_cast<const char*>(&dx10Header), sizeof(DDSHeaderDX10));
+    for(const auto& mip : texture.mMips)
+        file.write(reinterpret_cast<const char*>(mip.data()), mip.size());
+
+    return file.good();
+}
+
+
+bool loadDDS(const std::string& path, CompressedTexture& texture)
+{
+    PROFILER_EVENT();
+
+    std::ifstream file(path, std::ios::binary);
+    if(!file.is_open())
+        return false;
+
+    uint32_t magic = 0;
+    DDSHeader header{};
+    file.read(reinterpret_cast<char*>(&magic), sizeof(uint32_t));
+    file.read(reinterpret_cast<char*>(&header), sizeof(DDSHeader));
+    if(!file.good() || magic != kDDSMagic || header.mSize != sizeof(DDSHeader))
+    {
+        BELL_LOG_ERROR(Assets, "%s is not a valid DDS file", path.c_str())
+        return false;
+    }
+
+    Format format;
+    bool supported = false;
+    switch(header.mPixelFormat.mFourCC)
+    {
+        case kDX10FourCC:
+        {
+            DDSHeaderDX10 dx10Header{};
+            file.read(reinterpret_cast<char*>(&dx10Header), sizeof(DDSHeaderDX10));
+            supported = file.good() && getFormatFromDXGI(dx10Header.mDXGIFormat, format);
+            break;
+        }
+
+        case kDXT1FourCC:
+            format = Format::BC1UNorm;
+            supported = true;
+            break;
+
+        case kDXT5FourCC:
+            format = Format::BC3UNorm;
+            supported = true;
+            break;
+
+        case kATI1FourCC:
+            format = Format::BC4UNorm;
+            supported = true;
+            break;
+
+        case kATI2FourCC:
+            format = Format::BC5UNorm;
+            supported = true;
+            break;
+
+        default:
+            break;
+    }
+
+    if(!supported)
+    {
+        BELL_LOG_ERROR(Assets, "%s has an unsupported DDS format", path.c_str())
+        return false;
+    }
+
+    texture.mFormat = format;
+    texture.mWidth = header.mWidth;
+    texture.mHeight = header.mHeight;
+    texture.mMips.clear();
+
+    const uint32_t mipCount = std::max(1u, header.mMipMapCount);
+    uint32_t mipWidth = header.mWidth;
+    uint32_t mipHeight = header.mHeight;
+    for(uint32_t i = 0; i < mipCount; ++i)
+    {
+        std::vector<unsigned char> mip(((mipWidth + 3) / 4) * ((mipHeight + 3) / 4) * getBlockBytes(format));
+        file.read(reinterpret_cast<char*>(mip.data()), mip.size());
+        if(!file.good())
+        {
+            BELL_LOG_ERROR(Assets, "%s is truncated", path.c_str())
+            return false;
+        }
+
+        texture.mMips.push_back(std::move(mip));
+        mipWidth = std::max(1u, mipWidth / 2);
+        mipHeight = std::max(1u, mipHeight / 2);
+    }
+
+    return true;
+}
+
+
+std::string getCookedTexturePath(const std::string& path)
+{
+    return std::filesystem::path(path).replace_extension(".dds").string();
+}
+
+}
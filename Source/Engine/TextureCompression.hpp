@@ -0,0 +1,43 @@
+#ifndef TEXTURE_COMPRESSION_HPP
+#define TEXTURE_COMPRESSION_HPP
+
+#include "Engine/PassTypes.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// CPU BCn encoder/decoder and DDS container used by the texture cooker and material loading.
+// Encodes BC1 (opaque colour), BC3 (colour + alpha), BC4 (single channel), BC5 (normal maps) and
+// BC7 (mode 6 only, high quality colour). The block fitting uses SSE2 where available.
+namespace TextureCompression
+{
+
+struct CompressedTexture
+{
+    Format mFormat;
+    uint32_t mWidth;
+    uint32_t mHeight;
+    std::vector<std::vector<unsigned char>> mMips;
+};
+
+// Compress an RGBA8 image (R8 for BC4), width and height don't need to be a multiple of 4.
+std::vector<unsigned char> compressImage(const unsigned char* pixels, const uint32_t width, const uint32_t height, const uint32_t channels, const Format format);
+
+// Returns RGBA8 data (R8 for BC4), BC5 has the blue channel reconstructed as a unit normal Z.
+std::vector<unsigned char> decompressImage(const unsigned char* blocks, const uint32_t width, const uint32_t height, const Format format);
+
+// Generate the full mip chain on the CPU and compress every level.
+// Normal maps are renormalised after each downsample.
+CompressedTexture compressTexture(std::vector<unsigned char> pixels, const uint32_t width, const uint32_t height, const uint32_t channels,
+                                  const Format format, const bool normalMap);
+
+bool writeDDS(const std::string& path, const CompressedTexture& texture);
+bool loadDDS(const std::string& path, CompressedTexture& texture);
+
+// Where the cooker writes the compressed version of a source texture.
+std::string getCookedTexturePath(const std::string& path);
+
+}
+
+#endif
@@ -0,0 +1,364 @@
+#include "Engine/TextureStreamer.hpp"
+#include "Engine/Engine.hpp"
+#include "Engine/Camera.hpp"
+#include "Engine/Scene.h"
+#include "Engine/TextureCompression.hpp"
+#include "Engine/TextureUtil.hpp"
+#include "Core/ConversionUtils.hpp"
+#include "Core/BellLogging.hpp"
+#include "Core/Profiling.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+
+namespace
+{
+    constexpr uint64_t kDefaultMemoryBudget = 512ull * 1024ull * 1024ull;
+    constexpr uint32_t kLoadThreadCount = 2;
+    constexpr uint32_t kMaxLoadsInFlight = 4;
+    constexpr uint32_t kMaxUploadsPerFrame = 4;
+    // Number of frames a texture has to go unrequested before it can be evicted.
+    constexpr uint64_t kEvictionDelay = 30;
+
+    ImageUsage getStreamedImageUsage(const TextureStreamer::TextureDesc& desc)
+    {
+        // Uncompressed textures generate their mips on the GPU so need to be a blit source.
+        return desc.mCompressed ? ImageUsage::Sampled | ImageUsage::TransferDest :
+                                  ImageUsage::Sampled | ImageUsage::TransferDest | ImageUsage::TransferSrc;
+    }
+
+    void setImageContents(Image& image, const TextureStreamer::TextureDesc& desc, const TextureStreamer::StreamedMips& mips)
+    {
+        if(desc.mCompressed)
+        {
+            for(uint32_t i = 0; i < mips.mMips.size(); ++i)
+            {
+                const ImageExtent extent = image->getExtent(0, i);
+                image->setContents(mips.mMips[i].data(), extent.width, extent.height, 1, 0, i);
+            }
+        }
+        else
+        {
+            const ImageExtent extent = image->getExtent(0, 0);
+            image->setContents(mips.mMips[0].data(), extent.width, extent.height, 1);
+            if(image->numberOfMips() > 1)
+                image->generateMips();
+        }
+    }
+}
+
+
+TextureStreamer::TextureStreamer(RenderEngine* eng) :
+    mEngine{eng},
+    mLoadThreads{kLoadThreadCount},
+    mTextures{},
+    mImageLookup{},
+    mMaterialTextures{},
+    mBaseMips{},
+    mPendingLoads{},
+    mMemoryBudget{kDefaultMemoryBudget},
+    mResidentMemory{0},
+    mPendingMemory{0},
+    mMipBias{0.0f} {}
+
+
+TextureStreamer::~TextureStreamer()
+{
+    clear();
+}
+
+
+uint32_t TextureStreamer::getBaseMip(const uint32_t width, const uint32_t height, const uint32_t mipCount)
+{
+    uint32_t mip = 0;
+    while((mip + 1) < mipCount && std::max(width >> mip, height >> mip) > kBaseMipSize)
+        ++mip;
+
+    return mip;
+}
+
+
+TextureStreamer::StreamedMips TextureStreamer::extractMips(const TextureUtil::TextureInfo& info, const uint32_t channels, const uint32_t firstMip)
+{
+    StreamedMips mips{firstMip, {}};
+    if(firstMip == 0)
+    {
+        mips.mMips.push_back(info.mData);
+        return mips;
+    }
+
+    uint32_t width = info.width;
+    uint32_t height = info.height;
+    std::vector<unsigned char> level = TextureUtil::generateMip2D(info.mData, width, height, channels);
+    for(uint32_t i = 1; i < firstMip; ++i)
+    {
+        width = std::max(1u, width / 2);
+        height = std::max(1u, height / 2);
+        level = TextureUtil::generateMip2D(level, width, height, channels);
+    }
+
+    mips.mMips.push_back(std::move(level));
+
+    return mips;
+}
+
+
+TextureStreamer::StreamedMips TextureStreamer::extractMips(const TextureCompression::CompressedTexture& texture, const uint32_t firstMip)
+{
+    StreamedMips mips{firstMip, {}};
+    if(firstMip < texture.mMips.size())
+        mips.mMips.assign(texture.mMips.begin() + firstMip, texture.mMips.end());
+
+    return mips;
+}
+
+
+TextureStreamer::StreamedMips TextureStreamer::loadMips(const TextureDesc& desc, const uint32_t firstMip)
+{
+    PROFILER_EVENT();
+
+    if(desc.mCompressed)
+    {
+        TextureCompression::CompressedTexture texture{};
+        if(!TextureCompression::loadDDS(desc.mPath, texture) || texture.mMips.size() != desc.mMipCount)
+            return {firstMip, {}};
+
+        return extractMips(texture, firstMip);
+    }
+
+    const TextureUtil::TextureInfo info = TextureUtil::load32BitTexture(desc.mPath.c_str(), desc.mChannels);
+    if(static_cast<uint32_t>(info.width) != desc.mWidth || static_cast<uint32_t>(info.height) != desc.mHeight)
+        return {firstMip, {}};
+
+    return extractMips(info, desc.mChannels, firstMip);
+}
+
+
+uint64_t TextureStreamer::calculateSize(const TextureDesc& desc, const uint32_t firstMip)
+{
+    uint64_t size = 0;
+    for(uint32_t i = firstMip; i < desc.mMipCount; ++i)
+        size += getImageDataSize(desc.mFormat, std::max(1u, desc.mWidth >> i), std::max(1u, desc.mHeight >> i), 1);
+
+    return size;
+}
+
+
+Image* TextureStreamer::addTexture(const TextureDesc& desc, StreamedMips&& baseMips)
+{
+    const uint32_t baseMip = baseMips.mFirstMip;
+    BELL_ASSERT(baseMip < desc.mMipCount, "Base mip outside of the mip chain")
+
+    Image* image = new Image(mEngine->getDevice(), desc.mFormat, getStreamedImageUsage(desc), std::max(1u, desc.mWidth >> baseMip),
+                             std::max(1u, desc.mHeight >> baseMip), 1, desc.mMipCount - baseMip, 1, 1, desc.mName);
+    setImageContents(*image, desc, baseMips);
+
+    mImageLookup[image] = static_cast<uint32_t>(mTextures.size());
+    mTextures.push_back({desc, image, ~0u, 0, baseMip, baseMip, baseMip, 0, false, false});
+    mBaseMips.push_back(std::move(baseMips));
+    mResidentMemory += calculateSize(desc, baseMip);
+
+    return image;
+}
+
+
+void TextureStreamer::setMaterialSlot(const Image* image, const uint32_t materialID, const uint32_t textureIndex)
+{
+    auto it = mImageLookup.find(image);
+    if(it == mImageLookup.end())
+        return;
+
+    mTextures[it->second].mMaterialID = materialID;
+    mTextures[it->second].mMaterialTextureIndex = textureIndex;
+    mMaterialTextures[materialID].push_back(it->second);
+}
+
+
+void TextureStreamer::requestMips(const std::vector<MeshInstance*>& instances, const Camera& camera, const uint32_t viewportHeight)
+{
+    PROFILER_EVENT();
+
+    if(mTextures.empty())
+        return;
+
+    const float tanHalfFOV = std::tan(glm::radians(camera.getFOV()) * 0.5f);
+    for(const MeshInstance* instance : instances)
+    {
+        const AABB bounds = instance->getMesh()->getAABB() * instance->getTransMatrix();
+        const float radius = glm::length(bounds.getSideLengths()) * 0.5f;
+        const float distance = std::max(glm::length(float3(bounds.getCentralPoint()) - camera.getPosition()) - radius, camera.getNearPlane());
+        // Approximate height in pixels, assumes the UVs cover the mesh once.
+        const float projectedSize = (radius * viewportHeight) / (distance * tanHalfFOV);
+
+        for(uint32_t i = 0; i < instance->getSubMeshCount(); ++i)
+            requestMaterial(instance->getMaterialIndex(i), projectedSize);
+    }
+}
+
+
+void TextureStreamer::requestMaterial(const uint32_t materialID, const float projectedSize)
+{
+    auto it = mMaterialTextures.find(materialID);
+    if(it == mMaterialTextures.end())
+        return;
+
+    const uint64_t currentFrame = mEngine->getDevice()->getCurrentSubmissionIndex();
+    for(const uint32_t textureIndex : it->second)
+    {
+        StreamedTexture& texture = mTextures[textureIndex];
+        const float texels = static_cast<float>(std::max(texture.mDesc.mWidth, texture.mDesc.mHeight));
+        const float lod = std::log2(texels / std::max(projectedSize, 1.0f)) + mMipBias;
+        const uint32_t mip = std::min(static_cast<uint32_t>(std::max(lod, 0.0f)), texture.mBaseMip);
+
+        texture.mRequestedMip = std::min(texture.mRequestedMip, mip);
+        texture.mLastRequested = currentFrame;
+    }
+}
+
+
+void TextureStreamer::upload(StreamedTexture& texture, const StreamedMips& mips)
+{
+    const TextureDesc& desc = texture.mDesc;
+    const uint32_t firstMip = mips.mFirstMip;
+    const uint32_t mipCount = desc.mMipCount - firstMip;
+
+    Image newImage{mEngine->getDevice(), desc.mFormat, getStreamedImageUsage(desc), std::max(1u, desc.mWidth >> firstMip),
+                   std::max(1u, desc.mHeight >> firstMip), 1, mipCount, 1, 1, desc.mName};
+    setImageContents(newImage, desc, mips);
+
+    // Frames in flight can still be sampling from the old image, so make sure it's destruction is deferred until they're done.
+    (*texture.mImage)->updateLastAccessed();
+    *texture.mImage = newImage;
+    if(texture.mMaterialID != ~0u)
+        mEngine->getMaterialTable().setTexture(texture.mMaterialID, texture.mMaterialTextureIndex, ImageView{*texture.mImage, ImageViewType::Colour, 0, 1, 0, mipCount});
+
+    mResidentMemory -= calculateSize(desc, texture.mResidentMip);
+    mResidentMemory += calculateSize(desc, firstMip);
+    texture.mResidentMip = firstMip;
+}
+
+
+bool TextureStreamer::evict(const uint64_t requiredBytes)
+{
+    if((mResidentMemory + mPendingMemory + requiredBytes) <= mMemoryBudget)
+        return true;
+
+    const uint64_t currentFrame = mEngine->getDevice()->getCurrentSubmissionIndex();
+    std::vector<uint32_t> candidates{};
+    for(uint32_t i = 0; i < mTextures.size(); ++i)
+    {
+        const StreamedTexture& texture = mTextures[i];
+        if(!texture.mLoading && texture.mResidentMip < texture.mBaseMip && (texture.mLastRequested + kEvictionDelay) < currentFrame)
+            candidates.push_back(i);
+    }
+
+    // Least recently requested first.
+    std::sort(candidates.begin(), candidates.end(), [this](const uint32_t lhs, const uint32_t rhs)
+    {
+        return mTextures[lhs].mLastRequested < mTextures[rhs].mLastRequested;
+    });
+
+    for(const uint32_t textureIndex : candidates)
+    {
+        if((mResidentMemory + mPendingMemory + requiredBytes) <= mMemoryBudget)
+            break;
+
+        upload(mTextures[textureIndex], mBaseMips[textureIndex]);
+    }
+
+    return (mResidentMemory + mPendingMemory + requiredBytes) <= mMemoryBudget;
+}
+
+
+void TextureStreamer::update()
+{
+    PROFILER_EVENT();
+
+    // Upload any finished loads.
+    uint32_t uploads = 0;
+    for(auto it = mPendingLoads.begin(); it != mPendingLoads.end() && uploads < kMaxUploadsPerFrame;)
+    {
+        if(it->wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+
+        LoadResult result = it->get();
+        it = mPendingLoads.erase(it);
+
+        StreamedTexture& texture = mTextures[result.mTextureIndex];
+        texture.mLoading = false;
+        mPendingMemory -= calculateSize(texture.mDesc, result.mMips.mFirstMip) - calculateSize(texture.mDesc, texture.mResidentMip);
+
+        if(result.mMips.mMips.empty())
+        {
+            BELL_LOG_ERROR(Assets, "Failed to stream %s", texture.mDesc.mPath.c_str())
+            texture.mFailed = true;
+            continue;
+        }
+
+        upload(texture, result.mMips);
+        ++uploads;
+    }
+
+    // Handle the budget being lowered.
+    if(mResidentMemory > mMemoryBudget)
+        evict(0);
+
+    // Start new loads, textures furthest from their requested mip first.
+    if(mPendingLoads.size() < kMaxLoadsInFlight)
+    {
+        std::vector<uint32_t> requests{};
+        for(uint32_t i = 0; i < mTextures.size(); ++i)
+        {
+            const StreamedTexture& texture = mTextures[i];
+            if(!texture.mLoading && !texture.mFailed && texture.mRequestedMip < texture.mResidentMip)
+                requests.push_back(i);
+        }
+
+        std::sort(requests.begin(), requests.end(), [this](const uint32_t lhs, const uint32_t rhs)
+        {
+            return (mTextures[lhs].mResidentMip - mTextures[lhs].mRequestedMip) > (mTextures[rhs].mResidentMip - mTextures[rhs].mRequestedMip);
+        });
+
+        for(const uint32_t textureIndex : requests)
+        {
+            if(mPendingLoads.size() >= kMaxLoadsInFlight)
+                break;
+
+            StreamedTexture& texture = mTextures[textureIndex];
+            const uint64_t additionalMemory = calculateSize(texture.mDesc, texture.mRequestedMip) - calculateSize(texture.mDesc, texture.mResidentMip);
+            if(!evict(additionalMemory))
+                continue;
+
+            texture.mLoading = true;
+            mPendingMemory += additionalMemory;
+            mPendingLoads.push_back(mLoadThreads.addTask([desc = texture.mDesc, textureIndex, firstMip = texture.mRequestedMip]()
+            {
+                return LoadResult{textureIndex, loadMips(desc, firstMip)};
+            }));
+        }
+    }
+
+    // Requests only last a single frame.
+    for(StreamedTexture& texture : mTextures)
+        texture.mRequestedMip = texture.mBaseMip;
+}
+
+
+void TextureStreamer::clear()
+{
+    for(auto& load : mPendingLoads)
+        load.wait();
+
+    mPendingLoads.clear();
+    mTextures.clear();
+    mImageLookup.clear();
+    mMaterialTextures.clear();
+    mBaseMips.clear();
+    mResidentMemory = 0;
+    mPendingMemory = 0;
+}
@@ -104,6 +104,35 @@ std::vector<T> generateMip(const std::vector<T>& tex, const uint32_t width, cons
     return mip;
 }
 
+// 2D box filter that clamps at the edges, so is safe for odd and 1 texel wide/high images.
+inline std::vector<unsigned char> generateMip2D(const std::vector<unsigned char>& tex, const uint32_t width, const uint32_t height, const uint32_t channels)
+{
+    BELL_ASSERT(tex.size() == width * height * channels, "Incorrect texture dimensions")
+
+    const uint32_t newWidth = std::max(1u, width / 2);
+    const uint32_t newHeight = std::max(1u, height / 2);
+
+    std::vector<unsigned char> mip(newWidth * newHeight * channels);
+    for(uint32_t y = 0; y < newHeight; ++y)
+    {
+        const uint32_t y0 = std::min(y * 2, height - 1);
+        const uint32_t y1 = std::min(y * 2 + 1, height - 1);
+        for(uint32_t x = 0; x < newWidth; ++x)
+        {
+            const uint32_t x0 = std::min(x * 2, width - 1);
+            const uint32_t x1 = std::min(x * 2 + 1, width - 1);
+            for(uint32_t c = 0; c < channels; ++c)
+            {
+                const uint32_t sum = tex[(y0 * width + x0) * channels + c] + tex[(y0 * width + x1) * channels + c] +
+                                     tex[(y1 * width + x0) * channels + c] + tex[(y1 * width + x1) * channels + c];
+                mip[(y * newWidth + x) * channels + c] = static_cast<unsigned char>((sum + 2) / 4);
+            }
+        }
+    }
+
+    return mip;
+}
+
 template<typename T>
 std::vector<T> generateVoxelMip(const std::vector<T>& tex, const uint32_t width, const uint32_t height, const uint32_t depth, const uint32_t channels)
 {
@@ -260,6 +289,15 @@ std::vector<T> generateMipMin(const std::vector<T>& tex, const uint32_t width, c
     return mip;
 }
 
+// Value of a voxel y voxels up a column whose surface is heightSample high, negative below the surface.
+inline int8_t getHeightMapVoxel(const float heightSample, const uint32_t y, const uint32_t height, const float voxelSize)
+{
+    const float voxelHeight = y * voxelSize;
+    const float f = heightSample > voxelHeight ? -127.0f * (1.0f - (voxelHeight / heightSample)) : 127.0f * ((voxelHeight - heightSample) / ((height * voxelSize) - heightSample));
+
+    return static_cast<int8_t>(f);
+}
+
 inline std::vector<int8_t> generateVoxelGridFromHeightMap(const std::vector<unsigned char>& heightMap, const uint32_t width, const uint32_t height, const uint32_t depth, const float voxelSize)
 {
     std::vector<int8_t> voxelData{};
@@ -276,11 +314,8 @@ inline std::vector<int8_t> generateVoxelGridFromHeightMap(const std::vector<unsi
                 const uint32_t heightIndex = (z * width) + x;
                 BELL_ASSERT(heightIndex < heightMap.size(), "OOB index")
 
-                const float voxelHeight = y * voxelSize;
                 const float heightSample = (float(heightMap[heightIndex]) / 255.0f) * height * voxelSize;
-                const float f = heightSample > voxelHeight ? -127.0f * (1.0f - (voxelHeight / heightSample)) : 127.0f * ((voxelHeight - heightSample) / ((height * voxelSize) - heightSample));
-
-                voxelData[voxelIndex] = f;
+                voxelData[voxelIndex] = getHeightMapVoxel(heightSample, y, height, voxelSize);
             }
         }
     }
@@ -44,13 +44,7 @@ TransparentTechnique::TransparentTechnique(RenderEngine* eng, RenderGraph& graph
 
                     UberShaderStateCache stateCache(exec);
 
-                    for (const auto& mesh : meshes)
-                    {
-                        if (!(mesh->getInstanceFlags() & InstanceFlags::Draw))
-                            continue;
-
-                        mesh->draw(exec, &stateCache);
-                    }
+                    eng->getRenderView(graph.getTask(taskIndex).getInputRenderQueueIndex()).recordSortedDraws(exec, &stateCache);
                 }
     );
 
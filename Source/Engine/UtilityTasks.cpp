@@ -108,7 +108,8 @@ void compileShadeFlagsPipelines(std::unordered_map<uint64_t, uint64_t>& pipeline
                                 const std::string& fragmentPath,
                                 RenderEngine* engine,
                                 const RenderGraph& graph,
-                                const TaskID id)
+                                const TaskID id,
+                                const uint64_t vertexShadeFlags)
 {
     const Scene* scene = engine->getScene();
     RenderDevice* device = engine->getDevice();
@@ -124,7 +125,7 @@ void compileShadeFlagsPipelines(std::unordered_map<uint64_t, uint64_t>& pipeline
             {
                 ShaderDefine fragmentShadeDefines(L"SHADE_FLAGS", shadeflags);
                 Shader fragmentShader = engine->getShader(fragmentPath, fragmentShadeDefines);
-                ShaderDefine vertexShadeDefine(L"SHADE_FLAGS", (skinning ? kShade_Skinning : 0u));
+                ShaderDefine vertexShadeDefine(L"SHADE_FLAGS", (skinning ? kShade_Skinning : 0u) | vertexShadeFlags);
                 Shader vertexShader = engine->getShader(vertexPath, vertexShadeDefine);
 
                 const auto& graphicsTask = static_cast<const GraphicsTask &>(task);
@@ -145,14 +146,15 @@ void compileSkinnedPipelineVariants(PipelineHandle* array,
                                     const std::string& fragmentPath,
                                     RenderEngine* engine,
                                     const RenderGraph& graph,
-                                    const TaskID id)
+                                    const TaskID id,
+                                    const uint64_t vertexShadeFlags)
 {
     RenderDevice* device = engine->getDevice();
     const RenderTask& task = graph.getTask(id);
     Shader fragmentShader = engine->getShader(fragmentPath);
     for(uint8_t skinning = 0; skinning < 2; ++skinning)
     {
-        ShaderDefine vertexShadeDefine(L"SHADE_FLAGS", (skinning ? kShade_Skinning : 0u));
+        ShaderDefine vertexShadeDefine(L"SHADE_FLAGS", (skinning ? kShade_Skinning : 0u) | vertexShadeFlags);
         Shader vertexShader = engine->getShader(vertexPath, vertexShadeDefine);
 
         const auto& graphicsTask = static_cast<const GraphicsTask &>(task);
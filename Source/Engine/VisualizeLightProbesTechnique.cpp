@@ -29,8 +29,8 @@ ViaualizeLightProbesTechnique::ViaualizeLightProbesTechnique(RenderEngine* eng,
     mLigthVolumeVisFragmentShader(eng->getShader("./Shaders/LightProbeVolumeVis.frag")),
     mVertexBuffer(eng->getDevice(), BufferUsage::Vertex | BufferUsage::TransferDest, eng->getUnitSphereMesh().getVertexData().size(),
                   eng->getUnitSphereMesh().getVertexData().size(), "LightProbe vertex buffer"),
-    mIndexBuffer(eng->getDevice(), BufferUsage::Index | BufferUsage::TransferDest, eng->getUnitSphereMesh().getIndexData().size() * sizeof(uint32_t),
-                  eng->getUnitSphereMesh().getIndexData().size() * sizeof(uint32_t), "LightProbe index buffer")
+    mIndexBuffer(eng->getDevice(), BufferUsage::Index | BufferUsage::TransferDest, eng->getUnitSphereMesh().getBaseIndexCount() * sizeof(uint32_t),
+                  eng->getUnitSphereMesh().getBaseIndexCount() * sizeof(uint32_t), "LightProbe index buffer")
 {
 
     if(!eng->getIrradianceProbes().empty())
@@ -136,7 +136,7 @@ ViaualizeLightProbesTechnique::ViaualizeLightProbesTechnique(RenderEngine* eng,
     mVertexBuffer->setContents(vertexData.data(), vertexData.size());
 
     const auto& indexData = unitSphere.getIndexData();
-    mIndexBuffer->setContents(indexData.data(), indexData.size() * sizeof(uint32_t));
-    mIndexCount = indexData.size();
+    mIndexCount = unitSphere.getBaseIndexCount();
+    mIndexBuffer->setContents(indexData.data(), mIndexCount * sizeof(uint32_t));
 }
 
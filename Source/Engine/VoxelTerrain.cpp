@@ -2,13 +2,113 @@
 
 #include "TextureUtil.hpp"
 
+#include <limits>
+
+
+namespace
+{
+    // Enough to find the surface within a cell to well under a hundredth of a voxel.
+    constexpr uint32_t kCellSteps = 4;
+    constexpr uint32_t kBisectionSteps = 6;
+
+    // Visits the cells of a grid, with its minimum at the origin, that the ray passes through between tMin and tMax
+    // in order, until visit returns true.
+    template<typename F>
+    bool traverseGrid(const float3& origin, const float3& direction, const float tMin, const float tMax,
+                      const float cellSize, const int3& cellCount, F&& visit)
+    {
+        const float3 start = origin + (direction * tMin);
+        int3 cell = glm::clamp(int3(glm::floor(start / cellSize)), int3(0), cellCount - 1);
+
+        int3 step{};
+        float3 tNext{};
+        float3 tDelta{};
+        for(int32_t axis = 0; axis < 3; ++axis)
+        {
+            if(direction[axis] == 0.0f)
+            {
+                tNext[axis] = std::numeric_limits<float>::max();
+                tDelta[axis] = std::numeric_limits<float>::max();
+                continue;
+            }
+
+            step[axis] = direction[axis] > 0.0f ? 1 : -1;
+            const float boundary = float(cell[axis] + (step[axis] > 0 ? 1 : 0)) * cellSize;
+            tNext[axis] = (boundary - origin[axis]) / direction[axis];
+            tDelta[axis] = cellSize / std::abs(direction[axis]);
+        }
+
+        float t = tMin;
+        while(t < tMax)
+        {
+            const int32_t axis = tNext.x < tNext.y ? (tNext.x < tNext.z ? 0 : 2) : (tNext.y < tNext.z ? 1 : 2);
+            if(visit(cell, t, std::min(tNext[axis], tMax)))
+                return true;
+
+            cell[axis] += step[axis];
+            if(cell[axis] < 0 || cell[axis] >= cellCount[axis])
+                break;
+
+            t = tNext[axis];
+            tNext[axis] += tDelta[axis];
+        }
+
+        return false;
+    }
+}
+
 
 VoxelTerrain::VoxelTerrain(const uint3& size, const float voxelSize) :
     mSize{size},
-    mVoxelSize{voxelSize}
+    mVoxelSize{voxelSize},
+    mChunkCount{size / kChunkSize}
 {
-    mVoxelData.resize(mSize.x * mSize.y * mSize.z);
-    std::memset(mVoxelData.data(), -1, mVoxelData.size());
+    BELL_ASSERT(mSize.x % kChunkSize == 0 && mSize.y % kChunkSize == 0 && mSize.z % kChunkSize == 0, "Terrain size must be a multiple of the chunk size")
+
+    // Start out entirely inside the terrain.
+    Chunk solid{};
+    solid.mUniformValue = -1;
+    solid.mSigns = kInside;
+    solid.mDirty = false;
+    solid.mRevision = 0;
+    mChunks.resize(mChunkCount.x * mChunkCount.y * mChunkCount.z, solid);
+}
+
+
+template<typename F>
+void VoxelTerrain::initialiseChunks(F&& voxelValue)
+{
+    constexpr uint32_t chunkVoxels = kChunkSize * kChunkSize * kChunkSize;
+
+    for(uint32_t chunk_i = 0; chunk_i < mChunks.size(); ++chunk_i)
+    {
+        const uint3 chunkStart = getChunkPosition(chunk_i) * kChunkSize;
+
+        std::vector<int8_t> voxels(chunkVoxels);
+        for(uint32_t y = 0; y < kChunkSize; ++y)
+        {
+            for(uint32_t z = 0; z < kChunkSize; ++z)
+            {
+                for(uint32_t x = 0; x < kChunkSize; ++x)
+                {
+                    voxels[x + (z * kChunkSize) + (y * kChunkSize * kChunkSize)] = voxelValue(chunkStart + uint3{x, y, z});
+                }
+            }
+        }
+
+        Chunk& chunk = mChunks[chunk_i];
+        chunk.mVoxels = std::move(voxels);
+        updateChunk(chunk);
+        ++chunk.mRevision;
+
+        if(!chunk.mDirty)
+        {
+            chunk.mDirty = true;
+            mDirtyChunks.push_back(chunk_i);
+        }
+    }
+
+    compactChunks(uint3{0, 0, 0}, mChunkCount - 1u);
 }
 
 
@@ -19,13 +119,495 @@ void VoxelTerrain::initialiseFromHeightMap(const std::string& path)
     const TextureInfo heightMap = load32BitTexture(path.c_str(), STBI_grey);
     BELL_ASSERT(heightMap.height == mSize.z && heightMap.width == mSize.x, "Height map resampling needs to be implemented")
 
-    mVoxelData = TextureUtil::generateVoxelGridFromHeightMap(heightMap.mData, mSize.x, mSize.y, mSize.z, mVoxelSize);
+    initialiseChunks([&](const uint3& position)
+    {
+        const uint32_t heightIndex = (position.z * mSize.x) + position.x;
+        BELL_ASSERT(heightIndex < heightMap.mData.size(), "OOB index")
+
+        const float heightSample = (float(heightMap.mData[heightIndex]) / 255.0f) * mSize.y * mVoxelSize;
+        return getHeightMapVoxel(heightSample, position.y, mSize.y, mVoxelSize);
+    });
 }
 
 
 void VoxelTerrain::initialiseFromData(const std::vector<int8_t>& data)
 {
     BELL_ASSERT(data.size() == (mSize.x * mSize.y * mSize.z), "Data has incorrect dimensions")
-    mVoxelData = data;
+
+    initialiseChunks([&](const uint3& position)
+    {
+        return data[position.x + (position.z * mSize.x) + (position.y * mSize.x * mSize.z)];
+    });
+}
+
+
+int8_t VoxelTerrain::getVoxel(const int3& position, const uint32_t lod) const
+{
+    const uint32_t cellCount = getChunkCellCount(lod);
+    const int3 lodSize = int3(mSize / (1u << lod));
+    const uint3 clampedPosition = uint3(glm::clamp(position, int3(0), lodSize - 1));
+
+    const Chunk& chunk = mChunks[getChunkIndex(clampedPosition / cellCount)];
+    if(chunk.mVoxels.empty())
+        return chunk.mUniformValue;
+
+    const uint3 local = clampedPosition % cellCount;
+    const std::vector<int8_t>& voxels = lod == 0 ? chunk.mVoxels : chunk.mLODs[lod - 1];
+
+    return voxels[local.x + (local.z * cellCount) + (local.y * cellCount * cellCount)];
+}
+
+
+void VoxelTerrain::setVoxel(const uint3& position, const int8_t value)
+{
+    BELL_ASSERT(position.x < mSize.x && position.y < mSize.y && position.z < mSize.z, "Voxel out of bounds")
+
+    const uint3 chunkPosition = position / kChunkSize;
+    Chunk& chunk = mChunks[getChunkIndex(chunkPosition)];
+    const uint3 local = position % kChunkSize;
+    const uint32_t index = local.x + (local.z * kChunkSize) + (local.y * kChunkSize * kChunkSize);
+
+    if(chunk.mVoxels.empty())
+    {
+        if(chunk.mUniformValue == value)
+            return;
+
+        chunk.mVoxels.resize(kChunkSize * kChunkSize * kChunkSize, chunk.mUniformValue);
+    }
+    else if(chunk.mVoxels[index] == value)
+        return;
+
+    chunk.mVoxels[index] = value;
+    updateChunk(chunk);
+
+    markDirty(int3(position), int3(position));
+    compactChunks(glm::max(chunkPosition, 1u) - 1u, glm::min(chunkPosition + 1u, mChunkCount - 1u));
+}
+
+
+void VoxelTerrain::modify(const float3& position, const float radius, const int32_t value)
+{
+    const float3 gridPosition = (position - getMinimum()) / mVoxelSize;
+    const float voxelRadius = radius / mVoxelSize;
+
+    const int3 minVoxel = glm::max(int3(glm::floor(gridPosition - voxelRadius)), int3(0));
+    const int3 maxVoxel = glm::min(int3(glm::ceil(gridPosition + voxelRadius)), int3(mSize) - 1);
+    if(maxVoxel.x < minVoxel.x || maxVoxel.y < minVoxel.y || maxVoxel.z < minVoxel.z)
+        return;
+
+    const uint3 minChunk = uint3(minVoxel) / kChunkSize;
+    const uint3 maxChunk = uint3(maxVoxel) / kChunkSize;
+    bool modified = false;
+
+    for(uint32_t chunkY = minChunk.y; chunkY <= maxChunk.y; ++chunkY)
+    {
+        for(uint32_t chunkZ = minChunk.z; chunkZ <= maxChunk.z; ++chunkZ)
+        {
+            for(uint32_t chunkX = minChunk.x; chunkX <= maxChunk.x; ++chunkX)
+            {
+                const uint3 chunkStart = uint3{chunkX, chunkY, chunkZ} * kChunkSize;
+                const int3 start = glm::max(minVoxel, int3(chunkStart));
+                const int3 end = glm::min(maxVoxel, int3(chunkStart + kChunkSize - 1u));
+
+                Chunk& chunk = mChunks[getChunkIndex(uint3{chunkX, chunkY, chunkZ})];
+                bool chunkModified = false;
+
+                for(int32_t y = start.y; y <= end.y; ++y)
+                {
+                    for(int32_t z = start.z; z <= end.z; ++z)
+                    {
+                        for(int32_t x = start.x; x <= end.x; ++x)
+                        {
+                            if(glm::distance(float3(x, y, z), gridPosition) > voxelRadius)
+                                continue;
+
+                            const uint3 local = uint3(x, y, z) - chunkStart;
+                            const uint32_t index = local.x + (local.z * kChunkSize) + (local.y * kChunkSize * kChunkSize);
+
+                            const int32_t oldValue = chunk.mVoxels.empty() ? chunk.mUniformValue : chunk.mVoxels[index];
+                            const int32_t newValue = std::clamp(oldValue + value, -127, 127);
+                            if(newValue == oldValue)
+                                continue;
+
+                            if(chunk.mVoxels.empty())
+                                chunk.mVoxels.resize(kChunkSize * kChunkSize * kChunkSize, chunk.mUniformValue);
+
+                            chunk.mVoxels[index] = static_cast<int8_t>(newValue);
+                            chunkModified = true;
+                        }
+                    }
+                }
+
+                if(chunkModified)
+                {
+                    updateChunk(chunk);
+                    modified = true;
+                }
+            }
+        }
+    }
+
+    if(modified)
+    {
+        markDirty(minVoxel, maxVoxel);
+        compactChunks(glm::max(minChunk, 1u) - 1u, glm::min(maxChunk + 1u, mChunkCount - 1u));
+    }
+}
+
+
+AABB VoxelTerrain::getChunkBounds(const uint32_t chunk) const
+{
+    const float3 minimum = getMinimum() + (float3(getChunkPosition(chunk) * kChunkSize) * mVoxelSize);
+    const float3 maximum = minimum + float3(kChunkSize * mVoxelSize);
+
+    return AABB{float4(minimum, 1.0f), float4(maximum, 1.0f)};
+}
+
+
+bool VoxelTerrain::mayContainSurface(const uint32_t chunk) const
+{
+    const uint8_t signs = mChunks[chunk].mSigns;
+    if(signs == (kInside | kOutside))
+        return true;
+
+    // Cells on the far side of the chunk have corners in the neighbouring chunks.
+    const uint3 position = getChunkPosition(chunk);
+    const uint3 start = glm::max(position, 1u) - 1u;
+    const uint3 end = glm::min(position + 1u, mChunkCount - 1u);
+
+    for(uint32_t y = start.y; y <= end.y; ++y)
+    {
+        for(uint32_t z = start.z; z <= end.z; ++z)
+        {
+            for(uint32_t x = start.x; x <= end.x; ++x)
+            {
+                if(mChunks[getChunkIndex(uint3{x, y, z})].mSigns != signs)
+                    return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+
+bool VoxelTerrain::getChunkBrick(const uint32_t chunk, const uint32_t lod, int8_t* brick) const
+{
+    BELL_ASSERT(lod < kLODCount, "Invalid terrain LOD")
+    if(!mayContainSurface(chunk))
+        return false;
+
+    const uint32_t cellCount = getChunkCellCount(lod);
+    const uint32_t brickSize = getBrickSize(lod);
+    const int3 brickStart = int3(getChunkPosition(chunk) * cellCount) - 1;
+
+    uint8_t signs = 0;
+    for(uint32_t y = 0; y < brickSize; ++y)
+    {
+        for(uint32_t z = 0; z < brickSize; ++z)
+        {
+            for(uint32_t x = 0; x < brickSize; ++x)
+            {
+                const int8_t value = getVoxel(brickStart + int3(x, y, z), lod);
+                brick[x + (z * brickSize) + (y * brickSize * brickSize)] = value;
+
+                // Only the cell corners decide whether the surface passes through, the border is just for normals.
+                const bool corner = x >= 1 && y >= 1 && z >= 1 && x <= cellCount + 1 && y <= cellCount + 1 && z <= cellCount + 1;
+                if(corner)
+                    signs |= value < 0 ? kInside : kOutside;
+            }
+        }
+    }
+
+    return signs == (kInside | kOutside);
+}
+
+
+void VoxelTerrain::clearDirtyChunks()
+{
+    for(const uint32_t chunk : mDirtyChunks)
+        mChunks[chunk].mDirty = false;
+
+    mDirtyChunks.clear();
+}
+
+
+size_t VoxelTerrain::getMemoryUsage() const
+{
+    size_t size = mChunks.size() * sizeof(Chunk);
+    for(const Chunk& chunk : mChunks)
+    {
+        size += chunk.mVoxels.size();
+        for(const std::vector<int8_t>& lod : chunk.mLODs)
+            size += lod.size();
+    }
+
+    return size;
+}
+
+
+float VoxelTerrain::sampleDensity(const float3& position) const
+{
+    return sampleGrid((position - getMinimum()) / mVoxelSize) / 127.0f;
+}
+
+
+float3 VoxelTerrain::sampleNormal(const float3& position) const
+{
+    // Central differences a voxel either side, the same as the terrain meshes normals.
+    const float3 gridPosition = (position - getMinimum()) / mVoxelSize;
+    const float3 gradient{sampleGrid(gridPosition + float3(1.0f, 0.0f, 0.0f)) - sampleGrid(gridPosition - float3(1.0f, 0.0f, 0.0f)),
+                          sampleGrid(gridPosition + float3(0.0f, 1.0f, 0.0f)) - sampleGrid(gridPosition - float3(0.0f, 1.0f, 0.0f)),
+                          sampleGrid(gridPosition + float3(0.0f, 0.0f, 1.0f)) - sampleGrid(gridPosition - float3(0.0f, 0.0f, 1.0f))};
+
+    const float length = glm::length(gradient);
+    return length > 0.0f ? gradient / length : float3(0.0f, 1.0f, 0.0f);
+}
+
+
+float VoxelTerrain::intersectionDistance(const Ray& ray, const float maxDistance) const
+{
+    // March in voxels, the direction is normalised so distances just need scaling back by the voxel size.
+    const float3 origin = (ray.getPosition() - getMinimum()) / mVoxelSize;
+    const float3 direction = ray.getDirection();
+    const float3 gridSize = float3(mSize);
+
+    float tEnter = 0.0f;
+    float tExit = maxDistance / mVoxelSize;
+    for(int32_t axis = 0; axis < 3; ++axis)
+    {
+        if(direction[axis] == 0.0f)
+        {
+            if(origin[axis] < 0.0f || origin[axis] > gridSize[axis])
+                return std::numeric_limits<float>::max();
+
+            continue;
+        }
+
+        const float t1 = -origin[axis] / direction[axis];
+        const float t2 = (gridSize[axis] - origin[axis]) / direction[axis];
+        tEnter = std::max(tEnter, std::min(t1, t2));
+        tExit = std::min(tExit, std::max(t1, t2));
+    }
+
+    if(tEnter >= tExit)
+        return std::numeric_limits<float>::max();
+
+    bool outside = sampleGrid(origin + (direction * tEnter)) >= 0.0f;
+    float hitDistance = std::numeric_limits<float>::max();
+
+    auto visitCell = [&](const int3& cell, const float cellEnter, const float cellExit)
+    {
+        // The filtered voxels can only cross the surface in cells with corners either side of it.
+        uint8_t signs = 0;
+        for(int32_t corner = 0; corner < 8; ++corner)
+            signs |= getVoxel(cell + int3(corner & 1, (corner >> 1) & 1, corner >> 2)) < 0 ? kInside : kOutside;
+
+        if(signs != (kInside | kOutside))
+        {
+            outside = signs == kOutside;
+            return false;
+        }
+
+        float previous = cellEnter;
+        for(uint32_t i = 1; i <= kCellSteps; ++i)
+        {
+            const float t = glm::mix(cellEnter, cellExit, float(i) / float(kCellSteps));
+            const bool sampleOutside = sampleGrid(origin + (direction * t)) >= 0.0f;
+
+            if(outside && !sampleOutside)
+            {
+                float lower = previous;
+                float upper = t;
+                for(uint32_t j = 0; j < kBisectionSteps; ++j)
+                {
+                    const float middle = (lower + upper) * 0.5f;
+                    if(sampleGrid(origin + (direction * middle)) >= 0.0f)
+                        lower = middle;
+                    else
+                        upper = middle;
+                }
+
+                hitDistance = upper * mVoxelSize;
+                return true;
+            }
+
+            outside = sampleOutside;
+            previous = t;
+        }
+
+        return false;
+    };
+
+    traverseGrid(origin, direction, tEnter, tExit, float(kChunkSize), int3(mChunkCount),
+                 [&](const int3& chunk, const float chunkEnter, const float chunkExit)
+    {
+        const uint32_t chunkIndex = getChunkIndex(uint3(chunk));
+        if(!mayContainSurface(chunkIndex))
+        {
+            outside = mChunks[chunkIndex].mSigns == kOutside;
+            return false;
+        }
+
+        return traverseGrid(origin, direction, chunkEnter, chunkExit, 1.0f, int3(mSize), visitCell);
+    });
+
+    return hitDistance;
 }
 
+
+bool VoxelTerrain::intersects(const AABB& box) const
+{
+    const float3 boxMinimum = (float3(box.getMin()) - getMinimum()) / mVoxelSize;
+    const float3 boxMaximum = (float3(box.getMax()) - getMinimum()) / mVoxelSize;
+    if(glm::any(glm::lessThan(boxMaximum, float3(0.0f))) || glm::any(glm::greaterThan(boxMinimum, float3(mSize))))
+        return false;
+
+    const int3 minVoxel = glm::max(int3(glm::floor(boxMinimum)), int3(0));
+    const int3 maxVoxel = glm::min(int3(glm::ceil(boxMaximum)), int3(mSize) - 1);
+    const uint3 minChunk = uint3(minVoxel) / kChunkSize;
+    const uint3 maxChunk = uint3(maxVoxel) / kChunkSize;
+
+    for(uint32_t chunkY = minChunk.y; chunkY <= maxChunk.y; ++chunkY)
+    {
+        for(uint32_t chunkZ = minChunk.z; chunkZ <= maxChunk.z; ++chunkZ)
+        {
+            for(uint32_t chunkX = minChunk.x; chunkX <= maxChunk.x; ++chunkX)
+            {
+                const Chunk& chunk = mChunks[getChunkIndex(uint3{chunkX, chunkY, chunkZ})];
+                if(chunk.mSigns == kOutside)
+                    continue;
+
+                if(chunk.mSigns == kInside)
+                    return true;
+
+                const uint3 chunkStart = uint3{chunkX, chunkY, chunkZ} * kChunkSize;
+                const uint3 start = uint3(glm::max(minVoxel, int3(chunkStart))) - chunkStart;
+                const uint3 end = uint3(glm::min(maxVoxel, int3(chunkStart + kChunkSize - 1u))) - chunkStart;
+
+                for(uint32_t y = start.y; y <= end.y; ++y)
+                {
+                    for(uint32_t z = start.z; z <= end.z; ++z)
+                    {
+                        for(uint32_t x = start.x; x <= end.x; ++x)
+                        {
+                            if(chunk.mVoxels[x + (z * kChunkSize) + (y * kChunkSize * kChunkSize)] < 0)
+                                return true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+
+void VoxelTerrain::updateChunk(Chunk& chunk)
+{
+    if(chunk.mVoxels.empty())
+    {
+        chunk.mSigns = chunk.mUniformValue < 0 ? kInside : kOutside;
+        return;
+    }
+
+    const int8_t first = chunk.mVoxels[0];
+    bool uniform = true;
+    uint8_t signs = 0;
+    for(const int8_t value : chunk.mVoxels)
+    {
+        signs |= value < 0 ? kInside : kOutside;
+        uniform = uniform && value == first;
+    }
+
+    chunk.mSigns = signs;
+
+    if(uniform)
+    {
+        chunk.mUniformValue = first;
+        chunk.mVoxels = std::vector<int8_t>{};
+        for(std::vector<int8_t>& lod : chunk.mLODs)
+            lod = std::vector<int8_t>{};
+
+        return;
+    }
+
+    uint32_t lodSize = kChunkSize;
+    const std::vector<int8_t>* previousLOD = &chunk.mVoxels;
+    for(std::vector<int8_t>& lod : chunk.mLODs)
+    {
+        lod = TextureUtil::generateVoxelMip(*previousLOD, lodSize, lodSize, lodSize, 1);
+        previousLOD = &lod;
+        lodSize /= 2;
+    }
+}
+
+
+void VoxelTerrain::compactChunks(const uint3& minChunk, const uint3& maxChunk)
+{
+    for(uint32_t y = minChunk.y; y <= maxChunk.y; ++y)
+    {
+        for(uint32_t z = minChunk.z; z <= maxChunk.z; ++z)
+        {
+            for(uint32_t x = minChunk.x; x <= maxChunk.x; ++x)
+            {
+                const uint32_t index = getChunkIndex(uint3{x, y, z});
+                Chunk& chunk = mChunks[index];
+                if(chunk.mVoxels.empty() || mayContainSurface(index))
+                    continue;
+
+                // Nothing meshes these voxels, so their distance to the surface is lost.
+                chunk.mUniformValue = chunk.mSigns == kInside ? -127 : 127;
+                chunk.mVoxels = std::vector<int8_t>{};
+                for(std::vector<int8_t>& lod : chunk.mLODs)
+                    lod = std::vector<int8_t>{};
+            }
+        }
+    }
+}
+
+
+void VoxelTerrain::markDirty(const int3& minVoxel, const int3& maxVoxel)
+{
+    // Bricks at the lowest LOD read up to this many voxels past either side of their chunk.
+    const int32_t border = 2 << (kLODCount - 1);
+    const int3 minChunk = glm::max((minVoxel - border) / int32_t(kChunkSize), int3(0));
+    const int3 maxChunk = glm::min((maxVoxel + border) / int32_t(kChunkSize), int3(mChunkCount) - 1);
+
+    for(int32_t y = minChunk.y; y <= maxChunk.y; ++y)
+    {
+        for(int32_t z = minChunk.z; z <= maxChunk.z; ++z)
+        {
+            for(int32_t x = minChunk.x; x <= maxChunk.x; ++x)
+            {
+                const uint32_t index = getChunkIndex(uint3(x, y, z));
+                Chunk& chunk = mChunks[index];
+                ++chunk.mRevision;
+                if(!chunk.mDirty)
+                {
+                    chunk.mDirty = true;
+                    mDirtyChunks.push_back(index);
+                }
+            }
+        }
+    }
+}
+
+
+float VoxelTerrain::sampleGrid(const float3& position) const
+{
+    const float3 base = glm::floor(position);
+    const float3 weight = position - base;
+    const int3 voxel = int3(base);
+
+    auto lerpX = [&](const int32_t y, const int32_t z)
+    {
+        return glm::mix(float(getVoxel(voxel + int3(0, y, z))), float(getVoxel(voxel + int3(1, y, z))), weight.x);
+    };
+
+    const float bottom = glm::mix(lerpX(0, 0), lerpX(0, 1), weight.z);
+    const float top = glm::mix(lerpX(1, 0), lerpX(1, 1), weight.z);
+
+    return glm::mix(bottom, top, weight.y);
+}
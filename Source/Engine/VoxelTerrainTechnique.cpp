@@ -1,66 +1,108 @@
 #include "Engine/VoxelTerrainTechnique.hpp"
+#include "Engine/VoxelTerrain.hpp"
 #include "Engine/Engine.hpp"
 #include "Engine/DefaultResourceSlots.hpp"
 
-#include "Engine/TextureUtil.hpp"
 #include "Engine/GeomUtils.h"
 
+#include "MarchingCubesTables.hpp"
+
 #include "Core/Executor.hpp"
 
-#include <numeric>
+#include <cstring>
+
+
+static constexpr char kTerrainVertexCounters[] = "TerrainVertexCounters";
+static constexpr char kTerrainEditPosition[] = "TerrainEditPosition";
+
+namespace
+{
+    // A float4 position and packed normal, as written by MarchingCubes.comp.
+    constexpr uint32_t kVertexSize = 20;
+    constexpr uint32_t kInitialVertexCapacity = (16 * 1024 * 1024) / kVertexSize;
+    constexpr uint32_t kInitialDrawCapacity = 256;
+
+    // Added to the voxels around the mouse each frame whilst editing.
+    constexpr int32_t kEditStrength = 2;
+
+    // Classifies every cell the same way as the shader, so chunks can be given exactly the vertices they need.
+    uint32_t countVertices(const int8_t* brick, const uint32_t cellCount)
+    {
+        using namespace MarchingCubes;
+
+        const uint32_t brickSize = cellCount + 3;
 
-#include <glm/gtx/transform.hpp>
+        uint32_t triangleCount = 0;
+        for(uint32_t y = 0; y < cellCount; ++y)
+        {
+            for(uint32_t z = 0; z < cellCount; ++z)
+            {
+                for(uint32_t x = 0; x < cellCount; ++x)
+                {
+                    uint32_t cubeIndex = 0;
+                    for(uint32_t corner = 0; corner < 8; ++corner)
+                    {
+                        // Offset by one to skip the bricks border.
+                        const uint32_t voxelX = x + kCubeCorners[corner][0] + 1;
+                        const uint32_t voxelY = y + kCubeCorners[corner][1] + 1;
+                        const uint32_t voxelZ = z + kCubeCorners[corner][2] + 1;
+                        if(brick[voxelX + (voxelZ * brickSize) + (voxelY * brickSize * brickSize)] >= 0)
+                            cubeIndex |= 1u << corner;
+                    }
+
+                    triangleCount += kTriangleCounts[cubeIndex];
+                }
+            }
+        }
+
+        return triangleCount * 3;
+    }
+}
 
 
 VoxelTerrainTechnique::VoxelTerrainTechnique(RenderEngine* eng, RenderGraph& graph) :
     Technique("Voxel terrain", eng->getDevice()),
     mGenerateTerrainMeshShader(eng->getShader("./Shaders/MarchingCubes.comp")),
-    mInitialiseIndirectDrawShader(eng->getShader("./Shaders/InitialiseIndirectDraw.comp")),
     mTerrainVertexShader(eng->getShader("./Shaders/Terrain.vert")),
     mTerrainFragmentShaderDeferred(eng->getShader("./Shaders/TerrainDeferred.frag")),
     mModifyTerrainShader(eng->getShader("./Shaders/ModifyTerrain.comp")),
-    mVoxelGrid(getDevice(), Format::R8Norm, ImageUsage::Sampled | ImageUsage::Storage | ImageUsage::TransferDest,
-               eng->getScene()->getVoxelTerrain()->getSize().x, eng->getScene()->getVoxelTerrain()->getSize().z, eng->getScene()->getVoxelTerrain()->getSize().y, 1, 1, 1, "Terrain Voxels"),
-    mVoxelGridView(mVoxelGrid, ImageViewType::Colour),
-    mVertexBuffer(getDevice(), BufferUsage::Vertex | BufferUsage::DataBuffer, 10 * 1024 * 1024, 10 * 1024 * 1024, "Terrain vertex buffer"),
+    mBricks(getDevice(), Format::R8Norm, ImageUsage::Sampled | ImageUsage::TransferDest, VoxelTerrain::getBrickSize(0), VoxelTerrain::getBrickSize(0),
+            VoxelTerrain::getBrickSize(0) * kMaxChunkUpdatesPerFrame, 1, 1, 1, "Terrain bricks"),
+    mBricksView(mBricks, ImageViewType::Colour),
+    mVertexBuffer(getDevice(), BufferUsage::Vertex | BufferUsage::DataBuffer, kInitialVertexCapacity * kVertexSize, kInitialVertexCapacity * kVertexSize, "Terrain vertex buffer"),
     mVertexBufferView(mVertexBuffer),
-    mIndirectArgsBuffer(getDevice(), BufferUsage::IndirectArgs | BufferUsage::DataBuffer, sizeof(uint32_t) * 4, sizeof(uint32_t) * 4, "Terrain indirect Args"),
-    mIndirectArgView(mIndirectArgsBuffer),
+    mVertexCounters(getDevice(), BufferUsage::DataBuffer | BufferUsage::TransferDest, sizeof(uint32_t) * kMaxChunkUpdatesPerFrame, sizeof(uint32_t), "Terrain vertex counters"),
+    mVertexCountersView(mVertexCounters),
+    mDrawCommands(getDevice(), BufferUsage::IndirectArgs | BufferUsage::TransferDest, sizeof(uint4) * kInitialDrawCapacity, sizeof(uint4), "Terrain draw commands"),
+    mDrawCommandsView(mDrawCommands),
+    mEditPosition(getDevice(), BufferUsage::DataBuffer | BufferUsage::Uniform, sizeof(float4), sizeof(float4), "Terrain edit position"),
+    mEditPositionView(mEditPosition),
+    mVertexCapacity(kInitialVertexCapacity),
     mModifySize(5.0f),
     mTextureScale(5.0f, 5.0f),
     mMaterialIndexXZ(0),
     mMaterialIndexY(0)
 {
-    // Upload terrain grid.
-    {
-        const Scene* scene = eng->getScene();
-        const std::unique_ptr<VoxelTerrain>& terrain = scene->getVoxelTerrain();
-        uint3 voxelGridSize = terrain->getSize();
-        const std::vector<int8_t>& voxelData = terrain->getVoxelData();
+    const std::unique_ptr<VoxelTerrain>& terrain = eng->getScene()->getVoxelTerrain();
+    const uint3 chunkCount = terrain->getChunkCount();
 
-        mVoxelGrid->setContents(voxelData.data(), voxelGridSize.x, voxelGridSize.y, voxelGridSize.z);
-    }
+    // Every chunk is queued when the terrain is initialised, as they all start out dirty.
+    mChunkMeshes.resize(chunkCount.x * chunkCount.y * chunkCount.z, ChunkMesh{0, 0, 0, false});
+    mBrickData.resize(VoxelTerrain::getBrickSize(0) * VoxelTerrain::getBrickSize(0) * VoxelTerrain::getBrickSize(0));
+    mLODDistance = VoxelTerrain::kChunkSize * terrain->getVoxelSize() * 8.0f;
 
-    {
-        ComputeTask resetIndirectArgs{"Terrain reset args"};
-        resetIndirectArgs.addInput(kTerrainIndirectBuffer, AttachmentType::DataBufferWO);
-        resetIndirectArgs.setRecordCommandsCallback(
-                [this](const RenderGraph& graph, const uint32_t taskIndex, Executor* exec, RenderEngine*, const std::vector<const MeshInstance*>&)
-                {
-                    const ComputeTask& task = static_cast<const ComputeTask&>(graph.getTask(taskIndex));
-                    exec->setComputeShader(task, graph, mInitialiseIndirectDrawShader);
+    mFreeVertexRanges.insert({0, mVertexCapacity});
+    mRetiredVertexRanges.resize(getDevice()->getSwapChainImageCount());
 
-                    exec->dispatch(1, 1, 1);
-                });
-        graph.addTask(resetIndirectArgs);
-    }
+    for(uint32_t i = 0; i < getDevice()->getSwapChainImageCount(); ++i)
+        mEditPosition.get(i)->setContents(0, sizeof(float4));
 
     {
         ComputeTask modifyTerrain("ModifyTerrain");
-        modifyTerrain.addInput(kTerrainVoxelGrid, AttachmentType::Image3D);
         modifyTerrain.addInput(kPreviousLinearDepth, AttachmentType::Texture2D);
         modifyTerrain.addInput(kCameraBuffer, AttachmentType::UniformBuffer);
         modifyTerrain.addInput(kDefaultSampler, AttachmentType::Sampler);
+        modifyTerrain.addInput(kTerrainEditPosition, AttachmentType::DataBufferWO);
         modifyTerrain.addInput("ModifyConstant", AttachmentType::PushConstants);
         modifyTerrain.setRecordCommandsCallback(
                     [this](const RenderGraph& graph, const uint32_t taskIndex, Executor* exec, RenderEngine* eng, const std::vector<const MeshInstance*>&)
@@ -69,6 +111,7 @@ VoxelTerrainTechnique::VoxelTerrainTechnique(RenderEngine* eng, RenderGraph& gra
                     PROFILER_GPU_TASK(exec);
                     PROFILER_GPU_EVENT("voxel terrain");
 
+                    // Only picks the position under the mouse, the edit is applied to the CPU terrain once it's read back.
                     if(eng->editTerrain())
                     {
                         const ComputeTask& task = static_cast<const ComputeTask&>(graph.getTask(taskIndex));
@@ -76,22 +119,10 @@ VoxelTerrainTechnique::VoxelTerrainTechnique(RenderEngine* eng, RenderGraph& gra
 
                         ImGuiIO& io = ImGui::GetIO();
 
-                        const Scene* scene = eng->getScene();
-                        const std::unique_ptr<VoxelTerrain>& terrain = scene->getVoxelTerrain();
-                        const float voxelSize = terrain->getVoxelSize();
-                        const float3 voxelGridWorldSize = float3(terrain->getSize()) * voxelSize;
-
-                        float mode = 0.0f;
-                        if(io.MouseDown[0])
-                            mode = 0.01f;
-                        else if(io.MouseDown[1])
-                            mode = -0.01f;
-
-                        TerrainModifying constants{uint2{io.MousePos.x, io.MousePos.y}, mode, voxelSize, voxelGridWorldSize};
+                        TerrainModifying constants{uint2{io.MousePos.x, io.MousePos.y}};
                         exec->insertPushConstant(&constants, sizeof(TerrainModifying));
 
-                        const uint32_t modifySize = std::ceil(mModifySize / voxelSize);
-                        exec->dispatch(modifySize, modifySize, modifySize);
+                        exec->dispatch(1, 1, 1);
                     }
                 });
 
@@ -101,84 +132,38 @@ VoxelTerrainTechnique::VoxelTerrainTechnique(RenderEngine* eng, RenderGraph& gra
     {
         ComputeTask marchCube{"terrain march cubes"};
         marchCube.addInput(kTerrainVoxelGrid, AttachmentType::Texture3D);
-        marchCube.addInput(kTerrainIndirectBuffer, AttachmentType::DataBufferRW);
+        marchCube.addInput(kTerrainVertexCounters, AttachmentType::DataBufferRW);
         marchCube.addInput(kTerrainVertexBuffer, AttachmentType::DataBufferWO);
-        marchCube.addInput(kDefaultSampler, AttachmentType::Sampler);
-        marchCube.addInput(kCameraBuffer, AttachmentType::UniformBuffer);
         marchCube.addInput(kTerrainUniformBuffer, AttachmentType::PushConstants);
         marchCube.setRecordCommandsCallback(
             [this](const RenderGraph& graph, const uint32_t taskIndex, Executor* exec, RenderEngine* eng, const std::vector<const MeshInstance*>&)
         {
+            if(mChunkUpdates.empty())
+                return;
+
             const ComputeTask& task = static_cast<const ComputeTask&>(graph.getTask(taskIndex));
             exec->setComputeShader(task, graph, mGenerateTerrainMeshShader);
 
-            const Scene* scene = eng->getScene();
-            const Scene::ShadowCascades cascades = scene->getShadowCascades();
-            const Camera& cam = scene->getCamera();
-            const float4x4 view = cam.getViewMatrix();
-            const float cameraFarPlane = cam.getFarPlane();
-            const float2 cascadeRanges[3] = {{cam.getNearPlane(), cascades.mNearEnd * cameraFarPlane},
-                                             {cascades.mNearEnd * cameraFarPlane, cascades.mMidEnd * cameraFarPlane},
-                                             {cascades.mMidEnd * cameraFarPlane, cascades.mFarEnd * cameraFarPlane} };
-            const std::unique_ptr<VoxelTerrain>& terrain = scene->getVoxelTerrain();
-
-            // generate terrain at 3 LODs.
-            for(uint32_t lod = 0u; lod < 3u; ++lod)
+            const std::unique_ptr<VoxelTerrain>& terrain = eng->getScene()->getVoxelTerrain();
+
+            for(uint32_t update_i = 0; update_i < mChunkUpdates.size(); ++update_i)
             {
-                const float baseVoxelSize = terrain->getVoxelSize();
-                const float lodFactor = std::pow(2.0f, float(lod));
-                const float lodVoxelSize = baseVoxelSize * lodFactor;
-                const float3 voxelGridWorldSize = float3(terrain->getSize()) * baseVoxelSize;
-
-                const float4x4 invView = glm::inverse(cam.getViewMatrix());
-                const float nearPlane = cascadeRanges[lod].x;
-                const float farPlane = cascadeRanges[lod].y;
-                const float frustumHalfHeightFar = farPlane * tanf(glm::radians(cam.getFOV()) * 0.5f);
-                const float frustumHalfHeightNear = nearPlane * tanf(glm::radians(cam.getFOV()) * 0.5f);
-                const float aspect = cam.getAspect();
-                const float frustumHalfWidthFar = frustumHalfHeightFar * aspect;
-                const float frustumHalfWidthNear = frustumHalfHeightNear * aspect;
-                const float3 camUpFar = float3(0.f, frustumHalfHeightFar, 0.0f);
-                const float3 camRightFar = float3(frustumHalfWidthFar, 0.0f, 0.0f);
-                const float3 camUpNear = float3(0.f, frustumHalfHeightNear, 0.0f);
-                const float3 camRightNear = float3(frustumHalfWidthNear, 0.0f, 0.0f);
-                float3 viewSpaceFrustumPoints[8] = {camUpNear + camRightNear - float3(0.0f, 0.0f, nearPlane), -camUpNear + camRightNear - float3(0.0f, 0.0f, nearPlane),
-                                                    camUpNear - camRightNear - float3(0.0f, 0.0f, nearPlane), -camUpNear - camRightNear - float3(0.0f, 0.0f, nearPlane),
-                                                    camUpFar + camRightFar - float3(0.0f, 0.0f, farPlane), -camUpFar + camRightFar - float3(0.0f, 0.0f, farPlane),
-                                                    camUpFar - camRightFar - float3(0.0f, 0.0f, farPlane), -camUpFar - camRightFar - float3(0.0f, 0.0f, farPlane)};
-                float3 terrainVolumeMin{INFINITY, INFINITY, INFINITY};
-                float3 terrainVolumeMax{-INFINITY, -INFINITY, -INFINITY};
-                for(uint32_t i = 0u; i < 8u; ++i)
-                {
-                    const float4 transformedPoint = invView * float4(viewSpaceFrustumPoints[i], 1.0f);
-                    terrainVolumeMin = componentWiseMin(terrainVolumeMin, float3(transformedPoint.x, transformedPoint.y, transformedPoint.z));
-                    terrainVolumeMax = componentWiseMax(terrainVolumeMax, float3(transformedPoint.x, transformedPoint.y, transformedPoint.z));
-                }
-                float3 gridMin = -(voxelGridWorldSize / 2.0f);
-                float3 gridMax = -gridMin;
-                float3 volumeMin = componentWiseMax(terrainVolumeMin, gridMin);
-                volumeMin = componentWiseMin(terrainVolumeMin, gridMax);
-                int3 offset = (terrainVolumeMin - gridMin) / lodVoxelSize;
-
-                const float4x4 proj = glm::perspective(glm::radians(cam.getFOV()), cam.getAspect(), farPlane, nearPlane);
-                const std::array<float4, 6> planes = frustumPlanes(proj * view);
-
-                TerrainVolume uniformBuffer{};
-                uniformBuffer.minimum = gridMin;
-                uniformBuffer.offset = offset;
-                uniformBuffer.voxelSize = baseVoxelSize;
-                uniformBuffer.lod = lodFactor;
-                memcpy(&uniformBuffer.frustumPlanes, planes.data(), sizeof(float4) * 6);
-                exec->insertPushConstant(&uniformBuffer, sizeof(TerrainVolume));
-
-                float3 volumeMax = terrainVolumeMax;
-                volumeMax = componentWiseMin(volumeMax, gridMax);
-                volumeMax = componentWiseMax(volumeMax, gridMin);
-
-                const float3 volumeSize = volumeMax - volumeMin;
-                exec->dispatch(std::ceil(volumeSize.x / (lodVoxelSize * 4.0f)), std::ceil(volumeSize.y / (lodVoxelSize * 4.0f)), std::ceil(volumeSize.z / (lodVoxelSize * 4.0f)));
+                const ChunkUpdate& update = mChunkUpdates[update_i];
+                const uint32_t cellCount = VoxelTerrain::getChunkCellCount(update.mLOD);
+
+                TerrainChunk constants{};
+                constants.minimum = terrain->getChunkBounds(update.mChunk).getMin();
+                constants.voxelSize = terrain->getVoxelSize() * float(1u << update.mLOD);
+                constants.brickOffset = update_i * VoxelTerrain::getBrickSize(0);
+                constants.cellCount = cellCount;
+                constants.vertexOffset = update.mVertexOffset;
+                constants.vertexCapacity = update.mVertexCount;
+                constants.counterIndex = update_i;
+                exec->insertPushConstant(&constants, sizeof(TerrainChunk));
+
+                const uint32_t groupCount = (cellCount + 3) / 4;
+                exec->dispatch(groupCount, groupCount, groupCount);
             }
-
         });
         mSurfaceGenerationTask = graph.addTask(marchCube);
     }
@@ -208,6 +193,9 @@ VoxelTerrainTechnique::VoxelTerrainTechnique(RenderEngine* eng, RenderGraph& gra
         renderTerrainTask.setRecordCommandsCallback(
         [this](const RenderGraph& graph, const uint32_t taskIndex, Executor* exec, RenderEngine*, const std::vector<const MeshInstance*>&)
         {
+            if(mDrawCommandData.empty())
+                return;
+
             const GraphicsTask& task = static_cast<const GraphicsTask&>(graph.getTask(taskIndex));
             exec->setGraphicsShaders(task, graph, mTerrainVertexShader, nullptr, nullptr, nullptr, mTerrainFragmentShaderDeferred);
             exec->bindVertexBuffer(mVertexBufferView, 0);
@@ -215,10 +203,11 @@ VoxelTerrainTechnique::VoxelTerrainTechnique(RenderEngine* eng, RenderGraph& gra
             TerrainTexturing textureInfo{mTextureScale, mMaterialIndexXZ, mMaterialIndexY};
             exec->insertPushConstant(&textureInfo, sizeof(TerrainTexturing));
 
-            exec->indirectDraw(1, mIndirectArgView);
+            // One draw per visible chunk.
+            exec->indirectDraw(static_cast<uint32_t>(mDrawCommandData.size()), *mDrawCommandsView);
         });
 
-        graph.addTask(renderTerrainTask);
+        mRenderTaskID = graph.addTask(renderTerrainTask);
     }
     else
     {
@@ -228,12 +217,260 @@ VoxelTerrainTechnique::VoxelTerrainTechnique(RenderEngine* eng, RenderGraph& gra
 }
 
 
+void VoxelTerrainTechnique::render(RenderGraph&, RenderEngine* eng)
+{
+    PROFILER_EVENT();
+
+    // Ranges freed the last time this frame index ran are no longer being drawn.
+    const uint32_t frameIndex = getDevice()->getCurrentFrameIndex();
+    for(const VertexRange& range : mRetiredVertexRanges[frameIndex])
+        freeVertices(range);
+    mRetiredVertexRanges[frameIndex].clear();
+
+    const Scene* scene = eng->getScene();
+    VoxelTerrain& terrain = *scene->getVoxelTerrain();
+    BELL_ASSERT(terrain.getChunkCount().x * terrain.getChunkCount().y * terrain.getChunkCount().z == mChunkMeshes.size(), "Terrain has been resized")
+
+    applyEdit(eng, terrain);
+
+    // Edited chunks jump the queue, so edits show up straight away.
+    for(const uint32_t chunk : terrain.getDirtyChunks())
+    {
+        ChunkMesh& mesh = mChunkMeshes[chunk];
+        if(!mesh.mQueued)
+        {
+            mesh.mQueued = true;
+            mRemeshQueue.push_front(chunk);
+        }
+    }
+    terrain.clearDirtyChunks();
+
+    const float3 cameraPosition = scene->getCamera().getPosition();
+    for(uint32_t chunk = 0; chunk < mChunkMeshes.size(); ++chunk)
+    {
+        ChunkMesh& mesh = mChunkMeshes[chunk];
+        if(mesh.mQueued || mesh.mVertexCount == 0)
+            continue;
+
+        if(selectLOD(terrain, chunk, cameraPosition) != mesh.mLOD)
+        {
+            mesh.mQueued = true;
+            mRemeshQueue.push_back(chunk);
+        }
+    }
+
+    mChunkUpdates.clear();
+    while(!mRemeshQueue.empty() && mChunkUpdates.size() < kMaxChunkUpdatesPerFrame)
+    {
+        const uint32_t chunk = mRemeshQueue.front();
+        mRemeshQueue.pop_front();
+        mChunkMeshes[chunk].mQueued = false;
+
+        if(!updateChunk(terrain, chunk, selectLOD(terrain, chunk, cameraPosition)))
+            break;
+    }
+
+    if(!mChunkUpdates.empty())
+        (*mVertexCounters)->setContents(0, static_cast<uint32_t>(mChunkUpdates.size() * sizeof(uint32_t)));
+
+    const Frustum frustum = scene->getCamera().getFrustum();
+    mDrawCommandData.clear();
+    for(uint32_t chunk = 0; chunk < mChunkMeshes.size(); ++chunk)
+    {
+        const ChunkMesh& mesh = mChunkMeshes[chunk];
+        if(mesh.mVertexCount > 0 && frustum.isContainedWithin(terrain.getChunkBounds(chunk)) != Intersection::None)
+            mDrawCommandData.push_back(uint4{mesh.mVertexCount, 1, mesh.mVertexOffset, 0});
+    }
+
+    Buffer& drawCommands = *mDrawCommands;
+    const uint64_t requiredSize = mDrawCommandData.size() * sizeof(uint4);
+    if(drawCommands->getSize() < requiredSize)
+    {
+        uint64_t newSize = drawCommands->getSize();
+        while(newSize < requiredSize)
+            newSize *= 2;
+
+        drawCommands->resize(static_cast<uint32_t>(newSize), false);
+        *mDrawCommandsView = BufferView(drawCommands);
+    }
+
+    if(!mDrawCommandData.empty())
+        drawCommands->setContents(mDrawCommandData.data(), static_cast<uint32_t>(requiredSize));
+
+    (*mBricks)->updateLastAccessed();
+    (*mBricksView)->updateLastAccessed();
+    mVertexBuffer->updateLastAccessed();
+    (*mVertexCounters)->updateLastAccessed();
+    drawCommands->updateLastAccessed();
+    (*mEditPosition)->updateLastAccessed();
+}
+
+
 void VoxelTerrainTechnique::bindResources(RenderGraph& graph)
 {
-    if(!graph.isResourceSlotBound(kTerrainVertexBuffer))
+    // Rebound every frame, as they're either per frame or can be replaced when growing.
+    graph.bindImage(kTerrainVoxelGrid, *mBricksView);
+    graph.bindBuffer(kTerrainVertexBuffer, mVertexBufferView);
+    graph.bindBuffer(kTerrainVertexCounters, *mVertexCountersView);
+    graph.bindBuffer(kTerrainIndirectBuffer, *mDrawCommandsView);
+    graph.bindBuffer(kTerrainEditPosition, *mEditPositionView);
+}
+
+
+uint32_t VoxelTerrainTechnique::selectLOD(const VoxelTerrain& terrain, const uint32_t chunk, const float3& cameraPosition) const
+{
+    const float distance = glm::distance(float3(terrain.getChunkBounds(chunk).getCentralPoint()), cameraPosition);
+    const uint32_t lod = distance < mLODDistance ? 0 : (distance < mLODDistance * 2.0f ? 1 : 2);
+
+    return std::min(lod, VoxelTerrain::kLODCount - 1);
+}
+
+
+bool VoxelTerrainTechnique::updateChunk(const VoxelTerrain& terrain, const uint32_t chunk, const uint32_t lod)
+{
+    ChunkMesh& mesh = mChunkMeshes[chunk];
+    retireMesh(mesh);
+    mesh.mLOD = static_cast<uint8_t>(lod);
+
+    if(!terrain.getChunkBrick(chunk, lod, mBrickData.data()))
+        return true;
+
+    const uint32_t vertexCount = countVertices(mBrickData.data(), VoxelTerrain::getChunkCellCount(lod));
+    if(vertexCount == 0)
+        return true;
+
+    uint32_t vertexOffset = 0;
+    if(!allocateVertices(vertexCount, vertexOffset))
     {
-        graph.bindBuffer(kTerrainVertexBuffer, mVertexBufferView);
-        graph.bindBuffer(kTerrainIndirectBuffer, mIndirectArgView);
-        graph.bindImage(kTerrainVoxelGrid, mVoxelGridView);
+        growVertexBuffer(vertexCount);
+        return false;
     }
+
+    const uint32_t brickSize = VoxelTerrain::getBrickSize(lod);
+    const uint32_t brickOffset = static_cast<uint32_t>(mChunkUpdates.size()) * VoxelTerrain::getBrickSize(0);
+    (*mBricks)->setContents(mBrickData.data(), brickSize, brickSize, brickSize, 0, 0, 0, 0, brickOffset);
+
+    mesh.mVertexOffset = vertexOffset;
+    mesh.mVertexCount = vertexCount;
+    mChunkUpdates.push_back(ChunkUpdate{chunk, lod, vertexOffset, vertexCount});
+
+    return true;
+}
+
+
+void VoxelTerrainTechnique::retireMesh(ChunkMesh& mesh)
+{
+    if(mesh.mVertexCount == 0)
+        return;
+
+    mRetiredVertexRanges[getDevice()->getCurrentFrameIndex()].push_back(VertexRange{mesh.mVertexOffset, mesh.mVertexCount});
+    mesh.mVertexCount = 0;
+}
+
+
+bool VoxelTerrainTechnique::allocateVertices(const uint32_t count, uint32_t& offset)
+{
+    for(auto it = mFreeVertexRanges.begin(); it != mFreeVertexRanges.end(); ++it)
+    {
+        if(it->second < count)
+            continue;
+
+        offset = it->first;
+        const uint32_t remaining = it->second - count;
+        mFreeVertexRanges.erase(it);
+
+        if(remaining > 0)
+            mFreeVertexRanges.insert({offset + count, remaining});
+
+        return true;
+    }
+
+    return false;
+}
+
+
+void VoxelTerrainTechnique::freeVertices(const VertexRange& range)
+{
+    uint32_t offset = range.mOffset;
+    uint32_t count = range.mCount;
+
+    // Merge with the neighbouring free ranges.
+    auto next = mFreeVertexRanges.lower_bound(offset);
+    if(next != mFreeVertexRanges.end() && next->first == offset + count)
+    {
+        count += next->second;
+        next = mFreeVertexRanges.erase(next);
+    }
+
+    if(next != mFreeVertexRanges.begin())
+    {
+        auto previous = std::prev(next);
+        if(previous->first + previous->second == offset)
+        {
+            previous->second += count;
+            return;
+        }
+    }
+
+    mFreeVertexRanges.insert(next, {offset, count});
+}
+
+
+void VoxelTerrainTechnique::growVertexBuffer(const uint32_t requiredCount)
+{
+    uint32_t newCapacity = mVertexCapacity * 2;
+    while(newCapacity < requiredCount)
+        newCapacity *= 2;
+
+    BELL_LOG_WARNING(Engine, "Growing the terrain vertex buffer to %u vertices", newCapacity)
+
+    // The old buffer is kept alive until the frames in flight are done with it.
+    mVertexBuffer->resize(newCapacity * kVertexSize, false);
+    mVertexBufferView = BufferView(mVertexBuffer);
+    mVertexCapacity = newCapacity;
+
+    mFreeVertexRanges.clear();
+    mFreeVertexRanges.insert({0, mVertexCapacity});
+    for(std::vector<VertexRange>& ranges : mRetiredVertexRanges)
+        ranges.clear();
+
+    // Bricks uploaded this frame are dropped along with their updates.
+    mChunkUpdates.clear();
+    mRemeshQueue.clear();
+    for(uint32_t chunk = 0; chunk < mChunkMeshes.size(); ++chunk)
+    {
+        mChunkMeshes[chunk].mVertexCount = 0;
+        mChunkMeshes[chunk].mQueued = true;
+        mRemeshQueue.push_back(chunk);
+    }
+}
+
+
+void VoxelTerrainTechnique::applyEdit(RenderEngine* eng, VoxelTerrain& terrain)
+{
+    if(!eng->editTerrain())
+        return;
+
+    ImGuiIO& io = ImGui::GetIO();
+
+    int32_t value = 0;
+    if(io.MouseDown[0])
+        value = kEditStrength;
+    else if(io.MouseDown[1])
+        value = -kEditStrength;
+
+    if(value == 0)
+        return;
+
+    // Picked by ModifyTerrain.comp the last time this frame index ran.
+    Buffer& editPosition = *mEditPosition;
+    MapInfo mapInfo{0, sizeof(float4)};
+
+    float4 position;
+    void* bufPtr = editPosition->map(mapInfo);
+    memcpy(&position, bufPtr, sizeof(float4));
+    editPosition->unmap();
+
+    if(position.w > 0.0f)
+        terrain.modify(float3(position), mModifySize, value);
 }
@@ -443,6 +443,28 @@ bool RenderGraph::isResourceSlotBound(const char* name) const
 }
 
 
+std::vector<std::pair<const char*, RenderGraph::ResourceType>> RenderGraph::getBoundResources() const
+{
+    std::vector<std::pair<const char*, ResourceType>> resources{};
+    for(const auto& [name, view] : mImageViews)
+        resources.push_back({name, ResourceType::Image});
+    for(const auto& [name, views] : mImageViewArrays)
+        resources.push_back({name, ResourceType::ImageArray});
+    for(const auto& [name, view] : mBufferViews)
+        resources.push_back({name, ResourceType::Buffer});
+    for(const auto& [name, views] : mBufferViewArrays)
+        resources.push_back({name, ResourceType::BufferArray});
+    for(const auto& [name, sampler] : mSamplers)
+        resources.push_back({name, ResourceType::Sampler});
+    for(const auto& [name, set] : mSRS)
+        resources.push_back({name, ResourceType::SRS});
+    for(const auto& [name, structure] : mAccelerationStructures)
+        resources.push_back({name, ResourceType::AccelerationStructure});
+
+    return resources;
+}
+
+
 void RenderGraph::bindInternalResources()
 {
 	for (const auto& resourceEntry : mInternalResources)
@@ -530,6 +552,9 @@ void RenderGraph::reorderTasks()
 
     const uint32_t taskCount = static_cast<uint32_t>(mTaskOrder.size());
 
+    const std::vector<std::pair<uint32_t, uint32_t>> dependancies = mTaskDependancies;
+    std::vector<uint32_t> newTaskIndicies(taskCount);
+
 	// keep track of tasks that have already been added to meet other tasks dependancies.
 	// This stops us readding moved from tasks.
 	std::vector<uint8_t> usedDependants(taskCount);
@@ -552,6 +577,7 @@ void RenderGraph::reorderTasks()
 
 		usedDependants[taskIndexToAdd] = 1;
 
+        newTaskIndicies[taskIndexToAdd] = static_cast<uint32_t>(newTaskOrder.size());
 		newTaskOrder.push_back(mTaskOrder[taskIndexToAdd]);
         newFrameBuffersNeedUpdating.push_back(mFrameBuffersNeedUpdating[taskIndexToAdd]);
         newDescriptorsNeedUpdating.push_back(mDescriptorsNeedUpdating[taskIndexToAdd]);
@@ -566,14 +592,18 @@ void RenderGraph::reorderTasks()
     mFrameBuffersNeedUpdating.swap(newFrameBuffersNeedUpdating);
     mDescriptorsNeedUpdating.swap(newDescriptorsNeedUpdating);
 
+    mCompiledDependancies.clear();
+    for(const auto& [dependancy, dependant] : dependancies)
+        mCompiledDependancies.push_back({newTaskIndicies[dependancy], newTaskIndicies[dependant]});
+
 #ifndef NDEBUG // Enable to print out task submission order.
 
-	BELL_LOG("Task submission order:");
+	BELL_LOG_TRACE(RenderGraph, "Task submission order:")
 
 	for (const auto& [type, index] : mTaskOrder)
 	{
 		const auto& task = getTask(type, index);
-		BELL_LOG_ARGS("%s", task.getName().c_str());
+		BELL_LOG_TRACE(RenderGraph, "%s", task.getName().c_str())
 	}
 
 #endif
@@ -967,6 +997,7 @@ void RenderGraph::reset()
 	mComputeTasks.clear();
 	mTaskOrder.clear();
 	mTaskDependancies.clear();
+    mCompiledDependancies.clear();
 }
 
 
@@ -992,8 +1023,8 @@ void RenderGraph::verifyDependencies()
             {
                 const RenderTask& task1 = getTask(dependantOuter);
                 const RenderTask& task2 = getTask(dependancyOuter);
-                BELL_LOG_ARGS("Circular dependancy between %s and %s", task1.getName().c_str(), task2.getName().c_str());
-                fflush(stdout);
+                BELL_LOG_ERROR(RenderGraph, "Circular dependancy between %s and %s", task1.getName().c_str(), task2.getName().c_str());
+                Log::flush();
                 BELL_TRAP;
             }
         }
@@ -0,0 +1,135 @@
+#include "Engine/Engine.hpp"
+#include "Engine/FrameCapture.hpp"
+
+#include "GLFW/glfw3.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Re-records a captured frame in isolation, for profiling and comparing optimisations against the same inputs.
+// usage: BELL_FRAME_REPLAY <capture> [--frames <count>] [--scene <path>]
+// The graph is rebuilt by registering the captured passes and checked against the captured one, then every view
+// is frozen to what it drew when captured. With the null device only the CPU side runs, other backends open a
+// window and execute the frame on the GPU as well.
+// Needs to be run from the build directory, as the engine loads its assets.
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        printf("usage: %s <capture> [--frames <count>] [--scene <path>]\n", argv[0]);
+        return 1;
+    }
+
+    const std::string capturePath = argv[1];
+    std::string scenePath{};
+    uint32_t frameCount = 100;
+
+    for(int i = 2; i < argc; ++i)
+    {
+        const bool hasValue = (i + 1) < argc;
+
+        if(strcmp(argv[i], "--frames") == 0 && hasValue)
+            frameCount = std::max(1u, static_cast<uint32_t>(strtoul(argv[++i], nullptr, 10)));
+        else if(strcmp(argv[i], "--scene") == 0 && hasValue)
+            scenePath = argv[++i];
+        else
+        {
+            printf("usage: %s <capture> [--frames <count>] [--scene <path>]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    FrameCapture::Frame capture{};
+    if(!FrameCapture::readFromFile(capturePath, capture))
+    {
+        printf("Failed to read %s\n", capturePath.c_str());
+        return 1;
+    }
+
+    if(scenePath.empty())
+        scenePath = capture.mScenePath;
+
+    const GraphicsOptions options{0, false};
+
+#ifdef NULL_DEVICE
+    RenderEngine* engine = new RenderEngine(capture.mWidth, capture.mHeight, options);
+#else
+    glfwInit();
+    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+    glfwWindowHint(GLFW_RESIZABLE, GL_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(capture.mWidth, capture.mHeight, "Frame replay", nullptr, nullptr);
+    if(!window)
+    {
+        glfwTerminate();
+        return 1;
+    }
+
+    RenderEngine* engine = new RenderEngine(window, options);
+#endif
+
+    engine->setScene(scenePath);
+
+    for(uint32_t pass_i = 0; pass_i < 64; ++pass_i)
+    {
+        const uint64_t pass = 1ull << pass_i;
+        if(capture.mRegisteredPasses & pass)
+            engine->registerPass(static_cast<PassType>(pass));
+    }
+
+    if(!engine->setReplayFrame(&capture))
+    {
+        printf("%s doesn't match the captured scene\n", scenePath.c_str());
+        return 1;
+    }
+
+    std::vector<double> frameTimes{};
+    frameTimes.reserve(frameCount);
+
+    // The first frame compiles the graph, so is run once up front and not timed.
+    for(uint32_t frame_i = 0; frame_i <= frameCount; ++frame_i)
+    {
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        engine->startFrame(capture.mFrameDelta);
+        engine->recordScene();
+        engine->render();
+        engine->swap();
+        engine->endFrame();
+
+        const auto end = std::chrono::high_resolution_clock::now();
+
+        if(frame_i == 0)
+        {
+            // Capture the replay as well, so it can be compared against the original.
+            FrameCapture::Frame replayed = FrameCapture::captureFrame(*engine, capture.mBoneMatrices);
+            const std::vector<std::string> differences = FrameCapture::compareGraphs(capture, replayed);
+            for(const std::string& difference : differences)
+                printf("Graph mismatch: %s\n", difference.c_str());
+
+            if(!differences.empty())
+                printf("The replayed graph differs from the captured one, timings may not be comparable\n");
+        }
+        else
+            frameTimes.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    engine->flushWait();
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    double total = 0.0;
+    for(const double time : frameTimes)
+        total += time;
+
+    printf("Replayed %s (%zu tasks, %zu instances, %ux%u) %u times\n", capturePath.c_str(), capture.mTasks.size(), capture.mInstances.size(),
+           capture.mWidth, capture.mHeight, frameCount);
+    printf("Frame time mean %.3f ms, p50 %.3f ms, min %.3f ms, max %.3f ms\n", total / double(frameTimes.size()),
+           frameTimes[frameTimes.size() / 2], frameTimes.front(), frameTimes.back());
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "Engine/StaticMesh.h"
+#include "Engine/CookedMesh.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// Offline cooker, converts any mesh assimp can load in to the Bell native .bmesh format.
+// usage: BELL_MESH_COOKER <input mesh> [output mesh] [--global-scale]
+int main(int argc, char** argv)
+{
+    if(argc < 2)
+    {
+        printf("usage: %s <input mesh> [output mesh] [--global-scale]\n", argv[0]);
+        return 1;
+    }
+
+    const std::string inputPath = argv[1];
+    std::string outputPath = inputPath + CookedMesh::kFileExtension;
+    bool globalScale = false;
+
+    for(int i = 2; i < argc; ++i)
+    {
+        if(strcmp(argv[i], "--global-scale") == 0)
+            globalScale = true;
+        else
+            outputPath = argv[i];
+    }
+
+    // Matches the attributes the scene loader requests.
+    const int vertexAttributes = VertexAttributes::Position4 | VertexAttributes::Normals | VertexAttributes::TextureCoordinates |
+                                 VertexAttributes::Tangents | VertexAttributes::Albedo;
+
+    StaticMesh mesh{inputPath, vertexAttributes, globalScale};
+    if(mesh.getVertexCount() == 0)
+    {
+        printf("Failed to load %s\n", inputPath.c_str());
+        return 1;
+    }
+
+    if(!mesh.writeCookedMesh(outputPath))
+    {
+        printf("Failed to write %s\n", outputPath.c_str());
+        return 1;
+    }
+
+    printf("Cooked %s -> %s (%llu verticies, %zu indicies, %u submeshes, %zu meshlets, %u LODs, %u bones)\n", inputPath.c_str(), outputPath.c_str(),
+           static_cast<unsigned long long>(mesh.getVertexCount()), mesh.getIndexData().size(), mesh.getSubMeshCount(), mesh.getMeshlets().size(), mesh.getLODCount(), mesh.getBoneCount());
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "Engine/TextureCompression.hpp"
+#include "Engine/TextureUtil.hpp"
+#include "Engine/ThreadPool.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct TextureType
+    {
+        const char* mName;
+        Format mFormat;
+        int mChannels;
+        bool mNormalMap;
+    };
+
+    const TextureType kTextureTypes[] =
+    {
+        {"albedo", Format::BC1UNorm, STBI_rgb_alpha, false},
+        {"albedo-alpha", Format::BC3UNorm, STBI_rgb_alpha, false},
+        {"normal", Format::BC5UNorm, STBI_rgb_alpha, true},
+        {"metalness-roughness", Format::BC1UNorm, STBI_rgb_alpha, false},
+        {"metalness-roughness-bc7", Format::BC7UNorm, STBI_rgb_alpha, false},
+        {"mask", Format::BC4UNorm, STBI_grey, false}
+    };
+
+    bool cookTexture(const TextureType& type, const std::string& inputPath)
+    {
+        TextureUtil::TextureInfo info = TextureUtil::load32BitTexture(inputPath.c_str(), type.mChannels);
+        if(info.mData.empty())
+        {
+            printf("Failed to load %s\n", inputPath.c_str());
+            return false;
+        }
+
+        const TextureCompression::CompressedTexture texture = TextureCompression::compressTexture(std::move(info.mData), info.width, info.height,
+                                                                                                  type.mChannels, type.mFormat, type.mNormalMap);
+
+        const std::string outputPath = TextureCompression::getCookedTexturePath(inputPath);
+        if(!TextureCompression::writeDDS(outputPath, texture))
+        {
+            printf("Failed to write %s\n", outputPath.c_str());
+            return false;
+        }
+
+        printf("Cooked %s -> %s (%s, %dx%d, %zu mips)\n", inputPath.c_str(), outputPath.c_str(), type.mName, info.width, info.height, texture.mMips.size());
+
+        return true;
+    }
+}
+
+// Offline cooker, compresses textures to BCn with a full mip chain and writes them next to the source
+// texture as .dds, which the scene loader picks up in preference to the source.
+// usage: BELL_TEXTURE_COOKER <type> <input texture>...
+int main(int argc, char** argv)
+{
+    const TextureType* type = nullptr;
+    if(argc >= 2)
+    {
+        for(const TextureType& candidate : kTextureTypes)
+        {
+            if(strcmp(argv[1], candidate.mName) == 0)
+                type = &candidate;
+        }
+    }
+
+    if(argc < 3 || !type)
+    {
+        printf("usage: %s <type> <input texture>...\ntypes:", argv[0]);
+        for(const TextureType& candidate : kTextureTypes)
+            printf(" %s", candidate.mName);
+        printf("\n");
+
+        return 1;
+    }
+
+    ThreadPool threadPool{};
+    std::vector<std::future<bool>> results{};
+    for(int i = 2; i < argc; ++i)
+        results.push_back(threadPool.addTask(cookTexture, *type, std::string(argv[i])));
+
+    bool success = true;
+    for(auto& result : results)
+        success = result.get() && success;
+
+    return success ? 0 : 1;
+}